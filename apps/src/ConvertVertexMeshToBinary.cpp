@@ -1,6 +1,6 @@
 /*
 
-Copyright (c) 2005-2017, University of Oxford.
+Copyright (c) 2005-2018, University of Oxford.
 All rights reserved.
 
 University of Oxford means the Chancellor, Masters and Scholars of the
@@ -36,8 +36,12 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 /**
  * @file
  *
- * This file gives an example of how you can create your own executable
- * in a user project.
+ * Converts a two-dimensional vertex mesh to the binary format read by VertexMeshBinaryReader.
+ *
+ * Usage: ConvertVertexMeshToBinary input output.vmesh
+ *
+ * The input is either the base name of a pair of .node and .cell files, as read by
+ * VertexMeshReader, or a VirtualLeaf XML file ending in .xml.
  */
 
 #include <iostream>
@@ -48,7 +52,9 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "PetscTools.hpp"
 #include "PetscException.hpp"
 
-#include "Hello.hpp"
+#include "VertexMeshReader.hpp"
+#include "VertexMeshBinaryWriter.hpp"
+#include "VirtualLeafMeshReader.hpp"
 
 int main(int argc, char *argv[])
 {
@@ -57,26 +63,28 @@ int main(int argc, char *argv[])
 
     int exit_code = ExecutableSupport::EXIT_OK;
 
-    // You should put all the main code within a try-catch, to ensure that
-    // you clean up PETSc before quitting.
     try
     {
-        if (argc<2)
+        if (argc != 3)
         {
-            ExecutableSupport::PrintError("Usage: ExampleApp arguments ...", true);
+            ExecutableSupport::PrintError("Usage: ConvertVertexMeshToBinary input output.vmesh", true);
             exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
         }
-        else
+        else if (PetscTools::AmMaster())
         {
-            for (int i=1; i<argc; i++)
+            std::string input(argv[1]);
+            std::string output(argv[2]);
+            if (input.size() > 4 && input.substr(input.size() - 4) == ".xml")
             {
-                if (PetscTools::AmMaster())
-                {
-                    std::string arg_i(argv[i]);
-                    Hello world(arg_i);
-                    std::cout << "Argument " << i << " is " << world.GetMessage() << std::endl << std::flush;
-                }
+                VirtualLeafMeshReader mesh_reader(input);
+                VertexMeshBinaryWriter::WriteFileUsingMeshReader(mesh_reader, output);
             }
+            else
+            {
+                VertexMeshReader<2,2> mesh_reader(input);
+                VertexMeshBinaryWriter::WriteFileUsingMeshReader(mesh_reader, output);
+            }
+            std::cout << "Wrote " << output << std::endl << std::flush;
         }
     }
     catch (const Exception& e)
@@ -85,9 +93,6 @@ int main(int argc, char *argv[])
         exit_code = ExecutableSupport::EXIT_ERROR;
     }
 
-    // Optional - write the machine info to file.
-    ExecutableSupport::WriteMachineInfoFile("machine_info");
-
     // End by finalizing PETSc, and returning a suitable exit code.
     // 0 means 'no error'
     ExecutableSupport::FinalizePetsc();
@@ -0,0 +1,132 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/**
+ * @file
+ *
+ * Generates a large vertex tissue for scaling studies, with a circular wound in the middle,
+ * and writes it in the binary format read by VertexMeshBinaryReader.
+ *
+ * Usage: GenerateLargeTissue -cells N [-relaxation_steps N | -honeycomb_jitter J] [-wound_radius R]
+ *                            [-threads N] [-seed N] -output output.vmesh
+ *
+ * The tissue is about sqrt(N) cells across and up, of unit mean area. By default it is a
+ * Voronoi tessellation relaxed by 5 Lloyd iterations; with -honeycomb_jitter it is a honeycomb
+ * whose nodes are moved by up to J edge lengths. The time taken and the peak memory are printed.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "PetscException.hpp"
+#include "CommandLineArguments.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include "LargeVertexMeshGenerator.hpp"
+
+int main(int argc, char *argv[])
+{
+    // This sets up PETSc and prints out copyright information, etc.
+    ExecutableSupport::StandardStartup(&argc, &argv);
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    try
+    {
+        CommandLineArguments* p_args = CommandLineArguments::Instance();
+        if (!p_args->OptionExists("-cells") || !p_args->OptionExists("-output"))
+        {
+            ExecutableSupport::PrintError("Usage: GenerateLargeTissue -cells N [-relaxation_steps N | -honeycomb_jitter J] "
+                                          "[-wound_radius R] [-threads N] [-seed N] -output output.vmesh", true);
+            exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        }
+        else if (PetscTools::AmMaster())
+        {
+            unsigned num_cells = p_args->GetUnsignedCorrespondingToOption("-cells");
+            unsigned num_cells_across = std::max(1u, (unsigned)floor(sqrt((double)num_cells) + 0.5));
+            std::string output = p_args->GetStringCorrespondingToOption("-output");
+            RandomNumberGenerator::Instance()->Reseed(p_args->OptionExists("-seed") ? p_args->GetUnsignedCorrespondingToOption("-seed") : 0);
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            LargeVertexMeshGenerator generator(num_cells_across, num_cells_across);
+            if (p_args->OptionExists("-threads"))
+            {
+                generator.SetNumThreads(p_args->GetUnsignedCorrespondingToOption("-threads"));
+            }
+            if (p_args->OptionExists("-honeycomb_jitter"))
+            {
+                generator.GenerateJitteredHoneycomb(p_args->GetDoubleCorrespondingToOption("-honeycomb_jitter"));
+            }
+            else
+            {
+                unsigned num_relaxation_steps = 5;
+                if (p_args->OptionExists("-relaxation_steps"))
+                {
+                    num_relaxation_steps = p_args->GetUnsignedCorrespondingToOption("-relaxation_steps");
+                }
+                generator.GenerateVoronoiTissue(num_relaxation_steps);
+            }
+            unsigned num_wound_cells = 0;
+            if (p_args->OptionExists("-wound_radius"))
+            {
+                num_wound_cells = generator.CutCircularWound(p_args->GetDoubleCorrespondingToOption("-wound_radius"));
+            }
+            double generation_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            generator.WriteBinaryFile(output);
+            std::cout << "Wrote " << output << ": " << generator.GetNumElements() << " cells, "
+                      << generator.GetNumNodes() << " nodes, " << num_wound_cells << " cells cut for the wound" << std::endl;
+            std::cout << "Generated in " << generation_seconds << " s on " << generator.GetNumThreads() << " threads" << std::endl;
+            std::cout << "Peak memory: " << generator.GetPeakMemoryBytes()/1048576.0 << " MiB in the generator, "
+                      << LargeVertexMeshGenerator::GetPeakResidentMemoryBytes()/1048576.0 << " MiB for the process" << std::endl << std::flush;
+        }
+    }
+    catch (const Exception& e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+
+    // End by finalizing PETSc, and returning a suitable exit code.
+    // 0 means 'no error'
+    ExecutableSupport::FinalizePetsc();
+    return exit_code;
+}
@@ -0,0 +1,561 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/**
+ * @file
+ *
+ * A benchmark for the wound healing forces. It cuts wounds of several radii into Voronoi
+ * meshes of 10^2 to 10^5 cells and into the virtual leaf mesh, and measures the time per
+ * time step of WoundHealingForce::AddForceContribution(), FarhadifarWoundHealingForce,
+ * MutableVertexMesh::ReMesh() and a full WoundHealingSimulation step. The results are written
+ * as JSON, so that they can be compared between releases.
+ *
+ * Usage: WoundHealingBenchmark [-steps N] [-max_cells N] [-output file.json] [-virtual_leaf path] [-trace file.json]
+ *                              [-thread_counts N1 N2 ...] [-scaling_cells N]
+ *
+ * With -thread_counts, the two forces are also timed with each of the given numbers of threads on
+ * one large Voronoi tissue made by LargeVertexMeshGenerator, of 250000 cells unless -scaling_cells
+ * is given, with a wound of radius 20, or a quarter of its width if that is smaller, cut into it. The forces only use more than one thread if the
+ * project was built with the WOUND_HEALING_USE_OPENMP option.
+ *
+ * The JSON file is written to the WoundHealingBenchmark folder of the Chaste test output. With
+ * -trace, a timeline of the simulations is written there as well, in the Chrome trace format. It
+ * only holds events if the project was built with the WOUND_HEALING_USE_TRACING option.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "PetscException.hpp"
+#include "CommandLineArguments.hpp"
+#include "FileFinder.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "CellsGenerator.hpp"
+#include "CellId.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "NoCellCycleModel.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SimpleTargetAreaModifier.hpp"
+#include "SimulationTime.hpp"
+#include "SmartPointers.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "VertexMeshReader.hpp"
+#include "VoronoiVertexMeshGenerator.hpp"
+
+#include "WoundHealingForce.hpp"
+#include "WoundHealingSimulation.hpp"
+#include "WoundHealingTracer.hpp"
+#include "FarhadifarWoundHealingForce.hpp"
+#include "LargeVertexMeshGenerator.hpp"
+#include "WoundMeshBuilder.hpp"
+#include "WoundMeshUtilities.hpp"
+
+/**
+ * The results of one benchmark case.
+ */
+struct BenchmarkResult
+{
+    /** The name of the mesh. */
+    std::string mMeshName;
+
+    /** The radius of the wound that was cut, in cell diameters of a unit-area cell. */
+    double mWoundRadius;
+
+    /** The number of cells after cutting the wound. */
+    unsigned mNumCells;
+
+    /** The number of nodes after cutting the wound. */
+    unsigned mNumNodes;
+
+    /** The number of nodes around the wounds. */
+    unsigned mNumWoundNodes;
+
+    /** The time taken by the first call to the wound force, which finds the wounds from scratch. */
+    double mWoundForceFirstCallNs;
+
+    /** The mean time per step of WoundHealingForce::AddForceContribution(). */
+    double mWoundForceNsPerStep;
+
+    /** The mean time per step of FarhadifarWoundHealingForce::AddForceContribution(). */
+    double mFarhadifarWoundForceNsPerStep;
+
+    /** The mean time per call of ReMesh(). */
+    double mReMeshNsPerStep;
+
+    /** The mean time per step of a full simulation. */
+    double mSimulationNsPerStep;
+};
+
+/**
+ * The times of the forces with one number of threads, on the large tissue.
+ */
+struct ThreadScalingResult
+{
+    /** The number of threads. */
+    unsigned mNumThreads;
+
+    /** The mean time per step of WoundHealingForce::AddForceContribution(). */
+    double mWoundForceNsPerStep;
+
+    /** The mean time per step of FarhadifarWoundHealingForce::AddForceContribution(). */
+    double mFarhadifarWoundForceNsPerStep;
+};
+
+/**
+ * Set up the singletons needed by a cell-based simulation, as AbstractCellBasedTestSuite does.
+ */
+void SetUpCellBasedSingletons()
+{
+    SimulationTime::Instance()->SetStartTime(0.0);
+    RandomNumberGenerator::Instance()->Reseed(0);
+    CellId::ResetMaxCellId();
+}
+
+/**
+ * Destroy the singletons needed by a cell-based simulation, so that the next case starts afresh.
+ */
+void TearDownCellBasedSingletons()
+{
+    SimulationTime::Destroy();
+    RandomNumberGenerator::Destroy();
+    CellPropertyRegistry::Instance()->Clear();
+}
+
+/**
+ * @param start a time point
+ * @return the number of nanoseconds since the time point
+ */
+double GetNanosecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Run the benchmark on a mesh with wounds already cut into it. The mesh is changed by the simulation.
+ *
+ * @param rMesh the mesh
+ * @param rResult the result, whose mesh name and wound radius are already set
+ * @param numSteps the number of steps to time
+ */
+void RunBenchmarkCase(MutableVertexMesh<2,2>& rMesh, BenchmarkResult& rResult, unsigned numSteps)
+{
+    std::vector<CellPtr> cells;
+    CellsGenerator<NoCellCycleModel, 2> cells_generator;
+    cells_generator.GenerateBasic(cells, rMesh.GetNumElements());
+    for (unsigned i=0; i<cells.size(); i++)
+    {
+        cells[i]->SetBirthTime(-(double)i - 19.0);
+    }
+    VertexBasedCellPopulation<2> cell_population(rMesh, cells);
+    for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+         cell_iter != cell_population.End();
+         ++cell_iter)
+    {
+        cell_iter->GetCellData()->SetItem("target area", 1.0);
+    }
+
+    rResult.mNumCells = cell_population.GetNumRealCells();
+    rResult.mNumNodes = rMesh.GetNumNodes();
+
+    // The wound force on its own. The first call finds the wounds from scratch, later calls patch them.
+    MAKE_PTR(WoundHealingForce<2>, p_wound_force);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    p_wound_force->AddForceContribution(cell_population);
+    rResult.mWoundForceFirstCallNs = GetNanosecondsSince(start);
+
+    rResult.mNumWoundNodes = 0;
+    for (unsigned wound_index=0; wound_index<p_wound_force->rGetWoundLoops().size(); wound_index++)
+    {
+        rResult.mNumWoundNodes += p_wound_force->rGetWoundLoops()[wound_index].size();
+    }
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned step=0; step<numSteps; step++)
+    {
+        p_wound_force->AddForceContribution(cell_population);
+    }
+    rResult.mWoundForceNsPerStep = GetNanosecondsSince(start)/numSteps;
+
+    // The Farhadifar and wound forces combined in a single pass
+    MAKE_PTR(FarhadifarWoundHealingForce<2>, p_fused_force);
+    p_fused_force->AddForceContribution(cell_population);
+    start = std::chrono::steady_clock::now();
+    for (unsigned step=0; step<numSteps; step++)
+    {
+        p_fused_force->AddForceContribution(cell_population);
+    }
+    rResult.mFarhadifarWoundForceNsPerStep = GetNanosecondsSince(start)/numSteps;
+
+    // ReMesh() on an unchanged mesh, after a first call has carried out any swaps that were due
+    rMesh.ReMesh();
+    start = std::chrono::steady_clock::now();
+    for (unsigned step=0; step<numSteps; step++)
+    {
+        rMesh.ReMesh();
+    }
+    rResult.mReMeshNsPerStep = GetNanosecondsSince(start)/numSteps;
+
+    // A full simulation, with output only at its start and end. It behaves as an OffLatticeSimulation, but is traced by step.
+    double dt = 0.01;
+    std::stringstream output_directory;
+    output_directory << "WoundHealingBenchmark/" << rResult.mMeshName << "_" << rResult.mNumCells << "_" << rResult.mWoundRadius;
+
+    WoundHealingSimulation<2> simulator(cell_population);
+    simulator.SetOutputDirectory(output_directory.str());
+    simulator.SetDt(dt);
+    simulator.SetEndTime(numSteps*dt);
+    simulator.SetSamplingTimestepMultiple(numSteps);
+    MAKE_PTR(FarhadifarWoundHealingForce<2>, p_simulation_force);
+    simulator.AddForce(p_simulation_force);
+    MAKE_PTR(SimpleTargetAreaModifier<2>, p_growth_modifier);
+    p_growth_modifier->SetGrowthDuration(0.0);
+    simulator.AddSimulationModifier(p_growth_modifier);
+
+    start = std::chrono::steady_clock::now();
+    simulator.Solve();
+    rResult.mSimulationNsPerStep = GetNanosecondsSince(start)/numSteps;
+}
+
+/**
+ * Time the two forces with each of several numbers of threads on one large tissue. The forces
+ * give the same results with any number of threads, so only their times differ.
+ *
+ * @param numCells the approximate number of cells of the tissue
+ * @param rThreadCounts the numbers of threads
+ * @param numSteps the number of steps to time
+ * @param rNumCells set to the number of cells after cutting the wound
+ * @return the result for each number of threads
+ */
+std::vector<ThreadScalingResult> RunThreadScaling(unsigned numCells, const std::vector<unsigned>& rThreadCounts,
+                                                  unsigned numSteps, unsigned& rNumCells)
+{
+    unsigned num_cells_across = (unsigned)floor(sqrt((double)numCells) + 0.5);
+    LargeVertexMeshGenerator generator(num_cells_across, num_cells_across);
+    generator.GenerateVoronoiTissue(2);
+    generator.CutCircularWound(std::min(20.0, 0.25*num_cells_across));
+    MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+    std::vector<CellPtr> cells;
+    CellsGenerator<NoCellCycleModel, 2> cells_generator;
+    cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+    VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+    for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+         cell_iter != cell_population.End();
+         ++cell_iter)
+    {
+        cell_iter->GetCellData()->SetItem("target area", 1.0);
+    }
+    rNumCells = cell_population.GetNumRealCells();
+
+    std::vector<ThreadScalingResult> results;
+    for (unsigned i=0; i<rThreadCounts.size(); i++)
+    {
+        ThreadScalingResult result;
+        result.mNumThreads = rThreadCounts[i];
+
+        // The first call of each force finds the wounds and sizes its buffers, so is not timed
+        MAKE_PTR(WoundHealingForce<2>, p_wound_force);
+        p_wound_force->SetNumThreads(rThreadCounts[i]);
+        p_wound_force->AddForceContribution(cell_population);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned step=0; step<numSteps; step++)
+        {
+            p_wound_force->AddForceContribution(cell_population);
+        }
+        result.mWoundForceNsPerStep = GetNanosecondsSince(start)/numSteps;
+
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_fused_force);
+        p_fused_force->SetNumThreads(rThreadCounts[i]);
+        p_fused_force->AddForceContribution(cell_population);
+        start = std::chrono::steady_clock::now();
+        for (unsigned step=0; step<numSteps; step++)
+        {
+            p_fused_force->AddForceContribution(cell_population);
+        }
+        result.mFarhadifarWoundForceNsPerStep = GetNanosecondsSince(start)/numSteps;
+        results.push_back(result);
+
+        std::cout << "voronoi " << rNumCells << " cells, " << result.mNumThreads << " threads: "
+                  << result.mFarhadifarWoundForceNsPerStep << " ns per step of the fused force" << std::endl << std::flush;
+    }
+    return results;
+}
+
+/**
+ * Write the results of all cases as JSON.
+ *
+ * @param rResults the results
+ * @param rScalingResults the results of the thread scaling, if it was run
+ * @param numScalingCells the number of cells of the tissue used for the thread scaling
+ * @param numSteps the number of steps that were timed
+ * @param rFile the file to write to
+ */
+void WriteResults(const std::vector<BenchmarkResult>& rResults, const std::vector<ThreadScalingResult>& rScalingResults,
+                  unsigned numScalingCells, unsigned numSteps, out_stream& rFile)
+{
+    *rFile << std::setprecision(10);
+    *rFile << "{\n";
+    *rFile << "  \"benchmark\": \"wound_healing\",\n";
+    *rFile << "  \"num_steps\": " << numSteps << ",\n";
+    *rFile << "  \"timings_compiled_in\": " << (WoundHealingForceTimings::IsEnabled() ? "true" : "false") << ",\n";
+    *rFile << "  \"tracing_compiled_in\": " << (WoundHealingTracer::IsEnabled() ? "true" : "false") << ",\n";
+#ifdef _OPENMP
+    *rFile << "  \"openmp_compiled_in\": true,\n";
+#else
+    *rFile << "  \"openmp_compiled_in\": false,\n";
+#endif
+    *rFile << "  \"cases\": [\n";
+    for (unsigned i=0; i<rResults.size(); i++)
+    {
+        const BenchmarkResult& r_result = rResults[i];
+        *rFile << "    {\n";
+        *rFile << "      \"mesh\": \"" << r_result.mMeshName << "\",\n";
+        *rFile << "      \"wound_radius\": " << r_result.mWoundRadius << ",\n";
+        *rFile << "      \"num_cells\": " << r_result.mNumCells << ",\n";
+        *rFile << "      \"num_nodes\": " << r_result.mNumNodes << ",\n";
+        *rFile << "      \"num_wound_nodes\": " << r_result.mNumWoundNodes << ",\n";
+        *rFile << "      \"wound_force_first_call_ns\": " << r_result.mWoundForceFirstCallNs << ",\n";
+        *rFile << "      \"wound_force_ns_per_step\": " << r_result.mWoundForceNsPerStep << ",\n";
+        *rFile << "      \"farhadifar_wound_force_ns_per_step\": " << r_result.mFarhadifarWoundForceNsPerStep << ",\n";
+        *rFile << "      \"remesh_ns_per_step\": " << r_result.mReMeshNsPerStep << ",\n";
+        *rFile << "      \"simulation_ns_per_step\": " << r_result.mSimulationNsPerStep << "\n";
+        *rFile << "    }" << (i+1 < rResults.size() ? "," : "") << "\n";
+    }
+    *rFile << "  ],\n";
+
+    // Speedups are relative to the first number of threads
+    *rFile << "  \"thread_scaling_num_cells\": " << numScalingCells << ",\n";
+    *rFile << "  \"thread_scaling\": [\n";
+    for (unsigned i=0; i<rScalingResults.size(); i++)
+    {
+        const ThreadScalingResult& r_result = rScalingResults[i];
+        *rFile << "    {\n";
+        *rFile << "      \"num_threads\": " << r_result.mNumThreads << ",\n";
+        *rFile << "      \"wound_force_ns_per_step\": " << r_result.mWoundForceNsPerStep << ",\n";
+        *rFile << "      \"wound_force_speedup\": " << rScalingResults[0].mWoundForceNsPerStep/r_result.mWoundForceNsPerStep << ",\n";
+        *rFile << "      \"farhadifar_wound_force_ns_per_step\": " << r_result.mFarhadifarWoundForceNsPerStep << ",\n";
+        *rFile << "      \"farhadifar_wound_force_speedup\": "
+               << rScalingResults[0].mFarhadifarWoundForceNsPerStep/r_result.mFarhadifarWoundForceNsPerStep << "\n";
+        *rFile << "    }" << (i+1 < rScalingResults.size() ? "," : "") << "\n";
+    }
+    *rFile << "  ]\n";
+    *rFile << "}\n";
+}
+
+int main(int argc, char *argv[])
+{
+    // This sets up PETSc and prints out copyright information, etc.
+    ExecutableSupport::StandardStartup(&argc, &argv);
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    try
+    {
+        CommandLineArguments* p_args = CommandLineArguments::Instance();
+        unsigned num_steps = 20;
+        if (p_args->OptionExists("-steps"))
+        {
+            num_steps = p_args->GetUnsignedCorrespondingToOption("-steps");
+        }
+        unsigned max_num_cells = 100000;
+        if (p_args->OptionExists("-max_cells"))
+        {
+            max_num_cells = p_args->GetUnsignedCorrespondingToOption("-max_cells");
+        }
+        std::string output_file_name = "wound_healing_benchmark.json";
+        if (p_args->OptionExists("-output"))
+        {
+            output_file_name = p_args->GetStringCorrespondingToOption("-output");
+        }
+        std::string virtual_leaf_path = "projects/wound_healing_comparison/test/data/virtual_leaf";
+        if (p_args->OptionExists("-virtual_leaf"))
+        {
+            virtual_leaf_path = p_args->GetStringCorrespondingToOption("-virtual_leaf");
+        }
+        std::string trace_file_name;
+        if (p_args->OptionExists("-trace"))
+        {
+            trace_file_name = p_args->GetStringCorrespondingToOption("-trace");
+        }
+        std::vector<unsigned> thread_counts;
+        if (p_args->OptionExists("-thread_counts"))
+        {
+            thread_counts = p_args->GetUnsignedsCorrespondingToOption("-thread_counts");
+        }
+        unsigned num_scaling_cells = 250000;
+        if (p_args->OptionExists("-scaling_cells"))
+        {
+            num_scaling_cells = p_args->GetUnsignedCorrespondingToOption("-scaling_cells");
+        }
+        if (num_steps == 0)
+        {
+            EXCEPTION("The number of steps must be positive");
+        }
+        for (unsigned i=0; i<thread_counts.size(); i++)
+        {
+            if (thread_counts[i] == 0)
+            {
+                EXCEPTION("The numbers of threads must be positive");
+            }
+        }
+        if (!trace_file_name.empty())
+        {
+            WoundHealingTracer::Instance()->SetThreadName("main");
+            WoundHealingTracer::Instance()->Start();
+        }
+
+        // The wound radii, in units of the diameter of a unit-area cell
+        std::vector<double> wound_radii;
+        wound_radii.push_back(1.5);
+        wound_radii.push_back(3.0);
+        wound_radii.push_back(6.0);
+
+        std::vector<BenchmarkResult> results;
+
+        // Voronoi meshes of 10^2 to 10^5 cells
+        for (unsigned num_cells=100; num_cells<=max_num_cells; num_cells*=10)
+        {
+            unsigned num_cells_across = (unsigned)floor(sqrt((double)num_cells) + 0.5);
+            for (unsigned radius_index=0; radius_index<wound_radii.size(); radius_index++)
+            {
+                // Keep the wound well inside the tissue
+                if (wound_radii[radius_index] > 0.25*num_cells_across)
+                {
+                    continue;
+                }
+
+                SetUpCellBasedSingletons();
+                VoronoiVertexMeshGenerator generator(num_cells_across, num_cells_across, 1, 1.0);
+                MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+                WoundMeshUtilities::CutCircularWound(*p_mesh, wound_radii[radius_index]);
+
+                BenchmarkResult result;
+                result.mMeshName = "voronoi";
+                result.mWoundRadius = wound_radii[radius_index];
+                RunBenchmarkCase(*p_mesh, result, num_steps);
+                results.push_back(result);
+                TearDownCellBasedSingletons();
+
+                std::cout << "voronoi " << result.mNumCells << " cells, wound radius " << result.mWoundRadius
+                          << ": " << result.mSimulationNsPerStep << " ns per simulation step" << std::endl << std::flush;
+            }
+        }
+
+        // The virtual leaf mesh, with its large elements removed as in TestReadAndRunVirtualLeaf and rescaled to unit mean cell area
+        FileFinder virtual_leaf_nodes(virtual_leaf_path + ".node", RelativeTo::ChasteSourceRoot);
+        std::string virtual_leaf_base = virtual_leaf_nodes.GetAbsolutePath();
+        virtual_leaf_base = virtual_leaf_base.substr(0, virtual_leaf_base.size() - 5);
+        for (unsigned radius_index=0; radius_index<wound_radii.size(); radius_index++)
+        {
+            SetUpCellBasedSingletons();
+            VertexMeshReader<2,2> mesh_reader(virtual_leaf_base);
+            MutableVertexMesh<2,2> mesh;
+            mesh.ConstructFromMeshReader(mesh_reader);
+
+            // Remove the large elements, rescale and cut the wound with a single ReMesh()
+            WoundMeshBuilder builder(mesh);
+            builder.RemoveElementsWithMoreNodesThan(12);
+            builder.RescaleToMeanElementArea(1.0);
+            if (wound_radii[radius_index] > 0.25*sqrt((double)builder.GetNumKeptElements()))
+            {
+                TearDownCellBasedSingletons();
+                continue;
+            }
+            builder.CutCircularWound(wound_radii[radius_index]);
+            builder.Build();
+
+            BenchmarkResult result;
+            result.mMeshName = "virtual_leaf";
+            result.mWoundRadius = wound_radii[radius_index];
+            RunBenchmarkCase(mesh, result, num_steps);
+            results.push_back(result);
+            TearDownCellBasedSingletons();
+
+            std::cout << "virtual_leaf " << result.mNumCells << " cells, wound radius " << result.mWoundRadius
+                      << ": " << result.mSimulationNsPerStep << " ns per simulation step" << std::endl << std::flush;
+        }
+
+        // The thread scaling on one large tissue
+        std::vector<ThreadScalingResult> scaling_results;
+        unsigned num_scaling_cells_cut = 0;
+        if (!thread_counts.empty())
+        {
+            SetUpCellBasedSingletons();
+            scaling_results = RunThreadScaling(num_scaling_cells, thread_counts, num_steps, num_scaling_cells_cut);
+            TearDownCellBasedSingletons();
+        }
+
+        if (PetscTools::AmMaster())
+        {
+            OutputFileHandler handler("WoundHealingBenchmark", false);
+            out_stream p_file = handler.OpenOutputFile(output_file_name);
+            WriteResults(results, scaling_results, num_scaling_cells_cut, num_steps, p_file);
+            p_file->close();
+            std::cout << "Results written to " << handler.GetOutputDirectoryFullPath() << output_file_name << std::endl;
+
+            if (!trace_file_name.empty())
+            {
+                WoundHealingTracer::Instance()->Stop();
+                WoundHealingTracer::Instance()->WriteChromeTrace(handler.GetOutputDirectoryFullPath() + trace_file_name);
+                std::cout << "Trace of " << WoundHealingTracer::Instance()->GetNumEvents() << " events written to "
+                          << handler.GetOutputDirectoryFullPath() << trace_file_name << std::endl;
+            }
+        }
+    }
+    catch (const Exception& e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+
+    // Write the machine info next to the results, so that they can be compared between machines
+    ExecutableSupport::SetOutputDirectory("WoundHealingBenchmark");
+    ExecutableSupport::WriteMachineInfoFile("machine_info");
+
+    // End by finalizing PETSc, and returning a suitable exit code.
+    // 0 means 'no error'
+    ExecutableSupport::FinalizePetsc();
+    return exit_code;
+}
@@ -0,0 +1,1044 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/**
+ * @file
+ *
+ * Runs wound healing simulations over a grid of parameters.
+ *
+ * Usage: WoundHealingSweep -grid grid.txt [-mesh path | -voronoi num_cells] [-output folder] [-workers N | -mpi] [-full_output] [-ensemble | -quasi_static]
+ *
+ * The grid file has a line for each parameter, giving its name and the values it takes, and
+ * every combination of values is run. See apps/sweeps/wound_tension_sweep.txt for an example.
+ *
+ * The base mesh is the virtual leaf mesh by default. It can also be a binary mesh (.vmesh),
+ * a VirtualLeaf XML file (.xml), the base name of a pair of .node and .cell files, or a
+ * Voronoi mesh with a given number of cells. It is built and preprocessed once and saved
+ * as a binary mesh.
+ *
+ * Runs that only differ in their force parameters and end time share a pre-wound state:
+ * the tissue is relaxed for relaxation_time, the wound is cut, and the whole simulation is
+ * checkpointed with CellBasedSimulationArchiver once. The sweep then loads each checkpoint
+ * once, and forks a worker process for each run from the loaded simulation, keeping up to
+ * -workers of them busy at a time. The worker changes the force parameters and carries on
+ * solving, so no branch has to read or deserialise the checkpoint again.
+ *
+ * A process that has started MPI must not fork, so such a sweep runs in a single process
+ * and never starts PETSc or MPI. With -mpi, PETSc and MPI are started instead, and the
+ * checkpoints and runs are shared between the MPI processes (mpirun -np N). Each process
+ * then carries out its own share of the runs one after another, loading the checkpoint
+ * again for each run, and -workers and -ensemble cannot be used. Each run writes a summary row
+ * once it has finished, and these are gathered into summary.csv at the end. When a sweep
+ * is restarted with the same grid and output folder, existing checkpoints are reused and
+ * runs with a summary row are skipped.
+ *
+ * Each run follows its wounds with a WoundMetricsModifier, which writes wound_metrics.csv in
+ * the output folder of the run. The whole mesh is only written at the start and end of a run,
+ * unless -full_output is given. A run stops as soon as its wound has closed, and the time
+ * this took is written in the closure_time column of the summary, which is empty for runs
+ * whose wound was still open at the end time.
+ *
+ * With -ensemble, runs that share a checkpoint and only differ in their wound tension are
+ * first run in lockstep by a WoundTensionEnsemble, in the process that loaded the checkpoint.
+ * Each run then carries on in its own worker from the state its lane had when it split off,
+ * which is before its first cell rearrangement. The wound metrics of such a run start at the
+ * hand-off, and its wall time includes its share of the lockstep.
+ *
+ * With -quasi_static, each run only finds the mechanical equilibrium of its tissue after the
+ * wound is cut, by minimising the energy of its forces with a WoundEnergyMinimiser instead of
+ * following the dynamics. The final wound area of the run is then its area at equilibrium,
+ * and its closure time is empty.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "PetscException.hpp"
+#include "CommandLineArguments.hpp"
+#include "FileFinder.hpp"
+#include "OutputFileHandler.hpp"
+
+#include "CellsGenerator.hpp"
+#include "CellId.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "NoCellCycleModel.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SimpleTargetAreaModifier.hpp"
+#include "SimulationTime.hpp"
+#include "SmartPointers.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "VertexMeshReader.hpp"
+#include "VoronoiVertexMeshGenerator.hpp"
+#include "CellBasedSimulationArchiver.hpp"
+
+#include "FarhadifarWoundHealingForce.hpp"
+#include "VertexMeshBinaryReader.hpp"
+#include "VertexMeshBinaryWriter.hpp"
+#include "VirtualLeafMeshReader.hpp"
+#include "WoundMeshUtilities.hpp"
+#include "WoundMetricsModifier.hpp"
+#include "WoundEnergyMinimiser.hpp"
+#include "WoundHealingSimulation.hpp"
+#include "WoundTensionEnsemble.hpp"
+
+/**
+ * The parameters of a sweep, in the order in which they appear in run indices and summary rows.
+ * The last parameter varies fastest between consecutive runs.
+ */
+const char* SWEEP_PARAMETER_NAMES[] = {"wound_tension",
+                                       "area_elasticity",
+                                       "perimeter_contractility",
+                                       "line_tension",
+                                       "boundary_line_tension",
+                                       "wound_radius",
+                                       "end_time",
+                                       "dt",
+                                       "relaxation_time"};
+
+/** The number of parameters of a sweep. */
+const unsigned NUM_SWEEP_PARAMETERS = 9;
+
+/** The value of each parameter if it is not given in the grid. */
+const double DEFAULT_SWEEP_PARAMETERS[NUM_SWEEP_PARAMETERS] = {1.0, 1.0, 0.04, 0.12, 0.12, 3.0, 10.0, 0.01, 1.0};
+
+/**
+ * The parameters that are fixed in the pre-wound checkpoint: runs that agree in these
+ * branch from the same checkpoint. The other parameters can differ between branches.
+ */
+const unsigned CHECKPOINT_PARAMETERS[] = {5, 7, 8};
+
+/** The number of parameters that are fixed in the pre-wound checkpoint. */
+const unsigned NUM_CHECKPOINT_PARAMETERS = 3;
+
+/** The type of the simulation archiver. */
+typedef CellBasedSimulationArchiver<2, WoundHealingSimulation<2> > SimulationArchiver;
+
+/**
+ * Read a parameter grid.
+ *
+ * @param rPathToFile the path to the grid file
+ * @return the values of each parameter, in the order of SWEEP_PARAMETER_NAMES
+ */
+std::vector<std::vector<double> > ReadParameterGrid(const std::string& rPathToFile)
+{
+    std::vector<std::vector<double> > grid(NUM_SWEEP_PARAMETERS);
+
+    std::ifstream file(rPathToFile.c_str());
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open the parameter grid " + rPathToFile);
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        line = line.substr(0, line.find('#'));
+        std::stringstream line_stream(line);
+        std::string name;
+        if (!(line_stream >> name))
+        {
+            continue;
+        }
+
+        unsigned parameter = 0;
+        while (parameter < NUM_SWEEP_PARAMETERS && name != SWEEP_PARAMETER_NAMES[parameter])
+        {
+            parameter++;
+        }
+        if (parameter == NUM_SWEEP_PARAMETERS)
+        {
+            EXCEPTION("Unknown parameter " + name + " in the parameter grid " + rPathToFile);
+        }
+        if (!grid[parameter].empty())
+        {
+            EXCEPTION("The parameter " + name + " is given twice in the parameter grid " + rPathToFile);
+        }
+
+        double value;
+        while (line_stream >> value)
+        {
+            grid[parameter].push_back(value);
+        }
+        if (!line_stream.eof() || grid[parameter].empty())
+        {
+            EXCEPTION("Could not read the values of " + name + " in the parameter grid " + rPathToFile);
+        }
+    }
+
+    for (unsigned parameter=0; parameter<NUM_SWEEP_PARAMETERS; parameter++)
+    {
+        if (grid[parameter].empty())
+        {
+            grid[parameter].push_back(DEFAULT_SWEEP_PARAMETERS[parameter]);
+        }
+    }
+    return grid;
+}
+
+/**
+ * @param rGrid the values of each parameter
+ * @return the number of runs in the sweep
+ */
+unsigned GetNumRuns(const std::vector<std::vector<double> >& rGrid)
+{
+    unsigned num_runs = 1;
+    for (unsigned parameter=0; parameter<NUM_SWEEP_PARAMETERS; parameter++)
+    {
+        num_runs *= rGrid[parameter].size();
+    }
+    return num_runs;
+}
+
+/**
+ * @param rGrid the values of each parameter
+ * @param runIndex the index of a run
+ * @return the value of each parameter in the run
+ */
+std::vector<double> GetRunParameters(const std::vector<std::vector<double> >& rGrid, unsigned runIndex)
+{
+    std::vector<double> parameters(NUM_SWEEP_PARAMETERS);
+    for (unsigned parameter=NUM_SWEEP_PARAMETERS; parameter-- > 0; )
+    {
+        parameters[parameter] = rGrid[parameter][runIndex % rGrid[parameter].size()];
+        runIndex /= rGrid[parameter].size();
+    }
+    return parameters;
+}
+
+/**
+ * @param rGrid the values of each parameter
+ * @return the grid written out in the format of grid files, for comparison on restart
+ */
+std::string GetGridDescription(const std::vector<std::vector<double> >& rGrid)
+{
+    std::stringstream description;
+    description << std::setprecision(17);
+    for (unsigned parameter=0; parameter<NUM_SWEEP_PARAMETERS; parameter++)
+    {
+        description << SWEEP_PARAMETER_NAMES[parameter];
+        for (unsigned i=0; i<rGrid[parameter].size(); i++)
+        {
+            description << " " << rGrid[parameter][i];
+        }
+        description << "\n";
+    }
+    return description.str();
+}
+
+/**
+ * @param runIndex the index of a run
+ * @return the name of the folder and summary row file of the run
+ */
+std::string GetRunName(unsigned runIndex)
+{
+    std::stringstream name;
+    name << "run_" << std::setw(5) << std::setfill('0') << runIndex;
+    return name.str();
+}
+
+/**
+ * Sort the runs of a sweep into the checkpoints they branch from.
+ *
+ * @param rGrid the values of each parameter
+ * @param rCheckpointOfRun filled with the index of the checkpoint of each run
+ * @return the index of the first run of each checkpoint
+ */
+std::vector<unsigned> GetCheckpoints(const std::vector<std::vector<double> >& rGrid, std::vector<unsigned>& rCheckpointOfRun)
+{
+    std::vector<unsigned> first_runs;
+    unsigned num_runs = GetNumRuns(rGrid);
+    rCheckpointOfRun.resize(num_runs);
+    for (unsigned run_index=0; run_index<num_runs; run_index++)
+    {
+        std::vector<double> parameters = GetRunParameters(rGrid, run_index);
+        unsigned checkpoint = 0;
+        for ( ; checkpoint<first_runs.size(); checkpoint++)
+        {
+            std::vector<double> checkpoint_parameters = GetRunParameters(rGrid, first_runs[checkpoint]);
+            bool same_checkpoint = true;
+            for (unsigned i=0; i<NUM_CHECKPOINT_PARAMETERS; i++)
+            {
+                same_checkpoint = same_checkpoint && (parameters[CHECKPOINT_PARAMETERS[i]] == checkpoint_parameters[CHECKPOINT_PARAMETERS[i]]);
+            }
+            if (same_checkpoint)
+            {
+                break;
+            }
+        }
+        if (checkpoint == first_runs.size())
+        {
+            first_runs.push_back(run_index);
+        }
+        rCheckpointOfRun[run_index] = checkpoint;
+    }
+    return first_runs;
+}
+
+/**
+ * @param checkpoint the index of a checkpoint
+ * @return the name of the simulation folder of the checkpoint
+ */
+std::string GetCheckpointName(unsigned checkpoint)
+{
+    std::stringstream name;
+    name << "pre_wound_" << std::setw(3) << std::setfill('0') << checkpoint;
+    return name.str();
+}
+
+/**
+ * @return the heading of the summary table
+ */
+std::string GetSummaryHeading()
+{
+    std::string heading = "run";
+    for (unsigned parameter=0; parameter<NUM_SWEEP_PARAMETERS; parameter++)
+    {
+        heading += std::string(",") + SWEEP_PARAMETER_NAMES[parameter];
+    }
+    return heading + ",num_cells,initial_wound_area,final_wound_area,num_open_wounds,closure_time,wall_time_s";
+}
+
+/**
+ * Set up the singletons needed by a cell-based simulation, as AbstractCellBasedTestSuite does.
+ */
+void SetUpCellBasedSingletons()
+{
+    SimulationTime::Instance()->SetStartTime(0.0);
+    RandomNumberGenerator::Instance()->Reseed(0);
+    CellId::ResetMaxCellId();
+}
+
+/**
+ * Destroy the singletons needed by a cell-based simulation, so that the next run starts afresh.
+ */
+void TearDownCellBasedSingletons()
+{
+    SimulationTime::Destroy();
+    RandomNumberGenerator::Destroy();
+    CellPropertyRegistry::Instance()->Clear();
+}
+
+/**
+ * Build and preprocess the base mesh, and save it as a binary mesh.
+ *
+ * @param rMeshPath the path given with -mesh, or an empty string
+ * @param numVoronoiCells the number of cells given with -voronoi, or zero
+ * @param rBinaryPath the path of the binary mesh to write
+ */
+void WriteBaseMesh(const std::string& rMeshPath, unsigned numVoronoiCells, const std::string& rBinaryPath)
+{
+    SetUpCellBasedSingletons();
+    if (numVoronoiCells > 0)
+    {
+        unsigned num_cells_across = (unsigned)floor(sqrt((double)numVoronoiCells) + 0.5);
+        VoronoiVertexMeshGenerator generator(num_cells_across, num_cells_across, 1, 1.0);
+        VertexMeshBinaryWriter::WriteFileUsingMesh(*(generator.GetMesh()), rBinaryPath);
+    }
+    else if (rMeshPath.size() > 6 && rMeshPath.substr(rMeshPath.size() - 6) == ".vmesh")
+    {
+        // A binary mesh is assumed to be ready for use
+        VertexMeshBinaryReader mesh_reader(rMeshPath);
+        VertexMeshBinaryWriter::WriteFileUsingMeshReader(mesh_reader, rBinaryPath);
+    }
+    else
+    {
+        // Other meshes are prepared as the virtual leaf mesh is in TestReadAndRunVirtualLeaf, but rescaled to unit mean area
+        MutableVertexMesh<2,2> mesh;
+        if (rMeshPath.size() > 4 && rMeshPath.substr(rMeshPath.size() - 4) == ".xml")
+        {
+            VirtualLeafMeshReader mesh_reader(rMeshPath);
+            mesh.ConstructFromMeshReader(mesh_reader);
+        }
+        else
+        {
+            VertexMeshReader<2,2> mesh_reader(rMeshPath);
+            mesh.ConstructFromMeshReader(mesh_reader);
+        }
+        WoundMeshUtilities::RemoveLargeElementsAndRescale(mesh, 12, 1.0);
+        VertexMeshBinaryWriter::WriteFileUsingMesh(mesh, rBinaryPath);
+    }
+    TearDownCellBasedSingletons();
+}
+
+/**
+ * @param rCellPopulation a cell population
+ * @param rNumOpenWounds set to the number of wounds in the population
+ * @return the total area of the wounds in the population
+ */
+double GetTotalWoundArea(VertexBasedCellPopulation<2>& rCellPopulation, unsigned& rNumOpenWounds)
+{
+    WoundHealingForce<2> wound_finder;
+    std::vector<std::vector<unsigned> > boundary_loops;
+    wound_finder.LabelBoundaryLoops(rCellPopulation, boundary_loops);
+
+    double total_area = 0.0;
+    rNumOpenWounds = 0;
+    for (unsigned loop_index=0; loop_index<boundary_loops.size(); loop_index++)
+    {
+        double signed_area = WoundMeshUtilities::GetSignedAreaOfLoop(rCellPopulation.rGetMesh(), boundary_loops[loop_index]);
+        if (boundary_loops[loop_index].size() > 2 && signed_area < 0.0)
+        {
+            total_area -= signed_area;
+            rNumOpenWounds++;
+        }
+    }
+    return total_area;
+}
+
+/**
+ * Relax the tissue, cut the wound and checkpoint the simulation, for all runs that share
+ * the parameters of a given run.
+ *
+ * @param rParameters the parameters of the first run of the checkpoint
+ * @param rSweepFolder the output folder of the sweep, relative to the Chaste test output
+ * @param rCheckpointName the name of the checkpoint
+ * @param rBaseMeshPath the path to the binary base mesh
+ */
+void WriteCheckpoint(const std::vector<double>& rParameters,
+                     const std::string& rSweepFolder,
+                     const std::string& rCheckpointName,
+                     const std::string& rBaseMeshPath)
+{
+    SetUpCellBasedSingletons();
+
+    VertexMeshBinaryReader mesh_reader(rBaseMeshPath);
+    MutableVertexMesh<2,2> mesh;
+    mesh.ConstructFromMeshReader(mesh_reader);
+
+    std::vector<CellPtr> cells;
+    CellsGenerator<NoCellCycleModel, 2> cells_generator;
+    cells_generator.GenerateBasic(cells, mesh.GetNumElements());
+    for (unsigned i=0; i<cells.size(); i++)
+    {
+        cells[i]->SetBirthTime(-(double)i - 19.0);
+    }
+    VertexBasedCellPopulation<2> cell_population(mesh, cells);
+    cell_population.SetRestrictVertexMovementBoolean(false);
+
+    // Relax the tissue with the default parameters; each branch sets its own
+    WoundHealingSimulation<2> simulator(cell_population);
+    simulator.SetOutputDirectory(rSweepFolder + "/" + rCheckpointName);
+    simulator.SetDt(rParameters[7]);
+    simulator.SetEndTime(rParameters[8]);
+    simulator.SetSamplingTimestepMultiple(100);
+    MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+    simulator.AddForce(p_force);
+    MAKE_PTR(SimpleTargetAreaModifier<2>, p_growth_modifier);
+    p_growth_modifier->SetGrowthDuration(0.0);
+    simulator.AddSimulationModifier(p_growth_modifier);
+    simulator.Solve();
+
+    WoundMeshUtilities::CutCircularWound(cell_population, rParameters[5]);
+    SimulationArchiver::Save(&simulator);
+
+    TearDownCellBasedSingletons();
+}
+
+/**
+ * @param rSimulator a simulation loaded from a checkpoint
+ * @return the wound healing force of the simulation
+ */
+boost::shared_ptr<FarhadifarWoundHealingForce<2> > GetWoundHealingForce(WoundHealingSimulation<2>& rSimulator)
+{
+    boost::shared_ptr<FarhadifarWoundHealingForce<2> > p_force;
+    for (unsigned i=0; i<rSimulator.rGetForceCollection().size(); i++)
+    {
+        boost::shared_ptr<FarhadifarWoundHealingForce<2> > p_this_force =
+                boost::dynamic_pointer_cast<FarhadifarWoundHealingForce<2> >(rSimulator.rGetForceCollection()[i]);
+        if (p_this_force)
+        {
+            p_force = p_this_force;
+        }
+    }
+    if (!p_force)
+    {
+        EXCEPTION("The checkpoint has no FarhadifarWoundHealingForce");
+    }
+    return p_force;
+}
+
+/**
+ * Set the force parameters of a run.
+ *
+ * @param pForce the wound healing force
+ * @param rParameters the parameters of the run
+ */
+void SetForceParameters(boost::shared_ptr<FarhadifarWoundHealingForce<2> > pForce, const std::vector<double>& rParameters)
+{
+    pForce->SetWoundTensionParameter(rParameters[0]);
+    pForce->SetAreaElasticityParameter(rParameters[1]);
+    pForce->SetPerimeterContractilityParameter(rParameters[2]);
+    pForce->SetLineTensionParameter(rParameters[3]);
+    pForce->SetBoundaryLineTensionParameter(rParameters[4]);
+}
+
+/**
+ * Carry on a simulation loaded from a checkpoint with the parameters of one run, and write
+ * the summary row of the run. This changes the simulation, so it is called in a worker process
+ * or on a copy of the checkpoint that is loaded for this run alone.
+ *
+ * @param rSimulator the simulation loaded from the checkpoint of the run
+ * @param rGrid the values of each parameter
+ * @param runIndex the index of the run
+ * @param rSweepFolder the output folder of the sweep, relative to the Chaste test output
+ * @param fullOutput whether to write the whole mesh at the usual sampling interval
+ * @param quasiStatic whether to minimise the energy rather than follow the dynamics
+ * @param pEnsemble an ensemble that has run this run in lockstep with others, if any
+ * @param lane the lane of the run in the ensemble
+ * @param sharedWallTime the share of this run in the wall time of the ensemble
+ */
+void RunBranch(WoundHealingSimulation<2>& rSimulator,
+               const std::vector<std::vector<double> >& rGrid,
+               unsigned runIndex,
+               const std::string& rSweepFolder,
+               bool fullOutput,
+               bool quasiStatic,
+               const WoundTensionEnsemble* pEnsemble=nullptr,
+               unsigned lane=0,
+               double sharedWallTime=0.0)
+{
+    std::vector<double> parameters = GetRunParameters(rGrid, runIndex);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    boost::shared_ptr<FarhadifarWoundHealingForce<2> > p_force = GetWoundHealingForce(rSimulator);
+    SetForceParameters(p_force, parameters);
+
+    VertexBasedCellPopulation<2>& r_cell_population = static_cast<VertexBasedCellPopulation<2>&>(rSimulator.rGetCellPopulation());
+    unsigned num_open_wounds = 0;
+    double initial_wound_area = GetTotalWoundArea(r_cell_population, num_open_wounds);
+    if (pEnsemble != nullptr)
+    {
+        pEnsemble->HandOffLane(lane, r_cell_population);
+    }
+
+    if (quasiStatic)
+    {
+        WoundEnergyMinimiser<2> minimiser(r_cell_population, p_force);
+        if (!minimiser.Minimise())
+        {
+            EXCEPTION("The energy minimisation did not reach equilibrium");
+        }
+        std::cout << GetRunName(runIndex) << " reached equilibrium after " << minimiser.GetNumForceEvaluations()
+                  << " force evaluations" << std::endl;
+    }
+    else
+    {
+        MAKE_PTR_ARGS(WoundMetricsModifier<2>, p_metrics_modifier, (p_force));
+        rSimulator.AddSimulationModifier(p_metrics_modifier);
+        if (!fullOutput)
+        {
+            unsigned num_steps = (unsigned)ceil(parameters[6]/parameters[7]);
+            rSimulator.SetSamplingTimestepMultiple(std::max(num_steps, 1u));
+        }
+
+        // The end time of a run is measured from when the wound was cut, and the run stops early once it has closed
+        rSimulator.SetOutputDirectory(rSweepFolder + "/" + GetRunName(runIndex));
+        rSimulator.SetEndTime(parameters[8] + parameters[6]);
+        rSimulator.SetWoundClosureStoppingEvent(p_force);
+        rSimulator.Solve();
+    }
+
+    double final_wound_area = GetTotalWoundArea(r_cell_population, num_open_wounds);
+    double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() + sharedWallTime;
+
+    // Write the row to a temporary file first, so that a run that is killed never leaves a partial row
+    OutputFileHandler handler(rSweepFolder, false);
+    std::string row_path = handler.GetOutputDirectoryFullPath() + GetRunName(runIndex) + ".row";
+    std::string temporary_path = row_path + ".tmp";
+    std::ofstream row_file(temporary_path.c_str());
+    row_file << std::setprecision(10) << runIndex;
+    for (unsigned parameter=0; parameter<NUM_SWEEP_PARAMETERS; parameter++)
+    {
+        row_file << "," << parameters[parameter];
+    }
+    row_file << "," << r_cell_population.GetNumRealCells()
+             << "," << initial_wound_area
+             << "," << final_wound_area
+             << "," << num_open_wounds
+             << ",";
+    if (rSimulator.GetWoundsHaveClosed())
+    {
+        row_file << rSimulator.GetWoundClosureTime() - parameters[8];
+    }
+    row_file << "," << wall_time << "\n";
+    row_file.close();
+    if (row_file.fail() || rename(temporary_path.c_str(), row_path.c_str()) != 0)
+    {
+        EXCEPTION("Could not write the summary row " + row_path);
+    }
+}
+
+/**
+ * @return the number of processes the sweep was launched on by mpirun, as far as the
+ * environment of the common MPI implementations tells, or 1 if it was launched directly
+ */
+unsigned GetNumLaunchedProcesses()
+{
+    const char* variables[3] = {"OMPI_COMM_WORLD_SIZE", "PMI_SIZE", "MPI_LOCALNRANKS"};
+    for (unsigned i=0; i<3; i++)
+    {
+        const char* p_value = getenv(variables[i]);
+        if (p_value != nullptr && atoi(p_value) > 1)
+        {
+            return atoi(p_value);
+        }
+    }
+    return 1;
+}
+
+/**
+ * Carry out a list of runs on a pool of worker processes. Each worker is a forked child
+ * process that carries out one run from the queue, starting from a copy of the memory of
+ * this process, and a new worker is started whenever one finishes. This must only be used
+ * when MPI has not been started, as MPI does not allow its processes to fork.
+ *
+ * @param rQueue the indices of the runs to carry out
+ * @param numWorkers the number of worker processes to run at the same time
+ * @param rRun the function that carries out a run, given its index
+ * @return the number of runs that failed
+ */
+unsigned RunQueueOnWorkers(const std::vector<unsigned>& rQueue,
+                           unsigned numWorkers,
+                           const std::function<void(unsigned)>& rRun)
+{
+    unsigned num_failed_runs = 0;
+    unsigned next_run = 0;
+    unsigned num_running = 0;
+    std::cout << std::flush;
+    while (next_run < rQueue.size() || num_running > 0)
+    {
+        while (num_running < numWorkers && next_run < rQueue.size())
+        {
+            pid_t process_id = fork();
+            if (process_id == 0)
+            {
+                // This is the worker. It leaves without any clean-up, which belongs to the parent.
+                int exit_status = EXIT_SUCCESS;
+                try
+                {
+                    rRun(rQueue[next_run]);
+                }
+                catch (const Exception& e)
+                {
+                    std::cerr << GetRunName(rQueue[next_run]) << " failed: " << e.GetMessage() << std::endl;
+                    exit_status = EXIT_FAILURE;
+                }
+                std::cout << std::flush;
+                _exit(exit_status);
+            }
+            else if (process_id < 0)
+            {
+                EXCEPTION("Could not start a worker process");
+            }
+            next_run++;
+            num_running++;
+        }
+
+        int status;
+        if (wait(&status) > 0)
+        {
+            num_running--;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+            {
+                num_failed_runs++;
+            }
+        }
+    }
+    return num_failed_runs;
+}
+
+/**
+ * Carry out a list of runs one after another in this process, without forking. This is used
+ * instead of RunQueueOnWorkers when MPI has been started with -mpi.
+ *
+ * @param rQueue the indices of the runs to carry out
+ * @param rRun the function that carries out a run, given its index
+ * @return the number of runs that failed
+ */
+unsigned RunQueueInProcess(const std::vector<unsigned>& rQueue,
+                           const std::function<void(unsigned)>& rRun)
+{
+    unsigned num_failed_runs = 0;
+    for (unsigned i=0; i<rQueue.size(); i++)
+    {
+        try
+        {
+            rRun(rQueue[i]);
+        }
+        catch (const Exception& e)
+        {
+            std::cerr << GetRunName(rQueue[i]) << " failed: " << e.GetMessage() << std::endl;
+            num_failed_runs++;
+        }
+    }
+    return num_failed_runs;
+}
+
+/**
+ * Split the runs of a checkpoint into groups that only differ in their wound tension.
+ *
+ * @param rGrid the values of each parameter
+ * @param rQueue the indices of the runs of a checkpoint
+ * @return the indices of the runs in each group
+ */
+std::vector<std::vector<unsigned> > GetWoundTensionGroups(const std::vector<std::vector<double> >& rGrid,
+                                                          const std::vector<unsigned>& rQueue)
+{
+    std::vector<std::vector<unsigned> > groups;
+    std::vector<std::vector<double> > group_parameters;
+    for (unsigned i=0; i<rQueue.size(); i++)
+    {
+        std::vector<double> parameters = GetRunParameters(rGrid, rQueue[i]);
+        parameters[0] = 0.0;
+        unsigned group = std::find(group_parameters.begin(), group_parameters.end(), parameters) - group_parameters.begin();
+        if (group == groups.size())
+        {
+            groups.push_back(std::vector<unsigned>());
+            group_parameters.push_back(parameters);
+        }
+        groups[group].push_back(rQueue[i]);
+    }
+    return groups;
+}
+
+/**
+ * Carry out the runs of a checkpoint that only differ in their wound tension, by running them
+ * in lockstep with a WoundTensionEnsemble until each needs a cell rearrangement, and then
+ * handing each run off to a worker process.
+ *
+ * @param rSimulator the simulation loaded from the checkpoint of the runs
+ * @param rGrid the values of each parameter
+ * @param rGroup the indices of the runs
+ * @param rSweepFolder the output folder of the sweep, relative to the Chaste test output
+ * @param fullOutput whether to write the whole mesh at the usual sampling interval
+ * @param numWorkers the number of worker processes to run at the same time
+ * @return the number of runs that failed
+ */
+unsigned RunEnsembleOnWorkers(WoundHealingSimulation<2>& rSimulator,
+                              const std::vector<std::vector<double> >& rGrid,
+                              const std::vector<unsigned>& rGroup,
+                              const std::string& rSweepFolder,
+                              bool fullOutput,
+                              unsigned numWorkers)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<double> parameters = GetRunParameters(rGrid, rGroup[0]);
+    boost::shared_ptr<FarhadifarWoundHealingForce<2> > p_force = GetWoundHealingForce(rSimulator);
+    SetForceParameters(p_force, parameters);
+
+    std::vector<double> wound_tensions;
+    for (unsigned i=0; i<rGroup.size(); i++)
+    {
+        wound_tensions.push_back(GetRunParameters(rGrid, rGroup[i])[0]);
+    }
+    VertexBasedCellPopulation<2>& r_cell_population = static_cast<VertexBasedCellPopulation<2>&>(rSimulator.rGetCellPopulation());
+    WoundTensionEnsemble ensemble(r_cell_population, p_force, wound_tensions, parameters[7]);
+
+    // Leave at least one step for each run to take on its own
+    unsigned num_steps = (unsigned)ceil(parameters[6]/parameters[7]);
+    ensemble.Run(num_steps > 1 ? num_steps - 1 : 0);
+    double shared_wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()/rGroup.size();
+    std::cout << "Ran " << rGroup.size() << " wound tensions in lockstep for " << ensemble.GetNumSteps() << " steps" << std::endl;
+
+    return RunQueueOnWorkers(rGroup, numWorkers, [&](unsigned runIndex)
+    {
+        unsigned lane = std::find(rGroup.begin(), rGroup.end(), runIndex) - rGroup.begin();
+        RunBranch(rSimulator, rGrid, runIndex, rSweepFolder, fullOutput, false, &ensemble, lane, shared_wall_time);
+    });
+}
+
+int main(int argc, char *argv[])
+{
+    // Worker processes are forked, which is only safe if MPI has not been started, so PETSc is only set up for -mpi
+    bool use_mpi = false;
+    for (int i=1; i<argc; i++)
+    {
+        use_mpi = use_mpi || std::string(argv[i]) == "-mpi";
+    }
+    if (use_mpi)
+    {
+        // This sets up PETSc and prints out copyright information, etc.
+        ExecutableSupport::StandardStartup(&argc, &argv);
+    }
+    else
+    {
+        CommandLineArguments::Instance()->p_argc = &argc;
+        CommandLineArguments::Instance()->p_argv = &argv;
+        ExecutableSupport::ShowCopyright();
+    }
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    // You should put all the main code within a try-catch, to ensure that
+    // you clean up PETSc before quitting.
+    try
+    {
+        CommandLineArguments* p_args = CommandLineArguments::Instance();
+        if (!p_args->OptionExists("-grid"))
+        {
+            ExecutableSupport::PrintError("Usage: WoundHealingSweep -grid grid.txt [-mesh path | -voronoi num_cells] [-output folder] [-workers N | -mpi] [-full_output] [-ensemble | -quasi_static]", true);
+            exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        }
+        else
+        {
+            std::vector<std::vector<double> > grid = ReadParameterGrid(p_args->GetStringCorrespondingToOption("-grid"));
+            std::string sweep_folder = "WoundHealingSweep";
+            if (p_args->OptionExists("-output"))
+            {
+                sweep_folder = p_args->GetStringCorrespondingToOption("-output");
+            }
+            unsigned num_workers = 1;
+            if (p_args->OptionExists("-workers"))
+            {
+                num_workers = p_args->GetUnsignedCorrespondingToOption("-workers");
+            }
+            unsigned num_voronoi_cells = 0;
+            if (p_args->OptionExists("-voronoi"))
+            {
+                num_voronoi_cells = p_args->GetUnsignedCorrespondingToOption("-voronoi");
+            }
+            bool full_output = p_args->OptionExists("-full_output");
+            bool use_ensembles = p_args->OptionExists("-ensemble");
+            bool quasi_static = p_args->OptionExists("-quasi_static");
+            std::string mesh_path;
+            if (p_args->OptionExists("-mesh"))
+            {
+                mesh_path = p_args->GetStringCorrespondingToOption("-mesh");
+            }
+            else
+            {
+                mesh_path = FileFinder("projects/wound_healing_comparison/test/data/virtual_leaf.cell", RelativeTo::ChasteSourceRoot).GetAbsolutePath();
+                mesh_path = mesh_path.substr(0, mesh_path.size() - 5);
+            }
+            if (num_workers == 0)
+            {
+                EXCEPTION("The number of workers must be positive");
+            }
+            if (use_ensembles && quasi_static)
+            {
+                EXCEPTION("Ensembles follow the dynamics, so -ensemble cannot be used with -quasi_static");
+            }
+            if (use_mpi && (num_workers > 1 || use_ensembles))
+            {
+                EXCEPTION("Worker processes are forked, which MPI does not allow, so -workers and -ensemble cannot be used with -mpi");
+            }
+            if (!use_mpi && GetNumLaunchedProcesses() > 1)
+            {
+                EXCEPTION("The sweep was launched on several MPI processes, which each need -mpi to share it");
+            }
+
+            /*
+             * The master sets up the sweep folder, checks that a restarted sweep has the same grid,
+             * and builds the base mesh once for all runs.
+             */
+            OutputFileHandler handler(sweep_folder, false);
+            std::string grid_path = handler.GetOutputDirectoryFullPath() + "grid.txt";
+            std::string base_mesh_path = handler.GetOutputDirectoryFullPath() + "base_mesh.vmesh";
+            std::string grid_description = GetGridDescription(grid);
+            bool grid_matches = true;
+            if (PetscTools::AmMaster())
+            {
+                std::ifstream old_grid_file(grid_path.c_str());
+                if (old_grid_file.is_open())
+                {
+                    std::stringstream old_grid;
+                    old_grid << old_grid_file.rdbuf();
+                    grid_matches = (old_grid.str() == grid_description);
+                }
+                else
+                {
+                    std::ofstream grid_file(grid_path.c_str());
+                    grid_file << grid_description;
+                }
+                if (grid_matches && !FileFinder(base_mesh_path, RelativeTo::Absolute).Exists())
+                {
+                    WriteBaseMesh(mesh_path, num_voronoi_cells, base_mesh_path);
+                }
+            }
+            bool grid_differs = PetscTools::ReplicateBool(!grid_matches);
+            if (grid_differs)
+            {
+                EXCEPTION("The output folder " + sweep_folder + " holds a sweep over a different grid");
+            }
+            PetscTools::Barrier("WoundHealingSweep::BaseMesh");
+
+            // Write the checkpoints that do not exist yet, sharing them between the processes
+            unsigned num_runs = GetNumRuns(grid);
+            std::vector<unsigned> checkpoint_of_run;
+            std::vector<unsigned> checkpoint_first_runs = GetCheckpoints(grid, checkpoint_of_run);
+            PetscTools::IsolateProcesses(true);
+            for (unsigned checkpoint=PetscTools::GetMyRank(); checkpoint<checkpoint_first_runs.size(); checkpoint+=PetscTools::GetNumProcs())
+            {
+                std::string done_path = handler.GetOutputDirectoryFullPath() + GetCheckpointName(checkpoint) + ".done";
+                if (!FileFinder(done_path, RelativeTo::Absolute).Exists())
+                {
+                    WriteCheckpoint(GetRunParameters(grid, checkpoint_first_runs[checkpoint]), sweep_folder,
+                                    GetCheckpointName(checkpoint), base_mesh_path);
+                    std::ofstream done_file(done_path.c_str());
+                    done_file << "done\n";
+                }
+            }
+            PetscTools::IsolateProcesses(false);
+            PetscTools::Barrier("WoundHealingSweep::Checkpoints");
+
+            // Share the unfinished runs between the processes, and sort them by checkpoint
+            std::vector<std::vector<unsigned> > queues(checkpoint_first_runs.size());
+            unsigned num_queued_runs = 0;
+            for (unsigned run_index=PetscTools::GetMyRank(); run_index<num_runs; run_index+=PetscTools::GetNumProcs())
+            {
+                if (!FileFinder(handler.GetOutputDirectoryFullPath() + GetRunName(run_index) + ".row", RelativeTo::Absolute).Exists())
+                {
+                    queues[checkpoint_of_run[run_index]].push_back(run_index);
+                    num_queued_runs++;
+                }
+            }
+            std::cout << "Process " << PetscTools::GetMyRank() << " has " << num_queued_runs << " of "
+                      << num_runs << " runs left to do" << std::endl;
+
+            // Load each checkpoint once, and branch all of its runs from the loaded simulation
+            PetscTools::IsolateProcesses(true);
+            unsigned num_failed_runs = 0;
+            for (unsigned checkpoint=0; checkpoint<queues.size(); checkpoint++)
+            {
+                if (queues[checkpoint].empty())
+                {
+                    continue;
+                }
+                if (use_mpi)
+                {
+                    // A process that has started MPI must not fork, so each run loads its own copy of the checkpoint
+                    double checkpoint_time = GetRunParameters(grid, checkpoint_first_runs[checkpoint])[8];
+                    num_failed_runs += RunQueueInProcess(queues[checkpoint], [&](unsigned runIndex)
+                    {
+                        SetUpCellBasedSingletons();
+                        WoundHealingSimulation<2>* p_simulator = SimulationArchiver::Load(sweep_folder + "/" + GetCheckpointName(checkpoint), checkpoint_time);
+                        try
+                        {
+                            RunBranch(*p_simulator, grid, runIndex, sweep_folder, full_output, quasi_static);
+                        }
+                        catch (const Exception&)
+                        {
+                            delete p_simulator;
+                            TearDownCellBasedSingletons();
+                            throw;
+                        }
+                        delete p_simulator;
+                        TearDownCellBasedSingletons();
+                    });
+                    continue;
+                }
+                SetUpCellBasedSingletons();
+                double checkpoint_time = GetRunParameters(grid, checkpoint_first_runs[checkpoint])[8];
+                WoundHealingSimulation<2>* p_simulator = SimulationArchiver::Load(sweep_folder + "/" + GetCheckpointName(checkpoint), checkpoint_time);
+                if (use_ensembles)
+                {
+                    std::vector<std::vector<unsigned> > groups = GetWoundTensionGroups(grid, queues[checkpoint]);
+                    for (unsigned group=0; group<groups.size(); group++)
+                    {
+                        num_failed_runs += RunEnsembleOnWorkers(*p_simulator, grid, groups[group], sweep_folder,
+                                                                full_output, num_workers);
+                    }
+                }
+                else
+                {
+                    num_failed_runs += RunQueueOnWorkers(queues[checkpoint], num_workers,
+                                                         [&](unsigned runIndex) { RunBranch(*p_simulator, grid, runIndex, sweep_folder, full_output, quasi_static); });
+                }
+                delete p_simulator;
+                TearDownCellBasedSingletons();
+            }
+            PetscTools::IsolateProcesses(false);
+            PetscTools::Barrier("WoundHealingSweep::Runs");
+
+            // Gather the rows of all finished runs, in order
+            if (PetscTools::AmMaster())
+            {
+                out_stream p_summary_file = handler.OpenOutputFile("summary.csv");
+                *p_summary_file << GetSummaryHeading() << "\n";
+                unsigned num_finished_runs = 0;
+                for (unsigned run_index=0; run_index<num_runs; run_index++)
+                {
+                    std::ifstream row_file((handler.GetOutputDirectoryFullPath() + GetRunName(run_index) + ".row").c_str());
+                    std::string row;
+                    if (std::getline(row_file, row))
+                    {
+                        *p_summary_file << row << "\n";
+                        num_finished_runs++;
+                    }
+                }
+                p_summary_file->close();
+                std::cout << num_finished_runs << " of " << num_runs << " runs have finished; the summary is in "
+                          << handler.GetOutputDirectoryFullPath() << "summary.csv" << std::endl;
+            }
+            if (num_failed_runs > 0)
+            {
+                exit_code = ExecutableSupport::EXIT_ERROR;
+            }
+        }
+    }
+    catch (const Exception& e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+
+    if (use_mpi)
+    {
+        // Optional - write the machine info to file.
+        ExecutableSupport::WriteMachineInfoFile("machine_info");
+
+        // End by finalizing PETSc
+        ExecutableSupport::FinalizePetsc();
+    }
+
+    // Return a suitable exit code; 0 means 'no error'
+    return exit_code;
+}
@@ -1,3 +1,8 @@
+# Convert a VirtualLeaf XML file to the .node and .cell files of a Chaste vertex mesh.
+#
+# From C++, VirtualLeafMeshReader (src/VirtualLeafMeshReader.hpp) reads the XML file
+# directly, in time linear in its size and without writing these intermediate files.
+
 import untangle
 
 def convert_xml_to_chaste(xml_path):
@@ -0,0 +1,170 @@
+# Read the trajectory of a wound healing run, as written by WoundTrajectoryModifier
+# (src/WoundTrajectoryModifier.hpp) to trajectory.wtraj in the simulation output directory.
+#
+# The file is memory mapped and its columns are returned as numpy arrays that point into
+# the mapping, so nothing is copied or read from disk until it is used. The format is
+# described in src/WoundTrajectoryFormat.hpp. A file whose run is still going, or stopped
+# early, can be read up to its last complete block.
+
+import sys
+
+import numpy as np
+
+MAGIC = b'WNDTRAJ1'
+VERSION = 1
+BYTE_ORDER_MARK = 0x01020304
+
+TOPOLOGY_BLOCK = 1
+FRAMES_BLOCK = 2
+METRICS_BLOCK = 3
+
+FILE_HEADER_BYTES = 16
+BLOCK_HEADER_BYTES = 24
+
+
+def _padded(num_bytes):
+    return (num_bytes + 7) & ~7
+
+
+class WoundTrajectory:
+
+    def __init__(self, path):
+        self._data = np.memmap(path, dtype=np.uint8, mode='r')
+
+        if self._data.size < FILE_HEADER_BYTES or bytes(self._data[:8]) != MAGIC:
+            raise ValueError(path + ' is not a wound trajectory file')
+        version, byte_order_mark = self._column(8, np.uint32, 2)
+        if byte_order_mark != BYTE_ORDER_MARK:
+            raise ValueError(path + ' was written on a machine of a different byte order')
+        if version != VERSION:
+            raise ValueError(path + ' has version ' + str(version) + ', not ' + str(VERSION))
+
+        # Element offsets, element nodes and boundary flags, by topology version
+        self._topologies = []
+
+        # For each frames block: times, topology versions, node offsets, x and y
+        self._frame_blocks = []
+
+        # For each metrics block: times, wound indices, numbers of nodes, areas and perimeters
+        self._metrics_blocks = []
+
+        offset = FILE_HEADER_BYTES
+        while offset + BLOCK_HEADER_BYTES <= self._data.size:
+            block_type, num_records = self._column(offset, np.uint32, 2)
+            payload_bytes, num_frame_nodes = self._column(offset + 8, np.uint64, 2)
+            start = offset + BLOCK_HEADER_BYTES
+            end = start + int(payload_bytes)
+            if end > self._data.size:
+                # The last block is still being written
+                break
+            if block_type == TOPOLOGY_BLOCK:
+                self._read_topology(start)
+            elif block_type == FRAMES_BLOCK:
+                self._read_frames(start, int(num_records), int(num_frame_nodes))
+            elif block_type == METRICS_BLOCK:
+                self._read_metrics(start, int(num_records))
+            offset = end
+
+        num_frames = [len(block[0]) for block in self._frame_blocks]
+        self._frame_block_starts = np.concatenate(([0], np.cumsum(num_frames, dtype=np.int64)))
+
+    def _column(self, offset, dtype, count):
+        return np.frombuffer(self._data, dtype=dtype, count=count, offset=offset)
+
+    def _read_topology(self, start):
+        version, num_nodes, num_elements, num_entries = (int(n) for n in self._column(start, np.uint32, 4))
+        offset = start + 16
+        boundary = self._column(offset, np.uint8, num_nodes)
+        offset += _padded(num_nodes)
+        element_offsets = self._column(offset, np.uint32, num_elements + 1)
+        offset += _padded(4*(num_elements + 1))
+        element_nodes = self._column(offset, np.uint32, num_entries)
+        assert version == len(self._topologies)
+        self._topologies.append((element_offsets, element_nodes, boundary))
+
+    def _read_frames(self, start, num_frames, num_frame_nodes):
+        offset = start
+        times = self._column(offset, np.float64, num_frames)
+        offset += _padded(8*num_frames)
+        versions = self._column(offset, np.uint32, num_frames)
+        offset += _padded(4*num_frames)
+        node_offsets = self._column(offset, np.uint64, num_frames + 1)
+        offset += 8*(num_frames + 1)
+        x = self._column(offset, np.float64, num_frame_nodes)
+        offset += 8*num_frame_nodes
+        y = self._column(offset, np.float64, num_frame_nodes)
+        self._frame_blocks.append((times, versions, node_offsets, x, y))
+
+    def _read_metrics(self, start, num_rows):
+        offset = start
+        columns = []
+        for dtype in (np.float64, np.uint32, np.uint32, np.float64, np.float64):
+            columns.append(self._column(offset, dtype, num_rows))
+            offset += _padded(np.dtype(dtype).itemsize*num_rows)
+        self._metrics_blocks.append(tuple(columns))
+
+    def _locate_frame(self, frame):
+        if frame < 0:
+            frame += self.num_frames
+        if frame < 0 or frame >= self.num_frames:
+            raise IndexError('frame ' + str(frame) + ' is out of range')
+        block = int(np.searchsorted(self._frame_block_starts, frame, side='right')) - 1
+        return self._frame_blocks[block], frame - int(self._frame_block_starts[block])
+
+    @property
+    def num_frames(self):
+        return int(self._frame_block_starts[-1])
+
+    @property
+    def num_topology_versions(self):
+        return len(self._topologies)
+
+    def times(self):
+        """The time of each frame. This is a copy, of one number per frame."""
+        return np.concatenate([block[0] for block in self._frame_blocks]) if self._frame_blocks else np.empty(0)
+
+    def topology_versions(self):
+        """The topology version of each frame. This is a copy, of one number per frame."""
+        return np.concatenate([block[1] for block in self._frame_blocks]) if self._frame_blocks else np.empty(0, np.uint32)
+
+    def positions(self, frame):
+        """The x and y coordinates of the nodes at a frame, as views into the file."""
+        (times, versions, node_offsets, x, y), index = self._locate_frame(frame)
+        begin, end = int(node_offsets[index]), int(node_offsets[index + 1])
+        return x[begin:end], y[begin:end]
+
+    def topology(self, frame):
+        """The element offsets, element nodes and boundary flags of the mesh at a frame, as views
+        into the file. The nodes of element i are element_nodes[element_offsets[i]:element_offsets[i+1]]."""
+        (times, versions, node_offsets, x, y), index = self._locate_frame(frame)
+        return self._topologies[int(versions[index])]
+
+    def frame_blocks(self):
+        """Yield the times, topology versions, node offsets, x and y coordinates of each block of
+        frames, as views into the file. Where the frames of a block share a topology, x and y can be
+        reshaped to (number of frames, number of nodes) without copying them."""
+        for block in self._frame_blocks:
+            yield block
+
+    def metrics(self):
+        """The wound metrics as a dictionary of columns: time, wound, num_nodes, area and perimeter,
+        with a row per wound per frame after the first. The columns are views into the file if
+        they were written as one block, and copies otherwise."""
+        names = ('time', 'wound', 'num_nodes', 'area', 'perimeter')
+        dtypes = (np.float64, np.uint32, np.uint32, np.float64, np.float64)
+        if len(self._metrics_blocks) == 1:
+            return dict(zip(names, self._metrics_blocks[0]))
+        return {name: np.concatenate([block[i] for block in self._metrics_blocks]) if self._metrics_blocks else np.empty(0, dtype)
+                for i, (name, dtype) in enumerate(zip(names, dtypes))}
+
+
+if __name__ == "__main__":
+    trajectory = WoundTrajectory(sys.argv[1] if len(sys.argv) > 1 else 'trajectory.wtraj')
+    times = trajectory.times()
+    print(str(trajectory.num_frames) + ' frames and ' + str(trajectory.num_topology_versions) + ' topology versions')
+    if trajectory.num_frames > 0:
+        print('times from ' + str(times[0]) + ' to ' + str(times[-1]))
+    metrics = trajectory.metrics()
+    for wound in np.unique(metrics['wound']):
+        rows = metrics['wound'] == wound
+        print('wound ' + str(wound) + ': area from ' + str(metrics['area'][rows][0]) + ' to ' + str(metrics['area'][rows][-1]))
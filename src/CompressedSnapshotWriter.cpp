@@ -0,0 +1,232 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "CompressedSnapshotWriter.hpp"
+#include "Exception.hpp"
+#include "WoundHealingTracer.hpp"
+
+#include <cstdio>
+#include <iomanip>
+#include <zlib.h>
+
+CompressedSnapshotWriter::CompressedSnapshotWriter(const std::string& rDirectory, int compressionLevel)
+    : mDirectory(rDirectory),
+      mCompressionLevel(compressionLevel),
+      mNumSnapshots(0),
+      mFinishing(false)
+{
+    if (mDirectory.empty() || mDirectory[mDirectory.size()-1] != '/')
+    {
+        mDirectory += "/";
+    }
+    if (compressionLevel < -1 || compressionLevel > 9)
+    {
+        EXCEPTION("The compression level must be between 0 and 9, or -1 for the default");
+    }
+
+    std::string index_path = mDirectory + "snapshots.csv";
+    mIndexFile.open(index_path.c_str(), std::ios::trunc);
+    if (!mIndexFile.is_open())
+    {
+        EXCEPTION("Could not open the snapshot index " + index_path);
+    }
+    mIndexFile << "index,time,event,file,num_nodes,num_elements,bytes,compressed_bytes\n";
+    mIndexFile << std::setprecision(10);
+
+    mThread = std::thread(&CompressedSnapshotWriter::WriteQueuedSnapshots, this);
+}
+
+CompressedSnapshotWriter::~CompressedSnapshotWriter()
+{
+    try
+    {
+        Finish();
+    }
+    catch (const Exception&)
+    {
+        // Destructors must not throw; call Finish() first to see errors
+    }
+}
+
+unsigned CompressedSnapshotWriter::WriteSnapshot(VertexMesh<2, 2>& rMesh, double time, const std::string& rEvent)
+{
+    WOUND_HEALING_TRACE_SCOPE("CopySnapshot");
+    std::unique_ptr<Snapshot> p_snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mFinishing)
+        {
+            EXCEPTION("No more snapshots can be written once the snapshot writer has finished");
+        }
+        if (!mSpareSnapshots.empty())
+        {
+            p_snapshot = std::move(mSpareSnapshots.back());
+            mSpareSnapshots.pop_back();
+        }
+    }
+    if (!p_snapshot)
+    {
+        p_snapshot.reset(new Snapshot);
+    }
+
+    // Copy the mesh outside the lock, so that the background thread is not held up
+    p_snapshot->mTime = time;
+    p_snapshot->mEvent = rEvent;
+    VertexMeshBinaryWriter::CopyArraysOfMesh(rMesh, p_snapshot->mArrays);
+
+    unsigned index;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        index = mNumSnapshots++;
+        p_snapshot->mIndex = index;
+        mQueue.push_back(std::move(p_snapshot));
+    }
+    mCondition.notify_one();
+    return index;
+}
+
+void CompressedSnapshotWriter::Finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mFinishing = true;
+    }
+    mCondition.notify_one();
+    if (mThread.joinable())
+    {
+        mThread.join();
+        mIndexFile.close();
+    }
+
+    if (!mErrorMessage.empty())
+    {
+        EXCEPTION(mErrorMessage);
+    }
+}
+
+unsigned CompressedSnapshotWriter::GetNumSnapshots()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumSnapshots;
+}
+
+void CompressedSnapshotWriter::WriteQueuedSnapshots()
+{
+    WOUND_HEALING_TRACE(WoundHealingTracer::Instance()->SetThreadName("CompressedSnapshotWriter"));
+    std::vector<char> buffer;
+    std::vector<unsigned char> compressed_buffer;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mCondition.wait(lock, [this] { return mFinishing || !mQueue.empty(); });
+        if (mQueue.empty())
+        {
+            // Finishing, and everything has been written
+            break;
+        }
+        std::unique_ptr<Snapshot> p_snapshot = std::move(mQueue.front());
+        mQueue.pop_front();
+        bool have_error = !mErrorMessage.empty();
+        lock.unlock();
+
+        // Once a snapshot has failed, the rest are dropped
+        std::string error_message;
+        if (!have_error)
+        {
+            try
+            {
+                WriteSnapshotToFile(*p_snapshot, buffer, compressed_buffer);
+            }
+            catch (const Exception& e)
+            {
+                error_message = e.GetMessage();
+            }
+        }
+
+        lock.lock();
+        if (!error_message.empty())
+        {
+            mErrorMessage = error_message;
+        }
+        mSpareSnapshots.push_back(std::move(p_snapshot));
+    }
+}
+
+void CompressedSnapshotWriter::WriteSnapshotToFile(const Snapshot& rSnapshot,
+                                                   std::vector<char>& rBuffer,
+                                                   std::vector<unsigned char>& rCompressedBuffer)
+{
+    WOUND_HEALING_TRACE_SCOPE("CompressAndWriteSnapshot");
+    VertexMeshBinaryWriter::EncodeArrays(rSnapshot.mArrays, rBuffer);
+
+    // Compress the whole file in one go, with a gzip header (window bits 15, plus 16)
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    if (deflateInit2(&stream, mCompressionLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        EXCEPTION("Could not start compressing a snapshot");
+    }
+    rCompressedBuffer.resize(deflateBound(&stream, rBuffer.size()));
+    stream.next_in = reinterpret_cast<Bytef*>(rBuffer.data());
+    stream.avail_in = rBuffer.size();
+    stream.next_out = rCompressedBuffer.data();
+    stream.avail_out = rCompressedBuffer.size();
+    int result = deflate(&stream, Z_FINISH);
+    std::size_t compressed_size = rCompressedBuffer.size() - stream.avail_out;
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END)
+    {
+        EXCEPTION("Could not compress a snapshot");
+    }
+
+    char file_name[32];
+    snprintf(file_name, sizeof(file_name), "snapshot_%05u.vmesh.gz", rSnapshot.mIndex);
+    std::string path = mDirectory + file_name;
+    std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(rCompressedBuffer.data()), compressed_size);
+    file.close();
+    if (file.fail())
+    {
+        EXCEPTION("Could not write the snapshot " + path);
+    }
+
+    mIndexFile << rSnapshot.mIndex << "," << rSnapshot.mTime << "," << rSnapshot.mEvent << "," << file_name << ","
+               << rSnapshot.mArrays.mX.size() << "," << rSnapshot.mArrays.mElementOffsets.size() - 1 << ","
+               << rBuffer.size() << "," << compressed_size << "\n";
+    mIndexFile.flush();
+}
@@ -0,0 +1,171 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef COMPRESSEDSNAPSHOTWRITER_HPP_
+#define COMPRESSEDSNAPSHOTWRITER_HPP_
+
+#include "VertexMesh.hpp"
+#include "VertexMeshBinaryWriter.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Writes snapshots of a vertex mesh from a background thread, so that a simulation does not
+ * wait for them to be compressed and written.
+ *
+ * WriteSnapshot() copies the nodes and elements of the mesh on the calling thread and queues
+ * the copy. The background thread lays each copy out as a binary vertex mesh (see
+ * VertexMeshBinaryFormat.hpp), compresses it with zlib and writes it to snapshot_NNNNN.vmesh.gz,
+ * which gunzip turns back into a file that VertexMeshBinaryReader can read. A line is added to
+ * snapshots.csv for each snapshot, giving its time and the event that caused it.
+ *
+ * The copies are recycled once written. The queue is not bounded, as snapshots are expected
+ * to be occasional; a caller that writes them faster than the disk can take them uses more memory
+ * rather than waiting.
+ */
+class CompressedSnapshotWriter
+{
+private:
+
+    /** A copy of a mesh waiting to be written. */
+    struct Snapshot
+    {
+        /** The index of the snapshot. */
+        unsigned mIndex;
+
+        /** The simulation time of the snapshot. */
+        double mTime;
+
+        /** The event that caused the snapshot. */
+        std::string mEvent;
+
+        /** The arrays of the mesh. */
+        VertexMeshBinaryArrays mArrays;
+    };
+
+    /** The directory the snapshots are written to, with a trailing slash. */
+    std::string mDirectory;
+
+    /** The zlib compression level, from 0 to 9, or -1 for the zlib default. */
+    int mCompressionLevel;
+
+    /** The index of the snapshots. Only used by the background thread once it has started. */
+    std::ofstream mIndexFile;
+
+    /** Guards the members below. */
+    std::mutex mMutex;
+
+    /** Signalled when a snapshot is queued, or the writer is finishing. */
+    std::condition_variable mCondition;
+
+    /** The snapshots waiting to be written. */
+    std::deque<std::unique_ptr<Snapshot> > mQueue;
+
+    /** Written snapshots whose arrays can be reused. */
+    std::vector<std::unique_ptr<Snapshot> > mSpareSnapshots;
+
+    /** The number of snapshots queued so far. */
+    unsigned mNumSnapshots;
+
+    /** Whether Finish() has been called. */
+    bool mFinishing;
+
+    /** The message of the first error on the background thread, if any. */
+    std::string mErrorMessage;
+
+    /** The background thread. */
+    std::thread mThread;
+
+    /**
+     * The body of the background thread, which writes queued snapshots until the writer finishes
+     * and the queue is empty.
+     */
+    void WriteQueuedSnapshots();
+
+    /**
+     * Compress and write a snapshot, and add it to the index.
+     *
+     * @param rSnapshot the snapshot
+     * @param rBuffer scratch space for the uncompressed file
+     * @param rCompressedBuffer scratch space for the compressed file
+     */
+    void WriteSnapshotToFile(const Snapshot& rSnapshot, std::vector<char>& rBuffer, std::vector<unsigned char>& rCompressedBuffer);
+
+public:
+
+    /**
+     * Constructor. Creates the index file and starts the background thread.
+     *
+     * @param rDirectory the absolute path of the directory to write the snapshots to
+     * @param compressionLevel the zlib compression level, from 0 to 9, or -1 for the zlib default
+     */
+    CompressedSnapshotWriter(const std::string& rDirectory, int compressionLevel=-1);
+
+    /**
+     * Destructor. Writes any snapshots that are still queued, without reporting errors.
+     */
+    ~CompressedSnapshotWriter();
+
+    /**
+     * Copy a mesh and queue the copy to be written. Deleted nodes and elements are left out,
+     * as by VertexMeshBinaryWriter::WriteFileUsingMesh().
+     *
+     * @param rMesh the mesh
+     * @param time the simulation time
+     * @param rEvent the event that caused the snapshot, which must not contain commas
+     * @return the index of the snapshot
+     */
+    unsigned WriteSnapshot(VertexMesh<2, 2>& rMesh, double time, const std::string& rEvent);
+
+    /**
+     * Wait for all queued snapshots to be written and stop the background thread. Throws if
+     * any of the snapshots could not be written.
+     */
+    void Finish();
+
+    /**
+     * @return the number of snapshots queued so far
+     */
+    unsigned GetNumSnapshots();
+};
+
+#endif /*COMPRESSEDSNAPSHOTWRITER_HPP_*/
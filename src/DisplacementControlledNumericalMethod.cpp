@@ -0,0 +1,266 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "DisplacementControlledNumericalMethod.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "StepSizeException.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+template<unsigned DIM>
+DisplacementControlledNumericalMethod<DIM>::DisplacementControlledNumericalMethod()
+    : AbstractNumericalMethod<DIM, DIM>(),
+      mMaxDisplacementFraction(0.5),
+      mErrorTolerance(1e-3),
+      mSafetyFactor(0.9),
+      mMaxGrowthFactor(2.0),
+      mMinimumTimestep(1e-4),
+      mMaximumTimestep(1.0),
+      mSuggestedTimestep(0.0),
+      mLastTimestep(0.0),
+      mNumAcceptedSteps(0),
+      mNumRejectedSteps(0)
+{
+    // Rejected steps are only retried by the simulation if the method says it is adaptive
+    this->mUseAdaptiveTimestep = true;
+}
+
+template<unsigned DIM>
+DisplacementControlledNumericalMethod<DIM>::~DisplacementControlledNumericalMethod()
+{
+}
+
+template<unsigned DIM>
+void DisplacementControlledNumericalMethod<DIM>::UpdateAllNodePositions(double dt)
+{
+    VertexBasedCellPopulation<DIM>* p_population = dynamic_cast<VertexBasedCellPopulation<DIM>*>(this->mpCellPopulation);
+    if (p_population == nullptr)
+    {
+        EXCEPTION("DisplacementControlledNumericalMethod is to be used with a VertexBasedCellPopulation only");
+    }
+    MutableVertexMesh<DIM, DIM>& r_mesh = p_population->rGetMesh();
+    const double max_displacement = mMaxDisplacementFraction*r_mesh.GetCellRearrangementThreshold();
+
+    // The forces divided by the damping constants are the node velocities
+    std::vector<c_vector<double, DIM> > velocities = this->ComputeForcesIncludingDamping();
+
+    // Nodes are renumbered when the mesh loses some, and then the old velocities are no use
+    bool have_last_velocities = (mLastTimestep > 0.0) && (mLastVelocities.size() == r_mesh.GetNumAllNodes());
+
+    double max_speed = 0.0;
+    double max_velocity_change = 0.0;
+    unsigned index = 0;
+    for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter, ++index)
+    {
+        max_speed = std::max(max_speed, norm_2(velocities[index]));
+        if (have_last_velocities)
+        {
+            max_velocity_change = std::max(max_velocity_change, norm_2(velocities[index] - mLastVelocities[node_iter->GetIndex()]));
+        }
+    }
+
+    // The largest step that satisfies each limit
+    double largest_step = mMaximumTimestep;
+    if (max_speed > 0.0)
+    {
+        largest_step = std::min(largest_step, max_displacement/max_speed);
+    }
+    double local_error = 0.0;
+    if (max_velocity_change > 0.0)
+    {
+        local_error = 0.5*dt*dt*max_velocity_change/mLastTimestep;
+        largest_step = std::min(largest_step, sqrt(2.0*mErrorTolerance*mLastTimestep/max_velocity_change));
+    }
+
+    if ((dt*max_speed > max_displacement || local_error > mErrorTolerance) && dt > mMinimumTimestep)
+    {
+        mNumRejectedSteps++;
+        std::stringstream message;
+        message << "A step of " << dt << " moves nodes by up to " << dt*max_speed << " with an estimated error of " << local_error;
+        throw StepSizeException(std::max(mSafetyFactor*largest_step, mMinimumTimestep), message.str(), false);
+    }
+
+    // Accept the step
+    index = 0;
+    for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter, ++index)
+    {
+        c_vector<double, DIM> new_location = node_iter->rGetLocation() + dt*velocities[index];
+        this->SafeNodePositionUpdate(node_iter->GetIndex(), new_location);
+    }
+
+    mLastVelocities.resize(r_mesh.GetNumAllNodes());
+    index = 0;
+    for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter, ++index)
+    {
+        mLastVelocities[node_iter->GetIndex()] = velocities[index];
+    }
+    mLastTimestep = dt;
+    mNumAcceptedSteps++;
+
+    mSuggestedTimestep = std::min(mSafetyFactor*largest_step, mMaxGrowthFactor*dt);
+    mSuggestedTimestep = std::max(std::min(mSuggestedTimestep, mMaximumTimestep), mMinimumTimestep);
+}
+
+template<unsigned DIM>
+double DisplacementControlledNumericalMethod<DIM>::GetSuggestedTimestep() const
+{
+    return mSuggestedTimestep;
+}
+
+template<unsigned DIM>
+void DisplacementControlledNumericalMethod<DIM>::ResetErrorEstimate()
+{
+    mLastTimestep = 0.0;
+}
+
+template<unsigned DIM>
+double DisplacementControlledNumericalMethod<DIM>::GetMaxDisplacementFraction() const
+{
+    return mMaxDisplacementFraction;
+}
+
+template<unsigned DIM>
+void DisplacementControlledNumericalMethod<DIM>::SetMaxDisplacementFraction(double maxDisplacementFraction)
+{
+    assert(maxDisplacementFraction > 0.0);
+    mMaxDisplacementFraction = maxDisplacementFraction;
+}
+
+template<unsigned DIM>
+double DisplacementControlledNumericalMethod<DIM>::GetErrorTolerance() const
+{
+    return mErrorTolerance;
+}
+
+template<unsigned DIM>
+void DisplacementControlledNumericalMethod<DIM>::SetErrorTolerance(double errorTolerance)
+{
+    assert(errorTolerance > 0.0);
+    mErrorTolerance = errorTolerance;
+}
+
+template<unsigned DIM>
+double DisplacementControlledNumericalMethod<DIM>::GetSafetyFactor() const
+{
+    return mSafetyFactor;
+}
+
+template<unsigned DIM>
+void DisplacementControlledNumericalMethod<DIM>::SetSafetyFactor(double safetyFactor)
+{
+    assert(safetyFactor > 0.0 && safetyFactor <= 1.0);
+    mSafetyFactor = safetyFactor;
+}
+
+template<unsigned DIM>
+double DisplacementControlledNumericalMethod<DIM>::GetMaxGrowthFactor() const
+{
+    return mMaxGrowthFactor;
+}
+
+template<unsigned DIM>
+void DisplacementControlledNumericalMethod<DIM>::SetMaxGrowthFactor(double maxGrowthFactor)
+{
+    assert(maxGrowthFactor >= 1.0);
+    mMaxGrowthFactor = maxGrowthFactor;
+}
+
+template<unsigned DIM>
+double DisplacementControlledNumericalMethod<DIM>::GetMinimumTimestep() const
+{
+    return mMinimumTimestep;
+}
+
+template<unsigned DIM>
+void DisplacementControlledNumericalMethod<DIM>::SetMinimumTimestep(double minimumTimestep)
+{
+    assert(minimumTimestep > 0.0);
+    mMinimumTimestep = minimumTimestep;
+}
+
+template<unsigned DIM>
+double DisplacementControlledNumericalMethod<DIM>::GetMaximumTimestep() const
+{
+    return mMaximumTimestep;
+}
+
+template<unsigned DIM>
+void DisplacementControlledNumericalMethod<DIM>::SetMaximumTimestep(double maximumTimestep)
+{
+    assert(maximumTimestep > 0.0);
+    mMaximumTimestep = maximumTimestep;
+}
+
+template<unsigned DIM>
+unsigned DisplacementControlledNumericalMethod<DIM>::GetNumAcceptedSteps() const
+{
+    return mNumAcceptedSteps;
+}
+
+template<unsigned DIM>
+unsigned DisplacementControlledNumericalMethod<DIM>::GetNumRejectedSteps() const
+{
+    return mNumRejectedSteps;
+}
+
+template<unsigned DIM>
+void DisplacementControlledNumericalMethod<DIM>::OutputNumericalMethodParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<MaxDisplacementFraction>" << mMaxDisplacementFraction << "</MaxDisplacementFraction>\n";
+    *rParamsFile << "\t\t\t<ErrorTolerance>" << mErrorTolerance << "</ErrorTolerance>\n";
+    *rParamsFile << "\t\t\t<SafetyFactor>" << mSafetyFactor << "</SafetyFactor>\n";
+    *rParamsFile << "\t\t\t<MaxGrowthFactor>" << mMaxGrowthFactor << "</MaxGrowthFactor>\n";
+    *rParamsFile << "\t\t\t<MinimumTimestep>" << mMinimumTimestep << "</MinimumTimestep>\n";
+    *rParamsFile << "\t\t\t<MaximumTimestep>" << mMaximumTimestep << "</MaximumTimestep>\n";
+
+    // Call method on direct parent class
+    AbstractNumericalMethod<DIM, DIM>::OutputNumericalMethodParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class DisplacementControlledNumericalMethod<2>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS1(DisplacementControlledNumericalMethod, 2)
@@ -0,0 +1,249 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef DISPLACEMENTCONTROLLEDNUMERICALMETHOD_HPP_
+#define DISPLACEMENTCONTROLLEDNUMERICALMETHOD_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractNumericalMethod.hpp"
+
+#include <vector>
+
+/**
+ * A forward Euler method for vertex-based populations that chooses its own step size.
+ *
+ * Each step is checked against two limits before the nodes are moved:
+ *
+ *  - the largest node displacement must be at most a fraction of the cell rearrangement
+ *    (T1 swap) threshold of the mesh, so that no edge can shrink past the threshold and
+ *    invert before the mesh is checked for swaps at the next step;
+ *  - the local error of the step, estimated from the change in node velocities since the
+ *    last accepted step as 0.5*dt^2*|dv|/dt_last, must be at most an absolute tolerance.
+ *
+ * A step that fails either check is rejected by throwing a StepSizeException with a smaller
+ * step, and the simulation retries it. Otherwise the nodes are moved and the step size for
+ * the next step is suggested from the same two limits (see GetSuggestedTimestep()), growing
+ * by at most a fixed factor. Velocities jump when the mesh changes topology, so steps
+ * shrink around T1 and T2 swaps and grow again while the tissue relaxes.
+ *
+ * The rejected steps are redone by OffLatticeSimulation as sub-steps of its time step. To
+ * let the time step of the simulation itself grow, use a WoundHealingSimulation, which
+ * takes its time step from GetSuggestedTimestep().
+ */
+template<unsigned DIM>
+class DisplacementControlledNumericalMethod : public AbstractNumericalMethod<DIM, DIM>
+{
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractNumericalMethod<DIM, DIM> >(*this);
+        archive & mMaxDisplacementFraction;
+        archive & mErrorTolerance;
+        archive & mSafetyFactor;
+        archive & mMaxGrowthFactor;
+        archive & mMinimumTimestep;
+        archive & mMaximumTimestep;
+    }
+
+    /** The largest node displacement in a step, as a fraction of the cell rearrangement threshold. */
+    double mMaxDisplacementFraction;
+
+    /** The largest estimated local error of a step, as a distance. */
+    double mErrorTolerance;
+
+    /** The factor by which suggested step sizes are reduced, to make rejections less likely. */
+    double mSafetyFactor;
+
+    /** The largest factor by which the step size may grow from one step to the next. */
+    double mMaxGrowthFactor;
+
+    /** Steps of this size or smaller are never rejected. */
+    double mMinimumTimestep;
+
+    /** The largest step size that is suggested. */
+    double mMaximumTimestep;
+
+    /** The step size suggested for the next step, or zero before the first step. */
+    double mSuggestedTimestep;
+
+    /** The velocity of each node at the last accepted step, indexed by node. */
+    std::vector<c_vector<double, DIM> > mLastVelocities;
+
+    /** The size of the last accepted step, or zero if mLastVelocities is not valid. */
+    double mLastTimestep;
+
+    /** The number of accepted steps. */
+    unsigned mNumAcceptedSteps;
+
+    /** The number of rejected steps. */
+    unsigned mNumRejectedSteps;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    DisplacementControlledNumericalMethod();
+
+    /**
+     * Destructor.
+     */
+    virtual ~DisplacementControlledNumericalMethod();
+
+    /**
+     * Overridden UpdateAllNodePositions() method. Moves the nodes by one forward Euler step,
+     * or throws a StepSizeException if the step is too large.
+     *
+     * @param dt the step size
+     */
+    virtual void UpdateAllNodePositions(double dt);
+
+    /**
+     * @return the step size suggested for the next step, or zero if no step has been accepted yet
+     */
+    double GetSuggestedTimestep() const;
+
+    /**
+     * Forget the velocities of the last step, for when the nodes of the mesh have been renumbered.
+     */
+    void ResetErrorEstimate();
+
+    /**
+     * @return the largest node displacement in a step, as a fraction of the cell rearrangement threshold
+     */
+    double GetMaxDisplacementFraction() const;
+
+    /**
+     * Set the largest node displacement in a step. Defaults to 0.5, the limit that
+     * VertexBasedCellPopulation places on vertex movement.
+     *
+     * @param maxDisplacementFraction the largest displacement, as a fraction of the cell rearrangement threshold
+     */
+    void SetMaxDisplacementFraction(double maxDisplacementFraction);
+
+    /**
+     * @return the largest estimated local error of a step
+     */
+    double GetErrorTolerance() const;
+
+    /**
+     * Set the largest estimated local error of a step. Defaults to 1e-3.
+     *
+     * @param errorTolerance the tolerance, as a distance
+     */
+    void SetErrorTolerance(double errorTolerance);
+
+    /**
+     * @return the factor by which suggested step sizes are reduced
+     */
+    double GetSafetyFactor() const;
+
+    /**
+     * Set the factor by which suggested step sizes are reduced. Defaults to 0.9.
+     *
+     * @param safetyFactor the factor, between 0 and 1
+     */
+    void SetSafetyFactor(double safetyFactor);
+
+    /**
+     * @return the largest factor by which the step size may grow from one step to the next
+     */
+    double GetMaxGrowthFactor() const;
+
+    /**
+     * Set the largest factor by which the step size may grow from one step to the next. Defaults to 2.
+     *
+     * @param maxGrowthFactor the factor, at least 1
+     */
+    void SetMaxGrowthFactor(double maxGrowthFactor);
+
+    /**
+     * @return the step size at or below which steps are never rejected
+     */
+    double GetMinimumTimestep() const;
+
+    /**
+     * Set the step size at or below which steps are never rejected. Defaults to 1e-4.
+     *
+     * @param minimumTimestep the step size
+     */
+    void SetMinimumTimestep(double minimumTimestep);
+
+    /**
+     * @return the largest step size that is suggested
+     */
+    double GetMaximumTimestep() const;
+
+    /**
+     * Set the largest step size that is suggested. Defaults to 1.
+     *
+     * @param maximumTimestep the step size
+     */
+    void SetMaximumTimestep(double maximumTimestep);
+
+    /**
+     * @return the number of steps accepted so far
+     */
+    unsigned GetNumAcceptedSteps() const;
+
+    /**
+     * @return the number of steps rejected so far
+     */
+    unsigned GetNumRejectedSteps() const;
+
+    /**
+     * Overridden OutputNumericalMethodParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputNumericalMethodParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS1(DisplacementControlledNumericalMethod, 2)
+
+#endif /*DISPLACEMENTCONTROLLEDNUMERICALMETHOD_HPP_*/
@@ -0,0 +1,384 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "FarhadifarWoundHealingForce.hpp"
+
+template<unsigned DIM>
+FarhadifarWoundHealingForce<DIM>::FarhadifarWoundHealingForce()
+   : WoundHealingForce<DIM>(),
+     mAreaElasticityParameter(1.0), // These parameters are Case I in Farhadifar's paper
+     mPerimeterContractilityParameter(0.04),
+     mLineTensionParameter(0.12),
+     mBoundaryLineTensionParameter(0.12) // this parameter as such does not exist in Farhadifar's model.
+{
+}
+
+template<unsigned DIM>
+FarhadifarWoundHealingForce<DIM>::~FarhadifarWoundHealingForce()
+{
+}
+
+template<unsigned DIM>
+void FarhadifarWoundHealingForce<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    WOUND_HEALING_TRACE_SCOPE("FarhadifarWoundHealingForce::AddForceContribution");
+
+    // Throw an exception message if not using a VertexBasedCellPopulation
+    if (dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("FarhadifarWoundHealingForce is to be used with a VertexBasedCellPopulation only");
+    }
+
+    // Define some helper variables
+    VertexBasedCellPopulation<DIM>* p_cell_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    MutableVertexMesh<DIM, DIM>& r_mesh = p_cell_population->rGetMesh();
+    unsigned num_nodes = r_mesh.GetNumAllNodes();
+    WOUND_HEALING_COUNT(this->mTimings.AddCall());
+
+    // Bring the wound boundaries up to date
+    this->UpdateWoundBoundaries(*p_cell_population);
+
+    // The Farhadifar terms are timed together, from the target areas to the gather
+    {
+        WOUND_HEALING_TIME_PHASE(this->mTimings, FARHADIFAR);
+
+        /*
+         * Look up the target area of each element. Cell::GetCellData() allocates memory, so we
+         * keep the cell data of each element and only look it up again if the element now belongs
+         * to a different cell. This is done in serial, since an exception must not be thrown from
+         * inside a parallel loop.
+         */
+        unsigned num_elements = r_mesh.GetNumAllElements();
+        mTargetAreas.resize(num_elements);
+        mElementCells.resize(num_elements);
+        mElementCellData.resize(num_elements);
+        for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = p_cell_population->Begin();
+             cell_iter != p_cell_population->End();
+             ++cell_iter)
+        {
+            CellPtr p_cell = *cell_iter;
+            unsigned elem_index = p_cell_population->GetLocationIndexUsingCell(p_cell);
+            if (mElementCells[elem_index] != p_cell)
+            {
+                mElementCells[elem_index] = p_cell;
+                mElementCellData[elem_index] = p_cell->GetCellData();
+            }
+            try
+            {
+                // If we haven't specified a growth modifier, there won't be any target areas in the CellData array
+                mTargetAreas[elem_index] = mElementCellData[elem_index]->GetItem("target area");
+            }
+            catch (Exception&)
+            {
+                EXCEPTION("You need to add an AbstractTargetAreaModifier to the simulation in order to use a FarhadifarWoundHealingForce");
+            }
+        }
+
+        // Give each element a contiguous block of slots in mElementNodeForces, one for each of its nodes
+        mElementNodeOffsets.resize(num_elements+1);
+        mElementNodeOffsets[0] = 0;
+        for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+        {
+            VertexElement<DIM, DIM>* p_element = r_mesh.GetElement(elem_index);
+            unsigned num_slots = p_element->IsDeleted() ? 0 : p_element->GetNumNodes();
+            mElementNodeOffsets[elem_index+1] = mElementNodeOffsets[elem_index] + num_slots;
+        }
+        mElementNodeForces.resize(mElementNodeOffsets[num_elements]);
+
+        /*
+         * Record the slots that hold the forces on each node, in the order of its containing
+         * elements, so that the gather below does not have to search each element for the node.
+         * The slots are counted, the counts summed into offsets, and the slots filled in.
+         */
+        mNodeSlotOffsets.assign(num_nodes+1, 0);
+        for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+        {
+            VertexElement<DIM, DIM>* p_element = r_mesh.GetElement(elem_index);
+            for (unsigned local_index=0; local_index<mElementNodeOffsets[elem_index+1] - mElementNodeOffsets[elem_index]; local_index++)
+            {
+                mNodeSlotOffsets[p_element->GetNodeGlobalIndex(local_index)+1]++;
+            }
+        }
+        for (unsigned node_index=0; node_index<num_nodes; node_index++)
+        {
+            mNodeSlotOffsets[node_index+1] += mNodeSlotOffsets[node_index];
+        }
+        mNodeSlots.resize(mNodeSlotOffsets[num_nodes]);
+        for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+        {
+            VertexElement<DIM, DIM>* p_element = r_mesh.GetElement(elem_index);
+            for (unsigned local_index=0; local_index<mElementNodeOffsets[elem_index+1] - mElementNodeOffsets[elem_index]; local_index++)
+            {
+                mNodeSlots[mNodeSlotOffsets[p_element->GetNodeGlobalIndex(local_index)]++] = mElementNodeOffsets[elem_index] + local_index;
+            }
+        }
+
+        // Filling the slots moved each offset on to the start of the next node, so move them back
+        for (unsigned node_index=num_nodes; node_index>0; node_index--)
+        {
+            mNodeSlotOffsets[node_index] = mNodeSlotOffsets[node_index-1];
+        }
+        mNodeSlotOffsets[0] = 0;
+
+        /*
+         * Visit each element once. Its area elasticity acts on each of its nodes, and the
+         * perimeter contractility and line tension act along each of its edges. The gradient of an edge at its second node is minus the gradient at its
+         * first node, so each edge gradient only needs to be computed once per element.
+         * Each element only writes to its own slots, so the elements can be visited in parallel.
+         */
+        int num_elements_as_int = num_elements;
+
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(this->mNumThreads) schedule(static)
+#endif
+        for (int elem_index=0; elem_index<num_elements_as_int; elem_index++)
+        {
+            VertexElement<DIM, DIM>* p_element = r_mesh.GetElement(elem_index);
+            if (p_element->IsDeleted())
+            {
+                continue;
+            }
+            unsigned num_nodes_elem = p_element->GetNumNodes();
+            c_vector<double, DIM>* p_slots = &(mElementNodeForces[mElementNodeOffsets[elem_index]]);
+            for (unsigned local_index=0; local_index<num_nodes_elem; local_index++)
+            {
+                p_slots[local_index] = zero_vector<double>(DIM);
+            }
+
+            double element_area = r_mesh.GetVolumeOfElement(elem_index);
+            double element_perimeter = r_mesh.GetSurfaceAreaOfElement(elem_index);
+            double area_elasticity_coefficient = mAreaElasticityParameter*(element_area - mTargetAreas[elem_index]);
+            double perimeter_contractility_coefficient = mPerimeterContractilityParameter*element_perimeter;
+
+            for (unsigned local_index=0; local_index<num_nodes_elem; local_index++)
+            {
+                unsigned next_local_index = (local_index+1)%num_nodes_elem;
+                Node<DIM>* p_this_node = p_element->GetNode(local_index);
+                Node<DIM>* p_next_node = p_element->GetNode(next_local_index);
+
+                // Add the force contribution from this cell's area elasticity (note the minus sign)
+                p_slots[local_index] -= area_elasticity_coefficient*
+                        r_mesh.GetAreaGradientOfElementAtNode(p_element, local_index);
+
+                // Compute the gradient of the edge to the next node, computed at the present node
+                c_vector<double, DIM> edge_gradient = r_mesh.GetNextEdgeGradientOfElementAtNode(p_element, local_index);
+
+                // The line tension is halved for internal edges, since each of these is visited from both of its elements
+                const std::set<unsigned>& r_this_elem_indices = p_this_node->rGetContainingElementIndices();
+                const std::set<unsigned>& r_next_elem_indices = p_next_node->rGetContainingElementIndices();
+                unsigned num_shared_elements = 0;
+                for (std::set<unsigned>::const_iterator iter = r_next_elem_indices.begin();
+                     iter != r_next_elem_indices.end();
+                     ++iter)
+                {
+                    num_shared_elements += r_this_elem_indices.count(*iter);
+                }
+                double line_tension_parameter = mLineTensionParameter/2.0;
+                if (num_shared_elements == 1)
+                {
+                    line_tension_parameter = mBoundaryLineTensionParameter;
+                }
+
+                // Add the perimeter contractility and line tension along this edge to both of its nodes
+                double edge_coefficient = perimeter_contractility_coefficient + line_tension_parameter;
+                p_slots[local_index] -= edge_coefficient*edge_gradient;
+                p_slots[next_local_index] += edge_coefficient*edge_gradient;
+            }
+        }
+
+        /*
+         * Then gather the force on each node from its slots. Each node sums its contributions
+         * in the order of its containing elements whatever the number of threads, so the result
+         * is reproducible bit for bit.
+         */
+        mNodeForces.resize(num_nodes);
+        int num_nodes_as_int = num_nodes;
+
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(this->mNumThreads) schedule(static)
+#endif
+        for (int node_index=0; node_index<num_nodes_as_int; node_index++)
+        {
+            mNodeForces[node_index] = zero_vector<double>(DIM);
+            for (unsigned slot=mNodeSlotOffsets[node_index]; slot<mNodeSlotOffsets[node_index+1]; slot++)
+            {
+                mNodeForces[node_index] += mElementNodeForces[mNodeSlots[slot]];
+            }
+        }
+    }
+
+    // Add the tension along the wounds, using the wound-edge adjacency table
+    {
+        WOUND_HEALING_TIME_PHASE(this->mTimings, WOUND_TENSION);
+        for (unsigned table_index=0; table_index<this->mWoundNodeTable.size(); table_index++)
+        {
+            unsigned node_index = this->mWoundNodeTable[table_index].mNodeIndex;
+            mNodeForces[node_index] += MakeCVector(this->CalculateWoundTensionOnNode(table_index, *p_cell_population));
+        }
+    }
+
+    // Finally, pass the accumulated forces to the nodes
+    WOUND_HEALING_TIME_PHASE(this->mTimings, FORCE_APPLICATION);
+    for (unsigned node_index=0; node_index<num_nodes; node_index++)
+    {
+        Node<DIM>* p_node = r_mesh.GetNode(node_index);
+        if (!p_node->IsDeleted())
+        {
+            p_node->AddAppliedForceContribution(mNodeForces[node_index]);
+        }
+    }
+}
+
+template<unsigned DIM>
+double FarhadifarWoundHealingForce<DIM>::CalculateEnergy(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    if (dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("FarhadifarWoundHealingForce is to be used with a VertexBasedCellPopulation only");
+    }
+    VertexBasedCellPopulation<DIM>* p_cell_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    MutableVertexMesh<DIM, DIM>& r_mesh = p_cell_population->rGetMesh();
+
+    double energy = 0.0;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = p_cell_population->Begin();
+         cell_iter != p_cell_population->End();
+         ++cell_iter)
+    {
+        unsigned elem_index = p_cell_population->GetLocationIndexUsingCell(*cell_iter);
+        double target_area = 0.0;
+        try
+        {
+            target_area = cell_iter->GetCellData()->GetItem("target area");
+        }
+        catch (Exception&)
+        {
+            EXCEPTION("You need to add an AbstractTargetAreaModifier to the simulation in order to use a FarhadifarWoundHealingForce");
+        }
+        double element_area = r_mesh.GetVolumeOfElement(elem_index);
+        double element_perimeter = r_mesh.GetSurfaceAreaOfElement(elem_index);
+        energy += 0.5*mAreaElasticityParameter*(element_area - target_area)*(element_area - target_area)
+                + 0.5*mPerimeterContractilityParameter*element_perimeter*element_perimeter;
+
+        // Each internal edge is visited from both of its elements, so gets half the line tension from each
+        VertexElement<DIM, DIM>* p_element = r_mesh.GetElement(elem_index);
+        unsigned num_nodes_elem = p_element->GetNumNodes();
+        for (unsigned local_index=0; local_index<num_nodes_elem; local_index++)
+        {
+            Node<DIM>* p_this_node = p_element->GetNode(local_index);
+            Node<DIM>* p_next_node = p_element->GetNode((local_index+1)%num_nodes_elem);
+            const std::set<unsigned>& r_this_elem_indices = p_this_node->rGetContainingElementIndices();
+            const std::set<unsigned>& r_next_elem_indices = p_next_node->rGetContainingElementIndices();
+            unsigned num_shared_elements = 0;
+            for (std::set<unsigned>::const_iterator iter = r_next_elem_indices.begin();
+                 iter != r_next_elem_indices.end();
+                 ++iter)
+            {
+                num_shared_elements += r_this_elem_indices.count(*iter);
+            }
+            double line_tension_parameter = (num_shared_elements == 1) ? mBoundaryLineTensionParameter : mLineTensionParameter/2.0;
+            energy += line_tension_parameter*norm_2(r_mesh.GetVectorFromAtoB(p_this_node->rGetLocation(), p_next_node->rGetLocation()));
+        }
+    }
+
+    // Add the energy of the tension along the wounds
+    return energy + WoundHealingForce<DIM>::CalculateEnergy(rCellPopulation);
+}
+
+template<unsigned DIM>
+double FarhadifarWoundHealingForce<DIM>::GetAreaElasticityParameter()
+{
+    return mAreaElasticityParameter;
+}
+
+template<unsigned DIM>
+double FarhadifarWoundHealingForce<DIM>::GetPerimeterContractilityParameter()
+{
+    return mPerimeterContractilityParameter;
+}
+
+template<unsigned DIM>
+double FarhadifarWoundHealingForce<DIM>::GetLineTensionParameter()
+{
+    return mLineTensionParameter;
+}
+
+template<unsigned DIM>
+double FarhadifarWoundHealingForce<DIM>::GetBoundaryLineTensionParameter()
+{
+    return mBoundaryLineTensionParameter;
+}
+
+template<unsigned DIM>
+void FarhadifarWoundHealingForce<DIM>::SetAreaElasticityParameter(double areaElasticityParameter)
+{
+    mAreaElasticityParameter = areaElasticityParameter;
+}
+
+template<unsigned DIM>
+void FarhadifarWoundHealingForce<DIM>::SetPerimeterContractilityParameter(double perimeterContractilityParameter)
+{
+    mPerimeterContractilityParameter = perimeterContractilityParameter;
+}
+
+template<unsigned DIM>
+void FarhadifarWoundHealingForce<DIM>::SetLineTensionParameter(double lineTensionParameter)
+{
+    mLineTensionParameter = lineTensionParameter;
+}
+
+template<unsigned DIM>
+void FarhadifarWoundHealingForce<DIM>::SetBoundaryLineTensionParameter(double boundaryLineTensionParameter)
+{
+    mBoundaryLineTensionParameter = boundaryLineTensionParameter;
+}
+
+template<unsigned DIM>
+void FarhadifarWoundHealingForce<DIM>::OutputForceParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<AreaElasticityParameter>" << mAreaElasticityParameter << "</AreaElasticityParameter>\n";
+    *rParamsFile << "\t\t\t<PerimeterContractilityParameter>" << mPerimeterContractilityParameter << "</PerimeterContractilityParameter>\n";
+    *rParamsFile << "\t\t\t<LineTensionParameter>" << mLineTensionParameter << "</LineTensionParameter>\n";
+    *rParamsFile << "\t\t\t<BoundaryLineTensionParameter>" << mBoundaryLineTensionParameter << "</BoundaryLineTensionParameter>\n";
+
+    // Call method on direct parent class
+    WoundHealingForce<DIM>::OutputForceParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class FarhadifarWoundHealingForce<2>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS1(FarhadifarWoundHealingForce, 2)
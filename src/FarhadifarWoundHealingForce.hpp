@@ -0,0 +1,245 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef FARHADIFARWOUNDHEALINGFORCE_HPP_
+#define FARHADIFARWOUNDHEALINGFORCE_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include "Exception.hpp"
+
+#include "WoundHealingForce.hpp"
+#include "CellData.hpp"
+
+#include <iostream>
+#include <vector>
+
+/**
+ * A force class for use in Vertex-based simulations that combines the force of
+ * Farhadifar et al (Curr. Biol., 2007, 17, 2095-2104), as implemented in FarhadifarForce,
+ * with the tension along the wound from WoundHealingForce.
+ *
+ * Using this force gives the same result as adding a FarhadifarForce and a
+ * WoundHealingForce to a simulation, but it visits each element only once per
+ * time step. The area elasticity, perimeter contractility, line tension and wound
+ * tension of each element are added to a contiguous buffer of forces on the nodes,
+ * which are then passed to the nodes in a single sweep. If the project is built
+ * with OpenMP, elements and nodes are processed in parallel (see SetNumThreads()).
+ * Like WoundHealingForce, this force is only defined for DIM = 2.
+ */
+template<unsigned DIM>
+class FarhadifarWoundHealingForce : public WoundHealingForce<DIM>
+{
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<WoundHealingForce<DIM> >(*this);
+        archive & mAreaElasticityParameter;
+        archive & mPerimeterContractilityParameter;
+        archive & mLineTensionParameter;
+        archive & mBoundaryLineTensionParameter;
+    }
+
+protected:
+
+    /**
+     * The strength of the area term in the model. Corresponds to K_alpha in Farhadifar's paper.
+     */
+    double mAreaElasticityParameter;
+
+    /**
+     * The strength of the perimeter term in the model. Corresponds to Gamma_alpha in Farhadifar's paper.
+     */
+    double mPerimeterContractilityParameter;
+
+    /**
+     * The strength of the line tension term in the model. Lambda_{ij} in Farhadifar's paper.
+     */
+    double mLineTensionParameter;
+
+    /**
+     * The strength of the line tension at the boundary. This term does correspond to Lambda_{ij} in Farhadifar's paper.
+     */
+    double mBoundaryLineTensionParameter;
+
+    /**
+     * The target area of each element, looked up at the start of AddForceContribution().
+     */
+    std::vector<double> mTargetAreas;
+
+    /**
+     * The cell that each element belonged to at the last call to AddForceContribution().
+     */
+    std::vector<CellPtr> mElementCells;
+
+    /**
+     * The cell data of the cell in mElementCells, kept so that it need not be looked up every step.
+     */
+    std::vector<boost::shared_ptr<CellData> > mElementCellData;
+
+    /**
+     * The position of the first slot of each element in mElementNodeForces. Entry i+1
+     * minus entry i is the number of nodes of element i, or zero if it has been deleted.
+     */
+    std::vector<unsigned> mElementNodeOffsets;
+
+    /**
+     * The force that each element exerts on each of its nodes, in one contiguous block
+     * per element. Each element only writes to its own block, so that the elements can
+     * be visited in parallel.
+     */
+    std::vector<c_vector<double, DIM> > mElementNodeForces;
+
+    /**
+     * The position of the first entry of each node in mNodeSlots. Entry i+1 minus entry i
+     * is the number of elements containing node i.
+     */
+    std::vector<unsigned> mNodeSlotOffsets;
+
+    /**
+     * The slots of mElementNodeForces that hold the forces on each node, in one contiguous
+     * block per node, in the order of its containing elements.
+     */
+    std::vector<unsigned> mNodeSlots;
+
+    /**
+     * The force on each node, gathered from the blocks of its elements.
+     */
+    std::vector<c_vector<double, DIM> > mNodeForces;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    FarhadifarWoundHealingForce();
+
+    /**
+     * Destructor.
+     */
+    virtual ~FarhadifarWoundHealingForce();
+
+    /**
+     * Overridden AddForceContribution() method.
+     *
+     * Calculates the force on each node in the vertex-based cell population, including
+     * the tension along the wound, in a single traversal of the elements.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Overridden CalculateEnergy() method.
+     *
+     * Calculates the energy whose negative gradient is the force added by AddForceContribution():
+     * the sum over the cells of K/2*(A - A0)^2 + Gamma/2*P^2, the line tension times the
+     * length of each edge, and the wound tension times the perimeter of the wounds.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @return the energy
+     */
+    virtual double CalculateEnergy(AbstractCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * @return mAreaElasticityParameter
+     */
+    double GetAreaElasticityParameter();
+
+    /**
+     * @return mPerimeterContractilityParameter
+     */
+    double GetPerimeterContractilityParameter();
+
+    /**
+     * @return mLineTensionParameter
+     */
+    double GetLineTensionParameter();
+
+    /**
+     * @return mBoundaryLineTensionParameter
+     */
+    double GetBoundaryLineTensionParameter();
+
+    /**
+     * Set mAreaElasticityParameter.
+     *
+     * @param areaElasticityParameter the new value of mAreaElasticityParameter
+     */
+    void SetAreaElasticityParameter(double areaElasticityParameter);
+
+    /**
+     * Set mPerimeterContractilityParameter.
+     *
+     * @param perimeterContractilityParameter the new value of perimterContractilityParameter
+     */
+    void SetPerimeterContractilityParameter(double perimeterContractilityParameter);
+
+    /**
+     * Set mLineTensionParameter.
+     *
+     * @param lineTensionParameter the new value of mLineTensionParameter
+     */
+    void SetLineTensionParameter(double lineTensionParameter);
+
+    /**
+     * Set mBoundaryLineTensionParameter.
+     *
+     * @param boundaryLineTensionParameter the new value of mBoundaryLineTensionParameter
+     */
+    void SetBoundaryLineTensionParameter(double boundaryLineTensionParameter);
+
+    /**
+     * Overridden OutputForceParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputForceParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS1(FarhadifarWoundHealingForce, 2)
+
+#endif /*FARHADIFARWOUNDHEALINGFORCE_HPP_*/
@@ -0,0 +1,872 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "LargeVertexMeshGenerator.hpp"
+#include "Exception.hpp"
+#include "RandomNumberGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sys/resource.h>
+
+namespace
+{
+/** The number of times the seeds may be nudged before the tessellation gives up. */
+const unsigned MAX_NUM_DEGENERACY_REPAIRS = 20;
+
+/**
+ * @param rVector a vector
+ * @return the memory held by the vector, in bytes
+ */
+template<typename T>
+std::size_t GetCapacityBytes(const std::vector<T>& rVector)
+{
+    return rVector.capacity()*sizeof(T);
+}
+
+/**
+ * Free the memory held by a vector.
+ *
+ * @param rVector the vector
+ */
+template<typename T>
+void FreeVector(std::vector<T>& rVector)
+{
+    std::vector<T>().swap(rVector);
+}
+}
+
+LargeVertexMeshGenerator::LargeVertexMeshGenerator(unsigned numElementsAcross, unsigned numElementsUp, double elementTargetArea)
+    : mNumElementsAcross(numElementsAcross),
+      mNumElementsUp(numElementsUp),
+      mElementTargetArea(elementTargetArea),
+      mWidth(0.0),
+      mHeight(0.0),
+      mNumThreads(1),
+      mpMesh(nullptr),
+      mPeakMemoryBytes(0),
+      mNumDegeneracyRepairs(0),
+      mBinSize(1.0),
+      mNumBinColumns(1),
+      mNumBinRows(1)
+{
+    if (numElementsAcross == 0 || numElementsUp == 0)
+    {
+        EXCEPTION("The tissue must have at least one cell across and up");
+    }
+    if (!(elementTargetArea > 0.0))
+    {
+        EXCEPTION("The target area of the cells must be positive");
+    }
+    if ((double)numElementsAcross*numElementsUp >= 4.0e9)
+    {
+        EXCEPTION("The tissue has too many cells to be indexed");
+    }
+    mArrays.mElementOffsets.assign(1, 0);
+}
+
+LargeVertexMeshGenerator::~LargeVertexMeshGenerator()
+{
+    DeleteMesh();
+}
+
+void LargeVertexMeshGenerator::SetNumThreads(unsigned numThreads)
+{
+    mNumThreads = std::max(numThreads, 1u);
+}
+
+unsigned LargeVertexMeshGenerator::GetNumThreads() const
+{
+    return mNumThreads;
+}
+
+void LargeVertexMeshGenerator::DeleteMesh()
+{
+    delete mpMesh;
+    mpMesh = nullptr;
+}
+
+void LargeVertexMeshGenerator::UpdatePeakMemory(std::size_t extraBytes)
+{
+    std::size_t bytes = extraBytes
+        + GetCapacityBytes(mArrays.mX) + GetCapacityBytes(mArrays.mY) + GetCapacityBytes(mArrays.mIsBoundaryNode)
+        + GetCapacityBytes(mArrays.mElementOffsets) + GetCapacityBytes(mArrays.mElementNodes)
+        + GetCapacityBytes(mArrays.mElementAttributes)
+        + GetCapacityBytes(mSeedX) + GetCapacityBytes(mSeedY) + GetCapacityBytes(mBinStarts) + GetCapacityBytes(mBinSeeds);
+    mPeakMemoryBytes = std::max(mPeakMemoryBytes, bytes);
+}
+
+void LargeVertexMeshGenerator::GenerateVoronoiTissue(unsigned numRelaxationSteps)
+{
+    DeleteMesh();
+    double spacing = sqrt(mElementTargetArea);
+    mWidth = mNumElementsAcross*spacing;
+    mHeight = mNumElementsUp*spacing;
+
+    // One seed at a random point of each square of the grid, so that no region starts empty
+    unsigned num_seeds = mNumElementsAcross*mNumElementsUp;
+    mSeedX.resize(num_seeds);
+    mSeedY.resize(num_seeds);
+    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+    for (unsigned row=0; row<mNumElementsUp; row++)
+    {
+        for (unsigned col=0; col<mNumElementsAcross; col++)
+        {
+            mSeedX[row*mNumElementsAcross + col] = (col + p_gen->ranf())*spacing;
+            mSeedY[row*mNumElementsAcross + col] = (row + p_gen->ranf())*spacing;
+        }
+    }
+
+    // The seeds stay in the rectangle, so bins of the same squares hold about one seed each
+    mBinSize = spacing;
+    mNumBinColumns = mNumElementsAcross;
+    mNumBinRows = mNumElementsUp;
+    for (unsigned step=0; step<numRelaxationSteps; step++)
+    {
+        BinSeeds();
+        RelaxSeeds();
+    }
+    BinSeeds();
+    SortSeedsByBin();
+
+    /*
+     * Where four or more seeds lie almost on a circle, rounding can make neighbouring cells
+     * disagree on which of them meet at a vertex. The seeds of such cells are moved by a tiny
+     * amount and the tessellation is tried again.
+     */
+    mNumDegeneracyRepairs = 0;
+    std::vector<unsigned> bad_seeds = BuildVoronoiTissue();
+    while (!bad_seeds.empty())
+    {
+        if (mNumDegeneracyRepairs == MAX_NUM_DEGENERACY_REPAIRS)
+        {
+            EXCEPTION("Could not resolve the degenerate vertices of the Voronoi tessellation");
+        }
+        mNumDegeneracyRepairs++;
+        double nudge = 1e-7*spacing;
+        for (unsigned i=0; i<bad_seeds.size(); i++)
+        {
+            unsigned seed_index = bad_seeds[i];
+            mSeedX[seed_index] = std::min(std::max(mSeedX[seed_index] + nudge*(2.0*p_gen->ranf() - 1.0), 0.0), mWidth);
+            mSeedY[seed_index] = std::min(std::max(mSeedY[seed_index] + nudge*(2.0*p_gen->ranf() - 1.0), 0.0), mHeight);
+        }
+        BinSeeds();
+        bad_seeds = BuildVoronoiTissue();
+    }
+
+    FreeVector(mSeedX);
+    FreeVector(mSeedY);
+    FreeVector(mBinStarts);
+    FreeVector(mBinSeeds);
+}
+
+void LargeVertexMeshGenerator::BinSeeds()
+{
+    unsigned num_seeds = mSeedX.size();
+    unsigned num_bins = mNumBinColumns*mNumBinRows;
+    std::vector<unsigned> seed_bins(num_seeds);
+    mBinStarts.assign(num_bins + 1, 0);
+    for (unsigned seed_index=0; seed_index<num_seeds; seed_index++)
+    {
+        unsigned col = std::min((unsigned)std::max(mSeedX[seed_index]/mBinSize, 0.0), mNumBinColumns - 1);
+        unsigned row = std::min((unsigned)std::max(mSeedY[seed_index]/mBinSize, 0.0), mNumBinRows - 1);
+        seed_bins[seed_index] = row*mNumBinColumns + col;
+        mBinStarts[seed_bins[seed_index] + 1]++;
+    }
+    for (unsigned bin=0; bin<num_bins; bin++)
+    {
+        mBinStarts[bin + 1] += mBinStarts[bin];
+    }
+
+    /*
+     * Fill each bin from its end, going through the seeds backwards so that each bin lists its
+     * seeds in increasing order. Entry b+1 then holds the start of bin b, so shift them down.
+     */
+    mBinSeeds.resize(num_seeds);
+    for (unsigned seed_index=num_seeds; seed_index-- > 0; )
+    {
+        mBinSeeds[--mBinStarts[seed_bins[seed_index] + 1]] = seed_index;
+    }
+    for (unsigned bin=0; bin<num_bins; bin++)
+    {
+        mBinStarts[bin] = mBinStarts[bin + 1];
+    }
+    mBinStarts[num_bins] = num_seeds;
+    UpdatePeakMemory(GetCapacityBytes(seed_bins));
+}
+
+void LargeVertexMeshGenerator::SortSeedsByBin()
+{
+    unsigned num_seeds = mSeedX.size();
+    std::vector<double> sorted_x(num_seeds);
+    std::vector<double> sorted_y(num_seeds);
+    for (unsigned i=0; i<num_seeds; i++)
+    {
+        sorted_x[i] = mSeedX[mBinSeeds[i]];
+        sorted_y[i] = mSeedY[mBinSeeds[i]];
+        mBinSeeds[i] = i;
+    }
+    UpdatePeakMemory(GetCapacityBytes(sorted_x) + GetCapacityBytes(sorted_y));
+    mSeedX.swap(sorted_x);
+    mSeedY.swap(sorted_y);
+}
+
+void LargeVertexMeshGenerator::ClipByBisector(unsigned seedIndex, unsigned otherIndex, ClippedCell& rCell) const
+{
+    // The side nearer the seed is where the dot product with the direction to the other seed is below that of the midpoint
+    double direction_x = mSeedX[otherIndex] - mSeedX[seedIndex];
+    double direction_y = mSeedY[otherIndex] - mSeedY[seedIndex];
+    if (direction_x == 0.0 && direction_y == 0.0)
+    {
+        return;
+    }
+    double threshold = 0.5*(direction_x*(mSeedX[otherIndex] + mSeedX[seedIndex]) + direction_y*(mSeedY[otherIndex] + mSeedY[seedIndex]));
+
+    unsigned num_vertices = rCell.mX.size();
+    bool is_clipped = false;
+    for (unsigned k=0; k<num_vertices; k++)
+    {
+        if (direction_x*rCell.mX[k] + direction_y*rCell.mY[k] > threshold)
+        {
+            is_clipped = true;
+            break;
+        }
+    }
+    if (!is_clipped)
+    {
+        return;
+    }
+
+    /*
+     * Sutherland-Hodgman clipping of a convex polygon. A vertex that is kept starts the same
+     * edge as before. Where the boundary leaves the kept side, the new vertex starts an edge
+     * along the bisector; where it comes back, the new vertex starts the rest of the old edge.
+     */
+    rCell.mNewX.clear();
+    rCell.mNewY.clear();
+    rCell.mNewEdgeLabels.clear();
+    for (unsigned k=0; k<num_vertices; k++)
+    {
+        unsigned next = (k + 1 == num_vertices) ? 0 : k + 1;
+        double this_value = direction_x*rCell.mX[k] + direction_y*rCell.mY[k] - threshold;
+        double next_value = direction_x*rCell.mX[next] + direction_y*rCell.mY[next] - threshold;
+        if (this_value <= 0.0)
+        {
+            rCell.mNewX.push_back(rCell.mX[k]);
+            rCell.mNewY.push_back(rCell.mY[k]);
+            rCell.mNewEdgeLabels.push_back(rCell.mEdgeLabels[k]);
+        }
+        if ((this_value <= 0.0) != (next_value <= 0.0))
+        {
+            double fraction = this_value/(this_value - next_value);
+            rCell.mNewX.push_back(rCell.mX[k] + fraction*(rCell.mX[next] - rCell.mX[k]));
+            rCell.mNewY.push_back(rCell.mY[k] + fraction*(rCell.mY[next] - rCell.mY[k]));
+            rCell.mNewEdgeLabels.push_back(this_value <= 0.0 ? otherIndex : rCell.mEdgeLabels[k]);
+        }
+    }
+    rCell.mX.swap(rCell.mNewX);
+    rCell.mY.swap(rCell.mNewY);
+    rCell.mEdgeLabels.swap(rCell.mNewEdgeLabels);
+}
+
+void LargeVertexMeshGenerator::ClipVoronoiCell(unsigned seedIndex, ClippedCell& rCell) const
+{
+    // Start from the rectangle, counterclockwise from the lower left corner
+    unsigned num_seeds = mSeedX.size();
+    const double corner_x[4] = {0.0, mWidth, mWidth, 0.0};
+    const double corner_y[4] = {0.0, 0.0, mHeight, mHeight};
+    rCell.mX.assign(corner_x, corner_x + 4);
+    rCell.mY.assign(corner_y, corner_y + 4);
+    rCell.mEdgeLabels.resize(4);
+    for (unsigned side=0; side<4; side++)
+    {
+        rCell.mEdgeLabels[side] = num_seeds + side;
+    }
+
+    double seed_x = mSeedX[seedIndex];
+    double seed_y = mSeedY[seedIndex];
+    int home_col = std::min((int)std::max(seed_x/mBinSize, 0.0), (int)mNumBinColumns - 1);
+    int home_row = std::min((int)std::max(seed_y/mBinSize, 0.0), (int)mNumBinRows - 1);
+
+    /*
+     * Clip by the seeds in rings of bins around the seed's bin. A seed further away than twice
+     * the distance to the furthest vertex of the cell cannot clip it, so we stop once the next
+     * ring is that far away.
+     */
+    for (int ring=0; ; ring++)
+    {
+        for (int row=home_row-ring; row<=home_row+ring; row++)
+        {
+            if (row < 0 || row >= (int)mNumBinRows)
+            {
+                continue;
+            }
+            int col_step = (row == home_row-ring || row == home_row+ring) ? 1 : 2*ring;
+            for (int col=home_col-ring; col<=home_col+ring; col+=std::max(col_step, 1))
+            {
+                if (col < 0 || col >= (int)mNumBinColumns)
+                {
+                    continue;
+                }
+                unsigned bin = row*mNumBinColumns + col;
+                for (unsigned i=mBinStarts[bin]; i<mBinStarts[bin+1]; i++)
+                {
+                    if (mBinSeeds[i] != seedIndex)
+                    {
+                        ClipByBisector(seedIndex, mBinSeeds[i], rCell);
+                    }
+                }
+            }
+        }
+
+        double max_squared_radius = 0.0;
+        for (unsigned k=0; k<rCell.mX.size(); k++)
+        {
+            double dx = rCell.mX[k] - seed_x;
+            double dy = rCell.mY[k] - seed_y;
+            max_squared_radius = std::max(max_squared_radius, dx*dx + dy*dy);
+        }
+
+        // The distance to the nearest side of the block of rings searched that has bins beyond it
+        double unsearched_distance = HUGE_VAL;
+        if (home_col-ring > 0)
+        {
+            unsearched_distance = std::min(unsearched_distance, seed_x - (home_col-ring)*mBinSize);
+        }
+        if (home_col+ring+1 < (int)mNumBinColumns)
+        {
+            unsearched_distance = std::min(unsearched_distance, (home_col+ring+1)*mBinSize - seed_x);
+        }
+        if (home_row-ring > 0)
+        {
+            unsearched_distance = std::min(unsearched_distance, seed_y - (home_row-ring)*mBinSize);
+        }
+        if (home_row+ring+1 < (int)mNumBinRows)
+        {
+            unsearched_distance = std::min(unsearched_distance, (home_row+ring+1)*mBinSize - seed_y);
+        }
+        if (unsearched_distance == HUGE_VAL || unsearched_distance*unsearched_distance >= 4.0*max_squared_radius)
+        {
+            break;
+        }
+    }
+}
+
+void LargeVertexMeshGenerator::RelaxSeeds()
+{
+    int num_seeds = mSeedX.size();
+    std::vector<double> new_x(num_seeds);
+    std::vector<double> new_y(num_seeds);
+
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(mNumThreads)
+#endif
+    {
+        ClippedCell cell;
+#ifdef _OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (int seed_index=0; seed_index<num_seeds; seed_index++)
+        {
+            ClipVoronoiCell(seed_index, cell);
+
+            // The centroid, with the vertices taken relative to the seed to keep the precision
+            double twice_area = 0.0;
+            double weighted_x = 0.0;
+            double weighted_y = 0.0;
+            unsigned num_vertices = cell.mX.size();
+            for (unsigned k=0; k<num_vertices; k++)
+            {
+                unsigned next = (k + 1 == num_vertices) ? 0 : k + 1;
+                double x0 = cell.mX[k] - mSeedX[seed_index];
+                double y0 = cell.mY[k] - mSeedY[seed_index];
+                double x1 = cell.mX[next] - mSeedX[seed_index];
+                double y1 = cell.mY[next] - mSeedY[seed_index];
+                double cross = x0*y1 - x1*y0;
+                twice_area += cross;
+                weighted_x += cross*(x0 + x1);
+                weighted_y += cross*(y0 + y1);
+            }
+            new_x[seed_index] = mSeedX[seed_index];
+            new_y[seed_index] = mSeedY[seed_index];
+            if (twice_area > 0.0)
+            {
+                new_x[seed_index] += weighted_x/(3.0*twice_area);
+                new_y[seed_index] += weighted_y/(3.0*twice_area);
+            }
+        }
+    }
+
+    UpdatePeakMemory(GetCapacityBytes(new_x) + GetCapacityBytes(new_y));
+    mSeedX.swap(new_x);
+    mSeedY.swap(new_y);
+}
+
+std::vector<unsigned> LargeVertexMeshGenerator::BuildVoronoiTissue()
+{
+    int num_seeds = mSeedX.size();
+
+    // First pass: count the vertices of each cell, and those it owns as the lowest numbered cell meeting there
+    std::vector<uint32_t> vertex_starts(num_seeds + 1, 0);
+    std::vector<uint32_t> node_starts(num_seeds + 1, 0);
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(mNumThreads)
+#endif
+    {
+        ClippedCell cell;
+#ifdef _OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (int seed_index=0; seed_index<num_seeds; seed_index++)
+        {
+            ClipVoronoiCell(seed_index, cell);
+            unsigned num_vertices = cell.mX.size();
+            unsigned num_owned = 0;
+            for (unsigned k=0; k<num_vertices; k++)
+            {
+                unsigned previous = (k == 0) ? num_vertices - 1 : k - 1;
+                if ((unsigned)seed_index < std::min(cell.mEdgeLabels[previous], cell.mEdgeLabels[k]))
+                {
+                    num_owned++;
+                }
+            }
+            vertex_starts[seed_index + 1] = num_vertices;
+            node_starts[seed_index + 1] = num_owned;
+        }
+    }
+    for (int seed_index=0; seed_index<num_seeds; seed_index++)
+    {
+        vertex_starts[seed_index + 1] += vertex_starts[seed_index];
+        node_starts[seed_index + 1] += node_starts[seed_index];
+    }
+    unsigned num_vertices_total = vertex_starts[num_seeds];
+    unsigned num_nodes = node_starts[num_seeds];
+
+    // Second pass: store the key of each vertex, and the location of each node at its owner
+    std::vector<VertexKey> vertex_keys(num_vertices_total);
+    std::vector<unsigned char> expected_num_uses(num_nodes);
+    mArrays.mX.resize(num_nodes);
+    mArrays.mY.resize(num_nodes);
+    mArrays.mIsBoundaryNode.resize(num_nodes);
+#ifdef _OPENMP
+    #pragma omp parallel num_threads(mNumThreads)
+#endif
+    {
+        ClippedCell cell;
+#ifdef _OPENMP
+        #pragma omp for schedule(static)
+#endif
+        for (int seed_index=0; seed_index<num_seeds; seed_index++)
+        {
+            ClipVoronoiCell(seed_index, cell);
+            unsigned num_vertices = cell.mX.size();
+            unsigned node_index = node_starts[seed_index];
+            for (unsigned k=0; k<num_vertices; k++)
+            {
+                unsigned previous = (k == 0) ? num_vertices - 1 : k - 1;
+                VertexKey& r_key = vertex_keys[vertex_starts[seed_index] + k];
+                r_key.mLabels[0] = seed_index;
+                r_key.mLabels[1] = cell.mEdgeLabels[previous];
+                r_key.mLabels[2] = cell.mEdgeLabels[k];
+                std::sort(r_key.mLabels, r_key.mLabels + 3);
+                if (r_key.mLabels[0] == (unsigned)seed_index)
+                {
+                    // Sides of the rectangle have labels from the number of seeds up
+                    mArrays.mX[node_index] = cell.mX[k];
+                    mArrays.mY[node_index] = cell.mY[k];
+                    mArrays.mIsBoundaryNode[node_index] = (r_key.mLabels[2] >= (unsigned)num_seeds) ? 1 : 0;
+                    expected_num_uses[node_index] = 1 + (r_key.mLabels[1] < (unsigned)num_seeds) + (r_key.mLabels[2] < (unsigned)num_seeds);
+                    node_index++;
+                }
+            }
+        }
+    }
+
+    // Third pass: each cell finds its nodes in the lists of their owners
+    std::vector<unsigned char> is_bad_seed(num_seeds, 0);
+    mArrays.mElementNodes.resize(num_vertices_total);
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(mNumThreads) schedule(static)
+#endif
+    for (int seed_index=0; seed_index<num_seeds; seed_index++)
+    {
+        for (unsigned vertex_index=vertex_starts[seed_index]; vertex_index<vertex_starts[seed_index+1]; vertex_index++)
+        {
+            const VertexKey& r_key = vertex_keys[vertex_index];
+            unsigned owner = r_key.mLabels[0];
+            unsigned node_index = node_starts[owner];
+            bool is_found = false;
+            for (unsigned owner_vertex=vertex_starts[owner]; owner_vertex<vertex_starts[owner+1]; owner_vertex++)
+            {
+                const VertexKey& r_owner_key = vertex_keys[owner_vertex];
+                if (r_owner_key.mLabels[0] != owner)
+                {
+                    continue;
+                }
+                if (r_owner_key.mLabels[1] == r_key.mLabels[1] && r_owner_key.mLabels[2] == r_key.mLabels[2])
+                {
+                    is_found = true;
+                    break;
+                }
+                node_index++;
+            }
+            if (is_found)
+            {
+                mArrays.mElementNodes[vertex_index] = node_index;
+            }
+            else
+            {
+                // Written by one iteration only, as the owner is not this seed
+                mArrays.mElementNodes[vertex_index] = 0;
+                is_bad_seed[seed_index] = 1;
+            }
+        }
+    }
+
+    // Each node must be used by as many cells as met at its vertex
+    std::vector<unsigned char> num_uses(num_nodes, 0);
+    for (unsigned vertex_index=0; vertex_index<num_vertices_total; vertex_index++)
+    {
+        unsigned char& r_num_uses = num_uses[mArrays.mElementNodes[vertex_index]];
+        r_num_uses = std::min(r_num_uses + 1, 255);
+    }
+    for (int seed_index=0; seed_index<num_seeds; seed_index++)
+    {
+        for (unsigned vertex_index=vertex_starts[seed_index]; vertex_index<vertex_starts[seed_index+1]; vertex_index++)
+        {
+            if (vertex_keys[vertex_index].mLabels[0] == (unsigned)seed_index
+                && num_uses[mArrays.mElementNodes[vertex_index]] != expected_num_uses[mArrays.mElementNodes[vertex_index]])
+            {
+                is_bad_seed[seed_index] = 1;
+            }
+        }
+    }
+
+    UpdatePeakMemory(GetCapacityBytes(vertex_starts) + GetCapacityBytes(node_starts) + GetCapacityBytes(vertex_keys)
+                     + GetCapacityBytes(expected_num_uses) + GetCapacityBytes(is_bad_seed) + GetCapacityBytes(num_uses));
+
+    std::vector<unsigned> bad_seeds;
+    for (int seed_index=0; seed_index<num_seeds; seed_index++)
+    {
+        if (is_bad_seed[seed_index])
+        {
+            bad_seeds.push_back(seed_index);
+        }
+    }
+    if (bad_seeds.empty())
+    {
+        mArrays.mElementOffsets.swap(vertex_starts);
+        mArrays.mElementAttributes.clear();
+    }
+    return bad_seeds;
+}
+
+void LargeVertexMeshGenerator::GenerateJitteredHoneycomb(double jitter)
+{
+    if (jitter < 0.0 || jitter >= 0.5)
+    {
+        EXCEPTION("The jitter must be at least 0 and below 0.5");
+    }
+    DeleteMesh();
+    mNumDegeneracyRepairs = 0;
+
+    /*
+     * The hexagons point up, with odd rows shifted right by half a hexagon. The corners lie on
+     * a lattice with steps of half the width of a hexagon across and half its edge length up,
+     * which numbers the nodes without a search.
+     */
+    double edge_length = sqrt(2.0*mElementTargetArea/(3.0*sqrt(3.0)));
+    double half_width = 0.5*sqrt(3.0)*edge_length;
+    unsigned num_lattice_columns = 2*mNumElementsAcross + 2;
+    unsigned num_lattice_rows = 3*mNumElementsUp + 2;
+    mWidth = (num_lattice_columns - 1)*half_width;
+    mHeight = (num_lattice_rows - 1)*0.5*edge_length;
+
+    const int corner_dx[6] = {0, 1, 1, 0, -1, -1};
+    const int corner_dy[6] = {-2, -1, 1, 2, 1, -1};
+    unsigned num_elements = mNumElementsAcross*mNumElementsUp;
+    std::vector<uint32_t> lattice_nodes(num_lattice_columns*num_lattice_rows, 0);
+    mArrays.mElementOffsets.resize(num_elements + 1);
+    mArrays.mElementNodes.resize(6*num_elements);
+    for (unsigned row=0; row<mNumElementsUp; row++)
+    {
+        for (unsigned col=0; col<mNumElementsAcross; col++)
+        {
+            unsigned elem_index = row*mNumElementsAcross + col;
+            unsigned centre_x = 2*col + (row % 2) + 1;
+            unsigned centre_y = 3*row + 2;
+            mArrays.mElementOffsets[elem_index] = 6*elem_index;
+            for (unsigned corner=0; corner<6; corner++)
+            {
+                // Store the lattice point for now, and count the elements using it
+                unsigned lattice_point = (centre_y + corner_dy[corner])*num_lattice_columns + centre_x + corner_dx[corner];
+                mArrays.mElementNodes[6*elem_index + corner] = lattice_point;
+                lattice_nodes[lattice_point]++;
+            }
+        }
+    }
+    mArrays.mElementOffsets[num_elements] = 6*num_elements;
+
+    // Number the nodes in lattice order, so that they run along rows; nodes in fewer than three elements are on the boundary
+    mArrays.mX.clear();
+    mArrays.mY.clear();
+    mArrays.mIsBoundaryNode.clear();
+    RandomNumberGenerator* p_gen = RandomNumberGenerator::Instance();
+    for (unsigned lattice_y=0; lattice_y<num_lattice_rows; lattice_y++)
+    {
+        for (unsigned lattice_x=0; lattice_x<num_lattice_columns; lattice_x++)
+        {
+            uint32_t& r_lattice_node = lattice_nodes[lattice_y*num_lattice_columns + lattice_x];
+            if (r_lattice_node == 0)
+            {
+                continue;
+            }
+            mArrays.mIsBoundaryNode.push_back(r_lattice_node < 3 ? 1 : 0);
+            r_lattice_node = mArrays.mX.size();
+            double x = lattice_x*half_width;
+            double y = lattice_y*0.5*edge_length;
+            if (jitter > 0.0)
+            {
+                x += jitter*edge_length*(2.0*p_gen->ranf() - 1.0);
+                y += jitter*edge_length*(2.0*p_gen->ranf() - 1.0);
+            }
+            mArrays.mX.push_back(x);
+            mArrays.mY.push_back(y);
+        }
+    }
+    for (unsigned i=0; i<mArrays.mElementNodes.size(); i++)
+    {
+        mArrays.mElementNodes[i] = lattice_nodes[mArrays.mElementNodes[i]];
+    }
+    mArrays.mElementAttributes.clear();
+    UpdatePeakMemory(GetCapacityBytes(lattice_nodes));
+}
+
+unsigned LargeVertexMeshGenerator::CutCircularWound(double woundRadius)
+{
+    DeleteMesh();
+    unsigned num_nodes = GetNumNodes();
+    unsigned num_elements = GetNumElements();
+    double centre_x = 0.5*mWidth;
+    double centre_y = 0.5*mHeight;
+
+    // Mark the nodes of the removed cells, and count the uses of the nodes by the kept cells
+    std::vector<unsigned char> is_element_kept(num_elements, 1);
+    std::vector<unsigned char> is_node_of_removed_element(num_nodes, 0);
+    std::vector<unsigned char> is_node_kept(num_nodes, 0);
+    unsigned num_removed = 0;
+    for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+    {
+        unsigned start = mArrays.mElementOffsets[elem_index];
+        unsigned end = mArrays.mElementOffsets[elem_index + 1];
+        double twice_area = 0.0;
+        double weighted_x = 0.0;
+        double weighted_y = 0.0;
+        double first_x = mArrays.mX[mArrays.mElementNodes[start]];
+        double first_y = mArrays.mY[mArrays.mElementNodes[start]];
+        for (unsigned i=start; i<end; i++)
+        {
+            unsigned next = (i + 1 == end) ? start : i + 1;
+            double x0 = mArrays.mX[mArrays.mElementNodes[i]] - first_x;
+            double y0 = mArrays.mY[mArrays.mElementNodes[i]] - first_y;
+            double x1 = mArrays.mX[mArrays.mElementNodes[next]] - first_x;
+            double y1 = mArrays.mY[mArrays.mElementNodes[next]] - first_y;
+            double cross = x0*y1 - x1*y0;
+            twice_area += cross;
+            weighted_x += cross*(x0 + x1);
+            weighted_y += cross*(y0 + y1);
+        }
+        double centroid_x = first_x + (twice_area != 0.0 ? weighted_x/(3.0*twice_area) : 0.0);
+        double centroid_y = first_y + (twice_area != 0.0 ? weighted_y/(3.0*twice_area) : 0.0);
+        double squared_distance = (centroid_x - centre_x)*(centroid_x - centre_x) + (centroid_y - centre_y)*(centroid_y - centre_y);
+
+        is_element_kept[elem_index] = (squared_distance >= woundRadius*woundRadius) ? 1 : 0;
+        for (unsigned i=start; i<end; i++)
+        {
+            if (is_element_kept[elem_index])
+            {
+                is_node_kept[mArrays.mElementNodes[i]] = 1;
+            }
+            else
+            {
+                is_node_of_removed_element[mArrays.mElementNodes[i]] = 1;
+            }
+        }
+        num_removed += 1 - is_element_kept[elem_index];
+    }
+    if (num_removed == 0)
+    {
+        return 0;
+    }
+
+    // Renumber the kept nodes in order; those that lost a cell now border the wound
+    std::vector<uint32_t> new_node_indices(num_nodes, 0);
+    unsigned num_new_nodes = 0;
+    for (unsigned node_index=0; node_index<num_nodes; node_index++)
+    {
+        if (is_node_kept[node_index])
+        {
+            new_node_indices[node_index] = num_new_nodes;
+            mArrays.mX[num_new_nodes] = mArrays.mX[node_index];
+            mArrays.mY[num_new_nodes] = mArrays.mY[node_index];
+            mArrays.mIsBoundaryNode[num_new_nodes] = mArrays.mIsBoundaryNode[node_index] | is_node_of_removed_element[node_index];
+            num_new_nodes++;
+        }
+    }
+    mArrays.mX.resize(num_new_nodes);
+    mArrays.mY.resize(num_new_nodes);
+    mArrays.mIsBoundaryNode.resize(num_new_nodes);
+
+    unsigned num_new_elements = 0;
+    unsigned num_entries = 0;
+    for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+    {
+        if (!is_element_kept[elem_index])
+        {
+            continue;
+        }
+        unsigned start = mArrays.mElementOffsets[elem_index];
+        unsigned end = mArrays.mElementOffsets[elem_index + 1];
+        mArrays.mElementOffsets[num_new_elements] = num_entries;
+        for (unsigned i=start; i<end; i++)
+        {
+            mArrays.mElementNodes[num_entries++] = new_node_indices[mArrays.mElementNodes[i]];
+        }
+        num_new_elements++;
+    }
+    mArrays.mElementOffsets[num_new_elements] = num_entries;
+    mArrays.mElementOffsets.resize(num_new_elements + 1);
+    mArrays.mElementNodes.resize(num_entries);
+    if (!mArrays.mElementAttributes.empty())
+    {
+        unsigned num_kept = 0;
+        for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+        {
+            if (is_element_kept[elem_index])
+            {
+                mArrays.mElementAttributes[num_kept++] = mArrays.mElementAttributes[elem_index];
+            }
+        }
+        mArrays.mElementAttributes.resize(num_kept);
+    }
+
+    UpdatePeakMemory(GetCapacityBytes(is_element_kept) + GetCapacityBytes(is_node_of_removed_element)
+                     + GetCapacityBytes(is_node_kept) + GetCapacityBytes(new_node_indices));
+    return num_removed;
+}
+
+const VertexMeshBinaryArrays& LargeVertexMeshGenerator::rGetArrays() const
+{
+    return mArrays;
+}
+
+unsigned LargeVertexMeshGenerator::GetNumNodes() const
+{
+    return mArrays.mX.size();
+}
+
+unsigned LargeVertexMeshGenerator::GetNumElements() const
+{
+    return mArrays.mElementOffsets.size() - 1;
+}
+
+double LargeVertexMeshGenerator::GetWidth() const
+{
+    return mWidth;
+}
+
+double LargeVertexMeshGenerator::GetHeight() const
+{
+    return mHeight;
+}
+
+unsigned LargeVertexMeshGenerator::GetNumDegeneracyRepairs() const
+{
+    return mNumDegeneracyRepairs;
+}
+
+std::size_t LargeVertexMeshGenerator::GetPeakMemoryBytes() const
+{
+    return mPeakMemoryBytes;
+}
+
+std::size_t LargeVertexMeshGenerator::GetPeakResidentMemoryBytes()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#ifdef __APPLE__
+    // Bytes on macOS, kilobytes elsewhere
+    return usage.ru_maxrss;
+#else
+    return 1024*(std::size_t)usage.ru_maxrss;
+#endif
+}
+
+void LargeVertexMeshGenerator::WriteBinaryFile(const std::string& rPathToFile) const
+{
+    VertexMeshBinaryWriter::WriteArrays(rPathToFile, mArrays);
+}
+
+MutableVertexMesh<2,2>* LargeVertexMeshGenerator::GetMesh()
+{
+    if (mpMesh == nullptr)
+    {
+        unsigned num_nodes = GetNumNodes();
+        std::vector<Node<2>*> nodes(num_nodes);
+        for (unsigned node_index=0; node_index<num_nodes; node_index++)
+        {
+            nodes[node_index] = new Node<2>(node_index, mArrays.mIsBoundaryNode[node_index] != 0,
+                                            mArrays.mX[node_index], mArrays.mY[node_index]);
+        }
+
+        unsigned num_elements = GetNumElements();
+        std::vector<VertexElement<2,2>*> elements(num_elements);
+        std::vector<Node<2>*> element_nodes;
+        for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+        {
+            element_nodes.clear();
+            for (unsigned i=mArrays.mElementOffsets[elem_index]; i<mArrays.mElementOffsets[elem_index + 1]; i++)
+            {
+                element_nodes.push_back(nodes[mArrays.mElementNodes[i]]);
+            }
+            elements[elem_index] = new VertexElement<2,2>(elem_index, element_nodes);
+        }
+        mpMesh = new MutableVertexMesh<2,2>(nodes, elements);
+    }
+    return mpMesh;
+}
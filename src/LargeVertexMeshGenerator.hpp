@@ -0,0 +1,328 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef LARGEVERTEXMESHGENERATOR_HPP_
+#define LARGEVERTEXMESHGENERATOR_HPP_
+
+#include "MutableVertexMesh.hpp"
+#include "VertexMeshBinaryWriter.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Generates large vertex tissues, of 10^5 to 10^6 cells, for scaling studies. The tissue
+ * fills a rectangle of numElementsAcross by numElementsUp cells of a given mean area, and is
+ * built straight into the arrays of the binary vertex mesh format (see VertexMeshBinaryFormat.hpp),
+ * from which it can be written to a file or turned into a MutableVertexMesh.
+ *
+ * Two kinds of tissue can be generated:
+ *
+ *  - A Voronoi tessellation relaxed by Lloyd's algorithm, as made by VoronoiVertexMeshGenerator.
+ *    The seeds start with one at a random point of each cell of a square grid. Each Voronoi cell
+ *    is found on its own by clipping the rectangle with the bisectors of the nearby seeds, which
+ *    are looked up in a grid of bins with about one seed each, so each relaxation step takes time
+ *    linear in the number of cells and runs in parallel when the project is built with OpenMP.
+ *    The cells at the edge of the tissue are clipped to the rectangle.
+ *  - A honeycomb of regular hexagons, as made by HoneycombVertexMeshGenerator, whose nodes are
+ *    moved by random amounts.
+ *
+ * A circular wound can then be cut into the middle of the tissue, as WoundMeshUtilities does,
+ * without building the mesh first. All the work takes time and memory linear in the number of
+ * cells; GetPeakMemoryBytes() reports the most memory held by the generator at once.
+ *
+ * Random numbers come from RandomNumberGenerator, and are drawn in serial, so the tissue does
+ * not depend on the number of threads.
+ */
+class LargeVertexMeshGenerator
+{
+private:
+
+    /**
+     * A convex polygon being clipped. The edge from vertex k to vertex k+1 lies on the bisector
+     * between the seed of the cell and the seed mEdgeLabels[k], or on a side of the rectangle,
+     * whose labels are the number of seeds plus 0 to 3.
+     */
+    struct ClippedCell
+    {
+        /** The x coordinates of the vertices, counterclockwise. */
+        std::vector<double> mX;
+
+        /** The y coordinates of the vertices. */
+        std::vector<double> mY;
+
+        /** The label of the edge starting at each vertex. */
+        std::vector<unsigned> mEdgeLabels;
+
+        /** Scratch space for the x coordinates while clipping. */
+        std::vector<double> mNewX;
+
+        /** Scratch space for the y coordinates while clipping. */
+        std::vector<double> mNewY;
+
+        /** Scratch space for the edge labels while clipping. */
+        std::vector<unsigned> mNewEdgeLabels;
+    };
+
+    /**
+     * A vertex of a Voronoi cell, identified by the seeds (or sides of the rectangle) whose
+     * cells meet there, in increasing order.
+     */
+    struct VertexKey
+    {
+        /** The labels of the three cells or sides, in increasing order. */
+        unsigned mLabels[3];
+    };
+
+    /** The number of cells across the rectangle. */
+    unsigned mNumElementsAcross;
+
+    /** The number of cells up the rectangle. */
+    unsigned mNumElementsUp;
+
+    /** The mean area of the cells. */
+    double mElementTargetArea;
+
+    /** The width of the rectangle. */
+    double mWidth;
+
+    /** The height of the rectangle. */
+    double mHeight;
+
+    /** The number of threads used for the Voronoi cells. */
+    unsigned mNumThreads;
+
+    /** The generated tissue. */
+    VertexMeshBinaryArrays mArrays;
+
+    /** The mesh made from the tissue by GetMesh(), or null. */
+    MutableVertexMesh<2,2>* mpMesh;
+
+    /** The most memory held by the generator at once, in bytes. */
+    std::size_t mPeakMemoryBytes;
+
+    /** The number of times the seeds were nudged to resolve a degenerate Voronoi vertex. */
+    unsigned mNumDegeneracyRepairs;
+
+    /** The x coordinates of the Voronoi seeds. */
+    std::vector<double> mSeedX;
+
+    /** The y coordinates of the Voronoi seeds. */
+    std::vector<double> mSeedY;
+
+    /** The width of the (square) bins of the seeds. */
+    double mBinSize;
+
+    /** The number of columns of bins. */
+    unsigned mNumBinColumns;
+
+    /** The number of rows of bins. */
+    unsigned mNumBinRows;
+
+    /**
+     * The seeds in bin b are mBinSeeds[mBinStarts[b]] up to, but not including,
+     * mBinSeeds[mBinStarts[b+1]], where bins are numbered by row.
+     */
+    std::vector<unsigned> mBinStarts;
+
+    /** The indices of the seeds, grouped by bin. */
+    std::vector<unsigned> mBinSeeds;
+
+    /**
+     * Bin the seeds with a counting sort.
+     */
+    void BinSeeds();
+
+    /**
+     * Renumber the seeds in the order of their bins, so that neighbouring cells have nearby indices.
+     */
+    void SortSeedsByBin();
+
+    /**
+     * Find the Voronoi cell of a seed, clipped to the rectangle.
+     *
+     * @param seedIndex the index of the seed
+     * @param rCell filled with the cell
+     */
+    void ClipVoronoiCell(unsigned seedIndex, ClippedCell& rCell) const;
+
+    /**
+     * Clip a cell by the bisector between its seed and another seed, keeping the side nearer its seed.
+     *
+     * @param seedIndex the index of the seed of the cell
+     * @param otherIndex the index of the other seed
+     * @param rCell the cell
+     */
+    void ClipByBisector(unsigned seedIndex, unsigned otherIndex, ClippedCell& rCell) const;
+
+    /**
+     * Move each seed to the centroid of its Voronoi cell.
+     */
+    void RelaxSeeds();
+
+    /**
+     * Build the tissue from the Voronoi cells of the seeds. Each vertex is made a node by the
+     * lowest numbered cell meeting there, and the other cells look it up in that cell's list.
+     *
+     * @return the seeds of the cells that did not agree on their vertices, which happens when
+     *     four or more seeds lie almost on a circle; empty if the tissue was built
+     */
+    std::vector<unsigned> BuildVoronoiTissue();
+
+    /**
+     * Record the memory currently held by the generator, if it is the most so far.
+     *
+     * @param extraBytes memory held in local variables, in bytes
+     */
+    void UpdatePeakMemory(std::size_t extraBytes=0);
+
+    /**
+     * Delete the mesh made by GetMesh(), if any, as the tissue has changed.
+     */
+    void DeleteMesh();
+
+public:
+
+    /**
+     * Constructor. No tissue is generated until GenerateVoronoiTissue() or
+     * GenerateJitteredHoneycomb() is called.
+     *
+     * @param numElementsAcross the number of cells across the rectangle
+     * @param numElementsUp the number of cells up the rectangle
+     * @param elementTargetArea the mean area of the cells (defaults to 1.0)
+     */
+    LargeVertexMeshGenerator(unsigned numElementsAcross, unsigned numElementsUp, double elementTargetArea=1.0);
+
+    /**
+     * Destructor. Deletes the mesh made by GetMesh(), if any.
+     */
+    ~LargeVertexMeshGenerator();
+
+    /**
+     * Set the number of threads used for the Voronoi cells. This only has an effect if the
+     * project is built with OpenMP (see the WOUND_HEALING_USE_OPENMP option).
+     *
+     * @param numThreads the number of threads
+     */
+    void SetNumThreads(unsigned numThreads);
+
+    /**
+     * @return the number of threads used for the Voronoi cells
+     */
+    unsigned GetNumThreads() const;
+
+    /**
+     * Generate a Voronoi tissue relaxed by Lloyd's algorithm.
+     *
+     * @param numRelaxationSteps the number of Lloyd iterations
+     */
+    void GenerateVoronoiTissue(unsigned numRelaxationSteps);
+
+    /**
+     * Generate a honeycomb of regular hexagons, and move each node by a random amount in
+     * each direction of up to a fraction of the edge length.
+     *
+     * @param jitter the fraction of the edge length, from 0 (a regular honeycomb) to below 0.5
+     */
+    void GenerateJitteredHoneycomb(double jitter);
+
+    /**
+     * Cut a circular wound into the middle of the tissue, by removing the cells whose centroids
+     * lie within a given distance of the centre of the rectangle. The nodes that are left
+     * without a cell are removed, and the nodes around the wound become boundary nodes.
+     *
+     * @param woundRadius the radius of the wound
+     * @return the number of cells removed
+     */
+    unsigned CutCircularWound(double woundRadius);
+
+    /**
+     * @return the arrays of the tissue
+     */
+    const VertexMeshBinaryArrays& rGetArrays() const;
+
+    /**
+     * @return the number of nodes of the tissue
+     */
+    unsigned GetNumNodes() const;
+
+    /**
+     * @return the number of cells of the tissue
+     */
+    unsigned GetNumElements() const;
+
+    /**
+     * @return the width of the rectangle
+     */
+    double GetWidth() const;
+
+    /**
+     * @return the height of the rectangle
+     */
+    double GetHeight() const;
+
+    /**
+     * @return the number of times the seeds were nudged to resolve a degenerate Voronoi vertex
+     */
+    unsigned GetNumDegeneracyRepairs() const;
+
+    /**
+     * @return the most memory held by the generator at once, in bytes, not counting the mesh made by GetMesh()
+     */
+    std::size_t GetPeakMemoryBytes() const;
+
+    /**
+     * @return the peak resident memory of the whole process so far, in bytes
+     */
+    static std::size_t GetPeakResidentMemoryBytes();
+
+    /**
+     * Write the tissue as a binary vertex mesh file, which VertexMeshBinaryReader can read.
+     *
+     * @param rPathToFile the path to the file
+     */
+    void WriteBinaryFile(const std::string& rPathToFile) const;
+
+    /**
+     * Make a mesh from the tissue. The mesh is owned by the generator, as with the meshes of
+     * Chaste's mesh generators, and is deleted with it or when the tissue changes.
+     *
+     * @return the mesh
+     */
+    MutableVertexMesh<2,2>* GetMesh();
+};
+
+#endif /*LARGEVERTEXMESHGENERATOR_HPP_*/
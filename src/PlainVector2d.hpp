@@ -0,0 +1,136 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef PLAINVECTOR2D_HPP_
+#define PLAINVECTOR2D_HPP_
+
+#include <cmath>
+#include "UblasVectorInclude.hpp"
+
+/**
+ * A plain two-dimensional vector of doubles, for use in the inner loops of the
+ * wound healing forces. Unlike c_vector, this is a POD type with no expression
+ * templates, so the compiler can keep both components in registers.
+ */
+struct PlainVector2d
+{
+    /** The first component. */
+    double x;
+
+    /** The second component. */
+    double y;
+};
+
+/**
+ * @param rVector a c_vector of length two
+ * @return the same vector as a PlainVector2d
+ */
+inline PlainVector2d MakePlainVector2d(const c_vector<double, 2>& rVector)
+{
+    return PlainVector2d{rVector[0], rVector[1]};
+}
+
+/**
+ * @param vector a PlainVector2d
+ * @return the same vector as a c_vector
+ */
+inline c_vector<double, 2> MakeCVector(PlainVector2d vector)
+{
+    c_vector<double, 2> c_vector_copy;
+    c_vector_copy[0] = vector.x;
+    c_vector_copy[1] = vector.y;
+    return c_vector_copy;
+}
+
+/**
+ * @param a the first vector
+ * @param b the second vector
+ * @return a + b
+ */
+inline constexpr PlainVector2d operator+(PlainVector2d a, PlainVector2d b)
+{
+    return PlainVector2d{a.x + b.x, a.y + b.y};
+}
+
+/**
+ * @param a the first vector
+ * @param b the second vector
+ * @return a - b
+ */
+inline constexpr PlainVector2d operator-(PlainVector2d a, PlainVector2d b)
+{
+    return PlainVector2d{a.x - b.x, a.y - b.y};
+}
+
+/**
+ * @param scale a scalar
+ * @param a a vector
+ * @return scale*a
+ */
+inline constexpr PlainVector2d operator*(double scale, PlainVector2d a)
+{
+    return PlainVector2d{scale*a.x, scale*a.y};
+}
+
+/**
+ * @param a the first vector
+ * @param b the second vector
+ * @return the inner product of a and b
+ */
+inline constexpr double Dot(PlainVector2d a, PlainVector2d b)
+{
+    return a.x*b.x + a.y*b.y;
+}
+
+/**
+ * @param a the first vector
+ * @param b the second vector
+ * @return the z component of the cross product of a and b
+ */
+inline constexpr double Cross(PlainVector2d a, PlainVector2d b)
+{
+    return a.x*b.y - a.y*b.x;
+}
+
+/**
+ * @param a a vector
+ * @return the Euclidean norm of a
+ */
+inline double Norm(PlainVector2d a)
+{
+    return std::sqrt(Dot(a, a));
+}
+
+#endif /*PLAINVECTOR2D_HPP_*/
@@ -0,0 +1,286 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#include "SemiImplicitWoundTensionNumericalMethod.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "FarhadifarWoundHealingForce.hpp"
+#include "WoundHealingForce.hpp"
+#include "LinearSystem.hpp"
+#include "ReplicatableVector.hpp"
+#include "PetscTools.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <vector>
+
+template<unsigned DIM>
+SemiImplicitWoundTensionNumericalMethod<DIM>::SemiImplicitWoundTensionNumericalMethod()
+    : AbstractNumericalMethod<DIM, DIM>(),
+      mTreatCellEdgesImplicitly(false),
+      mRelativeTolerance(1e-10),
+      mNumIterationsOfLastSolve(0),
+      mNumImplicitEdgesOfLastStep(0)
+{
+}
+
+template<unsigned DIM>
+SemiImplicitWoundTensionNumericalMethod<DIM>::~SemiImplicitWoundTensionNumericalMethod()
+{
+}
+
+template<unsigned DIM>
+void SemiImplicitWoundTensionNumericalMethod<DIM>::UpdateAllNodePositions(double dt)
+{
+    VertexBasedCellPopulation<DIM>* p_population = dynamic_cast<VertexBasedCellPopulation<DIM>*>(this->mpCellPopulation);
+    if (p_population == nullptr)
+    {
+        EXCEPTION("SemiImplicitWoundTensionNumericalMethod is to be used with a VertexBasedCellPopulation only");
+    }
+    boost::shared_ptr<WoundHealingForce<DIM> > p_wound_force;
+    for (unsigned i=0; i<this->mpForceCollection->size(); i++)
+    {
+        boost::shared_ptr<WoundHealingForce<DIM> > p_this_force =
+                boost::dynamic_pointer_cast<WoundHealingForce<DIM> >((*this->mpForceCollection)[i]);
+        if (p_this_force)
+        {
+            p_wound_force = p_this_force;
+        }
+    }
+    if (!p_wound_force)
+    {
+        EXCEPTION("SemiImplicitWoundTensionNumericalMethod needs a WoundHealingForce in the simulation");
+    }
+    MutableVertexMesh<DIM, DIM>& r_mesh = p_population->rGetMesh();
+
+    // The forces divided by the damping constants are the node velocities; this also brings the wound loops up to date
+    std::vector<c_vector<double, DIM> > velocities = this->ComputeForcesIncludingDamping();
+
+    // Number the rows of the system in the order of the node iterator, like the velocities
+    std::vector<unsigned> row_of_node(r_mesh.GetNumAllNodes(), UINT_MAX);
+    std::vector<double> dampings;
+    for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        row_of_node[node_iter->GetIndex()] = dampings.size();
+        dampings.push_back(p_population->GetDampingConstant(node_iter->GetIndex()));
+    }
+    unsigned num_rows = dampings.size();
+
+    /*
+     * Collect the edges under tension, as the global indices of their two nodes and their tension.
+     * Edges under no tension or under compression are left out, which keeps the system positive definite.
+     */
+    std::vector<unsigned> edge_nodes;
+    std::vector<double> edge_tensions;
+    double wound_tension = p_wound_force->GetWoundTensionParameter();
+    const std::vector<std::vector<unsigned> >& r_wound_loops = p_wound_force->rGetWoundLoops();
+    for (unsigned loop_index=0; loop_index<r_wound_loops.size() && wound_tension > 0.0; loop_index++)
+    {
+        const std::vector<unsigned>& r_loop = r_wound_loops[loop_index];
+        for (unsigned i=0; i<r_loop.size(); i++)
+        {
+            edge_nodes.push_back(r_loop[i]);
+            edge_nodes.push_back(r_loop[(i+1)%r_loop.size()]);
+            edge_tensions.push_back(wound_tension);
+        }
+    }
+
+    boost::shared_ptr<FarhadifarWoundHealingForce<DIM> > p_farhadifar_force =
+            boost::dynamic_pointer_cast<FarhadifarWoundHealingForce<DIM> >(p_wound_force);
+    if (mTreatCellEdgesImplicitly && p_farhadifar_force)
+    {
+        double perimeter_contractility = p_farhadifar_force->GetPerimeterContractilityParameter();
+        double line_tension = p_farhadifar_force->GetLineTensionParameter();
+        double boundary_line_tension = p_farhadifar_force->GetBoundaryLineTensionParameter();
+        for (typename VertexMesh<DIM, DIM>::VertexElementIterator elem_iter = r_mesh.GetElementIteratorBegin();
+             elem_iter != r_mesh.GetElementIteratorEnd();
+             ++elem_iter)
+        {
+            double perimeter_coefficient = perimeter_contractility*r_mesh.GetSurfaceAreaOfElement(elem_iter->GetIndex());
+            unsigned num_nodes_elem = elem_iter->GetNumNodes();
+            for (unsigned local_index=0; local_index<num_nodes_elem; local_index++)
+            {
+                Node<DIM>* p_this_node = elem_iter->GetNode(local_index);
+                Node<DIM>* p_next_node = elem_iter->GetNode((local_index+1)%num_nodes_elem);
+
+                // As in FarhadifarWoundHealingForce, internal edges get half the line tension from each of their elements
+                const std::set<unsigned>& r_this_elem_indices = p_this_node->rGetContainingElementIndices();
+                const std::set<unsigned>& r_next_elem_indices = p_next_node->rGetContainingElementIndices();
+                unsigned num_shared_elements = 0;
+                for (std::set<unsigned>::const_iterator iter = r_next_elem_indices.begin();
+                     iter != r_next_elem_indices.end();
+                     ++iter)
+                {
+                    num_shared_elements += r_this_elem_indices.count(*iter);
+                }
+                double tension = perimeter_coefficient + (num_shared_elements == 1 ? boundary_line_tension : line_tension/2.0);
+                if (tension > 0.0)
+                {
+                    edge_nodes.push_back(p_this_node->GetIndex());
+                    edge_nodes.push_back(p_next_node->GetIndex());
+                    edge_tensions.push_back(tension);
+                }
+            }
+        }
+    }
+    mNumImplicitEdgesOfLastStep = edge_tensions.size();
+
+    // Each row has an entry for its own node and for each node it shares an edge with, in each dimension
+    std::vector<unsigned> num_edges_of_row(num_rows, 0);
+    for (unsigned i=0; i<edge_nodes.size(); i++)
+    {
+        num_edges_of_row[row_of_node[edge_nodes[i]]]++;
+    }
+    unsigned max_num_edges = num_rows > 0 ? *std::max_element(num_edges_of_row.begin(), num_edges_of_row.end()) : 0;
+
+    // Assemble (eta_i*I + dt*K) dx = dt*F
+    LinearSystem linear_system(DIM*num_rows, DIM*(max_num_edges + 1));
+    linear_system.SetMatrixIsSymmetric(true);
+    linear_system.SetKspType("cg");
+    linear_system.SetPcType("jacobi");
+    linear_system.SetRelativeTolerance(mRelativeTolerance);
+    for (unsigned row=0; row<num_rows; row++)
+    {
+        for (unsigned i=0; i<DIM; i++)
+        {
+            linear_system.AddToMatrixElement(DIM*row + i, DIM*row + i, dampings[row]);
+            linear_system.SetRhsVectorElement(DIM*row + i, dt*dampings[row]*velocities[row][i]);
+        }
+    }
+    for (unsigned edge=0; edge<edge_tensions.size(); edge++)
+    {
+        unsigned row_a = row_of_node[edge_nodes[2*edge]];
+        unsigned row_b = row_of_node[edge_nodes[2*edge+1]];
+        c_vector<double, DIM> edge_vector = r_mesh.GetVectorFromAtoB(r_mesh.GetNode(edge_nodes[2*edge])->rGetLocation(),
+                                                                     r_mesh.GetNode(edge_nodes[2*edge+1])->rGetLocation());
+        double edge_length = norm_2(edge_vector);
+        if (edge_length < DBL_EPSILON)
+        {
+            continue;
+        }
+        c_vector<double, DIM> unit_vector = edge_vector/edge_length;
+        double scale = dt*edge_tensions[edge]/edge_length;
+        for (unsigned i=0; i<DIM; i++)
+        {
+            for (unsigned j=0; j<DIM; j++)
+            {
+                double hessian_entry = scale*((i == j ? 1.0 : 0.0) - unit_vector[i]*unit_vector[j]);
+                linear_system.AddToMatrixElement(DIM*row_a + i, DIM*row_a + j, hessian_entry);
+                linear_system.AddToMatrixElement(DIM*row_b + i, DIM*row_b + j, hessian_entry);
+                linear_system.AddToMatrixElement(DIM*row_a + i, DIM*row_b + j, -hessian_entry);
+                linear_system.AddToMatrixElement(DIM*row_b + i, DIM*row_a + j, -hessian_entry);
+            }
+        }
+    }
+    linear_system.AssembleFinalLinearSystem();
+
+    Vec solution = linear_system.Solve();
+    ReplicatableVector displacements(solution);
+    PetscTools::Destroy(solution);
+    mNumIterationsOfLastSolve = linear_system.GetNumIterations();
+
+    // Move the nodes
+    unsigned row = 0;
+    for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter, ++row)
+    {
+        c_vector<double, DIM> new_location = node_iter->rGetLocation();
+        for (unsigned i=0; i<DIM; i++)
+        {
+            new_location[i] += displacements[DIM*row + i];
+        }
+        this->SafeNodePositionUpdate(node_iter->GetIndex(), new_location);
+    }
+}
+
+template<unsigned DIM>
+bool SemiImplicitWoundTensionNumericalMethod<DIM>::GetTreatCellEdgesImplicitly() const
+{
+    return mTreatCellEdgesImplicitly;
+}
+
+template<unsigned DIM>
+void SemiImplicitWoundTensionNumericalMethod<DIM>::SetTreatCellEdgesImplicitly(bool treatCellEdgesImplicitly)
+{
+    mTreatCellEdgesImplicitly = treatCellEdgesImplicitly;
+}
+
+template<unsigned DIM>
+double SemiImplicitWoundTensionNumericalMethod<DIM>::GetRelativeTolerance() const
+{
+    return mRelativeTolerance;
+}
+
+template<unsigned DIM>
+void SemiImplicitWoundTensionNumericalMethod<DIM>::SetRelativeTolerance(double relativeTolerance)
+{
+    assert(relativeTolerance > 0.0);
+    mRelativeTolerance = relativeTolerance;
+}
+
+template<unsigned DIM>
+unsigned SemiImplicitWoundTensionNumericalMethod<DIM>::GetNumIterationsOfLastSolve() const
+{
+    return mNumIterationsOfLastSolve;
+}
+
+template<unsigned DIM>
+unsigned SemiImplicitWoundTensionNumericalMethod<DIM>::GetNumImplicitEdgesOfLastStep() const
+{
+    return mNumImplicitEdgesOfLastStep;
+}
+
+template<unsigned DIM>
+void SemiImplicitWoundTensionNumericalMethod<DIM>::OutputNumericalMethodParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<TreatCellEdgesImplicitly>" << mTreatCellEdgesImplicitly << "</TreatCellEdgesImplicitly>\n";
+    *rParamsFile << "\t\t\t<RelativeTolerance>" << mRelativeTolerance << "</RelativeTolerance>\n";
+
+    // Call method on direct parent class
+    AbstractNumericalMethod<DIM, DIM>::OutputNumericalMethodParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class SemiImplicitWoundTensionNumericalMethod<2>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS1(SemiImplicitWoundTensionNumericalMethod, 2)
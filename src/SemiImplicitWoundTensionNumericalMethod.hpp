@@ -0,0 +1,171 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef SEMIIMPLICITWOUNDTENSIONNUMERICALMETHOD_HPP_
+#define SEMIIMPLICITWOUNDTENSIONNUMERICALMETHOD_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractNumericalMethod.hpp"
+
+/**
+ * A numerical method for vertex-based populations that treats the tension along edges
+ * semi-implicitly, so that short edges under tension do not limit the step size.
+ *
+ * An edge of length L under tension c has the energy c*L, whose Hessian with respect to
+ * either end is c*(I - u*u^T)/L, where u is the unit vector along the edge. This stiffness
+ * across the edge grows as the edge gets shorter, and makes forward Euler unstable for
+ * steps longer than about eta*L/c. Each step here solves the linearised backward Euler
+ * system
+ *
+ *     (eta_i*I + dt*K) dx = dt*F
+ *
+ * for the displacements dx, where F are the forces from all forces of the simulation at
+ * the start of the step, eta_i is the damping constant of node i and K is the sum of the
+ * edge Hessians, with the tensions frozen at the start of the step. The system is sparse,
+ * symmetric and positive definite, and is solved with the conjugate gradient method of
+ * PETSc through a LinearSystem.
+ *
+ * The edges under tension are always the wound edges of the WoundHealingForce of the
+ * simulation. If SetTreatCellEdgesImplicitly() is switched on and the force is a
+ * FarhadifarWoundHealingForce, the edges of the cells are added with their perimeter
+ * contractility and line tension; the area elasticity stays explicit. With small steps
+ * the method agrees with forward Euler to first order.
+ *
+ * The tension still pulls edges together at a finite speed, so steps must stay short
+ * enough for the mesh to catch edges that need a T1 swap before their nodes cross.
+ */
+template<unsigned DIM>
+class SemiImplicitWoundTensionNumericalMethod : public AbstractNumericalMethod<DIM, DIM>
+{
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractNumericalMethod<DIM, DIM> >(*this);
+        archive & mTreatCellEdgesImplicitly;
+        archive & mRelativeTolerance;
+    }
+
+    /** Whether the perimeter contractility and line tension along cell edges are treated implicitly. */
+    bool mTreatCellEdgesImplicitly;
+
+    /** The relative tolerance of the linear solver. */
+    double mRelativeTolerance;
+
+    /** The number of linear solver iterations at the last step. */
+    unsigned mNumIterationsOfLastSolve;
+
+    /** The number of edges that were treated implicitly at the last step. */
+    unsigned mNumImplicitEdgesOfLastStep;
+
+public:
+
+    /**
+     * Constructor.
+     */
+    SemiImplicitWoundTensionNumericalMethod();
+
+    /**
+     * Destructor.
+     */
+    virtual ~SemiImplicitWoundTensionNumericalMethod();
+
+    /**
+     * Overridden UpdateAllNodePositions() method. Moves the nodes by one semi-implicit step.
+     *
+     * @param dt the step size
+     */
+    virtual void UpdateAllNodePositions(double dt);
+
+    /**
+     * @return whether the perimeter contractility and line tension along cell edges are treated implicitly
+     */
+    bool GetTreatCellEdgesImplicitly() const;
+
+    /**
+     * Set whether the perimeter contractility and line tension along cell edges are treated
+     * implicitly, as well as the wound tension. Defaults to false.
+     *
+     * @param treatCellEdgesImplicitly whether to treat the cell edges implicitly
+     */
+    void SetTreatCellEdgesImplicitly(bool treatCellEdgesImplicitly);
+
+    /**
+     * @return the relative tolerance of the linear solver
+     */
+    double GetRelativeTolerance() const;
+
+    /**
+     * Set the relative tolerance of the linear solver. Defaults to 1e-10.
+     *
+     * @param relativeTolerance the tolerance
+     */
+    void SetRelativeTolerance(double relativeTolerance);
+
+    /**
+     * @return the number of linear solver iterations at the last step
+     */
+    unsigned GetNumIterationsOfLastSolve() const;
+
+    /**
+     * @return the number of edges that were treated implicitly at the last step, counting
+     * an edge once for each element or wound it is under tension from
+     */
+    unsigned GetNumImplicitEdgesOfLastStep() const;
+
+    /**
+     * Overridden OutputNumericalMethodParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputNumericalMethodParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS1(SemiImplicitWoundTensionNumericalMethod, 2)
+
+#endif /*SEMIIMPLICITWOUNDTENSIONNUMERICALMETHOD_HPP_*/
@@ -0,0 +1,146 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef VERTEXMESHBINARYFORMAT_HPP_
+#define VERTEXMESHBINARYFORMAT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The header of a binary vertex mesh file. These files hold a two-dimensional vertex mesh
+ * as flat arrays, in the byte order of the machine that wrote them:
+ *
+ *  - the header;
+ *  - the x coordinates of the nodes, then their y coordinates, as doubles;
+ *  - a byte for each node, which is 1 for boundary nodes and 0 otherwise;
+ *  - mNumElements+1 offsets into the element node list, as uint32_t, so that the nodes
+ *    of element i are entries offsets[i] to offsets[i+1]-1 of the list;
+ *  - the element node list, as uint32_t;
+ *  - the attributes of the elements, as doubles, if there are any.
+ *
+ * Each array starts at a multiple of 8 bytes, so the file can be memory mapped and its
+ * arrays used in place.
+ */
+struct VertexMeshBinaryHeader
+{
+    /** Identifies the file as a binary vertex mesh. */
+    char mMagic[8];
+
+    /** The version of the format. */
+    uint32_t mVersion;
+
+    /** The value 0x01020304, to detect files written on machines of a different byte order. */
+    uint32_t mByteOrderMark;
+
+    /** The number of nodes. */
+    uint32_t mNumNodes;
+
+    /** The number of elements. */
+    uint32_t mNumElements;
+
+    /** The number of attributes of each element, either 0 or 1. */
+    uint32_t mNumElementAttributes;
+
+    /** The total number of entries in the element node list. */
+    uint32_t mNumElementNodeEntries;
+};
+
+static_assert(sizeof(VertexMeshBinaryHeader) == 32, "The binary vertex mesh header must not be padded");
+
+/** The magic string at the start of a binary vertex mesh file. */
+const char VERTEX_MESH_BINARY_MAGIC[8] = {'V', 'X', 'M', 'E', 'S', 'H', '2', 'D'};
+
+/** The current version of the binary vertex mesh format. */
+const uint32_t VERTEX_MESH_BINARY_VERSION = 1;
+
+/** The byte order mark of a binary vertex mesh file. */
+const uint32_t VERTEX_MESH_BINARY_BYTE_ORDER_MARK = 0x01020304;
+
+/**
+ * The positions of the arrays in a binary vertex mesh file, in bytes from its start.
+ */
+struct VertexMeshBinaryLayout
+{
+    /** The start of the x coordinates. */
+    std::size_t mXOffset;
+
+    /** The start of the y coordinates. */
+    std::size_t mYOffset;
+
+    /** The start of the boundary flags. */
+    std::size_t mBoundaryOffset;
+
+    /** The start of the element offsets. */
+    std::size_t mElementOffsetsOffset;
+
+    /** The start of the element node list. */
+    std::size_t mElementNodesOffset;
+
+    /** The start of the element attributes. */
+    std::size_t mAttributesOffset;
+
+    /** The size of the whole file. */
+    std::size_t mFileSize;
+
+    /**
+     * Constructor.
+     *
+     * @param rHeader the header of the file
+     */
+    explicit VertexMeshBinaryLayout(const VertexMeshBinaryHeader& rHeader)
+    {
+        std::size_t num_nodes = rHeader.mNumNodes;
+        std::size_t num_elements = rHeader.mNumElements;
+        mXOffset = sizeof(VertexMeshBinaryHeader);
+        mYOffset = mXOffset + num_nodes*sizeof(double);
+        mBoundaryOffset = mYOffset + num_nodes*sizeof(double);
+        mElementOffsetsOffset = RoundUp(mBoundaryOffset + num_nodes);
+        mElementNodesOffset = RoundUp(mElementOffsetsOffset + (num_elements+1)*sizeof(uint32_t));
+        mAttributesOffset = RoundUp(mElementNodesOffset + rHeader.mNumElementNodeEntries*sizeof(uint32_t));
+        mFileSize = mAttributesOffset + rHeader.mNumElementAttributes*num_elements*sizeof(double);
+    }
+
+    /**
+     * @param offset a position in the file
+     * @return the position rounded up to a multiple of 8 bytes
+     */
+    static std::size_t RoundUp(std::size_t offset)
+    {
+        return (offset + 7) & ~static_cast<std::size_t>(7);
+    }
+};
+
+#endif /*VERTEXMESHBINARYFORMAT_HPP_*/
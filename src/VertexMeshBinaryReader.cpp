@@ -0,0 +1,195 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "VertexMeshBinaryReader.hpp"
+#include "Exception.hpp"
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+VertexMeshBinaryReader::VertexMeshBinaryReader(const std::string& rPathToFile)
+    : mPathToFile(rPathToFile),
+      mpData(nullptr),
+      mFileSize(0),
+      mNodesRead(0),
+      mElementsRead(0)
+{
+    int file_descriptor = open(rPathToFile.c_str(), O_RDONLY);
+    if (file_descriptor < 0)
+    {
+        EXCEPTION("Could not open the binary mesh file " + rPathToFile);
+    }
+    struct stat file_status;
+    if (fstat(file_descriptor, &file_status) != 0 || (std::size_t)file_status.st_size < sizeof(VertexMeshBinaryHeader))
+    {
+        close(file_descriptor);
+        EXCEPTION("The binary mesh file " + rPathToFile + " is too short to hold a header");
+    }
+    mFileSize = file_status.st_size;
+
+    void* p_mapping = mmap(nullptr, mFileSize, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    close(file_descriptor);
+    if (p_mapping == MAP_FAILED)
+    {
+        EXCEPTION("Could not map the binary mesh file " + rPathToFile + " into memory");
+    }
+    mpData = static_cast<const char*>(p_mapping);
+
+    // Check the header, unmapping the file again if it is not valid
+    memcpy(&mHeader, mpData, sizeof(VertexMeshBinaryHeader));
+    std::string error;
+    if (memcmp(mHeader.mMagic, VERTEX_MESH_BINARY_MAGIC, sizeof(VERTEX_MESH_BINARY_MAGIC)) != 0)
+    {
+        error = "The file " + rPathToFile + " is not a binary mesh file";
+    }
+    else if (mHeader.mByteOrderMark != VERTEX_MESH_BINARY_BYTE_ORDER_MARK)
+    {
+        error = "The binary mesh file " + rPathToFile + " was written on a machine with a different byte order";
+    }
+    else if (mHeader.mVersion != VERTEX_MESH_BINARY_VERSION)
+    {
+        error = "The binary mesh file " + rPathToFile + " has an unsupported version";
+    }
+    else if (mHeader.mNumElementAttributes > 1 || VertexMeshBinaryLayout(mHeader).mFileSize != mFileSize)
+    {
+        error = "The binary mesh file " + rPathToFile + " is corrupt";
+    }
+    if (!error.empty())
+    {
+        munmap(const_cast<char*>(mpData), mFileSize);
+        mpData = nullptr;
+        EXCEPTION(error);
+    }
+
+    VertexMeshBinaryLayout layout(mHeader);
+    mpX = reinterpret_cast<const double*>(mpData + layout.mXOffset);
+    mpY = reinterpret_cast<const double*>(mpData + layout.mYOffset);
+    mpIsBoundaryNode = reinterpret_cast<const unsigned char*>(mpData + layout.mBoundaryOffset);
+    mpElementOffsets = reinterpret_cast<const uint32_t*>(mpData + layout.mElementOffsetsOffset);
+    mpElementNodes = reinterpret_cast<const uint32_t*>(mpData + layout.mElementNodesOffset);
+    mpElementAttributes = reinterpret_cast<const double*>(mpData + layout.mAttributesOffset);
+
+    if (mpElementOffsets[0] != 0 || mpElementOffsets[mHeader.mNumElements] != mHeader.mNumElementNodeEntries)
+    {
+        munmap(const_cast<char*>(mpData), mFileSize);
+        mpData = nullptr;
+        EXCEPTION("The binary mesh file " + rPathToFile + " is corrupt");
+    }
+}
+
+VertexMeshBinaryReader::~VertexMeshBinaryReader()
+{
+    if (mpData != nullptr)
+    {
+        munmap(const_cast<char*>(mpData), mFileSize);
+    }
+}
+
+unsigned VertexMeshBinaryReader::GetNumElements() const
+{
+    return mHeader.mNumElements;
+}
+
+unsigned VertexMeshBinaryReader::GetNumNodes() const
+{
+    return mHeader.mNumNodes;
+}
+
+unsigned VertexMeshBinaryReader::GetNumFaces() const
+{
+    return 0;
+}
+
+unsigned VertexMeshBinaryReader::GetNumElementAttributes() const
+{
+    return mHeader.mNumElementAttributes;
+}
+
+std::vector<double> VertexMeshBinaryReader::GetNextNode()
+{
+    if (mNodesRead >= mHeader.mNumNodes)
+    {
+        EXCEPTION("All nodes have already been read");
+    }
+    std::vector<double> node_data(3);
+    node_data[0] = mpX[mNodesRead];
+    node_data[1] = mpY[mNodesRead];
+    node_data[2] = mpIsBoundaryNode[mNodesRead];
+    mNodesRead++;
+    return node_data;
+}
+
+void VertexMeshBinaryReader::Reset()
+{
+    mNodesRead = 0;
+    mElementsRead = 0;
+}
+
+ElementData VertexMeshBinaryReader::GetNextElementData()
+{
+    if (mElementsRead >= mHeader.mNumElements)
+    {
+        EXCEPTION("All elements have already been read");
+    }
+    uint32_t begin = mpElementOffsets[mElementsRead];
+    uint32_t end = mpElementOffsets[mElementsRead+1];
+    if (end < begin || end > mHeader.mNumElementNodeEntries)
+    {
+        EXCEPTION("The binary mesh file " + mPathToFile + " is corrupt");
+    }
+
+    ElementData element_data;
+    element_data.NodeIndices.assign(mpElementNodes + begin, mpElementNodes + end);
+    for (unsigned i=0; i<element_data.NodeIndices.size(); i++)
+    {
+        if (element_data.NodeIndices[i] >= mHeader.mNumNodes)
+        {
+            EXCEPTION("The binary mesh file " + mPathToFile + " is corrupt");
+        }
+    }
+    element_data.AttributeValue = (mHeader.mNumElementAttributes > 0) ? mpElementAttributes[mElementsRead] : 0.0;
+    element_data.ContainingElement = 0;
+    mElementsRead++;
+    return element_data;
+}
+
+ElementData VertexMeshBinaryReader::GetNextFaceData()
+{
+    EXCEPTION("A binary vertex mesh has no faces");
+}
@@ -0,0 +1,155 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef VERTEXMESHBINARYREADER_HPP_
+#define VERTEXMESHBINARYREADER_HPP_
+
+#include "AbstractMeshReader.hpp"
+#include "VertexMeshBinaryFormat.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * A mesh reader for two-dimensional vertex meshes in the binary format described in
+ * VertexMeshBinaryFormat.hpp, as written by VertexMeshBinaryWriter. The file is memory
+ * mapped, and nodes and elements are read straight from the mapped arrays, so there is
+ * no text to parse. Pass the reader to VertexMesh::ConstructFromMeshReader() to build a
+ * mesh, as with VertexMeshReader.
+ */
+class VertexMeshBinaryReader : public AbstractMeshReader<2, 2>
+{
+private:
+
+    /** The path to the file. */
+    std::string mPathToFile;
+
+    /** The start of the mapped file. */
+    const char* mpData;
+
+    /** The size of the mapped file. */
+    std::size_t mFileSize;
+
+    /** The header of the file. */
+    VertexMeshBinaryHeader mHeader;
+
+    /** The x coordinates of the nodes. */
+    const double* mpX;
+
+    /** The y coordinates of the nodes. */
+    const double* mpY;
+
+    /** The boundary flags of the nodes. */
+    const unsigned char* mpIsBoundaryNode;
+
+    /** The offsets of the elements into mpElementNodes. */
+    const uint32_t* mpElementOffsets;
+
+    /** The nodes of the elements. */
+    const uint32_t* mpElementNodes;
+
+    /** The attributes of the elements, if any. */
+    const double* mpElementAttributes;
+
+    /** The index of the next node to be returned by GetNextNode(). */
+    unsigned mNodesRead;
+
+    /** The index of the next element to be returned by GetNextElementData(). */
+    unsigned mElementsRead;
+
+    /** The mapping is owned by the reader, so it must not be copied. */
+    VertexMeshBinaryReader(const VertexMeshBinaryReader&) = delete;
+
+    /** The mapping is owned by the reader, so it must not be copied. */
+    VertexMeshBinaryReader& operator=(const VertexMeshBinaryReader&) = delete;
+
+public:
+
+    /**
+     * Constructor. Maps the file into memory and checks its header.
+     *
+     * @param rPathToFile the path to the binary mesh file
+     */
+    VertexMeshBinaryReader(const std::string& rPathToFile);
+
+    /**
+     * Destructor. Unmaps the file.
+     */
+    virtual ~VertexMeshBinaryReader();
+
+    /**
+     * @return the number of elements in the mesh
+     */
+    unsigned GetNumElements() const;
+
+    /**
+     * @return the number of nodes in the mesh
+     */
+    unsigned GetNumNodes() const;
+
+    /**
+     * @return the number of faces in the mesh, which is zero
+     */
+    unsigned GetNumFaces() const;
+
+    /**
+     * @return the number of attributes of each element
+     */
+    unsigned GetNumElementAttributes() const;
+
+    /**
+     * @return the location of the next node, followed by 1 if it is on the boundary and 0 otherwise
+     */
+    std::vector<double> GetNextNode();
+
+    /**
+     * Go back to the first node and element.
+     */
+    void Reset();
+
+    /**
+     * @return the node indices and attribute of the next element
+     */
+    ElementData GetNextElementData();
+
+    /**
+     * There are no faces in a two-dimensional vertex mesh, so this always throws.
+     *
+     * @return nothing
+     */
+    ElementData GetNextFaceData();
+};
+
+#endif /*VERTEXMESHBINARYREADER_HPP_*/
@@ -0,0 +1,183 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "VertexMeshBinaryWriter.hpp"
+#include "Exception.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace
+{
+    /**
+     * Copy an array into a buffer. Empty arrays are skipped, as an empty array may start at the
+     * end of the buffer, where it cannot be indexed, and its data pointer may be null.
+     *
+     * @param rBuffer the buffer
+     * @param offset the position of the array in the buffer
+     * @param pData the start of the array
+     * @param numBytes the size of the array
+     */
+    void CopyIntoBuffer(std::vector<char>& rBuffer, std::size_t offset, const void* pData, std::size_t numBytes)
+    {
+        if (numBytes > 0)
+        {
+            assert(offset + numBytes <= rBuffer.size());
+            memcpy(rBuffer.data() + offset, pData, numBytes);
+        }
+    }
+}
+
+void VertexMeshBinaryWriter::EncodeArrays(const VertexMeshBinaryArrays& rArrays, std::vector<char>& rBuffer)
+{
+    VertexMeshBinaryHeader header;
+    memcpy(header.mMagic, VERTEX_MESH_BINARY_MAGIC, sizeof(VERTEX_MESH_BINARY_MAGIC));
+    header.mVersion = VERTEX_MESH_BINARY_VERSION;
+    header.mByteOrderMark = VERTEX_MESH_BINARY_BYTE_ORDER_MARK;
+    header.mNumNodes = rArrays.mX.size();
+    header.mNumElements = rArrays.mElementOffsets.size() - 1;
+    header.mNumElementAttributes = rArrays.mElementAttributes.empty() ? 0 : 1;
+    header.mNumElementNodeEntries = rArrays.mElementNodes.size();
+    VertexMeshBinaryLayout layout(header);
+
+    // Each array is padded with zeros up to its offset in the layout
+    rBuffer.assign(layout.mFileSize, 0);
+    CopyIntoBuffer(rBuffer, 0, &header, sizeof(header));
+    CopyIntoBuffer(rBuffer, layout.mXOffset, rArrays.mX.data(), rArrays.mX.size()*sizeof(double));
+    CopyIntoBuffer(rBuffer, layout.mYOffset, rArrays.mY.data(), rArrays.mY.size()*sizeof(double));
+    CopyIntoBuffer(rBuffer, layout.mBoundaryOffset, rArrays.mIsBoundaryNode.data(), rArrays.mIsBoundaryNode.size());
+    CopyIntoBuffer(rBuffer, layout.mElementOffsetsOffset, rArrays.mElementOffsets.data(), rArrays.mElementOffsets.size()*sizeof(uint32_t));
+    CopyIntoBuffer(rBuffer, layout.mElementNodesOffset, rArrays.mElementNodes.data(), rArrays.mElementNodes.size()*sizeof(uint32_t));
+    CopyIntoBuffer(rBuffer, layout.mAttributesOffset, rArrays.mElementAttributes.data(), rArrays.mElementAttributes.size()*sizeof(double));
+}
+
+void VertexMeshBinaryWriter::WriteArrays(const std::string& rPathToFile, const VertexMeshBinaryArrays& rArrays)
+{
+    std::vector<char> buffer;
+    EncodeArrays(rArrays, buffer);
+
+    std::ofstream file(rPathToFile.c_str(), std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open the binary mesh file " + rPathToFile + " for writing");
+    }
+    file.write(buffer.data(), buffer.size());
+    file.close();
+    if (file.fail())
+    {
+        EXCEPTION("Could not write the binary mesh file " + rPathToFile);
+    }
+}
+
+void VertexMeshBinaryWriter::WriteFileUsingMeshReader(AbstractMeshReader<2, 2>& rMeshReader, const std::string& rPathToFile)
+{
+    unsigned num_nodes = rMeshReader.GetNumNodes();
+    unsigned num_elements = rMeshReader.GetNumElements();
+    rMeshReader.Reset();
+
+    VertexMeshBinaryArrays arrays;
+    arrays.mX.resize(num_nodes);
+    arrays.mY.resize(num_nodes);
+    arrays.mIsBoundaryNode.resize(num_nodes);
+    for (unsigned node_index=0; node_index<num_nodes; node_index++)
+    {
+        std::vector<double> node_data = rMeshReader.GetNextNode();
+        arrays.mX[node_index] = node_data[0];
+        arrays.mY[node_index] = node_data[1];
+        arrays.mIsBoundaryNode[node_index] = (node_data.size() > 2 && node_data[2] != 0.0) ? 1 : 0;
+    }
+
+    arrays.mElementOffsets.assign(1, 0);
+    arrays.mElementOffsets.reserve(num_elements+1);
+    for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+    {
+        ElementData element_data = rMeshReader.GetNextElementData();
+        arrays.mElementNodes.insert(arrays.mElementNodes.end(), element_data.NodeIndices.begin(), element_data.NodeIndices.end());
+        arrays.mElementOffsets.push_back(arrays.mElementNodes.size());
+        if (rMeshReader.GetNumElementAttributes() > 0)
+        {
+            arrays.mElementAttributes.push_back(element_data.AttributeValue);
+        }
+    }
+    rMeshReader.Reset();
+
+    WriteArrays(rPathToFile, arrays);
+}
+
+void VertexMeshBinaryWriter::WriteFileUsingMesh(VertexMesh<2, 2>& rMesh, const std::string& rPathToFile)
+{
+    VertexMeshBinaryArrays arrays;
+    CopyArraysOfMesh(rMesh, arrays);
+    WriteArrays(rPathToFile, arrays);
+}
+
+void VertexMeshBinaryWriter::CopyArraysOfMesh(VertexMesh<2, 2>& rMesh, VertexMeshBinaryArrays& rArrays)
+{
+    rArrays.mX.clear();
+    rArrays.mY.clear();
+    rArrays.mIsBoundaryNode.clear();
+    rArrays.mElementOffsets.assign(1, 0);
+    rArrays.mElementNodes.clear();
+    rArrays.mElementAttributes.clear();
+
+    // Number the nodes that are not deleted in order
+    std::vector<uint32_t> new_node_indices(rMesh.GetNumAllNodes(), std::numeric_limits<uint32_t>::max());
+    for (unsigned node_index=0; node_index<rMesh.GetNumAllNodes(); node_index++)
+    {
+        Node<2>* p_node = rMesh.GetNode(node_index);
+        if (!p_node->IsDeleted())
+        {
+            new_node_indices[node_index] = rArrays.mX.size();
+            rArrays.mX.push_back(p_node->rGetLocation()[0]);
+            rArrays.mY.push_back(p_node->rGetLocation()[1]);
+            rArrays.mIsBoundaryNode.push_back(p_node->IsBoundaryNode() ? 1 : 0);
+        }
+    }
+
+    for (unsigned elem_index=0; elem_index<rMesh.GetNumAllElements(); elem_index++)
+    {
+        VertexElement<2, 2>* p_element = rMesh.GetElement(elem_index);
+        if (!p_element->IsDeleted())
+        {
+            for (unsigned local_index=0; local_index<p_element->GetNumNodes(); local_index++)
+            {
+                rArrays.mElementNodes.push_back(new_node_indices[p_element->GetNodeGlobalIndex(local_index)]);
+            }
+            rArrays.mElementOffsets.push_back(rArrays.mElementNodes.size());
+        }
+    }
+}
@@ -0,0 +1,125 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef VERTEXMESHBINARYWRITER_HPP_
+#define VERTEXMESHBINARYWRITER_HPP_
+
+#include "AbstractMeshReader.hpp"
+#include "VertexMesh.hpp"
+#include "VertexMeshBinaryFormat.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * The arrays of a two-dimensional vertex mesh, as they are laid out in a binary vertex mesh file.
+ */
+struct VertexMeshBinaryArrays
+{
+    /** The x coordinates of the nodes. */
+    std::vector<double> mX;
+
+    /** The y coordinates of the nodes. */
+    std::vector<double> mY;
+
+    /** 1 for each boundary node and 0 for each other node. */
+    std::vector<unsigned char> mIsBoundaryNode;
+
+    /** The offsets of the elements into mElementNodes, starting with 0. */
+    std::vector<uint32_t> mElementOffsets;
+
+    /** The nodes of the elements. */
+    std::vector<uint32_t> mElementNodes;
+
+    /** The attributes of the elements, or an empty vector if they have none. */
+    std::vector<double> mElementAttributes;
+};
+
+/**
+ * Writes two-dimensional vertex meshes in the binary format described in
+ * VertexMeshBinaryFormat.hpp, to be read by VertexMeshBinaryReader. A mesh can be written
+ * from any mesh reader, such as VertexMeshReader for the .node and .cell text files or
+ * VirtualLeafMeshReader, or from a mesh in memory.
+ */
+class VertexMeshBinaryWriter
+{
+public:
+
+    /**
+     * Write the mesh read by a mesh reader.
+     *
+     * @param rMeshReader the mesh reader, which is reset before and after reading
+     * @param rPathToFile the path to the binary file
+     */
+    static void WriteFileUsingMeshReader(AbstractMeshReader<2, 2>& rMeshReader, const std::string& rPathToFile);
+
+    /**
+     * Write a mesh. Deleted nodes and elements are left out and the others renumbered
+     * in order, as ReMesh() would. Element attributes are not written.
+     *
+     * @param rMesh the mesh
+     * @param rPathToFile the path to the binary file
+     */
+    static void WriteFileUsingMesh(VertexMesh<2, 2>& rMesh, const std::string& rPathToFile);
+
+    /**
+     * Copy the arrays of a mesh, leaving out deleted nodes and elements as WriteFileUsingMesh()
+     * does. The vectors are overwritten but keep their capacity, so they can be reused for
+     * meshes of a similar size.
+     *
+     * @param rMesh the mesh
+     * @param rArrays filled with the arrays of the mesh
+     */
+    static void CopyArraysOfMesh(VertexMesh<2, 2>& rMesh, VertexMeshBinaryArrays& rArrays);
+
+    /**
+     * Lay out the arrays of a mesh in memory exactly as they would be in a binary mesh file.
+     *
+     * @param rArrays the arrays of the mesh
+     * @param rBuffer overwritten with the contents of the file
+     */
+    static void EncodeArrays(const VertexMeshBinaryArrays& rArrays, std::vector<char>& rBuffer);
+
+    /**
+     * Write the arrays of a mesh to a file, for meshes that are built as arrays rather than
+     * as a VertexMesh.
+     *
+     * @param rPathToFile the path to the file
+     * @param rArrays the arrays of the mesh
+     */
+    static void WriteArrays(const std::string& rPathToFile, const VertexMeshBinaryArrays& rArrays);
+};
+
+#endif /*VERTEXMESHBINARYWRITER_HPP_*/
@@ -0,0 +1,461 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "VirtualLeafMeshReader.hpp"
+#include "Exception.hpp"
+
+#include <cstdlib>
+#include <utility>
+
+namespace
+{
+    /**
+     * A tag read from an XML file.
+     */
+    struct XmlTag
+    {
+        /** The name of the element. */
+        std::string mName;
+
+        /** Whether this is an end tag, such as </cell>. */
+        bool mIsEndTag;
+
+        /** Whether this is an empty element tag, such as <node n="3"/>. */
+        bool mIsEmptyElement;
+
+        /** The names and values of the attributes of the element. */
+        std::vector<std::pair<std::string, std::string> > mAttributes;
+
+        /**
+         * @param rName the name of an attribute
+         * @return the value of the attribute, or nullptr if the element does not have it
+         */
+        const std::string* GetAttribute(const std::string& rName) const
+        {
+            for (unsigned i=0; i<mAttributes.size(); i++)
+            {
+                if (mAttributes[i].first == rName)
+                {
+                    return &(mAttributes[i].second);
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    /**
+     * Reads the tags of an XML file one after the other, skipping text, comments, CDATA
+     * sections, processing instructions and document type declarations. This is all that
+     * is needed for VirtualLeaf files, whose data is held in attributes.
+     */
+    class XmlTagReader
+    {
+    private:
+
+        /** The buffer of the stream being read. */
+        std::streambuf* mpBuffer;
+
+        /** The path to the file, for error messages. */
+        const std::string& mrPathToFile;
+
+        /**
+         * @return the next character of the file, throwing if there are none left
+         */
+        char GetChar()
+        {
+            std::streambuf::int_type c = mpBuffer->sbumpc();
+            if (c == std::streambuf::traits_type::eof())
+            {
+                EXCEPTION("The VirtualLeaf file " + mrPathToFile + " ends in the middle of a tag");
+            }
+            return std::streambuf::traits_type::to_char_type(c);
+        }
+
+        /**
+         * @param c a character
+         * @return whether it is XML white space
+         */
+        static bool IsSpace(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        /**
+         * Skip past the next occurrence of a string.
+         *
+         * @param rTerminator the string
+         */
+        void SkipPast(const std::string& rTerminator)
+        {
+            std::string window;
+            while (window != rTerminator)
+            {
+                window.push_back(GetChar());
+                if (window.size() > rTerminator.size())
+                {
+                    window.erase(0, 1);
+                }
+            }
+        }
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param rFile the open file
+         * @param rPathToFile the path to the file, for error messages
+         */
+        XmlTagReader(std::istream& rFile, const std::string& rPathToFile)
+            : mpBuffer(rFile.rdbuf()),
+              mrPathToFile(rPathToFile)
+        {
+        }
+
+        /**
+         * Read the next start, end or empty element tag.
+         *
+         * @param rTag the tag to fill in
+         * @return false if the end of the file was reached before another tag
+         */
+        bool ReadNextTag(XmlTag& rTag)
+        {
+            while (true)
+            {
+                // Skip text up to the next tag
+                std::streambuf::int_type next = mpBuffer->sbumpc();
+                while (next != std::streambuf::traits_type::eof() && next != '<')
+                {
+                    next = mpBuffer->sbumpc();
+                }
+                if (next == std::streambuf::traits_type::eof())
+                {
+                    return false;
+                }
+
+                char c = GetChar();
+                if (c == '?')
+                {
+                    SkipPast("?>");
+                    continue;
+                }
+                if (c == '!')
+                {
+                    c = GetChar();
+                    if (c == '-')
+                    {
+                        SkipPast("-->");
+                    }
+                    else if (c == '[')
+                    {
+                        SkipPast("]]>");
+                    }
+                    else
+                    {
+                        SkipPast(">");
+                    }
+                    continue;
+                }
+
+                rTag.mName.clear();
+                rTag.mAttributes.clear();
+                rTag.mIsEndTag = (c == '/');
+                rTag.mIsEmptyElement = false;
+                if (rTag.mIsEndTag)
+                {
+                    c = GetChar();
+                }
+                while (!IsSpace(c) && c != '/' && c != '>')
+                {
+                    rTag.mName.push_back(c);
+                    c = GetChar();
+                }
+
+                // Read the attributes
+                while (true)
+                {
+                    while (IsSpace(c))
+                    {
+                        c = GetChar();
+                    }
+                    if (c == '>')
+                    {
+                        return true;
+                    }
+                    if (c == '/')
+                    {
+                        if (GetChar() != '>')
+                        {
+                            EXCEPTION("Badly formed <" + rTag.mName + "> tag in the VirtualLeaf file " + mrPathToFile);
+                        }
+                        rTag.mIsEmptyElement = true;
+                        return true;
+                    }
+
+                    rTag.mAttributes.push_back(std::make_pair(std::string(), std::string()));
+                    std::string& r_name = rTag.mAttributes.back().first;
+                    std::string& r_value = rTag.mAttributes.back().second;
+                    while (!IsSpace(c) && c != '=')
+                    {
+                        r_name.push_back(c);
+                        c = GetChar();
+                    }
+                    while (IsSpace(c))
+                    {
+                        c = GetChar();
+                    }
+                    char quote = (c == '=') ? GetChar() : c;
+                    while (IsSpace(quote))
+                    {
+                        quote = GetChar();
+                    }
+                    if (c != '=' || (quote != '"' && quote != '\''))
+                    {
+                        EXCEPTION("Badly formed attribute " + r_name + " of <" + rTag.mName + "> in the VirtualLeaf file " + mrPathToFile);
+                    }
+                    for (c = GetChar(); c != quote; c = GetChar())
+                    {
+                        r_value.push_back(c);
+                    }
+                    c = GetChar();
+                }
+            }
+        }
+    };
+
+    /**
+     * @param rTag a tag
+     * @param rName the name of an attribute
+     * @param rPathToFile the path to the file, for error messages
+     * @return the value of the attribute, which must be present
+     */
+    const std::string& GetRequiredAttribute(const XmlTag& rTag, const std::string& rName, const std::string& rPathToFile)
+    {
+        const std::string* p_value = rTag.GetAttribute(rName);
+        if (p_value == nullptr)
+        {
+            EXCEPTION("A <" + rTag.mName + "> element in the VirtualLeaf file " + rPathToFile + " has no " + rName + " attribute");
+        }
+        return *p_value;
+    }
+
+    /**
+     * @param rValue the value of an attribute
+     * @param rPathToFile the path to the file, for error messages
+     * @return the value as a number
+     */
+    double ParseDouble(const std::string& rValue, const std::string& rPathToFile)
+    {
+        char* p_end;
+        double value = strtod(rValue.c_str(), &p_end);
+        if (rValue.empty() || *p_end != '\0')
+        {
+            EXCEPTION("Could not read the number " + rValue + " in the VirtualLeaf file " + rPathToFile);
+        }
+        return value;
+    }
+}
+
+VirtualLeafMeshReader::VirtualLeafMeshReader(const std::string& rPathToFile)
+    : mNodesRead(0),
+      mElementsRead(0)
+{
+    std::ifstream file(rPathToFile.c_str());
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open the VirtualLeaf file " + rPathToFile);
+    }
+    ReadLeaf(file, rPathToFile);
+}
+
+void VirtualLeafMeshReader::ReadLeaf(std::istream& rFile, const std::string& rPathToFile)
+{
+    // The nodes and cells exactly as in the file
+    std::vector<std::vector<double> > leaf_nodes;
+    std::vector<std::vector<unsigned> > leaf_cells;
+
+    // Read the file in one pass, keeping track of which elements we are inside
+    std::vector<std::string> open_elements;
+    XmlTagReader reader(rFile, rPathToFile);
+    XmlTag tag;
+    while (reader.ReadNextTag(tag))
+    {
+        if (tag.mIsEndTag)
+        {
+            if (open_elements.empty() || open_elements.back() != tag.mName)
+            {
+                EXCEPTION("Unexpected </" + tag.mName + "> in the VirtualLeaf file " + rPathToFile);
+            }
+            open_elements.pop_back();
+            continue;
+        }
+
+        const std::string parent = open_elements.empty() ? std::string() : open_elements.back();
+        if (tag.mName == "node" && parent == "nodes")
+        {
+            std::vector<double> node_data(3);
+            node_data[0] = ParseDouble(GetRequiredAttribute(tag, "x", rPathToFile), rPathToFile);
+            node_data[1] = ParseDouble(GetRequiredAttribute(tag, "y", rPathToFile), rPathToFile);
+            const std::string* p_boundary = tag.GetAttribute("boundary");
+            node_data[2] = (p_boundary != nullptr && *p_boundary == "true") ? 1.0 : 0.0;
+            leaf_nodes.push_back(node_data);
+        }
+        else if (tag.mName == "cell" && parent == "cells")
+        {
+            leaf_cells.push_back(std::vector<unsigned>());
+        }
+        else if (tag.mName == "node" && parent == "cell")
+        {
+            const std::string& r_index = GetRequiredAttribute(tag, "n", rPathToFile);
+            char* p_end;
+            unsigned long node_index = strtoul(r_index.c_str(), &p_end, 10);
+            if (r_index.empty() || *p_end != '\0')
+            {
+                EXCEPTION("Could not read the node index " + r_index + " in the VirtualLeaf file " + rPathToFile);
+            }
+            leaf_cells.back().push_back(node_index);
+        }
+
+        if (!tag.mIsEmptyElement)
+        {
+            open_elements.push_back(tag.mName);
+        }
+    }
+    if (!open_elements.empty())
+    {
+        EXCEPTION("The VirtualLeaf file " + rPathToFile + " ends before <" + open_elements.back() + "> is closed");
+    }
+
+    /*
+     * Count the cells that contain each node. A node that appears twice in the same cell is
+     * only counted once, which we check by remembering the last cell each node was counted for.
+     */
+    unsigned num_leaf_nodes = leaf_nodes.size();
+    std::vector<unsigned> num_containing_cells(num_leaf_nodes, 0);
+    std::vector<unsigned> last_containing_cell(num_leaf_nodes, UNSIGNED_UNSET);
+    for (unsigned cell_index=0; cell_index<leaf_cells.size(); cell_index++)
+    {
+        for (unsigned i=0; i<leaf_cells[cell_index].size(); i++)
+        {
+            unsigned node_index = leaf_cells[cell_index][i];
+            if (node_index >= num_leaf_nodes)
+            {
+                EXCEPTION("A cell in the VirtualLeaf file " + rPathToFile + " refers to a node that does not exist");
+            }
+            if (last_containing_cell[node_index] != cell_index)
+            {
+                last_containing_cell[node_index] = cell_index;
+                num_containing_cells[node_index]++;
+            }
+        }
+    }
+
+    // Keep the junctions and the boundary nodes, numbering them in the order of the file
+    std::vector<unsigned> new_node_indices(num_leaf_nodes, UNSIGNED_UNSET);
+    for (unsigned node_index=0; node_index<num_leaf_nodes; node_index++)
+    {
+        if (num_containing_cells[node_index] > 2 || leaf_nodes[node_index][2] == 1.0)
+        {
+            new_node_indices[node_index] = mNodeData.size();
+            mNodeData.push_back(leaf_nodes[node_index]);
+        }
+    }
+
+    mElementNodeIndices.resize(leaf_cells.size());
+    for (unsigned cell_index=0; cell_index<leaf_cells.size(); cell_index++)
+    {
+        for (unsigned i=0; i<leaf_cells[cell_index].size(); i++)
+        {
+            unsigned new_node_index = new_node_indices[leaf_cells[cell_index][i]];
+            if (new_node_index != UNSIGNED_UNSET)
+            {
+                mElementNodeIndices[cell_index].push_back(new_node_index);
+            }
+        }
+    }
+}
+
+unsigned VirtualLeafMeshReader::GetNumElements() const
+{
+    return mElementNodeIndices.size();
+}
+
+unsigned VirtualLeafMeshReader::GetNumNodes() const
+{
+    return mNodeData.size();
+}
+
+unsigned VirtualLeafMeshReader::GetNumFaces() const
+{
+    return 0;
+}
+
+unsigned VirtualLeafMeshReader::GetNumElementAttributes() const
+{
+    return 1;
+}
+
+std::vector<double> VirtualLeafMeshReader::GetNextNode()
+{
+    if (mNodesRead >= mNodeData.size())
+    {
+        EXCEPTION("All nodes have already been read");
+    }
+    return mNodeData[mNodesRead++];
+}
+
+void VirtualLeafMeshReader::Reset()
+{
+    mNodesRead = 0;
+    mElementsRead = 0;
+}
+
+ElementData VirtualLeafMeshReader::GetNextElementData()
+{
+    if (mElementsRead >= mElementNodeIndices.size())
+    {
+        EXCEPTION("All elements have already been read");
+    }
+    ElementData element_data;
+    element_data.NodeIndices = mElementNodeIndices[mElementsRead++];
+    element_data.AttributeValue = 0.0;
+    element_data.ContainingElement = 0;
+    return element_data;
+}
+
+ElementData VirtualLeafMeshReader::GetNextFaceData()
+{
+    EXCEPTION("A VirtualLeaf mesh has no faces");
+}
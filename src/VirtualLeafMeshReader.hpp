@@ -0,0 +1,135 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef VIRTUALLEAFMESHREADER_HPP_
+#define VIRTUALLEAFMESHREADER_HPP_
+
+#include "AbstractMeshReader.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * A mesh reader for the XML leaf files written by VirtualLeaf (Merks et al, Plant
+ * Physiol., 2011, 155, 656-666), for use with VertexMesh::ConstructFromMeshReader().
+ *
+ * VirtualLeaf cells have nodes along their walls as well as at their junctions. As in
+ * python/virtual_leave_to_chaste.py, only nodes on the boundary of the leaf or shared
+ * by more than two cells are kept, and the other nodes are dropped from the cells. Nodes
+ * are numbered in the order in which they appear in the file, leaving out dropped nodes.
+ *
+ * The file is parsed in a single streaming pass in the constructor, and the number of
+ * cells containing each node is then counted in a single pass over the cells, so reading
+ * a leaf takes time linear in the size of the file. No intermediate files are written.
+ */
+class VirtualLeafMeshReader : public AbstractMeshReader<2, 2>
+{
+private:
+
+    /** The locations of the kept nodes, with their boundary flags as a third entry. */
+    std::vector<std::vector<double> > mNodeData;
+
+    /** The kept nodes of each cell, in the order in which they appear in the cell. */
+    std::vector<std::vector<unsigned> > mElementNodeIndices;
+
+    /** The index of the next node to be returned by GetNextNode(). */
+    unsigned mNodesRead;
+
+    /** The index of the next element to be returned by GetNextElementData(). */
+    unsigned mElementsRead;
+
+    /**
+     * Read the leaf from a file.
+     *
+     * @param rFile the open file
+     * @param rPathToFile the path to the file, for error messages
+     */
+    void ReadLeaf(std::istream& rFile, const std::string& rPathToFile);
+
+public:
+
+    /**
+     * Constructor. Reads the whole leaf.
+     *
+     * @param rPathToFile the path to the VirtualLeaf XML file
+     */
+    VirtualLeafMeshReader(const std::string& rPathToFile);
+
+    /**
+     * @return the number of elements in the mesh
+     */
+    unsigned GetNumElements() const;
+
+    /**
+     * @return the number of nodes in the mesh
+     */
+    unsigned GetNumNodes() const;
+
+    /**
+     * @return the number of faces in the mesh, which is zero
+     */
+    unsigned GetNumFaces() const;
+
+    /**
+     * @return the number of attributes of each element. As in the files written by
+     * python/virtual_leave_to_chaste.py, each element has a single attribute of zero.
+     */
+    unsigned GetNumElementAttributes() const;
+
+    /**
+     * @return the location of the next node, followed by 1 if it is on the boundary and 0 otherwise
+     */
+    std::vector<double> GetNextNode();
+
+    /**
+     * Go back to the first node and element.
+     */
+    void Reset();
+
+    /**
+     * @return the node indices of the next element
+     */
+    ElementData GetNextElementData();
+
+    /**
+     * There are no faces in a VirtualLeaf mesh, so this always throws.
+     *
+     * @return nothing
+     */
+    ElementData GetNextFaceData();
+};
+
+#endif /*VIRTUALLEAFMESHREADER_HPP_*/
@@ -0,0 +1,300 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#include "WoundEnergyMinimiser.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+/** The number of downhill steps FIRE takes before it starts to speed up. */
+static const unsigned FIRE_NUM_STEPS_BEFORE_SPEEDING_UP = 5;
+
+/** The factor by which FIRE grows its step size after each downhill step. */
+static const double FIRE_TIMESTEP_GROWTH = 1.1;
+
+/** The factor by which FIRE shrinks its step size after an uphill step. */
+static const double FIRE_TIMESTEP_SHRINKAGE = 0.5;
+
+/** The weight of the force direction in the velocities at the start, and after each uphill step. */
+static const double FIRE_INITIAL_MIXING = 0.1;
+
+/** The factor by which the weight of the force direction shrinks after each downhill step. */
+static const double FIRE_MIXING_DECAY = 0.99;
+
+template<unsigned DIM>
+WoundEnergyMinimiser<DIM>::WoundEnergyMinimiser(VertexBasedCellPopulation<DIM>& rCellPopulation,
+                                                boost::shared_ptr<WoundHealingForce<DIM> > pForce)
+    : mrCellPopulation(rCellPopulation),
+      mpForce(pForce),
+      mForceTolerance(1e-6),
+      mMaxDisplacementFraction(0.5),
+      mInitialTimestep(0.01),
+      mMaximumTimestep(0.1),
+      mMaxNumIterations(100000),
+      mMaxForce(0.0),
+      mNumForceEvaluations(0),
+      mNumTopologyChanges(0)
+{
+}
+
+template<unsigned DIM>
+void WoundEnergyMinimiser<DIM>::ComputeForces()
+{
+    MutableVertexMesh<DIM, DIM>& r_mesh = mrCellPopulation.rGetMesh();
+    for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        node_iter->ClearAppliedForce();
+    }
+    mpForce->AddForceContribution(mrCellPopulation);
+    mNumForceEvaluations++;
+
+    mMaxForce = 0.0;
+    for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+         node_iter != r_mesh.GetNodeIteratorEnd();
+         ++node_iter)
+    {
+        mMaxForce = std::max(mMaxForce, norm_2(node_iter->rGetAppliedForce()));
+    }
+}
+
+template<unsigned DIM>
+std::vector<unsigned> WoundEnergyMinimiser<DIM>::GetTopology()
+{
+    MutableVertexMesh<DIM, DIM>& r_mesh = mrCellPopulation.rGetMesh();
+    std::vector<unsigned> topology;
+    topology.push_back(r_mesh.GetNumAllNodes());
+    for (typename VertexMesh<DIM, DIM>::VertexElementIterator elem_iter = r_mesh.GetElementIteratorBegin();
+         elem_iter != r_mesh.GetElementIteratorEnd();
+         ++elem_iter)
+    {
+        topology.push_back(elem_iter->GetIndex());
+        topology.push_back(elem_iter->GetNumNodes());
+        for (unsigned local_index=0; local_index<elem_iter->GetNumNodes(); local_index++)
+        {
+            topology.push_back(elem_iter->GetNodeGlobalIndex(local_index));
+        }
+    }
+    return topology;
+}
+
+template<unsigned DIM>
+bool WoundEnergyMinimiser<DIM>::Minimise()
+{
+    MutableVertexMesh<DIM, DIM>& r_mesh = mrCellPopulation.rGetMesh();
+    const double max_displacement = mMaxDisplacementFraction*r_mesh.GetCellRearrangementThreshold();
+    mNumForceEvaluations = 0;
+    mNumTopologyChanges = 0;
+
+    double dt = mInitialTimestep;
+    double mixing = FIRE_INITIAL_MIXING;
+    unsigned num_downhill_steps = 0;
+    mVelocities.assign(r_mesh.GetNumAllNodes(), zero_vector<double>(DIM));
+    ComputeForces();
+
+    for (unsigned iteration=0; iteration<mMaxNumIterations && mMaxForce >= mForceTolerance; iteration++)
+    {
+        // Turn the velocities towards the forces while going downhill, and stop as soon as going uphill
+        double power = 0.0;
+        double squared_speed = 0.0;
+        double squared_force = 0.0;
+        for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+             node_iter != r_mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            const c_vector<double, DIM>& r_force = node_iter->rGetAppliedForce();
+            const c_vector<double, DIM>& r_velocity = mVelocities[node_iter->GetIndex()];
+            power += inner_prod(r_force, r_velocity);
+            squared_speed += inner_prod(r_velocity, r_velocity);
+            squared_force += inner_prod(r_force, r_force);
+        }
+        if (power > 0.0)
+        {
+            double force_weight = mixing*sqrt(squared_speed/squared_force);
+            for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+                 node_iter != r_mesh.GetNodeIteratorEnd();
+                 ++node_iter)
+            {
+                c_vector<double, DIM>& r_velocity = mVelocities[node_iter->GetIndex()];
+                r_velocity = (1.0 - mixing)*r_velocity + force_weight*node_iter->rGetAppliedForce();
+            }
+            num_downhill_steps++;
+            if (num_downhill_steps > FIRE_NUM_STEPS_BEFORE_SPEEDING_UP)
+            {
+                dt = std::min(FIRE_TIMESTEP_GROWTH*dt, mMaximumTimestep);
+                mixing *= FIRE_MIXING_DECAY;
+            }
+        }
+        else
+        {
+            std::fill(mVelocities.begin(), mVelocities.end(), zero_vector<double>(DIM));
+            dt *= FIRE_TIMESTEP_SHRINKAGE;
+            mixing = FIRE_INITIAL_MIXING;
+            num_downhill_steps = 0;
+        }
+
+        // Accelerate, and slow all nodes down together if any of them would move too far
+        double max_speed = 0.0;
+        for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+             node_iter != r_mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            c_vector<double, DIM>& r_velocity = mVelocities[node_iter->GetIndex()];
+            r_velocity += dt*node_iter->rGetAppliedForce();
+            max_speed = std::max(max_speed, norm_2(r_velocity));
+        }
+        if (dt*max_speed > max_displacement)
+        {
+            double scale = max_displacement/(dt*max_speed);
+            for (unsigned node_index=0; node_index<mVelocities.size(); node_index++)
+            {
+                mVelocities[node_index] *= scale;
+            }
+        }
+        for (typename AbstractMesh<DIM, DIM>::NodeIterator node_iter = r_mesh.GetNodeIteratorBegin();
+             node_iter != r_mesh.GetNodeIteratorEnd();
+             ++node_iter)
+        {
+            ChastePoint<DIM> new_location(node_iter->rGetLocation() + dt*mVelocities[node_iter->GetIndex()]);
+            mrCellPopulation.SetNode(node_iter->GetIndex(), new_location);
+        }
+
+        // Carry out any swaps, as at the start of a time step, and start again from rest if there were any
+        std::vector<unsigned> old_topology = GetTopology();
+        mrCellPopulation.RemoveDeadCells();
+        mrCellPopulation.Update();
+        if (GetTopology() != old_topology)
+        {
+            mNumTopologyChanges++;
+            mVelocities.assign(r_mesh.GetNumAllNodes(), zero_vector<double>(DIM));
+            dt = mInitialTimestep;
+            mixing = FIRE_INITIAL_MIXING;
+            num_downhill_steps = 0;
+        }
+        ComputeForces();
+    }
+    return mMaxForce < mForceTolerance;
+}
+
+template<unsigned DIM>
+double WoundEnergyMinimiser<DIM>::GetEnergy()
+{
+    return mpForce->CalculateEnergy(mrCellPopulation);
+}
+
+template<unsigned DIM>
+double WoundEnergyMinimiser<DIM>::GetMaxForce() const
+{
+    return mMaxForce;
+}
+
+template<unsigned DIM>
+unsigned WoundEnergyMinimiser<DIM>::GetNumForceEvaluations() const
+{
+    return mNumForceEvaluations;
+}
+
+template<unsigned DIM>
+unsigned WoundEnergyMinimiser<DIM>::GetNumTopologyChanges() const
+{
+    return mNumTopologyChanges;
+}
+
+template<unsigned DIM>
+double WoundEnergyMinimiser<DIM>::GetForceTolerance() const
+{
+    return mForceTolerance;
+}
+
+template<unsigned DIM>
+void WoundEnergyMinimiser<DIM>::SetForceTolerance(double forceTolerance)
+{
+    assert(forceTolerance > 0.0);
+    mForceTolerance = forceTolerance;
+}
+
+template<unsigned DIM>
+double WoundEnergyMinimiser<DIM>::GetMaxDisplacementFraction() const
+{
+    return mMaxDisplacementFraction;
+}
+
+template<unsigned DIM>
+void WoundEnergyMinimiser<DIM>::SetMaxDisplacementFraction(double maxDisplacementFraction)
+{
+    assert(maxDisplacementFraction > 0.0);
+    mMaxDisplacementFraction = maxDisplacementFraction;
+}
+
+template<unsigned DIM>
+double WoundEnergyMinimiser<DIM>::GetInitialTimestep() const
+{
+    return mInitialTimestep;
+}
+
+template<unsigned DIM>
+double WoundEnergyMinimiser<DIM>::GetMaximumTimestep() const
+{
+    return mMaximumTimestep;
+}
+
+template<unsigned DIM>
+void WoundEnergyMinimiser<DIM>::SetTimesteps(double initialTimestep, double maximumTimestep)
+{
+    if (initialTimestep <= 0.0 || maximumTimestep < initialTimestep)
+    {
+        EXCEPTION("The initial step size must be positive, and no larger than the maximum step size");
+    }
+    mInitialTimestep = initialTimestep;
+    mMaximumTimestep = maximumTimestep;
+}
+
+template<unsigned DIM>
+unsigned WoundEnergyMinimiser<DIM>::GetMaxNumIterations() const
+{
+    return mMaxNumIterations;
+}
+
+template<unsigned DIM>
+void WoundEnergyMinimiser<DIM>::SetMaxNumIterations(unsigned maxNumIterations)
+{
+    mMaxNumIterations = maxNumIterations;
+}
+
+// Explicit instantiation
+template class WoundEnergyMinimiser<2>;
@@ -0,0 +1,206 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef WOUNDENERGYMINIMISER_HPP_
+#define WOUNDENERGYMINIMISER_HPP_
+
+#include "VertexBasedCellPopulation.hpp"
+#include "WoundHealingForce.hpp"
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+/**
+ * Finds the mechanical equilibrium of a wounded tissue directly, by minimising the energy
+ * of a WoundHealingForce (or FarhadifarWoundHealingForce) over the node locations, rather
+ * than following overdamped dynamics until they have come to rest.
+ *
+ * The minimisation uses FIRE (Bitzek et al., Phys. Rev. Lett. 97, 170201, 2006), which only
+ * needs the forces: the nodes move with inertia along the forces, and the velocities are
+ * turned towards the forces, and set to zero whenever they point uphill. No node moves by
+ * more than a fraction of the cell rearrangement threshold in an iteration. After each
+ * iteration the population is updated as at a time step of a simulation, so T1, T2 and T3
+ * swaps happen on the way to equilibrium, and the minimisation restarts from rest after
+ * each change of topology.
+ *
+ * The minimisation stops once the largest force on a node is below a tolerance, and the
+ * state it stops in is a local minimum of the energy for its topology.
+ */
+template<unsigned DIM>
+class WoundEnergyMinimiser
+{
+static_assert(DIM == 2, "WoundEnergyMinimiser is only defined for two-dimensional vertex populations");
+
+private:
+
+    /** The population whose nodes are moved. */
+    VertexBasedCellPopulation<DIM>& mrCellPopulation;
+
+    /** The force whose energy is minimised. */
+    boost::shared_ptr<WoundHealingForce<DIM> > mpForce;
+
+    /** The largest force on a node at a minimum. */
+    double mForceTolerance;
+
+    /** The largest node displacement in an iteration, as a fraction of the cell rearrangement threshold. */
+    double mMaxDisplacementFraction;
+
+    /** The step size of FIRE at the start and after each uphill step. */
+    double mInitialTimestep;
+
+    /** The largest step size of FIRE. */
+    double mMaximumTimestep;
+
+    /** The largest number of iterations of a minimisation. */
+    unsigned mMaxNumIterations;
+
+    /** The velocity of each node, indexed by node. */
+    std::vector<c_vector<double, DIM> > mVelocities;
+
+    /** The largest force on a node at the last evaluation. */
+    double mMaxForce;
+
+    /** The number of force evaluations in the last minimisation. */
+    unsigned mNumForceEvaluations;
+
+    /** The number of changes of topology in the last minimisation. */
+    unsigned mNumTopologyChanges;
+
+    /**
+     * Calculate the force on each node, and the largest of them.
+     */
+    void ComputeForces();
+
+    /**
+     * @return the nodes of each element, as a list that differs whenever the topology of the mesh does
+     */
+    std::vector<unsigned> GetTopology();
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rCellPopulation the population whose nodes are moved, with target areas if the force needs them
+     * @param pForce the force whose energy is minimised
+     */
+    WoundEnergyMinimiser(VertexBasedCellPopulation<DIM>& rCellPopulation,
+                         boost::shared_ptr<WoundHealingForce<DIM> > pForce);
+
+    /**
+     * Minimise the energy, moving the nodes of the population and changing its topology.
+     *
+     * @return whether the largest force on a node fell below the tolerance within the largest number of iterations
+     */
+    bool Minimise();
+
+    /**
+     * @return the energy of the population now
+     */
+    double GetEnergy();
+
+    /**
+     * @return the largest force on a node at the end of the last minimisation
+     */
+    double GetMaxForce() const;
+
+    /**
+     * @return the number of force evaluations in the last minimisation
+     */
+    unsigned GetNumForceEvaluations() const;
+
+    /**
+     * @return the number of changes of topology in the last minimisation
+     */
+    unsigned GetNumTopologyChanges() const;
+
+    /**
+     * @return the largest force on a node at a minimum
+     */
+    double GetForceTolerance() const;
+
+    /**
+     * Set the largest force on a node at a minimum. Defaults to 1e-6.
+     *
+     * @param forceTolerance the tolerance
+     */
+    void SetForceTolerance(double forceTolerance);
+
+    /**
+     * @return the largest node displacement in an iteration, as a fraction of the cell rearrangement threshold
+     */
+    double GetMaxDisplacementFraction() const;
+
+    /**
+     * Set the largest node displacement in an iteration. Defaults to 0.5, the limit that
+     * VertexBasedCellPopulation places on vertex movement.
+     *
+     * @param maxDisplacementFraction the largest displacement, as a fraction of the cell rearrangement threshold
+     */
+    void SetMaxDisplacementFraction(double maxDisplacementFraction);
+
+    /**
+     * @return the step size of FIRE at the start and after each uphill step
+     */
+    double GetInitialTimestep() const;
+
+    /**
+     * @return the largest step size of FIRE
+     */
+    double GetMaximumTimestep() const;
+
+    /**
+     * Set the step sizes of FIRE. Default to 0.01 and 0.1.
+     *
+     * @param initialTimestep the step size at the start and after each uphill step
+     * @param maximumTimestep the largest step size
+     */
+    void SetTimesteps(double initialTimestep, double maximumTimestep);
+
+    /**
+     * @return the largest number of iterations of a minimisation
+     */
+    unsigned GetMaxNumIterations() const;
+
+    /**
+     * Set the largest number of iterations of a minimisation. Defaults to 100000.
+     *
+     * @param maxNumIterations the number of iterations
+     */
+    void SetMaxNumIterations(unsigned maxNumIterations);
+};
+
+#endif /*WOUNDENERGYMINIMISER_HPP_*/
@@ -34,11 +34,22 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "WoundHealingForce.hpp"
+#include "Toroidal2dVertexMesh.hpp"
+#include "Cylindrical2dVertexMesh.hpp"
+
+#include <algorithm>
+#include <cmath>
 
 template<unsigned DIM>
 WoundHealingForce<DIM>::WoundHealingForce()
    : AbstractForce<DIM>(),
-     mWoundTensionParameter(0.12) // this parameter as such does not exist in Farhadifar's model.
+     mWoundTensionParameter(0.12), // this parameter as such does not exist in Farhadifar's model.
+     mWoundLoopsInitialised(false),
+     mMeanWoundEdgeLength(0.0),
+     mNumNodesAtLastUpdate(0),
+     mNumWoundBoundaryRebuilds(0),
+     mNumThreads(1),
+     mMeshIsPeriodic(false)
 {
 }
 
@@ -49,171 +60,586 @@ WoundHealingForce<DIM>::~WoundHealingForce()
 
 template<unsigned DIM>
 void WoundHealingForce<DIM>::AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation)
+{
+    WOUND_HEALING_TRACE_SCOPE("WoundHealingForce::AddForceContribution");
+    VertexBasedCellPopulation<DIM>* p_cell_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
+    WOUND_HEALING_COUNT(mTimings.AddCall());
+
+    // First, bring the wound boundaries from the last time step up to date
+    UpdateWoundBoundaries(*p_cell_population);
+
+    // Then, calculate the tension on each wound node. Each node is handled by a single iteration, so
+    // the result does not depend on the number of threads.
+    int num_wound_nodes = mWoundNodeTable.size();
+    mWoundNodeForces.resize(num_wound_nodes);
+    {
+        WOUND_HEALING_TIME_PHASE(mTimings, WOUND_TENSION);
+
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(mNumThreads) schedule(static)
+#endif
+        for (int table_index=0; table_index<num_wound_nodes; table_index++)
+        {
+            mWoundNodeForces[table_index] = CalculateWoundTensionOnNode(table_index, *p_cell_population);
+        }
+    }
+
+    // Then, add forces to each wound boundary in a for loop
+    WOUND_HEALING_TIME_PHASE(mTimings, FORCE_APPLICATION);
+    for (int table_index=0; table_index<num_wound_nodes; table_index++)
+    {
+        Node<DIM>* p_node = p_cell_population->GetNode(mWoundNodeTable[table_index].mNodeIndex);
+        p_node->AddAppliedForceContribution(MakeCVector(mWoundNodeForces[table_index]));
+    }
+}
+
+template<unsigned DIM>
+double WoundHealingForce<DIM>::CalculateEnergy(AbstractCellPopulation<DIM>& rCellPopulation)
 {
     VertexBasedCellPopulation<DIM>* p_cell_population = static_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation);
-    unsigned num_nodes = p_cell_population->GetNumNodes();
-    // First, find the first boundary node
-    unsigned first_boundary_node_start = 0;
-    for (unsigned node_index=0; node_index<num_nodes; node_index++)
-    {
-        Node<DIM>* p_this_node = p_cell_population->GetNode(node_index);
-        if ( p_this_node->IsBoundaryNode() )
-        {
-            first_boundary_node_start = node_index;
-            break;
-        }
-    }
-
-    // Then a while loop to collect the nodes along the boundary
-    std::vector<unsigned> first_boundary_nodes;
-    first_boundary_nodes.push_back(first_boundary_node_start);
-    bool boundary_incomplete = true;
-    unsigned current_boundary_node = first_boundary_node_start;
-    while (boundary_incomplete)
-    {
-        // find adjacent cells A and B
-        std::set<unsigned> containing_elem_indices = p_cell_population->
-                GetNode(current_boundary_node)->rGetContainingElementIndices();
-        for (std::set<unsigned>::iterator iter = containing_elem_indices.begin();
-             iter != containing_elem_indices.end();
-             ++iter)
-        {
-            // Get this element, its index and its number of nodes
-            VertexElement<DIM, DIM>* p_element = p_cell_population->GetElement(*iter);
-            unsigned number_of_nodes_in_this_element = p_element->GetNumNodes();
-
-            // Find the local index of this node in this element
-            unsigned local_index = p_element->GetNodeLocalIndex(current_boundary_node);
-            unsigned next_node_local_index = (local_index+1)%number_of_nodes_in_this_element;
-            Node<DIM>* p_next_node = p_element->GetNode(next_node_local_index);
-            unsigned next_node_index = p_next_node->GetIndex();
-            if (next_node_index == first_boundary_node_start)
+    UpdateWoundBoundaries(*p_cell_population);
+
+    double wound_perimeter = 0.0;
+    for (unsigned loop_index=0; loop_index<mWoundLoops.size(); loop_index++)
+    {
+        const std::vector<unsigned>& r_loop = mWoundLoops[loop_index];
+        for (unsigned i=0; i<r_loop.size(); i++)
+        {
+            wound_perimeter += Norm(GetVectorBetweenNodes(p_cell_population->GetNode(r_loop[i]),
+                                                          p_cell_population->GetNode(r_loop[(i+1)%r_loop.size()]),
+                                                          *p_cell_population));
+        }
+    }
+    return mWoundTensionParameter*wound_perimeter;
+}
+
+template<unsigned DIM>
+PlainVector2d WoundHealingForce<DIM>::CalculateWoundTensionOnNode(unsigned tableIndex, VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    const WoundNodeNeighbours& r_entry = mWoundNodeTable[tableIndex];
+    Node<DIM>* p_this_node = rCellPopulation.GetNode(r_entry.mNodeIndex);
+    Node<DIM>* p_previous_node = rCellPopulation.GetNode(r_entry.mPreviousNodeIndex);
+    Node<DIM>* p_next_node = rCellPopulation.GetNode(r_entry.mNextNodeIndex);
+
+    // The gradient of the length of an edge at this node is the unit vector pointing along the edge towards it
+    PlainVector2d previous_edge = GetVectorBetweenNodes(p_previous_node, p_this_node, rCellPopulation);
+    PlainVector2d next_edge = GetVectorBetweenNodes(p_next_node, p_this_node, rCellPopulation);
+
+    return (-mWoundTensionParameter/Norm(previous_edge))*previous_edge
+           - (mWoundTensionParameter/Norm(next_edge))*next_edge;
+}
+
+template<unsigned DIM>
+PlainVector2d WoundHealingForce<DIM>::GetVectorBetweenNodes(Node<DIM>* pNodeA, Node<DIM>* pNodeB, VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    if (mMeshIsPeriodic)
+    {
+        return MakePlainVector2d(rCellPopulation.rGetMesh().GetVectorFromAtoB(pNodeA->rGetLocation(), pNodeB->rGetLocation()));
+    }
+    return MakePlainVector2d(pNodeB->rGetLocation()) - MakePlainVector2d(pNodeA->rGetLocation());
+}
+
+template<unsigned DIM>
+unsigned WoundHealingForce<DIM>::GetNextBoundaryNodeIndex(unsigned nodeIndex, VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    const std::set<unsigned>& r_containing_elem_indices = rCellPopulation.GetNode(nodeIndex)->rGetContainingElementIndices();
+    for (std::set<unsigned>::const_iterator iter = r_containing_elem_indices.begin();
+         iter != r_containing_elem_indices.end();
+         ++iter)
+    {
+        // Get this element, its index and its number of nodes
+        VertexElement<DIM, DIM>* p_element = rCellPopulation.GetElement(*iter);
+        unsigned number_of_nodes_in_this_element = p_element->GetNumNodes();
+
+        // Find the local index of this node in this element
+        unsigned local_index = p_element->GetNodeLocalIndex(nodeIndex);
+        unsigned next_node_local_index = (local_index+1)%number_of_nodes_in_this_element;
+        Node<DIM>* p_next_node = p_element->GetNode(next_node_local_index);
+
+        if (p_next_node->IsBoundaryNode())
+        {
+            // Two boundary nodes may also be joined by an internal edge, so check that no other element shares this edge
+            const std::set<unsigned>& r_next_elem_indices = p_next_node->rGetContainingElementIndices();
+            unsigned num_shared_elements = 0;
+            for (std::set<unsigned>::const_iterator next_iter = r_next_elem_indices.begin();
+                 next_iter != r_next_elem_indices.end();
+                 ++next_iter)
             {
-                boundary_incomplete = false;
-                break;
+                num_shared_elements += r_containing_elem_indices.count(*next_iter);
             }
-            else if (p_next_node->IsBoundaryNode())
+            if (num_shared_elements == 1)
             {
-                first_boundary_nodes.push_back( p_next_node->GetIndex() );
-                current_boundary_node = p_next_node->GetIndex();
-                break;
+                return p_next_node->GetIndex();
+            }
+        }
+    }
+    return UNSIGNED_UNSET;
+}
+
+template<unsigned DIM>
+bool WoundHealingForce<DIM>::TraceBoundaryLoop(unsigned startNodeIndex,
+                                               VertexBasedCellPopulation<DIM>& rCellPopulation,
+                                               std::vector<unsigned>& rLoop,
+                                               unsigned maxLength)
+{
+    WOUND_HEALING_TIME_PHASE(mTimings, LOOP_WALK);
+    rLoop.clear();
+    rLoop.push_back(startNodeIndex);
+    unsigned current_boundary_node = startNodeIndex;
+    while (rLoop.size() <= maxLength)
+    {
+        unsigned next_node_index = GetNextBoundaryNodeIndex(current_boundary_node, rCellPopulation);
+        if (next_node_index == startNodeIndex)
+        {
+            WOUND_HEALING_COUNT(mTimings.AddLoopWalk(rLoop.size()));
+            return true;
+        }
+        else if (next_node_index == UNSIGNED_UNSET)
+        {
+            WOUND_HEALING_COUNT(mTimings.AddLoopWalk(rLoop.size()));
+            return false;
+        }
+        rLoop.push_back(next_node_index);
+        current_boundary_node = next_node_index;
+    }
+    WOUND_HEALING_COUNT(mTimings.AddLoopWalk(rLoop.size()));
+    return false;
+}
+
+template<unsigned DIM>
+double WoundHealingForce<DIM>::GetSignedAreaOfLoop(const std::vector<unsigned>& rLoop, VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    // Use vectors relative to the first node, so that this also works on periodic meshes
+    const c_vector<double, DIM>& r_first_location = rCellPopulation.GetNode(rLoop[0])->rGetLocation();
+    double twice_area = 0.0;
+    c_vector<double, DIM> this_vector = zero_vector<double>(DIM);
+    for (unsigned i=1; i<rLoop.size(); i++)
+    {
+        c_vector<double, DIM> next_vector = rCellPopulation.rGetMesh().GetVectorFromAtoB(r_first_location,
+                rCellPopulation.GetNode(rLoop[i])->rGetLocation());
+        twice_area += this_vector[0]*next_vector[1] - this_vector[1]*next_vector[0];
+        this_vector = next_vector;
+    }
+    return 0.5*twice_area;
+}
+
+template<unsigned DIM>
+bool WoundHealingForce<DIM>::DoesLoopWrapAroundDomain(const std::vector<unsigned>& rLoop, VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    if (!mMeshIsPeriodic || rLoop.empty())
+    {
+        return false;
+    }
+
+    // The shortest vectors along the edges of a loop that encloses a hole add up to zero
+    PlainVector2d displacement{0.0, 0.0};
+    double perimeter = 0.0;
+    for (unsigned i=0; i<rLoop.size(); i++)
+    {
+        PlainVector2d edge = GetVectorBetweenNodes(rCellPopulation.GetNode(rLoop[i]),
+                                                   rCellPopulation.GetNode(rLoop[(i+1)%rLoop.size()]),
+                                                   rCellPopulation);
+        displacement = displacement + edge;
+        perimeter += Norm(edge);
+    }
+    return Norm(displacement) > 1e-6*perimeter;
+}
+
+template<unsigned DIM>
+bool WoundHealingForce<DIM>::IsWoundLoop(const std::vector<unsigned>& rLoop, VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    return rLoop.size() > 2
+           && !DoesLoopWrapAroundDomain(rLoop, rCellPopulation)
+           && GetSignedAreaOfLoop(rLoop, rCellPopulation) < 0.0;
+}
+
+template<unsigned DIM>
+bool WoundHealingForce<DIM>::IsPointInsideLoop(const c_vector<double, DIM>& rPoint,
+                                               const std::vector<unsigned>& rLoop,
+                                               VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    // Sum the angles subtended by the edges of the loop; this is +-2pi inside and 0 outside
+    double total_angle = 0.0;
+    c_vector<double, DIM> this_vector = rCellPopulation.rGetMesh().GetVectorFromAtoB(rPoint,
+            rCellPopulation.GetNode(rLoop.back())->rGetLocation());
+    for (unsigned i=0; i<rLoop.size(); i++)
+    {
+        c_vector<double, DIM> next_vector = rCellPopulation.rGetMesh().GetVectorFromAtoB(rPoint,
+                rCellPopulation.GetNode(rLoop[i])->rGetLocation());
+        total_angle += atan2(this_vector[0]*next_vector[1] - this_vector[1]*next_vector[0],
+                             this_vector[0]*next_vector[0] + this_vector[1]*next_vector[1]);
+        this_vector = next_vector;
+    }
+    return fabs(total_angle) > M_PI;
+}
+
+template<unsigned DIM>
+void WoundHealingForce<DIM>::LabelBoundaryLoops(VertexBasedCellPopulation<DIM>& rCellPopulation,
+                                                std::vector<std::vector<unsigned> >& rLoops)
+{
+    unsigned num_nodes = rCellPopulation.rGetMesh().GetNumAllNodes();
+    mNodeVisited.resize(num_nodes, false);
+    rLoops.clear();
+
+    /*
+     * First, find the boundary nodes. Each partition of the nodes collects its own boundary
+     * nodes, and the lists are joined in partition order, so the result is the same for any
+     * number of threads.
+     */
+    int num_partitions = mNumThreads;
+    mPartitionBoundaryNodes.resize(num_partitions);
+    {
+        WOUND_HEALING_TIME_PHASE(mTimings, BOUNDARY_SEARCH);
+        WOUND_HEALING_COUNT(mTimings.AddNodesScanned(num_nodes));
+
+#ifdef _OPENMP
+        #pragma omp parallel for num_threads(mNumThreads) schedule(static)
+#endif
+        for (int partition=0; partition<num_partitions; partition++)
+        {
+            std::vector<unsigned>& r_partition_nodes = mPartitionBoundaryNodes[partition];
+            r_partition_nodes.clear();
+            unsigned start_index = (num_nodes*(unsigned long)partition)/num_partitions;
+            unsigned end_index = (num_nodes*(unsigned long)(partition+1))/num_partitions;
+            for (unsigned node_index=start_index; node_index<end_index; node_index++)
+            {
+                Node<DIM>* p_this_node = rCellPopulation.GetNode(node_index);
+                if ( !p_this_node->IsDeleted() && p_this_node->IsBoundaryNode() )
+                {
+                    r_partition_nodes.push_back(node_index);
+                }
             }
-        } // element for loop
-    }// while loop
+        }
+    }
 
-    // find a node on the next boundary
-    unsigned second_boundary_node_start = 0;
-    for (unsigned node_index=0; node_index<num_nodes; node_index++)
+    /*
+     * Then start a new walk at every boundary node that no earlier walk has passed through.
+     * A walk that does not return to its start, such as one through a vertex where two
+     * loops touch, is not a loop; its nodes are still marked, so they are not walked again.
+     */
+    for (int partition=0; partition<num_partitions; partition++)
     {
-        Node<DIM>* p_this_node = p_cell_population->GetNode(node_index);
-        if ( p_this_node->IsBoundaryNode() )
+        for (unsigned boundary_index=0; boundary_index<mPartitionBoundaryNodes[partition].size(); boundary_index++)
         {
-            if(std::find(first_boundary_nodes.begin(),
-                    first_boundary_nodes.end(), node_index) == first_boundary_nodes.end())
+            unsigned node_index = mPartitionBoundaryNodes[partition][boundary_index];
+            if ( !mNodeVisited[node_index] )
             {
-                second_boundary_node_start = node_index;
-                break;
+                bool is_closed = TraceBoundaryLoop(node_index, rCellPopulation, mScratchLoop, num_nodes);
+                for (unsigned i=0; i<mScratchLoop.size(); i++)
+                {
+                    mNodeVisited[mScratchLoop[i]] = true;
+                }
+                if (is_closed)
+                {
+                    rLoops.push_back(mScratchLoop);
+                }
+            }
+        }
+    }
+
+    // Reset the flags we have set, which are all on boundary nodes
+    for (int partition=0; partition<num_partitions; partition++)
+    {
+        for (unsigned boundary_index=0; boundary_index<mPartitionBoundaryNodes[partition].size(); boundary_index++)
+        {
+            mNodeVisited[mPartitionBoundaryNodes[partition][boundary_index]] = false;
+        }
+    }
+}
+
+template<unsigned DIM>
+bool WoundHealingForce<DIM>::HaveNodesBeenRenumbered(VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    MutableVertexMesh<DIM, DIM>& r_mesh = rCellPopulation.rGetMesh();
+    if (r_mesh.GetNumAllNodes() != mNumNodesAtLastUpdate)
+    {
+        return true;
+    }
+
+    /*
+     * A ReMesh() that adds as many nodes as it removes leaves the number of nodes unchanged,
+     * but still shifts the indices of the nodes after each removed one. Every node of the
+     * cached rings must therefore still be near where it was at the last update. Nodes only
+     * move a small part of an edge in a time step, and a T1 swap moves them by less than the
+     * length of the short edge it removes.
+     */
+    double tolerance = 0.5*mMeanWoundEdgeLength;
+    for (unsigned wound_index=0; wound_index<mWoundLoops.size(); wound_index++)
+    {
+        const std::vector<unsigned>& r_wound_loop = mWoundLoops[wound_index];
+        WOUND_HEALING_COUNT(mTimings.AddNodesScanned(r_wound_loop.size()));
+        for (unsigned i=0; i<r_wound_loop.size(); i++)
+        {
+            Node<DIM>* p_node = r_mesh.GetNode(r_wound_loop[i]);
+            if (p_node->IsDeleted() ||
+                norm_2(r_mesh.GetVectorFromAtoB(mWoundLoopLocations[wound_index][i], p_node->rGetLocation())) >= tolerance)
+            {
+                return true;
             }
         }
     }
+    return false;
+}
+
+template<unsigned DIM>
+unsigned WoundHealingForce<DIM>::FindWoundBoundarySeed(unsigned woundIndex, VertexBasedCellPopulation<DIM>& rCellPopulation, bool nodesRenumbered)
+{
+    WOUND_HEALING_TIME_PHASE(mTimings, BOUNDARY_SEARCH);
+    MutableVertexMesh<DIM, DIM>& r_mesh = rCellPopulation.rGetMesh();
+    unsigned num_nodes = r_mesh.GetNumAllNodes();
+    const std::vector<unsigned>& r_wound_loop = mWoundLoops[woundIndex];
 
-    // Then a while loop to collect the nodes along the boundary
-    std::vector<unsigned> second_boundary_nodes;
-    boundary_incomplete = true;
-    second_boundary_nodes.push_back(second_boundary_node_start);
-    current_boundary_node = second_boundary_node_start;
-    while (boundary_incomplete)
+    if (!nodesRenumbered)
     {
-        // find adjacent cells A and B
-        std::set<unsigned> containing_elem_indices = p_cell_population->
-                GetNode(current_boundary_node)->rGetContainingElementIndices();
-        for (std::set<unsigned>::iterator iter = containing_elem_indices.begin();
-             iter != containing_elem_indices.end();
-             ++iter)
+        // Indices are unchanged, so any node of the old ring that is still on the boundary will do
+        for (unsigned i=0; i<r_wound_loop.size(); i++)
         {
-            // Get this element, its index and its number of nodes
-            VertexElement<DIM, DIM>* p_element = p_cell_population->GetElement(*iter);
-            unsigned number_of_nodes_in_this_element = p_element->GetNumNodes();
+            unsigned node_index = r_wound_loop[i];
+            WOUND_HEALING_COUNT(mTimings.AddNodesScanned(1));
+            Node<DIM>* p_node = r_mesh.GetNode(node_index);
+            if (!p_node->IsDeleted() && p_node->IsBoundaryNode())
+            {
+                return node_index;
+            }
+        }
+        return UNSIGNED_UNSET;
+    }
 
-            // Find the local index of this node in this element
-            unsigned local_index = p_element->GetNodeLocalIndex(current_boundary_node);
-            unsigned next_node_local_index = (local_index+1)%number_of_nodes_in_this_element;
-            Node<DIM>* p_next_node = p_element->GetNode(next_node_local_index);
-            unsigned next_node_index = p_next_node->GetIndex();
-            if (next_node_index == second_boundary_node_start)
+    /*
+     * ReMesh() removes deleted nodes and shifts the indices of the remaining ones down,
+     * keeping their order, and adds new nodes at the end. A surviving node can therefore
+     * only have moved down, by at most the number of nodes removed, which is not known if
+     * nodes were also added: a T2 swap removes three nodes and adds one. We scan down from
+     * each cached index for a boundary node near the cached location, and give up once we
+     * have looked at as many nodes as a rebuild would.
+     */
+    double tolerance = 0.5*mMeanWoundEdgeLength;
+    unsigned num_nodes_scanned = 0;
+    unsigned seed_index = UNSIGNED_UNSET;
+    for (unsigned i=0; i<r_wound_loop.size() && seed_index == UNSIGNED_UNSET && num_nodes_scanned < num_nodes; i++)
+    {
+        unsigned candidate = std::min(r_wound_loop[i], num_nodes-1);
+        while (num_nodes_scanned < num_nodes)
+        {
+            num_nodes_scanned++;
+            Node<DIM>* p_node = r_mesh.GetNode(candidate);
+            if (!p_node->IsDeleted() && p_node->IsBoundaryNode() &&
+                norm_2(r_mesh.GetVectorFromAtoB(mWoundLoopLocations[woundIndex][i], p_node->rGetLocation())) < tolerance)
             {
-                boundary_incomplete = false;
+                seed_index = candidate;
                 break;
             }
-            else if (p_next_node->IsBoundaryNode())
+            if (candidate == 0)
             {
-                second_boundary_nodes.push_back(p_next_node->GetIndex());
-                current_boundary_node = p_next_node->GetIndex();
                 break;
             }
-        } // element for loop
-    }// while loop
+            candidate--;
+        }
+    }
+    WOUND_HEALING_COUNT(mTimings.AddNodesScanned(num_nodes_scanned));
+    return seed_index;
+}
 
-    // Then, identify inner boundary
+template<unsigned DIM>
+void WoundHealingForce<DIM>::RebuildWoundBoundaries(VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    WOUND_HEALING_TIME_PHASE(mTimings, BOUNDARY_REBUILD);
+    std::vector<std::vector<unsigned> > boundary_loops;
+    LabelBoundaryLoops(rCellPopulation, boundary_loops);
 
-    std::vector<unsigned> inner_boundary_nodes;
-    if ( first_boundary_nodes.size() < second_boundary_nodes.size() )
+    mWoundLoops.clear();
+    if (mWoundCentres.empty())
     {
-        inner_boundary_nodes = first_boundary_nodes;
+        /*
+         * Every loop that is not the outer boundary is a wound. A periodic mesh has either no
+         * outer boundary (toroidal) or two that wrap around the domain (cylindrical), so we
+         * cannot assume that there is exactly one loop that is not a wound.
+         */
+        for (unsigned loop_index=0; loop_index<boundary_loops.size(); loop_index++)
+        {
+            if (IsWoundLoop(boundary_loops[loop_index], rCellPopulation))
+            {
+                mWoundLoops.push_back(std::vector<unsigned>());
+                mWoundLoops.back().swap(boundary_loops[loop_index]);
+            }
+        }
     }
     else
     {
-        inner_boundary_nodes = second_boundary_nodes;
+        /*
+         * Wound i is the hole around the i-th wound centre, if there still is one. If two
+         * wounds have merged, the hole goes to the wound with the lower index only.
+         */
+        mWoundLoops.resize(mWoundCentres.size());
+        std::vector<bool> loop_is_taken(boundary_loops.size(), false);
+        for (unsigned wound_index=0; wound_index<mWoundCentres.size(); wound_index++)
+        {
+            for (unsigned loop_index=0; loop_index<boundary_loops.size(); loop_index++)
+            {
+                if (!loop_is_taken[loop_index] &&
+                    IsWoundLoop(boundary_loops[loop_index], rCellPopulation) &&
+                    IsPointInsideLoop(mWoundCentres[wound_index], boundary_loops[loop_index], rCellPopulation))
+                {
+                    mWoundLoops[wound_index] = boundary_loops[loop_index];
+                    loop_is_taken[loop_index] = true;
+                    break;
+                }
+            }
+        }
     }
+}
 
-    // Then, add forces to that boundary a for loop
-
-    for ( auto &node_index : inner_boundary_nodes )
+template<unsigned DIM>
+void WoundHealingForce<DIM>::UpdateWoundBoundaries(VertexBasedCellPopulation<DIM>& rCellPopulation)
+{
+    WOUND_HEALING_TIME_PHASE(mTimings, BOUNDARY_UPDATE);
+    MutableVertexMesh<DIM, DIM>& r_mesh = rCellPopulation.rGetMesh();
+    unsigned num_nodes = r_mesh.GetNumAllNodes();
+
+    // Vectors between nodes only need to go through the mesh if it is periodic
+    mMeshIsPeriodic = (dynamic_cast<Toroidal2dVertexMesh*>(&r_mesh) != nullptr)
+                      || (dynamic_cast<Cylindrical2dVertexMesh*>(&r_mesh) != nullptr);
+    mNodeVisited.resize(num_nodes, false);
+    bool nodes_renumbered = mWoundLoopsInitialised && HaveNodesBeenRenumbered(rCellPopulation);
+
+    /*
+     * Try to re-walk each cached ring from one of its surviving nodes. The walks go into
+     * scratch loops that keep their capacity from step to step, so that no memory needs
+     * to be allocated unless the wounds grow.
+     */
+    bool rings_are_patched = mWoundLoopsInitialised;
+    std::vector<std::vector<unsigned> >& patched_loops = mPatchedLoops;
+    patched_loops.resize(mWoundLoops.size());
+    for (unsigned wound_index=0; wound_index<patched_loops.size(); wound_index++)
     {
-        // Find the indices of the elements owned by this node
-        std::set<unsigned> containing_elem_indices = p_cell_population->GetNode(node_index)->rGetContainingElementIndices();
-
-        c_vector<double, DIM> line_tension_contribution = zero_vector<double>(DIM);
-        // Iterate over these elements
-        for (std::set<unsigned>::iterator iter = containing_elem_indices.begin();
-             iter != containing_elem_indices.end();
-             ++iter)
+        patched_loops[wound_index].clear();
+    }
+    for (unsigned wound_index=0; rings_are_patched && wound_index<mWoundLoops.size(); wound_index++)
+    {
+        // A wound that has closed stays closed
+        if (mWoundLoops[wound_index].empty())
         {
-            // Get this element, its index and its number of nodes
-            VertexElement<DIM, DIM>* p_element = p_cell_population->GetElement(*iter);
-            unsigned num_nodes_elem = p_element->GetNumNodes();
-
-            // Find the local index of this node in this element
-            unsigned local_index = p_element->GetNodeLocalIndex(node_index);
+            continue;
+        }
 
-            // Add the force contribution from this cell's area elasticity (note the minus sign)
+        unsigned seed_index = FindWoundBoundarySeed(wound_index, rCellPopulation, nodes_renumbered);
 
-            // Get the previous and next nodes in this element
-            unsigned previous_node_local_index = (num_nodes_elem+local_index-1)%num_nodes_elem;
-            Node<DIM>* p_previous_node = p_element->GetNode(previous_node_local_index);
+        // Swaps only change a wound by a few nodes per step, so a much longer walk has left the wound
+        unsigned max_length = 2*mWoundLoops[wound_index].size() + 10;
+        if (seed_index == UNSIGNED_UNSET || mNodeVisited[seed_index]
+            || !TraceBoundaryLoop(seed_index, rCellPopulation, patched_loops[wound_index], max_length)
+            || !IsWoundLoop(patched_loops[wound_index], rCellPopulation))
+        {
+            rings_are_patched = false;
+        }
 
-            unsigned next_node_local_index = (local_index+1)%num_nodes_elem;
-            Node<DIM>* p_next_node = p_element->GetNode(next_node_local_index);
+        // A ring around a chosen centre must still surround it, rather than being another wound's ring
+        else if (!mWoundCentres.empty()
+                 && !IsPointInsideLoop(mWoundCentres[wound_index], patched_loops[wound_index], rCellPopulation))
+        {
+            rings_are_patched = false;
+        }
+        for (unsigned i=0; i<patched_loops[wound_index].size(); i++)
+        {
+            mNodeVisited[patched_loops[wound_index][i]] = true;
+        }
+    }
 
-            if ( p_previous_node->IsBoundaryNode() )
+    /*
+     * If the indices are unchanged, any old node that is still on the boundary but was not
+     * reached by the walks lies on a new loop. Without wound centres, a new hole of this
+     * kind is a wound that has split in two, so we add it as a further wound.
+     */
+    std::vector<unsigned>& other_visited_nodes = mOtherVisitedNodes;
+    other_visited_nodes.clear();
+    if (rings_are_patched && !nodes_renumbered && mWoundCentres.empty())
+    {
+        unsigned num_old_wounds = mWoundLoops.size();
+        for (unsigned wound_index=0; wound_index<num_old_wounds; wound_index++)
+        {
+            for (unsigned i=0; i<mWoundLoops[wound_index].size(); i++)
             {
-                c_vector<double, DIM> previous_edge_gradient =
-                        -p_cell_population->rGetMesh().GetNextEdgeGradientOfElementAtNode(p_element,
-                                previous_node_local_index);
-                line_tension_contribution -= mWoundTensionParameter*previous_edge_gradient;
+                unsigned node_index = mWoundLoops[wound_index][i];
+                if (node_index < num_nodes && !mNodeVisited[node_index] &&
+                    !r_mesh.GetNode(node_index)->IsDeleted() && r_mesh.GetNode(node_index)->IsBoundaryNode())
+                {
+                    std::vector<unsigned>& new_loop = mScratchLoop;
+                    unsigned max_length = 2*mWoundLoops[wound_index].size() + 10;
+                    if (TraceBoundaryLoop(node_index, rCellPopulation, new_loop, max_length)
+                        && IsWoundLoop(new_loop, rCellPopulation))
+                    {
+                        patched_loops.push_back(new_loop);
+                    }
+
+                    // Mark the nodes we have walked past, whether or not they formed a wound
+                    for (unsigned j=0; j<new_loop.size(); j++)
+                    {
+                        mNodeVisited[new_loop[j]] = true;
+                        other_visited_nodes.push_back(new_loop[j]);
+                    }
+                }
             }
+        }
+    }
 
-            if ( p_next_node->IsBoundaryNode() )
-            {
-                c_vector<double, DIM> next_edge_gradient = p_cell_population->
-                        rGetMesh().GetNextEdgeGradientOfElementAtNode(p_element, local_index);
-                line_tension_contribution -= mWoundTensionParameter*next_edge_gradient;
-            }
+    // Reset the flags we have set
+    for (unsigned wound_index=0; wound_index<patched_loops.size(); wound_index++)
+    {
+        for (unsigned i=0; i<patched_loops[wound_index].size(); i++)
+        {
+            mNodeVisited[patched_loops[wound_index][i]] = false;
+        }
+    }
+    for (unsigned i=0; i<other_visited_nodes.size(); i++)
+    {
+        mNodeVisited[other_visited_nodes[i]] = false;
+    }
+
+    // Otherwise the mesh has changed in a way we cannot follow, so start again
+    if (rings_are_patched)
+    {
+        mWoundLoops.swap(patched_loops);
+    }
+    else
+    {
+        RebuildWoundBoundaries(rCellPopulation);
+        mWoundLoopsInitialised = true;
+        mNumWoundBoundaryRebuilds++;
+    }
 
+    // Rebuild the wound-edge adjacency table from the rings
+    mWoundNodeTable.clear();
+    for (unsigned wound_index=0; wound_index<mWoundLoops.size(); wound_index++)
+    {
+        const std::vector<unsigned>& r_wound_loop = mWoundLoops[wound_index];
+        unsigned loop_size = r_wound_loop.size();
+        for (unsigned i=0; i<loop_size; i++)
+        {
+            WoundNodeNeighbours entry;
+            entry.mPreviousNodeIndex = r_wound_loop[(loop_size+i-1)%loop_size];
+            entry.mNodeIndex = r_wound_loop[i];
+            entry.mNextNodeIndex = r_wound_loop[(i+1)%loop_size];
+            mWoundNodeTable.push_back(entry);
         }
-        p_cell_population->GetNode(node_index)->AddAppliedForceContribution(line_tension_contribution);
     }
 
+    // Remember where the rings are, so that they can be found again after ReMesh()
+    mNumNodesAtLastUpdate = num_nodes;
+    mWoundLoopLocations.resize(mWoundLoops.size());
+    double total_edge_length = 0.0;
+    unsigned num_wound_edges = 0;
+    for (unsigned wound_index=0; wound_index<mWoundLoops.size(); wound_index++)
+    {
+        const std::vector<unsigned>& r_wound_loop = mWoundLoops[wound_index];
+        mWoundLoopLocations[wound_index].resize(r_wound_loop.size());
+        for (unsigned i=0; i<r_wound_loop.size(); i++)
+        {
+            mWoundLoopLocations[wound_index][i] = r_mesh.GetNode(r_wound_loop[i])->rGetLocation();
+            total_edge_length += r_mesh.GetDistanceBetweenNodes(r_wound_loop[i], r_wound_loop[(i+1)%r_wound_loop.size()]);
+        }
+        num_wound_edges += r_wound_loop.size();
+    }
+    mMeanWoundEdgeLength = (num_wound_edges == 0) ? 0.0 : total_edge_length/num_wound_edges;
 }
 
 template<unsigned DIM>
@@ -228,20 +654,96 @@ void WoundHealingForce<DIM>::SetWoundTensionParameter(double woundTension)
     mWoundTensionParameter = woundTension;
 }
 
+template<unsigned DIM>
+void WoundHealingForce<DIM>::SetWoundCentres(const std::vector<c_vector<double, DIM> >& rWoundCentres)
+{
+    mWoundCentres = rWoundCentres;
+
+    // The wounds have to be found again around the new centres
+    mWoundLoopsInitialised = false;
+}
+
+template<unsigned DIM>
+const std::vector<c_vector<double, DIM> >& WoundHealingForce<DIM>::rGetWoundCentres() const
+{
+    return mWoundCentres;
+}
+
+template<unsigned DIM>
+const std::vector<std::vector<unsigned> >& WoundHealingForce<DIM>::rGetWoundLoops() const
+{
+    return mWoundLoops;
+}
+
+template<unsigned DIM>
+unsigned WoundHealingForce<DIM>::GetNumThreads() const
+{
+    return mNumThreads;
+}
+
+template<unsigned DIM>
+void WoundHealingForce<DIM>::SetNumThreads(unsigned numThreads)
+{
+    if (numThreads == 0)
+    {
+        EXCEPTION("The number of threads must be positive");
+    }
+    mNumThreads = numThreads;
+}
+
+template<unsigned DIM>
+bool WoundHealingForce<DIM>::GetMeshIsPeriodic() const
+{
+    return mMeshIsPeriodic;
+}
+
+template<unsigned DIM>
+void WoundHealingForce<DIM>::GetWoundNodeTriples(std::vector<unsigned>& rTriples) const
+{
+    rTriples.clear();
+    rTriples.reserve(3*mWoundNodeTable.size());
+    for (unsigned table_index=0; table_index<mWoundNodeTable.size(); table_index++)
+    {
+        rTriples.push_back(mWoundNodeTable[table_index].mPreviousNodeIndex);
+        rTriples.push_back(mWoundNodeTable[table_index].mNodeIndex);
+        rTriples.push_back(mWoundNodeTable[table_index].mNextNodeIndex);
+    }
+}
+
+template<unsigned DIM>
+unsigned WoundHealingForce<DIM>::GetNumWoundBoundaryRebuilds() const
+{
+    return mNumWoundBoundaryRebuilds;
+}
+
+template<unsigned DIM>
+const WoundHealingForceTimings& WoundHealingForce<DIM>::rGetTimings() const
+{
+    return mTimings;
+}
+
+template<unsigned DIM>
+void WoundHealingForce<DIM>::ResetTimings()
+{
+    mTimings.Reset();
+}
+
 template<unsigned DIM>
 void WoundHealingForce<DIM>::OutputForceParameters(out_stream& rParamsFile)
 {
     *rParamsFile << "\t\t\t<WoundTensionParameter>" << mWoundTensionParameter << "</WoundTensionParameter>\n";
+    if (WoundHealingForceTimings::IsEnabled())
+    {
+        mTimings.OutputSummary(rParamsFile);
+    }
 
     // Call method on direct parent class
     AbstractForce<DIM>::OutputForceParameters(rParamsFile);
 }
 
 // Explicit instantiation
-template class WoundHealingForce<1>;
 template class WoundHealingForce<2>;
-template class WoundHealingForce<3>;
 
 // Serialization for Boost >= 1.36
 #include "SerializationExportWrapperForCpp.hpp"
-EXPORT_TEMPLATE_CLASS_SAME_DIMS(WoundHealingForce)
+EXPORT_TEMPLATE_CLASS1(WoundHealingForce, 2)
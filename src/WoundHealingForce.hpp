@@ -38,22 +38,35 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
+#include <boost/serialization/vector.hpp>
 #include "Exception.hpp"
 
 #include "AbstractForce.hpp"
 #include "VertexBasedCellPopulation.hpp"
+#include "PlainVector2d.hpp"
+#include "WoundHealingForceTimings.hpp"
 
 #include <iostream>
+#include <vector>
 
 /**
  * A force class for use in Vertex-based simulations. This force is based on the
  * Energy function proposed by Farhadifar et al in  Curr. Biol., 2007, 17, 2095-2104.
+ *
+ * The force is only defined for two-dimensional populations, and is only instantiated
+ * for DIM = 2. Its inner loops use PlainVector2d rather than c_vector.
+ *
+ * The force also works on periodic meshes (Toroidal2dVertexMesh and Cylindrical2dVertexMesh),
+ * where the edges of a wound may cross the periodic boundaries. A toroidal tissue has no
+ * free edges at all, so a wound can be followed in a much smaller tissue.
  */
 
 
 template<unsigned DIM>
 class WoundHealingForce : public AbstractForce<DIM>
 {
+static_assert(DIM == 2, "WoundHealingForce is only defined for two-dimensional vertex populations");
+
 friend class TestForces;
 
 private:
@@ -71,15 +84,251 @@ private:
     {
         archive & boost::serialization::base_object<AbstractForce<DIM> >(*this);
         archive & mWoundTensionParameter;
+        archive & mWoundCentres;
     }
 
 protected:
 
+    /**
+     * An entry of the wound-edge adjacency table: a wound node together with its
+     * neighbours along the wound.
+     */
+    struct WoundNodeNeighbours
+    {
+        /** Global index of the previous node along the wound. */
+        unsigned mPreviousNodeIndex;
+
+        /** Global index of the wound node. */
+        unsigned mNodeIndex;
+
+        /** Global index of the next node along the wound. */
+        unsigned mNextNodeIndex;
+    };
+
     /**
      * The strength of tension along the wound.
      */
     double mWoundTensionParameter;
 
+    /**
+     * Points inside the wounds that should be under tension, one per wound. If this is
+     * empty, every boundary loop that is a wound according to IsWoundLoop() is treated
+     * as one. On a flat mesh these are all loops other than the outer boundary, and on a
+     * Toroidal2dVertexMesh, which has no outer boundary, they are all the loops.
+     */
+    std::vector<c_vector<double, DIM> > mWoundCentres;
+
+    /**
+     * The ordered rings of nodes around each wound, as found at the last call to
+     * AddForceContribution(). If wound centres are given, entry i is the wound around
+     * mWoundCentres[i] and is empty once that wound has closed. The rings are kept
+     * between time steps and patched from one of their surviving nodes, rather than
+     * being re-traced from scratch. They are not archived, and are rebuilt after
+     * loading a checkpoint.
+     */
+    std::vector<std::vector<unsigned> > mWoundLoops;
+
+    /**
+     * The locations of the nodes in mWoundLoops at the last update. These are used
+     * to find the rings again if ReMesh() has renumbered the nodes.
+     */
+    std::vector<std::vector<c_vector<double, DIM> > > mWoundLoopLocations;
+
+    /**
+     * Flags marking the nodes that have been visited while labelling or patching
+     * boundary loops. Entries are reset after use, so this never needs clearing.
+     */
+    std::vector<bool> mNodeVisited;
+
+    /**
+     * Scratch space for the re-walked wound loops. This is swapped with mWoundLoops
+     * after a successful update, so the memory of both is reused from step to step.
+     */
+    std::vector<std::vector<unsigned> > mPatchedLoops;
+
+    /**
+     * Scratch space for walks that label boundary loops or look for wounds that have split in two.
+     */
+    std::vector<unsigned> mScratchLoop;
+
+    /**
+     * Scratch space for the nodes flagged by those walks.
+     */
+    std::vector<unsigned> mOtherVisitedNodes;
+
+    /**
+     * Whether the wound loops have been found at least once.
+     */
+    bool mWoundLoopsInitialised;
+
+    /**
+     * The mean edge length along the wounds at the last update, used as a length
+     * scale when matching cached locations to renumbered nodes.
+     */
+    double mMeanWoundEdgeLength;
+
+    /**
+     * The total number of nodes in the mesh at the last update, used to detect renumbering.
+     */
+    unsigned mNumNodesAtLastUpdate;
+
+    /**
+     * The number of times the wound boundaries had to be rebuilt from scratch.
+     */
+    unsigned mNumWoundBoundaryRebuilds;
+
+    /**
+     * The number of threads used to find the boundary nodes and to calculate the
+     * tension on the wound nodes. This only has an effect if the project is built
+     * with OpenMP, and the results do not depend on it. It is not archived.
+     */
+    unsigned mNumThreads;
+
+    /**
+     * The boundary nodes found by each partition of the nodes while labelling loops.
+     */
+    std::vector<std::vector<unsigned> > mPartitionBoundaryNodes;
+
+    /**
+     * The wound-edge adjacency table, with one entry for each node of mWoundLoops in
+     * the same order. It is rebuilt from the loops whenever they are updated.
+     */
+    std::vector<WoundNodeNeighbours> mWoundNodeTable;
+
+    /**
+     * The tension on each node of mWoundNodeTable, in the same order.
+     */
+    std::vector<PlainVector2d> mWoundNodeForces;
+
+    /**
+     * Whether the mesh at the last call to AddForceContribution() was periodic, i.e. a
+     * Toroidal2dVertexMesh or Cylindrical2dVertexMesh. Vectors between nodes of a periodic
+     * mesh have to be found through the mesh.
+     */
+    bool mMeshIsPeriodic;
+
+    /**
+     * Timers and counters for the phases of this force. These are only updated if the
+     * project is built with the WOUND_HEALING_USE_TIMINGS option, and are not archived.
+     */
+    WoundHealingForceTimings mTimings;
+
+    /**
+     * Calculate the tension on a node of a wound from the unit vectors along its two
+     * wound edges. The cost does not depend on how many elements meet at the node.
+     *
+     * @param tableIndex the index of the wound node in mWoundNodeTable
+     * @param rCellPopulation reference to the cell population
+     * @return the force on the node from the tension along the wound
+     */
+    PlainVector2d CalculateWoundTensionOnNode(unsigned tableIndex, VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Get the vector from one node to another, taking periodicity into account if needed.
+     *
+     * @param pNodeA the first node
+     * @param pNodeB the second node
+     * @param rCellPopulation reference to the cell population
+     * @return the vector from node A to node B
+     */
+    PlainVector2d GetVectorBetweenNodes(Node<DIM>* pNodeA, Node<DIM>* pNodeB, VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Find the node that follows a given boundary node along its boundary loop,
+     * in the order in which the nodes appear in their containing elements.
+     *
+     * @param nodeIndex global index of a boundary node
+     * @param rCellPopulation reference to the cell population
+     * @return the global index of the next boundary node, or UNSIGNED_UNSET if there is none
+     */
+    unsigned GetNextBoundaryNodeIndex(unsigned nodeIndex, VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Walk along a boundary loop, starting at a given boundary node.
+     *
+     * @param startNodeIndex global index of the boundary node to start from
+     * @param rCellPopulation reference to the cell population
+     * @param rLoop vector to be filled with the ordered nodes of the loop
+     * @param maxLength the maximum number of nodes to visit before giving up
+     * @return whether the walk returned to its starting node
+     */
+    bool TraceBoundaryLoop(unsigned startNodeIndex,
+                           VertexBasedCellPopulation<DIM>& rCellPopulation,
+                           std::vector<unsigned>& rLoop,
+                           unsigned maxLength);
+
+    /**
+     * Get the signed area enclosed by a boundary loop. Loops are traced in element
+     * order, so the outer boundary has a positive area and wounds have a negative one.
+     *
+     * @param rLoop the ordered nodes of the loop
+     * @param rCellPopulation reference to the cell population
+     * @return the signed area of the loop
+     */
+    double GetSignedAreaOfLoop(const std::vector<unsigned>& rLoop, VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Find whether the edges of a boundary loop add up to a displacement across the
+     * periodic domain, as for the top and bottom boundaries of a cylindrical mesh or a
+     * wound that has grown into a band around a toroidal mesh. Such a loop does not
+     * enclose a hole and its signed area is meaningless. Loops never wrap on flat meshes.
+     *
+     * @param rLoop the ordered nodes of the loop
+     * @param rCellPopulation reference to the cell population
+     * @return whether the loop wraps around the domain
+     */
+    bool DoesLoopWrapAroundDomain(const std::vector<unsigned>& rLoop, VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Find whether a boundary loop is a wound: a closed loop of at least three nodes that
+     * does not wrap around a periodic domain and encloses a negative signed area.
+     *
+     * @param rLoop the ordered nodes of the loop
+     * @param rCellPopulation reference to the cell population
+     * @return whether the loop is a wound
+     */
+    bool IsWoundLoop(const std::vector<unsigned>& rLoop, VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Find whether a point lies inside a boundary loop, using its winding number.
+     *
+     * @param rPoint the point
+     * @param rLoop the ordered nodes of the loop
+     * @param rCellPopulation reference to the cell population
+     * @return whether the loop winds around the point
+     */
+    bool IsPointInsideLoop(const c_vector<double, DIM>& rPoint,
+                           const std::vector<unsigned>& rLoop,
+                           VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Find whether ReMesh() has renumbered the nodes since the last update. This is so if the
+     * number of nodes has changed, or if any node of the cached rings is no longer near its
+     * cached location, which catches a ReMesh() that added as many nodes as it removed.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @return whether the nodes may have been renumbered
+     */
+    bool HaveNodesBeenRenumbered(VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * Find a node of a cached wound ring in the current mesh.
+     *
+     * @param woundIndex the index of the wound in mWoundLoops
+     * @param rCellPopulation reference to the cell population
+     * @param nodesRenumbered whether the nodes may have been renumbered since the last update, according
+     *     to HaveNodesBeenRenumbered()
+     * @return the global index of a current boundary node on the wound, or UNSIGNED_UNSET if none was found
+     */
+    unsigned FindWoundBoundarySeed(unsigned woundIndex, VertexBasedCellPopulation<DIM>& rCellPopulation, bool nodesRenumbered);
+
+    /**
+     * Find the wound boundaries from scratch, by labelling all boundary loops of the mesh.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void RebuildWoundBoundaries(VertexBasedCellPopulation<DIM>& rCellPopulation);
+
 public:
 
     /**
@@ -101,6 +350,16 @@ public:
      */
     virtual void AddForceContribution(AbstractCellPopulation<DIM>& rCellPopulation);
 
+    /**
+     * Calculate the energy whose negative gradient is the force added by AddForceContribution():
+     * the wound tension times the total perimeter of the wounds. This brings the wound
+     * boundaries up to date in the same way.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @return the energy
+     */
+    virtual double CalculateEnergy(AbstractCellPopulation<DIM>& rCellPopulation);
+
     /*
      * Get the Wound tension parameter
      */
@@ -114,7 +373,94 @@ public:
     void SetWoundTensionParameter(double woundTension);
 
     /**
-     * Overridden OutputForceParameters() method.
+     * Set points inside the wounds that should be under tension. Wound i is then the
+     * boundary loop around rWoundCentres[i]; other holes in the tissue are left alone.
+     *
+     * @param rWoundCentres one point inside each wound
+     */
+    void SetWoundCentres(const std::vector<c_vector<double, DIM> >& rWoundCentres);
+
+    /**
+     * @return the points inside the wounds, if given
+     */
+    const std::vector<c_vector<double, DIM> >& rGetWoundCentres() const;
+
+    /**
+     * @return the ordered nodes around each wound, as found at the last call
+     * to AddForceContribution()
+     */
+    const std::vector<std::vector<unsigned> >& rGetWoundLoops() const;
+
+    /**
+     * Bring the wound rings up to date with the current mesh. Each cached ring is re-walked
+     * from a surviving node, which copes with T1 and T2 swaps, node merges and renumbering
+     * by ReMesh(). Old nodes that are no longer on their ring pick up wounds that have
+     * split in two. The rings are only rebuilt from scratch if a wound cannot be found
+     * again or a walk no longer gives a wound. AddForceContribution() and CalculateEnergy()
+     * call this themselves.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void UpdateWoundBoundaries(VertexBasedCellPopulation<DIM>& rCellPopulation);
+
+    /**
+     * @return whether the mesh was periodic at the last update of the wound rings
+     */
+    bool GetMeshIsPeriodic() const;
+
+    /**
+     * Get each wound node together with its neighbours along its wound, as found at the
+     * last update of the wound rings.
+     *
+     * @param rTriples vector to be filled with the previous node, the node and the next node
+     * of each wound node in turn
+     */
+    void GetWoundNodeTriples(std::vector<unsigned>& rTriples) const;
+
+    /**
+     * Label all boundary loops of the mesh in a single pass over the nodes. Each
+     * boundary node is visited once, so apart from checking the boundary flag of each
+     * node this is linear in the number of boundary nodes. Chains of boundary nodes
+     * that do not close into a loop are left out.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param rLoops vector to be filled with the ordered nodes of every closed boundary loop
+     */
+    void LabelBoundaryLoops(VertexBasedCellPopulation<DIM>& rCellPopulation,
+                            std::vector<std::vector<unsigned> >& rLoops);
+
+    /**
+     * @return the number of threads used by this force
+     */
+    unsigned GetNumThreads() const;
+
+    /**
+     * Set the number of threads used by this force. This only has an effect if the
+     * project is built with OpenMP (see the WOUND_HEALING_USE_OPENMP option).
+     *
+     * @param numThreads the number of threads
+     */
+    void SetNumThreads(unsigned numThreads);
+
+    /**
+     * @return the number of times the wound boundaries have been rebuilt from scratch
+     */
+    unsigned GetNumWoundBoundaryRebuilds() const;
+
+    /**
+     * @return the timers and counters for the phases of this force. These stay at zero
+     * unless the project is built with the WOUND_HEALING_USE_TIMINGS option.
+     */
+    const WoundHealingForceTimings& rGetTimings() const;
+
+    /**
+     * Set the timers and counters for the phases of this force back to zero.
+     */
+    void ResetTimings();
+
+    /**
+     * Overridden OutputForceParameters() method. If timings are compiled in, a summary
+     * of them is written after the wound tension parameter.
      *
      * @param rParamsFile the file stream to which the parameters are output
      */
@@ -122,6 +468,6 @@ public:
 };
 
 #include "SerializationExportWrapper.hpp"
-EXPORT_TEMPLATE_CLASS_SAME_DIMS(WoundHealingForce)
+EXPORT_TEMPLATE_CLASS1(WoundHealingForce, 2)
 
 #endif /*WOUNDHEALINGFORCE_HPP_*/
@@ -0,0 +1,157 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "WoundHealingForceTimings.hpp"
+
+#include <cassert>
+
+WoundHealingForceTimings::WoundHealingForceTimings()
+{
+    Reset();
+}
+
+bool WoundHealingForceTimings::IsEnabled()
+{
+#ifdef WOUND_HEALING_TIMINGS
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* WoundHealingForceTimings::GetPhaseName(Phase phase)
+{
+    static const char* phase_names[NUM_PHASES] = {"BoundaryUpdate",
+                                                  "BoundarySearch",
+                                                  "LoopWalk",
+                                                  "BoundaryRebuild",
+                                                  "WoundTension",
+                                                  "Farhadifar",
+                                                  "ForceApplication"};
+    assert(phase < NUM_PHASES);
+    return phase_names[phase];
+}
+
+void WoundHealingForceTimings::Reset()
+{
+    for (unsigned phase=0; phase<NUM_PHASES; phase++)
+    {
+        mNumPhaseCalls[phase] = 0;
+        mPhaseNanoseconds[phase] = 0;
+    }
+    mNumCalls = 0;
+    mNumNodesScanned = 0;
+    mNumLoopWalks = 0;
+    mTotalLoopLength = 0;
+    mMaxLoopLength = 0;
+}
+
+void WoundHealingForceTimings::AddPhaseTime(Phase phase, unsigned long long nanoseconds)
+{
+    mNumPhaseCalls[phase]++;
+    mPhaseNanoseconds[phase] += nanoseconds;
+}
+
+void WoundHealingForceTimings::AddCall()
+{
+    mNumCalls++;
+}
+
+void WoundHealingForceTimings::AddNodesScanned(unsigned numNodes)
+{
+    mNumNodesScanned += numNodes;
+}
+
+void WoundHealingForceTimings::AddLoopWalk(unsigned loopLength)
+{
+    mNumLoopWalks++;
+    mTotalLoopLength += loopLength;
+    if (loopLength > mMaxLoopLength)
+    {
+        mMaxLoopLength = loopLength;
+    }
+}
+
+unsigned long long WoundHealingForceTimings::GetNumPhaseCalls(Phase phase) const
+{
+    return mNumPhaseCalls[phase];
+}
+
+unsigned long long WoundHealingForceTimings::GetPhaseNanoseconds(Phase phase) const
+{
+    return mPhaseNanoseconds[phase];
+}
+
+unsigned long long WoundHealingForceTimings::GetNumCalls() const
+{
+    return mNumCalls;
+}
+
+unsigned long long WoundHealingForceTimings::GetNumNodesScanned() const
+{
+    return mNumNodesScanned;
+}
+
+unsigned long long WoundHealingForceTimings::GetNumLoopWalks() const
+{
+    return mNumLoopWalks;
+}
+
+unsigned long long WoundHealingForceTimings::GetTotalLoopLength() const
+{
+    return mTotalLoopLength;
+}
+
+unsigned WoundHealingForceTimings::GetMaxLoopLength() const
+{
+    return mMaxLoopLength;
+}
+
+void WoundHealingForceTimings::OutputSummary(out_stream& rParamsFile) const
+{
+    *rParamsFile << "\t\t\t<WoundForceTimings>\n";
+    *rParamsFile << "\t\t\t\t<NumCalls>" << mNumCalls << "</NumCalls>\n";
+    *rParamsFile << "\t\t\t\t<NumNodesScanned>" << mNumNodesScanned << "</NumNodesScanned>\n";
+    *rParamsFile << "\t\t\t\t<NumLoopWalks>" << mNumLoopWalks << "</NumLoopWalks>\n";
+    *rParamsFile << "\t\t\t\t<TotalLoopLength>" << mTotalLoopLength << "</TotalLoopLength>\n";
+    *rParamsFile << "\t\t\t\t<MaxLoopLength>" << mMaxLoopLength << "</MaxLoopLength>\n";
+    for (unsigned phase=0; phase<NUM_PHASES; phase++)
+    {
+        *rParamsFile << "\t\t\t\t<Phase name=\"" << GetPhaseName(static_cast<Phase>(phase))
+                     << "\" calls=\"" << mNumPhaseCalls[phase]
+                     << "\" nanoseconds=\"" << mPhaseNanoseconds[phase] << "\"/>\n";
+    }
+    *rParamsFile << "\t\t\t</WoundForceTimings>\n";
+}
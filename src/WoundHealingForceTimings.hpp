@@ -0,0 +1,243 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef WOUNDHEALINGFORCETIMINGS_HPP_
+#define WOUNDHEALINGFORCETIMINGS_HPP_
+
+#include "OutputFileHandler.hpp"
+#include "WoundHealingTracer.hpp"
+
+#include <chrono>
+
+/*
+ * The timers and counters are only compiled in if WOUND_HEALING_TIMINGS is defined, which
+ * is done by the WOUND_HEALING_USE_TIMINGS CMake option. Otherwise the macros below expand
+ * to nothing and the counters stay at zero. Each timed phase is also a trace event if the
+ * project is built with the WOUND_HEALING_USE_TRACING option (see WoundHealingTracer).
+ */
+#ifdef WOUND_HEALING_TIMINGS
+#define WOUND_HEALING_PHASE_TIMER(timings, phase) \
+    WoundHealingForceTimings::ScopedPhaseTimer wound_healing_phase_timer(timings, WoundHealingForceTimings::phase)
+#define WOUND_HEALING_COUNT(statement) statement
+#else
+#define WOUND_HEALING_PHASE_TIMER(timings, phase)
+#define WOUND_HEALING_COUNT(statement)
+#endif
+#define WOUND_HEALING_TIME_PHASE(timings, phase) \
+    WOUND_HEALING_PHASE_TIMER(timings, phase); \
+    WOUND_HEALING_TRACE_SCOPE(WoundHealingForceTimings::GetPhaseName(WoundHealingForceTimings::phase))
+
+/**
+ * Timers and counters for the phases of the wound healing forces. Each phase keeps the
+ * number of times it was entered and the wall time spent in it. Phases may be nested: the
+ * boundary search, loop walks and rebuilds are all part of the boundary update.
+ */
+class WoundHealingForceTimings
+{
+public:
+
+    /**
+     * The phases that are timed.
+     */
+    enum Phase
+    {
+        BOUNDARY_UPDATE,
+        BOUNDARY_SEARCH,
+        LOOP_WALK,
+        BOUNDARY_REBUILD,
+        WOUND_TENSION,
+        FARHADIFAR,
+        FORCE_APPLICATION,
+        NUM_PHASES
+    };
+
+    /**
+     * Adds the time between its construction and destruction to a phase.
+     */
+    class ScopedPhaseTimer
+    {
+    private:
+
+        /** The timings to add to. */
+        WoundHealingForceTimings& mrTimings;
+
+        /** The phase being timed. */
+        Phase mPhase;
+
+        /** When the phase was entered. */
+        std::chrono::steady_clock::time_point mStart;
+
+    public:
+
+        /**
+         * Constructor. Starts the timer.
+         *
+         * @param rTimings the timings to add to
+         * @param phase the phase being timed
+         */
+        ScopedPhaseTimer(WoundHealingForceTimings& rTimings, Phase phase)
+            : mrTimings(rTimings),
+              mPhase(phase),
+              mStart(std::chrono::steady_clock::now())
+        {
+        }
+
+        /**
+         * Destructor. Stops the timer.
+         */
+        ~ScopedPhaseTimer()
+        {
+            std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - mStart;
+            mrTimings.AddPhaseTime(mPhase, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    };
+
+    /**
+     * Constructor. All timers and counters start at zero.
+     */
+    WoundHealingForceTimings();
+
+    /**
+     * @return whether the timers and counters were compiled in
+     */
+    static bool IsEnabled();
+
+    /**
+     * @param phase a phase
+     * @return the name of the phase, as written by OutputSummary()
+     */
+    static const char* GetPhaseName(Phase phase);
+
+    /**
+     * Set all timers and counters back to zero.
+     */
+    void Reset();
+
+    /**
+     * Add the time spent in one visit of a phase.
+     *
+     * @param phase the phase
+     * @param nanoseconds the time spent in it
+     */
+    void AddPhaseTime(Phase phase, unsigned long long nanoseconds);
+
+    /**
+     * Record a call to AddForceContribution().
+     */
+    void AddCall();
+
+    /**
+     * Record that a number of nodes were checked for being on the boundary.
+     *
+     * @param numNodes the number of nodes
+     */
+    void AddNodesScanned(unsigned numNodes);
+
+    /**
+     * Record a walk along a boundary loop.
+     *
+     * @param loopLength the number of nodes walked past
+     */
+    void AddLoopWalk(unsigned loopLength);
+
+    /**
+     * @param phase a phase
+     * @return the number of times the phase was entered
+     */
+    unsigned long long GetNumPhaseCalls(Phase phase) const;
+
+    /**
+     * @param phase a phase
+     * @return the total time spent in the phase, in nanoseconds
+     */
+    unsigned long long GetPhaseNanoseconds(Phase phase) const;
+
+    /**
+     * @return the number of calls to AddForceContribution()
+     */
+    unsigned long long GetNumCalls() const;
+
+    /**
+     * @return the number of nodes checked for being on the boundary
+     */
+    unsigned long long GetNumNodesScanned() const;
+
+    /**
+     * @return the number of walks along boundary loops
+     */
+    unsigned long long GetNumLoopWalks() const;
+
+    /**
+     * @return the total number of nodes walked past along boundary loops
+     */
+    unsigned long long GetTotalLoopLength() const;
+
+    /**
+     * @return the largest number of nodes walked past in a single walk
+     */
+    unsigned GetMaxLoopLength() const;
+
+    /**
+     * Write a summary of the timers and counters, in the format of the parameter files.
+     *
+     * @param rParamsFile the file stream to write to
+     */
+    void OutputSummary(out_stream& rParamsFile) const;
+
+private:
+
+    /** The number of times each phase was entered. */
+    unsigned long long mNumPhaseCalls[NUM_PHASES];
+
+    /** The time spent in each phase, in nanoseconds. */
+    unsigned long long mPhaseNanoseconds[NUM_PHASES];
+
+    /** The number of calls to AddForceContribution(). */
+    unsigned long long mNumCalls;
+
+    /** The number of nodes checked for being on the boundary. */
+    unsigned long long mNumNodesScanned;
+
+    /** The number of walks along boundary loops. */
+    unsigned long long mNumLoopWalks;
+
+    /** The total number of nodes walked past along boundary loops. */
+    unsigned long long mTotalLoopLength;
+
+    /** The largest number of nodes walked past in a single walk. */
+    unsigned mMaxLoopLength;
+};
+
+#endif /*WOUNDHEALINGFORCETIMINGS_HPP_*/
@@ -0,0 +1,268 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "WoundHealingSimulation.hpp"
+#include "SimulationTime.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "WoundMeshUtilities.hpp"
+#include "WoundHealingTracer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+template<unsigned DIM>
+WoundHealingSimulation<DIM>::WoundHealingSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                                                    bool deleteCellPopulationInDestructor,
+                                                    bool initialiseCells)
+    : OffLatticeSimulation<DIM>(rCellPopulation, deleteCellPopulationInDestructor, initialiseCells),
+      mClosedWoundArea(0.0),
+      mMaxClosedWoundNumNodes(3),
+      mWoundsHaveClosed(false),
+      mWoundClosureTime(0.0),
+      mNumTimeSteps(0),
+      mNumTimestepChanges(0),
+      mTraceStepIsOpen(false),
+      mTraceStepStart(0),
+      mTracePhaseStart(0),
+      mTraceNumT1Swaps(0)
+{
+}
+
+template<unsigned DIM>
+void WoundHealingSimulation<DIM>::SetupSolve()
+{
+    mNumTimeSteps = 0;
+    mNumTimestepChanges = 0;
+    mWoundsHaveClosed = false;
+    mTraceStepIsOpen = false;
+    OffLatticeSimulation<DIM>::SetupSolve();
+}
+
+template<unsigned DIM>
+void WoundHealingSimulation<DIM>::UpdateCellLocationsAndTopology()
+{
+    WOUND_HEALING_TRACE(TraceEndOfCellPopulationUpdate());
+    {
+        WOUND_HEALING_TRACE_SCOPE("UpdateCellLocationsAndTopology");
+        AdaptTimestep();
+        OffLatticeSimulation<DIM>::UpdateCellLocationsAndTopology();
+    }
+    mNumTimeSteps++;
+
+    // The modifiers and output follow
+    WOUND_HEALING_TRACE(mTracePhaseStart = WoundHealingTracer::Instance()->Now());
+}
+
+template<unsigned DIM>
+void WoundHealingSimulation<DIM>::AdaptTimestep()
+{
+    boost::shared_ptr<DisplacementControlledNumericalMethod<DIM> > p_method =
+            boost::dynamic_pointer_cast<DisplacementControlledNumericalMethod<DIM> >(this->mpNumericalMethod);
+    if (!p_method || p_method->GetSuggestedTimestep() <= 0.0)
+    {
+        return;
+    }
+
+    // Leave the time step alone unless it is well off, as each change restarts the step count
+    SimulationTime* p_simulation_time = SimulationTime::Instance();
+    double suggested_timestep = p_method->GetSuggestedTimestep();
+    double current_timestep = p_simulation_time->GetTimeStep();
+    if (suggested_timestep > 1.25*current_timestep || suggested_timestep < 0.8*current_timestep)
+    {
+        double remaining_time = this->mEndTime - p_simulation_time->GetTime();
+        unsigned num_time_steps = std::max(1u, (unsigned)ceil(remaining_time/suggested_timestep));
+        p_simulation_time->ResetEndTimeAndNumberOfTimeSteps(this->mEndTime, num_time_steps);
+        this->mDt = remaining_time/num_time_steps;
+        mNumTimestepChanges++;
+        WOUND_HEALING_TRACE_INSTANT("TimestepChange", "dt", this->mDt);
+    }
+}
+
+template<unsigned DIM>
+bool WoundHealingSimulation<DIM>::StoppingEventHasOccurred()
+{
+    WOUND_HEALING_TRACE(TraceEndOfStep());
+
+    // The rings are only known once the force has been applied in this solve
+    if (mpWoundClosureForce && mNumTimeSteps > 0 && !mWoundsHaveClosed && WoundsHaveClosed())
+    {
+        mWoundsHaveClosed = true;
+        mWoundClosureTime = SimulationTime::Instance()->GetTime();
+        WOUND_HEALING_TRACE_INSTANT("WoundsClosed", "time", mWoundClosureTime);
+    }
+
+    WOUND_HEALING_TRACE(TraceStartOfStep());
+    return mWoundsHaveClosed;
+}
+
+template<unsigned DIM>
+bool WoundHealingSimulation<DIM>::WoundsHaveClosed()
+{
+    // The rings were found at the last step, and the mesh has not been remeshed since
+    MutableVertexMesh<DIM, DIM>& r_mesh = static_cast<VertexBasedCellPopulation<DIM>&>(this->mrCellPopulation).rGetMesh();
+    const std::vector<std::vector<unsigned> >& r_wound_loops = mpWoundClosureForce->rGetWoundLoops();
+
+    bool all_rings_have_shrunk = true;
+    for (unsigned wound_index=0; wound_index<r_wound_loops.size(); wound_index++)
+    {
+        if (r_wound_loops[wound_index].size() > mMaxClosedWoundNumNodes)
+        {
+            all_rings_have_shrunk = false;
+        }
+    }
+    return all_rings_have_shrunk || WoundMeshUtilities::GetTotalAreaOfWounds(r_mesh, r_wound_loops) <= mClosedWoundArea;
+}
+
+template<unsigned DIM>
+unsigned WoundHealingSimulation<DIM>::GetNumT1SwapLocations()
+{
+    VertexBasedCellPopulation<DIM>* p_population = dynamic_cast<VertexBasedCellPopulation<DIM>*>(&(this->mrCellPopulation));
+    return (p_population == nullptr) ? 0 : p_population->rGetMesh().GetLocationsOfT1Swaps().size();
+}
+
+template<unsigned DIM>
+void WoundHealingSimulation<DIM>::TraceStartOfStep()
+{
+    WoundHealingTracer* p_tracer = WoundHealingTracer::Instance();
+    mTraceStepIsOpen = p_tracer->IsRecording();
+    if (mTraceStepIsOpen)
+    {
+        mTraceStepStart = p_tracer->Now();
+        mTracePhaseStart = mTraceStepStart;
+        mTraceNumT1Swaps = GetNumT1SwapLocations();
+    }
+}
+
+template<unsigned DIM>
+void WoundHealingSimulation<DIM>::TraceEndOfCellPopulationUpdate()
+{
+    if (!mTraceStepIsOpen)
+    {
+        return;
+    }
+
+    // Nothing clears the swap locations during the update, so any new ones come from this ReMesh()
+    WoundHealingTracer* p_tracer = WoundHealingTracer::Instance();
+    unsigned num_t1_swaps = GetNumT1SwapLocations();
+    p_tracer->RecordComplete("UpdateCellPopulation", mTracePhaseStart, p_tracer->Now(),
+                             "t1_swaps", num_t1_swaps >= mTraceNumT1Swaps ? num_t1_swaps - mTraceNumT1Swaps : num_t1_swaps);
+    p_tracer->RecordCounter("NumCells", this->mrCellPopulation.GetNumRealCells());
+}
+
+template<unsigned DIM>
+void WoundHealingSimulation<DIM>::TraceEndOfStep()
+{
+    if (!mTraceStepIsOpen)
+    {
+        return;
+    }
+    WoundHealingTracer* p_tracer = WoundHealingTracer::Instance();
+    unsigned long long now = p_tracer->Now();
+    p_tracer->RecordComplete("ModifiersAndOutput", mTracePhaseStart, now);
+    p_tracer->RecordComplete("TimeStep", mTraceStepStart, now, "time", SimulationTime::Instance()->GetTime());
+    mTraceStepIsOpen = false;
+}
+
+template<unsigned DIM>
+unsigned WoundHealingSimulation<DIM>::GetNumTimeSteps() const
+{
+    return mNumTimeSteps;
+}
+
+template<unsigned DIM>
+unsigned WoundHealingSimulation<DIM>::GetNumTimestepChanges() const
+{
+    return mNumTimestepChanges;
+}
+
+template<unsigned DIM>
+void WoundHealingSimulation<DIM>::SetWoundClosureStoppingEvent(boost::shared_ptr<WoundHealingForce<DIM> > pWoundForce,
+                                                               double closedWoundArea,
+                                                               unsigned maxClosedWoundNumNodes)
+{
+    mpWoundClosureForce = pWoundForce;
+    mClosedWoundArea = closedWoundArea;
+    mMaxClosedWoundNumNodes = maxClosedWoundNumNodes;
+}
+
+template<unsigned DIM>
+boost::shared_ptr<WoundHealingForce<DIM> > WoundHealingSimulation<DIM>::GetWoundClosureForce() const
+{
+    return mpWoundClosureForce;
+}
+
+template<unsigned DIM>
+double WoundHealingSimulation<DIM>::GetClosedWoundArea() const
+{
+    return mClosedWoundArea;
+}
+
+template<unsigned DIM>
+unsigned WoundHealingSimulation<DIM>::GetMaxClosedWoundNumNodes() const
+{
+    return mMaxClosedWoundNumNodes;
+}
+
+template<unsigned DIM>
+bool WoundHealingSimulation<DIM>::GetWoundsHaveClosed() const
+{
+    return mWoundsHaveClosed;
+}
+
+template<unsigned DIM>
+double WoundHealingSimulation<DIM>::GetWoundClosureTime() const
+{
+    return mWoundClosureTime;
+}
+
+template<unsigned DIM>
+void WoundHealingSimulation<DIM>::OutputSimulationParameters(out_stream& rParamsFile)
+{
+    if (mpWoundClosureForce)
+    {
+        *rParamsFile << "\t\t<ClosedWoundArea>" << mClosedWoundArea << "</ClosedWoundArea>\n";
+        *rParamsFile << "\t\t<MaxClosedWoundNumNodes>" << mMaxClosedWoundNumNodes << "</MaxClosedWoundNumNodes>\n";
+    }
+
+    // Call method on direct parent class
+    OffLatticeSimulation<DIM>::OutputSimulationParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class WoundHealingSimulation<2>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS1(WoundHealingSimulation, 2)
@@ -0,0 +1,292 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef WOUNDHEALINGSIMULATION_HPP_
+#define WOUNDHEALINGSIMULATION_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <boost/serialization/shared_ptr.hpp>
+
+#include "OffLatticeSimulation.hpp"
+#include "DisplacementControlledNumericalMethod.hpp"
+#include "WoundHealingForce.hpp"
+
+/**
+ * An off-lattice simulation for wound healing runs, whose time step can change from step
+ * to step, and which can stop once the wounds have closed.
+ *
+ * If the numerical method of the simulation is a DisplacementControlledNumericalMethod, the
+ * time step of each step is the one suggested by the method at the end of the step before,
+ * so large steps are taken while the tissue relaxes and small ones around swaps. The time
+ * step set with SetDt() is only used for the first step. With any other numerical method
+ * this behaves as an OffLatticeSimulation.
+ *
+ * The time step is only changed when the suggested step differs from it by more than a
+ * quarter, and it is rounded so that a whole number of steps reaches the end time. Changing
+ * it restarts the count of time steps in SimulationTime, which the sampling timestep multiple
+ * of the simulation counts from, so adaptive runs are best followed with WoundMetricsModifier
+ * and WoundSnapshotModifier, which go by simulation time.
+ *
+ * With SetWoundClosureStoppingEvent(), the simulation stops before its end time once every
+ * wound followed by a WoundHealingForce has closed. A wound counts as closed when its ring
+ * has shrunk to a few nodes, as a vertex mesh cannot close a hole any further than a
+ * triangle, or when the ring has gone altogether. The wounds also count as closed when
+ * their total area falls to a threshold. The check is made before each step from the rings
+ * found at the step before, at a cost proportional to the number of wound nodes.
+ *
+ * If the project is built with the WOUND_HEALING_USE_TRACING option and WoundHealingTracer is
+ * recording, each time step is traced with three phases: the update of the cell population
+ * (with its ReMesh() and the number of T1 swaps), UpdateCellLocationsAndTopology() (with the
+ * forces), and the modifiers and output. The output after the last time step is not traced, as
+ * Solve() gives no hook after it.
+ */
+template<unsigned DIM>
+class WoundHealingSimulation : public OffLatticeSimulation<DIM>
+{
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<OffLatticeSimulation<DIM> >(*this);
+        archive & mpWoundClosureForce;
+        archive & mClosedWoundArea;
+        archive & mMaxClosedWoundNumNodes;
+    }
+
+    /** The force whose wounds are checked for closure, or null if the simulation does not stop early. */
+    boost::shared_ptr<WoundHealingForce<DIM> > mpWoundClosureForce;
+
+    /** The wounds count as closed when their total area is at most this. */
+    double mClosedWoundArea;
+
+    /** A wound counts as closed when its ring has at most this many nodes. */
+    unsigned mMaxClosedWoundNumNodes;
+
+    /** Whether the wounds closed in the last call to Solve(). */
+    bool mWoundsHaveClosed;
+
+    /** The time at which the wounds closed in the last call to Solve(). */
+    double mWoundClosureTime;
+
+    /** The number of time steps taken by the last call to Solve(). */
+    unsigned mNumTimeSteps;
+
+    /** The number of times the time step was changed in the last call to Solve(). */
+    unsigned mNumTimestepChanges;
+
+    /** Whether a traced time step has been started and not yet ended. Not archived. */
+    bool mTraceStepIsOpen;
+
+    /** When the traced time step started, as given by WoundHealingTracer::Now(). */
+    unsigned long long mTraceStepStart;
+
+    /** When the traced phase of the time step started, as given by WoundHealingTracer::Now(). */
+    unsigned long long mTracePhaseStart;
+
+    /** The number of T1 swap locations held by the mesh when the traced time step started. */
+    unsigned mTraceNumT1Swaps;
+
+    /**
+     * Change the time step to the one suggested by the numerical method, if it is
+     * a DisplacementControlledNumericalMethod.
+     */
+    void AdaptTimestep();
+
+    /**
+     * @return whether all the wounds of the wound closure force have closed
+     */
+    bool WoundsHaveClosed();
+
+    /**
+     * @return the number of T1 swap locations held by the mesh, or 0 if the population is not vertex based
+     */
+    unsigned GetNumT1SwapLocations();
+
+    /**
+     * Start a traced time step, if the tracer is recording. Its first phase is the update of
+     * the cell population, which removes dead cells and carries out swaps in ReMesh().
+     */
+    void TraceStartOfStep();
+
+    /**
+     * End the traced update of the cell population, recording the number of T1 swaps it carried out.
+     */
+    void TraceEndOfCellPopulationUpdate();
+
+    /**
+     * End the traced time step, whose last phase holds the modifiers and output.
+     */
+    void TraceEndOfStep();
+
+protected:
+
+    /**
+     * Overridden SetupSolve() method. Resets the step counts.
+     */
+    virtual void SetupSolve();
+
+    /**
+     * Overridden UpdateCellLocationsAndTopology() method. Picks the time step before the
+     * nodes are moved.
+     */
+    virtual void UpdateCellLocationsAndTopology();
+
+    /**
+     * Overridden StoppingEventHasOccurred() method. Stops the simulation once the wounds have
+     * closed, if a wound closure stopping event has been set.
+     *
+     * @return whether the wounds have closed
+     */
+    virtual bool StoppingEventHasOccurred();
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rCellPopulation Reference to a cell population object
+     * @param deleteCellPopulationInDestructor Whether to delete the cell population on destruction to
+     *     free up memory (defaults to false)
+     * @param initialiseCells Whether to initialise cells (defaults to true, set to false when loading
+     *     from an archive)
+     */
+    WoundHealingSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                           bool deleteCellPopulationInDestructor=false,
+                           bool initialiseCells=true);
+
+    /**
+     * @return the number of time steps taken by the last call to Solve()
+     */
+    unsigned GetNumTimeSteps() const;
+
+    /**
+     * @return the number of times the time step was changed in the last call to Solve()
+     */
+    unsigned GetNumTimestepChanges() const;
+
+    /**
+     * Stop the simulation once the wounds followed by a force have closed.
+     *
+     * @param pWoundForce the force whose wounds are followed. It must be one of the forces of the simulation.
+     * @param closedWoundArea the wounds count as closed when their total area is at most this (defaults to 0)
+     * @param maxClosedWoundNumNodes a wound counts as closed when its ring has at most this many nodes (defaults to 3)
+     */
+    void SetWoundClosureStoppingEvent(boost::shared_ptr<WoundHealingForce<DIM> > pWoundForce,
+                                      double closedWoundArea=0.0,
+                                      unsigned maxClosedWoundNumNodes=3);
+
+    /**
+     * @return the force whose wounds are checked for closure, or null if there is no wound closure stopping event
+     */
+    boost::shared_ptr<WoundHealingForce<DIM> > GetWoundClosureForce() const;
+
+    /**
+     * @return the total wound area at or below which the wounds count as closed
+     */
+    double GetClosedWoundArea() const;
+
+    /**
+     * @return the number of nodes at or below which a wound counts as closed
+     */
+    unsigned GetMaxClosedWoundNumNodes() const;
+
+    /**
+     * @return whether the wounds closed in the last call to Solve()
+     */
+    bool GetWoundsHaveClosed() const;
+
+    /**
+     * @return the time at which the wounds closed in the last call to Solve(). Only valid if GetWoundsHaveClosed() is true.
+     */
+    double GetWoundClosureTime() const;
+
+    /**
+     * Overridden OutputSimulationParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    virtual void OutputSimulationParameters(out_stream& rParamsFile);
+};
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS1(WoundHealingSimulation, 2)
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Serialize information required to construct a WoundHealingSimulation.
+ */
+template<class Archive, unsigned DIM>
+inline void save_construct_data(
+    Archive & ar, const WoundHealingSimulation<DIM> * t, const unsigned int file_version)
+{
+    // Save data required to construct instance
+    const AbstractCellPopulation<DIM>* p_cell_population = &(t->rGetCellPopulation());
+    ar & p_cell_population;
+}
+
+/**
+ * De-serialize constructor parameters and initialise a WoundHealingSimulation.
+ */
+template<class Archive, unsigned DIM>
+inline void load_construct_data(
+    Archive & ar, WoundHealingSimulation<DIM> * t, const unsigned int file_version)
+{
+    // Retrieve data from archive required to construct new instance
+    AbstractCellPopulation<DIM>* p_cell_population;
+    ar >> p_cell_population;
+
+    // Invoke inplace constructor to initialise instance, last two variables set extra
+    // member variables to be deleted as they are loaded from archive and to not initialise cells.
+    ::new(t)WoundHealingSimulation<DIM>(*p_cell_population, true, false);
+}
+}
+} // namespace
+
+#endif /*WOUNDHEALINGSIMULATION_HPP_*/
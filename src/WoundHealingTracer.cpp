@@ -0,0 +1,313 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "WoundHealingTracer.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+/** The buffer of the calling thread, once it has recorded an event. */
+thread_local void* tp_thread_buffer = nullptr;
+
+/**
+ * Write a string as a JSON string.
+ *
+ * @param rFile the file to write to
+ * @param pString the string
+ */
+void WriteJsonString(std::ofstream& rFile, const char* pString)
+{
+    rFile << '"';
+    for (const char* p_char = pString; *p_char != '\0'; p_char++)
+    {
+        if (*p_char == '"' || *p_char == '\\')
+        {
+            rFile << '\\';
+        }
+        rFile << *p_char;
+    }
+    rFile << '"';
+}
+}
+
+WoundHealingTracer::Scope::Scope(const char* name)
+    : mName(nullptr),
+      mStart(0)
+{
+    WoundHealingTracer* p_tracer = WoundHealingTracer::Instance();
+    if (p_tracer->IsRecording())
+    {
+        mName = name;
+        mStart = p_tracer->Now();
+    }
+}
+
+WoundHealingTracer::Scope::~Scope()
+{
+    if (mName != nullptr)
+    {
+        WoundHealingTracer* p_tracer = WoundHealingTracer::Instance();
+        p_tracer->RecordComplete(mName, mStart, p_tracer->Now());
+    }
+}
+
+WoundHealingTracer::WoundHealingTracer()
+    : mIsRecording(false),
+      mRecording(0),
+      mEventsPerThread(0),
+      mEpoch(std::chrono::steady_clock::now())
+{
+}
+
+WoundHealingTracer* WoundHealingTracer::Instance()
+{
+    // Never destroyed, as threads keep pointers to their buffers
+    static WoundHealingTracer* p_instance = new WoundHealingTracer();
+    return p_instance;
+}
+
+bool WoundHealingTracer::IsEnabled()
+{
+#ifdef WOUND_HEALING_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void WoundHealingTracer::Start(unsigned eventsPerThread)
+{
+    unsigned events_per_thread = 1;
+    while (events_per_thread < eventsPerThread)
+    {
+        events_per_thread *= 2;
+    }
+    mEventsPerThread.store(events_per_thread, std::memory_order_relaxed);
+
+    // Each thread clears its own buffer when it first records in the new recording
+    mRecording.fetch_add(1, std::memory_order_release);
+    mIsRecording.store(true, std::memory_order_release);
+}
+
+void WoundHealingTracer::Stop()
+{
+    mIsRecording.store(false, std::memory_order_release);
+}
+
+bool WoundHealingTracer::IsRecording() const
+{
+    return mIsRecording.load(std::memory_order_relaxed);
+}
+
+unsigned long long WoundHealingTracer::Now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mEpoch).count();
+}
+
+void WoundHealingTracer::SetThreadName(const std::string& rName)
+{
+    ThreadBuffer& r_buffer = rGetThreadBuffer();
+    std::lock_guard<std::mutex> lock(mMutex);
+    r_buffer.mThreadName = rName;
+}
+
+void WoundHealingTracer::RecordComplete(const char* name,
+                                        unsigned long long start,
+                                        unsigned long long end,
+                                        const char* argName,
+                                        double argValue)
+{
+    if (IsRecording())
+    {
+        Event event = {name, argName, argValue, start, end > start ? end - start : 0, 'X'};
+        Record(event);
+    }
+}
+
+void WoundHealingTracer::RecordInstant(const char* name, const char* argName, double argValue)
+{
+    if (IsRecording())
+    {
+        Event event = {name, argName, argValue, Now(), 0, 'i'};
+        Record(event);
+    }
+}
+
+void WoundHealingTracer::RecordCounter(const char* name, double value)
+{
+    if (IsRecording())
+    {
+        Event event = {name, "value", value, Now(), 0, 'C'};
+        Record(event);
+    }
+}
+
+WoundHealingTracer::ThreadBuffer& WoundHealingTracer::rGetThreadBuffer()
+{
+    ThreadBuffer* p_buffer = static_cast<ThreadBuffer*>(tp_thread_buffer);
+    if (p_buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBuffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+        p_buffer = mBuffers.back().get();
+        p_buffer->mThreadId = mBuffers.size() - 1;
+        p_buffer->mThreadName = "thread " + std::to_string(p_buffer->mThreadId);
+        p_buffer->mHead.store(0, std::memory_order_relaxed);
+        p_buffer->mRecording.store(0, std::memory_order_relaxed);
+        tp_thread_buffer = p_buffer;
+    }
+
+    // Only the owning thread changes its buffer, but the readers look at its size, so it is cleared under the lock
+    unsigned recording = mRecording.load(std::memory_order_acquire);
+    if (p_buffer->mRecording.load(std::memory_order_relaxed) != recording)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        p_buffer->mEvents.resize(mEventsPerThread.load(std::memory_order_relaxed));
+        p_buffer->mHead.store(0, std::memory_order_release);
+        p_buffer->mRecording.store(recording, std::memory_order_release);
+    }
+    return *p_buffer;
+}
+
+void WoundHealingTracer::Record(const Event& rEvent)
+{
+    ThreadBuffer& r_buffer = rGetThreadBuffer();
+    unsigned long long head = r_buffer.mHead.load(std::memory_order_relaxed);
+    r_buffer.mEvents[head & (r_buffer.mEvents.size() - 1)] = rEvent;
+    r_buffer.mHead.store(head + 1, std::memory_order_release);
+}
+
+unsigned long long WoundHealingTracer::GetNumEvents() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    unsigned recording = mRecording.load(std::memory_order_acquire);
+    unsigned long long num_events = 0;
+    for (unsigned i=0; i<mBuffers.size(); i++)
+    {
+        if (mBuffers[i]->mRecording.load(std::memory_order_acquire) == recording)
+        {
+            unsigned long long head = mBuffers[i]->mHead.load(std::memory_order_acquire);
+            num_events += std::min<unsigned long long>(head, mBuffers[i]->mEvents.size());
+        }
+    }
+    return num_events;
+}
+
+unsigned long long WoundHealingTracer::GetNumOverwrittenEvents() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    unsigned recording = mRecording.load(std::memory_order_acquire);
+    unsigned long long num_overwritten = 0;
+    for (unsigned i=0; i<mBuffers.size(); i++)
+    {
+        unsigned long long head = mBuffers[i]->mHead.load(std::memory_order_acquire);
+        if (mBuffers[i]->mRecording.load(std::memory_order_acquire) == recording && head > mBuffers[i]->mEvents.size())
+        {
+            num_overwritten += head - mBuffers[i]->mEvents.size();
+        }
+    }
+    return num_overwritten;
+}
+
+void WoundHealingTracer::WriteChromeTrace(const std::string& rPath) const
+{
+    if (IsRecording())
+    {
+        EXCEPTION("The tracer must be stopped before its trace is written");
+    }
+
+    std::ofstream file(rPath.c_str(), std::ios::trunc);
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open the trace file " + rPath);
+    }
+
+    // Times are in microseconds in this format, and kept to the nanosecond
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"wound_healing_comparison\"}}";
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    unsigned recording = mRecording.load(std::memory_order_acquire);
+    for (unsigned buffer_index=0; buffer_index<mBuffers.size(); buffer_index++)
+    {
+        const ThreadBuffer& r_buffer = *mBuffers[buffer_index];
+        if (r_buffer.mRecording.load(std::memory_order_acquire) != recording)
+        {
+            continue;
+        }
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << r_buffer.mThreadId << ",\"args\":{\"name\":";
+        WriteJsonString(file, r_buffer.mThreadName.c_str());
+        file << "}}";
+
+        // Once the buffer has wrapped round, its oldest event is the one at the head
+        unsigned long long head = r_buffer.mHead.load(std::memory_order_acquire);
+        unsigned long long capacity = r_buffer.mEvents.size();
+        for (unsigned long long i=(head > capacity ? head - capacity : 0); i<head; i++)
+        {
+            const Event& r_event = r_buffer.mEvents[i & (capacity - 1)];
+            file << ",\n{\"name\":";
+            WriteJsonString(file, r_event.mName);
+            file << ",\"ph\":\"" << r_event.mPhase << "\",\"pid\":0,\"tid\":" << r_buffer.mThreadId
+                 << ",\"ts\":" << 1e-3*r_event.mStart;
+            if (r_event.mPhase == 'X')
+            {
+                file << ",\"dur\":" << 1e-3*r_event.mDuration;
+            }
+            else if (r_event.mPhase == 'i')
+            {
+                file << ",\"s\":\"t\"";
+            }
+            if (r_event.mArgName != nullptr)
+            {
+                file << ",\"args\":{";
+                WriteJsonString(file, r_event.mArgName);
+                file << ":" << std::setprecision(10) << std::defaultfloat << r_event.mArgValue
+                     << std::fixed << std::setprecision(3) << "}";
+            }
+            file << "}";
+        }
+    }
+    file << "\n]}\n";
+    file.close();
+    if (file.fail())
+    {
+        EXCEPTION("Could not write the trace file " + rPath);
+    }
+}
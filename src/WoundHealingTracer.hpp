@@ -0,0 +1,281 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef WOUNDHEALINGTRACER_HPP_
+#define WOUNDHEALINGTRACER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * The trace points are only compiled in if WOUND_HEALING_TRACING is defined, which is done
+ * by the WOUND_HEALING_USE_TRACING CMake option. Otherwise the macros below expand to nothing.
+ * When they are compiled in, a trace point costs a single relaxed load unless the tracer has
+ * been started. Names must be string literals, as only the pointer is kept.
+ */
+#ifdef WOUND_HEALING_TRACING
+#define WOUND_HEALING_TRACE_SCOPE(name) \
+    WoundHealingTracer::Scope wound_healing_trace_scope(name)
+#define WOUND_HEALING_TRACE_INSTANT(name, argName, argValue) \
+    WoundHealingTracer::Instance()->RecordInstant(name, argName, argValue)
+#define WOUND_HEALING_TRACE(statement) statement
+#else
+#define WOUND_HEALING_TRACE_SCOPE(name)
+#define WOUND_HEALING_TRACE_INSTANT(name, argName, argValue)
+#define WOUND_HEALING_TRACE(statement)
+#endif
+
+/**
+ * Records a timeline of the phases of wound healing simulations, and writes it in the Chrome
+ * trace event format, which chrome://tracing and the Perfetto UI (ui.perfetto.dev) can open.
+ * Sampling profiles can then be tied to the steps, swaps, rebuilds and output that caused them.
+ *
+ * There is one tracer per process. Each thread that records an event is given its own ring
+ * buffer the first time it does so. Recording is lock-free: a thread only writes to its own
+ * buffer, and publishes each event by advancing the head of the buffer. The lock is only taken
+ * when a thread first records in a recording, to size its buffer, as the readers look at the
+ * buffers under the lock. Once a buffer is full, the oldest events are overwritten, so a long
+ * run keeps its last events.
+ *
+ * The buffers are only read by WriteChromeTrace(), which must be called once the tracer has
+ * been stopped and the traced threads are no longer recording.
+ */
+class WoundHealingTracer
+{
+public:
+
+    /**
+     * Records the time between its construction and destruction as a complete event, if the
+     * tracer was recording when it was constructed.
+     */
+    class Scope
+    {
+    private:
+
+        /** The name of the event, or null if the tracer was not recording. */
+        const char* mName;
+
+        /** When the scope was entered, in nanoseconds since the tracer was created. */
+        unsigned long long mStart;
+
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param name the name of the event
+         */
+        explicit Scope(const char* name);
+
+        /**
+         * Destructor. Records the event.
+         */
+        ~Scope();
+    };
+
+    /**
+     * @return the tracer of this process
+     */
+    static WoundHealingTracer* Instance();
+
+    /**
+     * @return whether the trace points were compiled in
+     */
+    static bool IsEnabled();
+
+    /**
+     * Start recording. Any events left from an earlier recording are discarded.
+     *
+     * @param eventsPerThread the number of events kept per thread, rounded up to a power of two (defaults to 2^16)
+     */
+    void Start(unsigned eventsPerThread=65536u);
+
+    /**
+     * Stop recording. The recorded events are kept until the next call to Start().
+     */
+    void Stop();
+
+    /**
+     * @return whether the tracer is recording
+     */
+    bool IsRecording() const;
+
+    /**
+     * @return the current time, in nanoseconds since the tracer was created
+     */
+    unsigned long long Now() const;
+
+    /**
+     * Name the calling thread in the trace. The name is copied.
+     *
+     * @param rName the name
+     */
+    void SetThreadName(const std::string& rName);
+
+    /**
+     * Record a complete event on the calling thread, if recording.
+     *
+     * @param name the name of the event
+     * @param start when the event started, as returned by Now()
+     * @param end when the event ended, as returned by Now()
+     * @param argName the name of a number to attach to the event, or null for none
+     * @param argValue the number
+     */
+    void RecordComplete(const char* name,
+                        unsigned long long start,
+                        unsigned long long end,
+                        const char* argName=nullptr,
+                        double argValue=0.0);
+
+    /**
+     * Record an instant event on the calling thread, if recording.
+     *
+     * @param name the name of the event
+     * @param argName the name of a number to attach to the event, or null for none
+     * @param argValue the number
+     */
+    void RecordInstant(const char* name, const char* argName=nullptr, double argValue=0.0);
+
+    /**
+     * Record the value of a counter on the calling thread, if recording. Counters are drawn
+     * as a graph over time.
+     *
+     * @param name the name of the counter
+     * @param value its value
+     */
+    void RecordCounter(const char* name, double value);
+
+    /**
+     * @return the number of events held in the buffers
+     */
+    unsigned long long GetNumEvents() const;
+
+    /**
+     * @return the number of events that were overwritten because a buffer was full
+     */
+    unsigned long long GetNumOverwrittenEvents() const;
+
+    /**
+     * Write the recorded events in the Chrome trace event JSON format. The tracer must have
+     * been stopped.
+     *
+     * @param rPath the absolute path of the file to write
+     */
+    void WriteChromeTrace(const std::string& rPath) const;
+
+private:
+
+    /** A recorded event. */
+    struct Event
+    {
+        /** The name of the event. */
+        const char* mName;
+
+        /** The name of the number attached to the event, or null. */
+        const char* mArgName;
+
+        /** The number attached to the event. */
+        double mArgValue;
+
+        /** When the event started, in nanoseconds since the tracer was created. */
+        unsigned long long mStart;
+
+        /** How long the event lasted, in nanoseconds. */
+        unsigned long long mDuration;
+
+        /** The Chrome trace phase of the event: 'X' for complete, 'i' for instant, 'C' for counter. */
+        char mPhase;
+    };
+
+    /** The ring buffer of one thread. */
+    struct ThreadBuffer
+    {
+        /** The id of the thread in the trace. */
+        unsigned mThreadId;
+
+        /** The name of the thread in the trace. */
+        std::string mThreadName;
+
+        /** The events. Its size is a power of two, and it is only resized under the lock. */
+        std::vector<Event> mEvents;
+
+        /** The number of events recorded since the tracer was started. Only advanced by the owning thread. */
+        std::atomic<unsigned long long> mHead;
+
+        /** The recording the buffer was last cleared for. Only changed by the owning thread, under the lock. */
+        std::atomic<unsigned> mRecording;
+    };
+
+    /** Whether the tracer is recording. */
+    std::atomic<bool> mIsRecording;
+
+    /** The number of times the tracer has been started. */
+    std::atomic<unsigned> mRecording;
+
+    /** The number of events kept per thread. */
+    std::atomic<unsigned> mEventsPerThread;
+
+    /** The time the tracer was created, from which event times are measured. */
+    std::chrono::steady_clock::time_point mEpoch;
+
+    /** Guards the list of buffers, which only changes when a thread records its first event. */
+    mutable std::mutex mMutex;
+
+    /** The buffers of all threads that have recorded events. They live as long as the tracer. */
+    std::vector<std::unique_ptr<ThreadBuffer> > mBuffers;
+
+    /**
+     * Constructor. The tracer starts stopped.
+     */
+    WoundHealingTracer();
+
+    /**
+     * @return the buffer of the calling thread, created if needed and cleared if it holds events of an earlier recording
+     */
+    ThreadBuffer& rGetThreadBuffer();
+
+    /**
+     * Add an event to the buffer of the calling thread.
+     *
+     * @param rEvent the event
+     */
+    void Record(const Event& rEvent);
+};
+
+#endif /*WOUNDHEALINGTRACER_HPP_*/
@@ -0,0 +1,452 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#include "WoundMeshBuilder.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+WoundMeshBuilder::WoundMeshBuilder(MutableVertexMesh<2,2>& rMesh)
+    : mrMesh(rMesh),
+      mElementCentroids(rMesh.GetNumAllElements(), zero_vector<double>(2)),
+      mElementAreas(rMesh.GetNumAllElements(), 0.0),
+      mIsElementKept(rMesh.GetNumAllElements(), false),
+      mNumKeptElements(0),
+      mScaleFactor(1.0),
+      mHasBeenBuilt(false),
+      mGridOrigin(zero_vector<double>(2)),
+      mGridSpacing(1.0),
+      mNumGridColumns(1),
+      mNumGridRows(1)
+{
+    // The centroid and area of each element come from the same loop over its nodes. The node
+    // locations are taken relative to the first node, so that this also works for periodic meshes.
+    for (unsigned elem_index=0; elem_index<mrMesh.GetNumAllElements(); elem_index++)
+    {
+        VertexElement<2,2>* p_element = mrMesh.GetElement(elem_index);
+        if (p_element->IsDeleted())
+        {
+            continue;
+        }
+
+        unsigned num_nodes = p_element->GetNumNodes();
+        const c_vector<double, 2>& r_first_location = p_element->GetNode(0)->rGetLocation();
+        c_vector<double, 2> previous = zero_vector<double>(2);
+        double twice_signed_area = 0.0;
+        c_vector<double, 2> weighted_sum = zero_vector<double>(2);
+        for (unsigned local_index=1; local_index<=num_nodes; local_index++)
+        {
+            c_vector<double, 2> current = zero_vector<double>(2);
+            if (local_index < num_nodes)
+            {
+                current = mrMesh.GetVectorFromAtoB(r_first_location, p_element->GetNode(local_index)->rGetLocation());
+            }
+            double cross = previous[0]*current[1] - current[0]*previous[1];
+            twice_signed_area += cross;
+            weighted_sum += cross*(previous + current);
+            previous = current;
+        }
+
+        c_vector<double, 2> centroid = r_first_location;
+        if (twice_signed_area != 0.0)
+        {
+            centroid += weighted_sum/(3.0*twice_signed_area);
+        }
+        mElementCentroids[elem_index] = centroid;
+        mElementAreas[elem_index] = 0.5*fabs(twice_signed_area);
+        mIsElementKept[elem_index] = true;
+        mNumKeptElements++;
+    }
+
+    BuildGrid();
+}
+
+void WoundMeshBuilder::BuildGrid()
+{
+    mGridCellStarts.assign(2, 0);
+    mGridElements.clear();
+    if (mNumKeptElements == 0)
+    {
+        return;
+    }
+
+    c_vector<double, 2> lower = zero_vector<double>(2);
+    c_vector<double, 2> upper = zero_vector<double>(2);
+    double total_area = 0.0;
+    bool is_first = true;
+    for (unsigned elem_index=0; elem_index<mElementCentroids.size(); elem_index++)
+    {
+        if (!mIsElementKept[elem_index])
+        {
+            continue;
+        }
+        const c_vector<double, 2>& r_centroid = mElementCentroids[elem_index];
+        for (unsigned dim=0; dim<2; dim++)
+        {
+            lower[dim] = is_first ? r_centroid[dim] : std::min(lower[dim], r_centroid[dim]);
+            upper[dim] = is_first ? r_centroid[dim] : std::max(upper[dim], r_centroid[dim]);
+        }
+        total_area += mElementAreas[elem_index];
+        is_first = false;
+    }
+
+    // Aim for about one element per grid cell, but never more grid cells than a few times the elements
+    mGridOrigin = lower;
+    mGridSpacing = sqrt(total_area/mNumKeptElements);
+    double min_spacing = sqrt((upper[0] - lower[0])*(upper[1] - lower[1])/(4.0*mNumKeptElements));
+    mGridSpacing = std::max(mGridSpacing, min_spacing);
+    if (!(mGridSpacing > 0.0))
+    {
+        mGridSpacing = 1.0;
+    }
+    mNumGridColumns = 1 + (unsigned)floor((upper[0] - lower[0])/mGridSpacing);
+    mNumGridRows = 1 + (unsigned)floor((upper[1] - lower[1])/mGridSpacing);
+
+    // Counting sort of the elements by grid cell
+    unsigned num_cells = mNumGridColumns*mNumGridRows;
+    std::vector<unsigned> cell_of_element(mElementCentroids.size(), num_cells);
+    mGridCellStarts.assign(num_cells + 1, 0);
+    for (unsigned elem_index=0; elem_index<mElementCentroids.size(); elem_index++)
+    {
+        if (mIsElementKept[elem_index])
+        {
+            const c_vector<double, 2>& r_centroid = mElementCentroids[elem_index];
+            unsigned column = std::min((unsigned)floor((r_centroid[0] - mGridOrigin[0])/mGridSpacing), mNumGridColumns - 1);
+            unsigned row = std::min((unsigned)floor((r_centroid[1] - mGridOrigin[1])/mGridSpacing), mNumGridRows - 1);
+            cell_of_element[elem_index] = row*mNumGridColumns + column;
+            mGridCellStarts[cell_of_element[elem_index] + 1]++;
+        }
+    }
+    for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+    {
+        mGridCellStarts[cell_index + 1] += mGridCellStarts[cell_index];
+    }
+    mGridElements.resize(mNumKeptElements);
+    std::vector<unsigned> next_slot(mGridCellStarts.begin(), mGridCellStarts.end() - 1);
+    for (unsigned elem_index=0; elem_index<mElementCentroids.size(); elem_index++)
+    {
+        if (cell_of_element[elem_index] < num_cells)
+        {
+            mGridElements[next_slot[cell_of_element[elem_index]]++] = elem_index;
+        }
+    }
+}
+
+template<typename TEST>
+std::vector<unsigned> WoundMeshBuilder::GetKeptElementsInBox(const c_vector<double, 2>& rLower,
+                                                             const c_vector<double, 2>& rUpper,
+                                                             TEST isInside) const
+{
+    std::vector<unsigned> element_indices;
+    if (mGridElements.empty())
+    {
+        return element_indices;
+    }
+
+    // The range of grid cells overlapping the box, clamped to the grid
+    int first_column = (int)floor((rLower[0] - mGridOrigin[0])/mGridSpacing);
+    int last_column = (int)floor((rUpper[0] - mGridOrigin[0])/mGridSpacing);
+    int first_row = (int)floor((rLower[1] - mGridOrigin[1])/mGridSpacing);
+    int last_row = (int)floor((rUpper[1] - mGridOrigin[1])/mGridSpacing);
+    first_column = std::max(first_column, 0);
+    first_row = std::max(first_row, 0);
+    last_column = std::min(last_column, (int)mNumGridColumns - 1);
+    last_row = std::min(last_row, (int)mNumGridRows - 1);
+
+    for (int row=first_row; row<=last_row; row++)
+    {
+        for (int column=first_column; column<=last_column; column++)
+        {
+            unsigned cell_index = row*mNumGridColumns + column;
+            for (unsigned slot=mGridCellStarts[cell_index]; slot<mGridCellStarts[cell_index+1]; slot++)
+            {
+                unsigned elem_index = mGridElements[slot];
+                if (mIsElementKept[elem_index] && isInside(mElementCentroids[elem_index]))
+                {
+                    element_indices.push_back(elem_index);
+                }
+            }
+        }
+    }
+    std::sort(element_indices.begin(), element_indices.end());
+    return element_indices;
+}
+
+void WoundMeshBuilder::RemoveElements(const std::vector<unsigned>& rElementIndices)
+{
+    if (mHasBeenBuilt)
+    {
+        EXCEPTION("The mesh has already been built");
+    }
+    for (unsigned i=0; i<rElementIndices.size(); i++)
+    {
+        if (mIsElementKept[rElementIndices[i]])
+        {
+            mIsElementKept[rElementIndices[i]] = false;
+            mNumKeptElements--;
+        }
+    }
+}
+
+unsigned WoundMeshBuilder::GetNumKeptElements() const
+{
+    return mNumKeptElements;
+}
+
+bool WoundMeshBuilder::IsElementKept(unsigned elementIndex) const
+{
+    assert(elementIndex < mIsElementKept.size());
+    return mIsElementKept[elementIndex];
+}
+
+c_vector<double, 2> WoundMeshBuilder::GetCentroidOfElement(unsigned elementIndex) const
+{
+    assert(elementIndex < mElementCentroids.size());
+    return mScaleFactor*mElementCentroids[elementIndex];
+}
+
+double WoundMeshBuilder::GetAreaOfElement(unsigned elementIndex) const
+{
+    assert(elementIndex < mElementAreas.size());
+    return mScaleFactor*mScaleFactor*mElementAreas[elementIndex];
+}
+
+c_vector<double, 2> WoundMeshBuilder::GetCentroidOfKeptElements() const
+{
+    c_vector<double, 2> centroid = zero_vector<double>(2);
+    for (unsigned elem_index=0; elem_index<mElementCentroids.size(); elem_index++)
+    {
+        if (mIsElementKept[elem_index])
+        {
+            centroid += mElementCentroids[elem_index];
+        }
+    }
+    if (mNumKeptElements > 0)
+    {
+        centroid *= mScaleFactor/mNumKeptElements;
+    }
+    return centroid;
+}
+
+double WoundMeshBuilder::GetMeanAreaOfKeptElements() const
+{
+    double mean_area = 0.0;
+    for (unsigned elem_index=0; elem_index<mElementAreas.size(); elem_index++)
+    {
+        if (mIsElementKept[elem_index])
+        {
+            mean_area += mElementAreas[elem_index];
+        }
+    }
+    if (mNumKeptElements > 0)
+    {
+        mean_area *= mScaleFactor*mScaleFactor/mNumKeptElements;
+    }
+    return mean_area;
+}
+
+unsigned WoundMeshBuilder::RemoveElementsWithMoreNodesThan(unsigned maxNumNodes)
+{
+    std::vector<unsigned> large_elements;
+    for (unsigned elem_index=0; elem_index<mIsElementKept.size(); elem_index++)
+    {
+        if (mIsElementKept[elem_index] && mrMesh.GetElement(elem_index)->GetNumNodes() > maxNumNodes)
+        {
+            large_elements.push_back(elem_index);
+        }
+    }
+    RemoveElements(large_elements);
+    return large_elements.size();
+}
+
+void WoundMeshBuilder::SetScaleFactor(double scaleFactor)
+{
+    if (!(scaleFactor > 0.0))
+    {
+        EXCEPTION("The scale factor must be positive");
+    }
+    if (!mWoundCentres.empty())
+    {
+        EXCEPTION("The mesh must be rescaled before any wounds are cut");
+    }
+    mScaleFactor = scaleFactor;
+}
+
+double WoundMeshBuilder::GetScaleFactor() const
+{
+    return mScaleFactor;
+}
+
+void WoundMeshBuilder::RescaleToMeanElementArea(double targetMeanArea)
+{
+    if (mNumKeptElements == 0)
+    {
+        EXCEPTION("There are no elements left to rescale");
+    }
+    double mean_area = GetMeanAreaOfKeptElements()/(mScaleFactor*mScaleFactor);
+    SetScaleFactor(sqrt(targetMeanArea/mean_area));
+}
+
+std::vector<unsigned> WoundMeshBuilder::GetElementsInCircle(const c_vector<double, 2>& rCentre, double radius) const
+{
+    // Work in the coordinates of the mesh before rescaling, as the grid does
+    c_vector<double, 2> centre = rCentre/mScaleFactor;
+    double radius_squared = radius*radius/(mScaleFactor*mScaleFactor);
+    c_vector<double, 2> half_diagonal;
+    half_diagonal[0] = radius/mScaleFactor;
+    half_diagonal[1] = radius/mScaleFactor;
+
+    return GetKeptElementsInBox(centre - half_diagonal, centre + half_diagonal,
+        [&centre, radius_squared](const c_vector<double, 2>& rCentroid)
+        {
+            double dx = rCentroid[0] - centre[0];
+            double dy = rCentroid[1] - centre[1];
+            return dx*dx + dy*dy < radius_squared;
+        });
+}
+
+std::vector<unsigned> WoundMeshBuilder::GetElementsInPolygon(const std::vector<c_vector<double, 2> >& rVertices) const
+{
+    if (rVertices.size() < 3)
+    {
+        EXCEPTION("A polygon needs at least three vertices");
+    }
+
+    std::vector<c_vector<double, 2> > vertices(rVertices.size());
+    c_vector<double, 2> lower = rVertices[0]/mScaleFactor;
+    c_vector<double, 2> upper = lower;
+    for (unsigned i=0; i<rVertices.size(); i++)
+    {
+        vertices[i] = rVertices[i]/mScaleFactor;
+        for (unsigned dim=0; dim<2; dim++)
+        {
+            lower[dim] = std::min(lower[dim], vertices[i][dim]);
+            upper[dim] = std::max(upper[dim], vertices[i][dim]);
+        }
+    }
+
+    // Even-odd rule: count the edges crossed by a ray from the centroid in the +x direction
+    return GetKeptElementsInBox(lower, upper,
+        [&vertices](const c_vector<double, 2>& rCentroid)
+        {
+            bool is_inside = false;
+            for (unsigned i=0, j=vertices.size()-1; i<vertices.size(); j=i++)
+            {
+                const c_vector<double, 2>& r_a = vertices[i];
+                const c_vector<double, 2>& r_b = vertices[j];
+                if ((r_a[1] > rCentroid[1]) != (r_b[1] > rCentroid[1]))
+                {
+                    double x_crossing = r_a[0] + (rCentroid[1] - r_a[1])*(r_b[0] - r_a[0])/(r_b[1] - r_a[1]);
+                    if (rCentroid[0] < x_crossing)
+                    {
+                        is_inside = !is_inside;
+                    }
+                }
+            }
+            return is_inside;
+        });
+}
+
+unsigned WoundMeshBuilder::CutCircularWound(const c_vector<double, 2>& rCentre, double radius)
+{
+    std::vector<unsigned> wound_elements = GetElementsInCircle(rCentre, radius);
+    RemoveElements(wound_elements);
+    mWoundCentres.push_back(rCentre);
+    return wound_elements.size();
+}
+
+unsigned WoundMeshBuilder::CutCircularWound(double radius)
+{
+    return CutCircularWound(GetCentroidOfKeptElements(), radius);
+}
+
+unsigned WoundMeshBuilder::CutPolygonalWound(const std::vector<c_vector<double, 2> >& rVertices)
+{
+    std::vector<unsigned> wound_elements = GetElementsInPolygon(rVertices);
+    RemoveElements(wound_elements);
+
+    // The centre of the wound is the centroid of the polygon
+    double twice_signed_area = 0.0;
+    c_vector<double, 2> weighted_sum = zero_vector<double>(2);
+    for (unsigned i=0; i<rVertices.size(); i++)
+    {
+        c_vector<double, 2> a = rVertices[i] - rVertices[0];
+        c_vector<double, 2> b = rVertices[(i+1)%rVertices.size()] - rVertices[0];
+        double cross = a[0]*b[1] - b[0]*a[1];
+        twice_signed_area += cross;
+        weighted_sum += cross*(a + b);
+    }
+    c_vector<double, 2> centre = rVertices[0];
+    if (twice_signed_area != 0.0)
+    {
+        centre += weighted_sum/(3.0*twice_signed_area);
+    }
+    mWoundCentres.push_back(centre);
+    return wound_elements.size();
+}
+
+const std::vector<c_vector<double, 2> >& WoundMeshBuilder::rGetWoundCentres() const
+{
+    return mWoundCentres;
+}
+
+void WoundMeshBuilder::Build()
+{
+    if (mHasBeenBuilt)
+    {
+        EXCEPTION("The mesh has already been built");
+    }
+    mHasBeenBuilt = true;
+
+    // Rescale before remeshing, so that the swap thresholds apply to the rescaled mesh
+    if (mScaleFactor != 1.0)
+    {
+        for (unsigned node_index=0; node_index<mrMesh.GetNumAllNodes(); node_index++)
+        {
+            mrMesh.GetNode(node_index)->rGetModifiableLocation() *= mScaleFactor;
+        }
+    }
+
+    for (unsigned elem_index=0; elem_index<mIsElementKept.size(); elem_index++)
+    {
+        if (!mIsElementKept[elem_index] && !mrMesh.GetElement(elem_index)->IsDeleted())
+        {
+            mrMesh.DeleteElementPriorToReMesh(elem_index);
+        }
+    }
+    mrMesh.ReMesh();
+}
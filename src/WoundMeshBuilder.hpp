@@ -0,0 +1,262 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef WOUNDMESHBUILDER_HPP_
+#define WOUNDMESHBUILDER_HPP_
+
+#include "MutableVertexMesh.hpp"
+
+#include <vector>
+
+/**
+ * Prepares a mesh for a wound healing simulation: removes unwanted elements, rescales
+ * the mesh and cuts one or more wounds into it, with a single ReMesh() at the end.
+ *
+ * The constructor makes one pass over the elements of the mesh, computing the centroid
+ * and area of each with the same loop over its nodes, and bins the centroids into a
+ * uniform grid with about one element per cell. Region queries (circles and polygons)
+ * then only visit the grid cells that overlap the region, so carving several wounds into
+ * a large mesh does not need a pass over all the elements for each wound.
+ *
+ * Nothing is changed in the mesh until Build(), which applies the rescaling in one pass
+ * over the nodes, deletes the chosen elements with DeleteElementPriorToReMesh() and calls
+ * ReMesh() once. All positions and lengths given to and returned by the builder are in
+ * the coordinates of the rescaled mesh, so set the rescaling before cutting wounds.
+ *
+ * Distances are measured without periodicity, so on a Toroidal2dVertexMesh the wounds
+ * should be kept away from the edges of the periodic domain.
+ */
+class WoundMeshBuilder
+{
+private:
+
+    /** The mesh being prepared. */
+    MutableVertexMesh<2,2>& mrMesh;
+
+    /** The centroid of each element of the mesh, before rescaling. */
+    std::vector<c_vector<double, 2> > mElementCentroids;
+
+    /** The area of each element of the mesh, before rescaling. */
+    std::vector<double> mElementAreas;
+
+    /** Whether each element of the mesh is kept, i.e. neither deleted already nor chosen for deletion. */
+    std::vector<bool> mIsElementKept;
+
+    /** The number of elements that are kept. */
+    unsigned mNumKeptElements;
+
+    /** The factor the node locations are multiplied by in Build(). */
+    double mScaleFactor;
+
+    /** Whether Build() has been called. */
+    bool mHasBeenBuilt;
+
+    /** The centre of each wound cut so far, in rescaled coordinates. */
+    std::vector<c_vector<double, 2> > mWoundCentres;
+
+    /** The lower left corner of the grid, before rescaling. */
+    c_vector<double, 2> mGridOrigin;
+
+    /** The width of the (square) grid cells, before rescaling. */
+    double mGridSpacing;
+
+    /** The number of columns of the grid. */
+    unsigned mNumGridColumns;
+
+    /** The number of rows of the grid. */
+    unsigned mNumGridRows;
+
+    /**
+     * The elements binned in each grid cell are mGridElements[mGridCellStarts[c]] up to,
+     * but not including, mGridElements[mGridCellStarts[c+1]], where cells are numbered by row.
+     */
+    std::vector<unsigned> mGridCellStarts;
+
+    /** The indices of the binned elements, grouped by grid cell. */
+    std::vector<unsigned> mGridElements;
+
+    /**
+     * Bin the centroids of the live elements into the grid.
+     */
+    void BuildGrid();
+
+    /**
+     * Collect the kept elements whose centroids lie in the grid cells overlapping a box,
+     * and pass them to a test of their centroid.
+     *
+     * @param rLower the lower left corner of the box, before rescaling
+     * @param rUpper the upper right corner of the box, before rescaling
+     * @param isInside the test of a centroid, before rescaling
+     * @return the indices of the elements that pass the test, in increasing order
+     */
+    template<typename TEST>
+    std::vector<unsigned> GetKeptElementsInBox(const c_vector<double, 2>& rLower,
+                                               const c_vector<double, 2>& rUpper,
+                                               TEST isInside) const;
+
+    /**
+     * Choose elements for deletion.
+     *
+     * @param rElementIndices the elements
+     */
+    void RemoveElements(const std::vector<unsigned>& rElementIndices);
+
+public:
+
+    /**
+     * Constructor. Computes the centroids and areas of the elements of the mesh and
+     * builds the spatial index.
+     *
+     * @param rMesh the mesh to prepare. It is not changed until Build() is called.
+     */
+    WoundMeshBuilder(MutableVertexMesh<2,2>& rMesh);
+
+    /**
+     * @return the number of elements that are kept so far
+     */
+    unsigned GetNumKeptElements() const;
+
+    /**
+     * @param elementIndex the index of an element
+     * @return whether the element is kept so far
+     */
+    bool IsElementKept(unsigned elementIndex) const;
+
+    /**
+     * @param elementIndex the index of an element
+     * @return the centroid of the element, in rescaled coordinates
+     */
+    c_vector<double, 2> GetCentroidOfElement(unsigned elementIndex) const;
+
+    /**
+     * @param elementIndex the index of an element
+     * @return the area of the element after rescaling
+     */
+    double GetAreaOfElement(unsigned elementIndex) const;
+
+    /**
+     * @return the mean of the centroids of the kept elements, in rescaled coordinates
+     */
+    c_vector<double, 2> GetCentroidOfKeptElements() const;
+
+    /**
+     * @return the mean area of the kept elements after rescaling
+     */
+    double GetMeanAreaOfKeptElements() const;
+
+    /**
+     * Choose the elements with more than a given number of nodes for deletion, as done for
+     * the large elements of the virtual leaf mesh.
+     *
+     * @param maxNumNodes the largest number of nodes of an element that is kept
+     * @return the number of elements chosen
+     */
+    unsigned RemoveElementsWithMoreNodesThan(unsigned maxNumNodes);
+
+    /**
+     * Set the factor the node locations are multiplied by in Build(). Must be called before
+     * any wounds are cut.
+     *
+     * @param scaleFactor the factor
+     */
+    void SetScaleFactor(double scaleFactor);
+
+    /**
+     * @return the factor the node locations are multiplied by in Build()
+     */
+    double GetScaleFactor() const;
+
+    /**
+     * Set the rescaling so that the mean area of the elements kept so far is a given value.
+     * Must be called before any wounds are cut.
+     *
+     * @param targetMeanArea the mean area of the elements after rescaling
+     */
+    void RescaleToMeanElementArea(double targetMeanArea);
+
+    /**
+     * @param rCentre the centre of a circle, in rescaled coordinates
+     * @param radius the radius of the circle, in rescaled units
+     * @return the kept elements whose centroids lie strictly inside the circle, in increasing order
+     */
+    std::vector<unsigned> GetElementsInCircle(const c_vector<double, 2>& rCentre, double radius) const;
+
+    /**
+     * @param rVertices the vertices of a simple polygon in either orientation, in rescaled coordinates
+     * @return the kept elements whose centroids lie inside the polygon, in increasing order
+     */
+    std::vector<unsigned> GetElementsInPolygon(const std::vector<c_vector<double, 2> >& rVertices) const;
+
+    /**
+     * Cut a circular wound, by choosing the elements whose centroids lie within it for deletion.
+     *
+     * @param rCentre the centre of the wound, in rescaled coordinates
+     * @param radius the radius of the wound, in rescaled units
+     * @return the number of elements chosen
+     */
+    unsigned CutCircularWound(const c_vector<double, 2>& rCentre, double radius);
+
+    /**
+     * Cut a circular wound into the middle of the mesh, centred on the mean of the
+     * centroids of the elements kept so far.
+     *
+     * @param radius the radius of the wound, in rescaled units
+     * @return the number of elements chosen
+     */
+    unsigned CutCircularWound(double radius);
+
+    /**
+     * Cut a polygonal wound, by choosing the elements whose centroids lie within it for deletion.
+     *
+     * @param rVertices the vertices of a simple polygon, in rescaled coordinates
+     * @return the number of elements chosen
+     */
+    unsigned CutPolygonalWound(const std::vector<c_vector<double, 2> >& rVertices);
+
+    /**
+     * @return the centre of each wound cut so far, in rescaled coordinates, which can be passed
+     * to WoundHealingForce::SetWoundCentres() for meshes with several wounds
+     */
+    const std::vector<c_vector<double, 2> >& rGetWoundCentres() const;
+
+    /**
+     * Rescale the mesh, delete the chosen elements and call ReMesh() once. The builder
+     * cannot be used to change the mesh again afterwards.
+     */
+    void Build();
+};
+
+#endif /*WOUNDMESHBUILDER_HPP_*/
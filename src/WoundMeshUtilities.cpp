@@ -0,0 +1,115 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "WoundMeshUtilities.hpp"
+#include "WoundMeshBuilder.hpp"
+
+#include <cmath>
+
+void WoundMeshUtilities::RemoveLargeElementsAndRescale(MutableVertexMesh<2,2>& rMesh, unsigned maxNumNodes, double targetMeanArea)
+{
+    WoundMeshBuilder builder(rMesh);
+    builder.RemoveElementsWithMoreNodesThan(maxNumNodes);
+    builder.RescaleToMeanElementArea(targetMeanArea);
+    builder.Build();
+}
+
+void WoundMeshUtilities::CutCircularWound(MutableVertexMesh<2,2>& rMesh, double woundRadius)
+{
+    WoundMeshBuilder builder(rMesh);
+    builder.CutCircularWound(woundRadius);
+    builder.Build();
+}
+
+void WoundMeshUtilities::CutCircularWound(VertexBasedCellPopulation<2>& rCellPopulation, double woundRadius)
+{
+    // Each live element of the population's mesh has a cell, so the builder chooses the same elements
+    WoundMeshBuilder builder(rCellPopulation.rGetMesh());
+    std::vector<unsigned> wound_elements = builder.GetElementsInCircle(builder.GetCentroidOfKeptElements(), woundRadius);
+    for (unsigned i=0; i<wound_elements.size(); i++)
+    {
+        rCellPopulation.GetCellUsingLocationIndex(wound_elements[i])->Kill();
+    }
+    rCellPopulation.RemoveDeadCells();
+    rCellPopulation.Update();
+}
+
+double WoundMeshUtilities::GetSignedAreaOfLoop(MutableVertexMesh<2,2>& rMesh, const std::vector<unsigned>& rLoop)
+{
+    if (rLoop.empty())
+    {
+        return 0.0;
+    }
+
+    // Use vectors relative to the first node, so that this also works on periodic meshes
+    const c_vector<double, 2>& r_first_location = rMesh.GetNode(rLoop[0])->rGetLocation();
+    double twice_area = 0.0;
+    c_vector<double, 2> this_vector = zero_vector<double>(2);
+    for (unsigned i=1; i<rLoop.size(); i++)
+    {
+        c_vector<double, 2> next_vector = rMesh.GetVectorFromAtoB(r_first_location, rMesh.GetNode(rLoop[i])->rGetLocation());
+        twice_area += this_vector[0]*next_vector[1] - this_vector[1]*next_vector[0];
+        this_vector = next_vector;
+    }
+    return 0.5*twice_area;
+}
+
+double WoundMeshUtilities::GetPerimeterOfLoop(MutableVertexMesh<2,2>& rMesh, const std::vector<unsigned>& rLoop)
+{
+    double perimeter = 0.0;
+    for (unsigned i=0; i<rLoop.size(); i++)
+    {
+        const c_vector<double, 2>& r_location = rMesh.GetNode(rLoop[i])->rGetLocation();
+        const c_vector<double, 2>& r_next_location = rMesh.GetNode(rLoop[(i + 1)%rLoop.size()])->rGetLocation();
+        perimeter += norm_2(rMesh.GetVectorFromAtoB(r_location, r_next_location));
+    }
+    return perimeter;
+}
+
+double WoundMeshUtilities::GetAreaOfWound(MutableVertexMesh<2,2>& rMesh, const std::vector<unsigned>& rWoundLoop)
+{
+    // Wound rings run clockwise, so have negative signed area
+    return -GetSignedAreaOfLoop(rMesh, rWoundLoop);
+}
+
+double WoundMeshUtilities::GetTotalAreaOfWounds(MutableVertexMesh<2,2>& rMesh, const std::vector<std::vector<unsigned> >& rWoundLoops)
+{
+    double total_area = 0.0;
+    for (unsigned wound_index=0; wound_index<rWoundLoops.size(); wound_index++)
+    {
+        total_area += GetAreaOfWound(rMesh, rWoundLoops[wound_index]);
+    }
+    return total_area;
+}
@@ -0,0 +1,113 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef WOUNDMESHUTILITIES_HPP_
+#define WOUNDMESHUTILITIES_HPP_
+
+#include "MutableVertexMesh.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include <vector>
+
+/**
+ * Helper functions for preparing meshes for wound healing simulations and for measuring
+ * their wounds. These are shared by the apps of this project. The mesh preparation is
+ * done with a WoundMeshBuilder, which can also cut several wounds of other shapes.
+ */
+class WoundMeshUtilities
+{
+public:
+
+    /**
+     * Delete the elements with more than a given number of nodes, as done for the large
+     * elements of the virtual leaf mesh, and rescale the mesh so that the mean area of the
+     * remaining elements is a given value. ReMesh() is called at the end.
+     *
+     * @param rMesh the mesh
+     * @param maxNumNodes the largest number of nodes of an element that is kept
+     * @param targetMeanArea the mean area of the elements after rescaling
+     */
+    static void RemoveLargeElementsAndRescale(MutableVertexMesh<2,2>& rMesh, unsigned maxNumNodes, double targetMeanArea);
+
+    /**
+     * Cut a circular wound into the middle of a mesh, by deleting all elements whose
+     * centroids lie within a given distance of the mean of the element centroids.
+     * ReMesh() is called at the end.
+     *
+     * @param rMesh the mesh
+     * @param woundRadius the radius of the wound
+     */
+    static void CutCircularWound(MutableVertexMesh<2,2>& rMesh, double woundRadius);
+
+    /**
+     * Cut a circular wound into the middle of a cell population, for example one that has
+     * been relaxed, by killing and removing the cells of the elements that CutCircularWound()
+     * would delete from its mesh. The population is updated at the end.
+     *
+     * @param rCellPopulation the cell population
+     * @param woundRadius the radius of the wound
+     */
+    static void CutCircularWound(VertexBasedCellPopulation<2>& rCellPopulation, double woundRadius);
+
+    /**
+     * @param rMesh the mesh
+     * @param rLoop the ordered nodes of a boundary loop
+     * @return the signed area enclosed by the loop, which is negative for a wound
+     */
+    static double GetSignedAreaOfLoop(MutableVertexMesh<2,2>& rMesh, const std::vector<unsigned>& rLoop);
+
+    /**
+     * @param rMesh the mesh
+     * @param rLoop the ordered nodes of a boundary loop
+     * @return the length of the loop, including the edge from its last node back to its first
+     */
+    static double GetPerimeterOfLoop(MutableVertexMesh<2,2>& rMesh, const std::vector<unsigned>& rLoop);
+
+    /**
+     * @param rMesh the mesh
+     * @param rWoundLoop the ordered nodes around a wound, as found by a WoundHealingForce
+     * @return the area of the wound
+     */
+    static double GetAreaOfWound(MutableVertexMesh<2,2>& rMesh, const std::vector<unsigned>& rWoundLoop);
+
+    /**
+     * @param rMesh the mesh
+     * @param rWoundLoops the ordered nodes around each wound, as found by a WoundHealingForce
+     * @return the total area of the wounds
+     */
+    static double GetTotalAreaOfWounds(MutableVertexMesh<2,2>& rMesh, const std::vector<std::vector<unsigned> >& rWoundLoops);
+};
+
+#endif /*WOUNDMESHUTILITIES_HPP_*/
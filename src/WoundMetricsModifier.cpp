@@ -0,0 +1,267 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "WoundMetricsModifier.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
+#include "WoundMeshUtilities.hpp"
+
+#include <cmath>
+#include <stdint.h>
+
+template<unsigned DIM>
+WoundMetricsModifier<DIM>::WoundMetricsModifier()
+    : AbstractCellBasedSimulationModifier<DIM, DIM>(),
+      mOutputTimestepMultiple(1u),
+      mUseBinaryOutput(false),
+      mNumStepsMeasured(0u),
+      mLastTime(0.0)
+{
+}
+
+template<unsigned DIM>
+WoundMetricsModifier<DIM>::WoundMetricsModifier(boost::shared_ptr<WoundHealingForce<DIM> > pWoundForce)
+    : AbstractCellBasedSimulationModifier<DIM, DIM>(),
+      mpWoundForce(pWoundForce),
+      mOutputTimestepMultiple(1u),
+      mUseBinaryOutput(false),
+      mNumStepsMeasured(0u),
+      mLastTime(0.0)
+{
+}
+
+template<unsigned DIM>
+WoundMetricsModifier<DIM>::~WoundMetricsModifier()
+{
+}
+
+template<unsigned DIM>
+void WoundMetricsModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation, std::string outputDirectory)
+{
+    if (dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("WoundMetricsModifier is to be used with a VertexBasedCellPopulation only");
+    }
+    if (!mpWoundForce)
+    {
+        EXCEPTION("WoundMetricsModifier needs a WoundHealingForce to measure");
+    }
+
+    mNumStepsMeasured = 0;
+    mWoundAreas.clear();
+    mWoundPerimeters.clear();
+    mWoundClosureRates.clear();
+    mPreviousWoundAreas.clear();
+    mLastTime = SimulationTime::Instance()->GetTime();
+
+    OutputFileHandler output_file_handler(outputDirectory, false);
+    if (mUseBinaryOutput)
+    {
+        mpMetricsFile = output_file_handler.OpenOutputFile("wound_metrics.bin", std::ios::out | std::ios::trunc | std::ios::binary);
+    }
+    else
+    {
+        mpMetricsFile = output_file_handler.OpenOutputFile("wound_metrics.csv");
+        *mpMetricsFile << "time,wound,num_nodes,area,perimeter,circularity,closure_rate\n";
+    }
+}
+
+template<unsigned DIM>
+void WoundMetricsModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DIM>& rCellPopulation)
+{
+    MeasureWounds(rCellPopulation);
+}
+
+template<unsigned DIM>
+void WoundMetricsModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation)
+{
+    if (mpMetricsFile)
+    {
+        mpMetricsFile->close();
+        mpMetricsFile.reset();
+    }
+}
+
+template<unsigned DIM>
+void WoundMetricsModifier<DIM>::MeasureWounds(AbstractCellPopulation<DIM, DIM>& rCellPopulation)
+{
+    // The rings were found by the force during this step, before the nodes moved and before
+    // any remeshing, so their node indices are still valid here
+    MutableVertexMesh<DIM, DIM>& r_mesh = static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation).rGetMesh();
+    const std::vector<std::vector<unsigned> >& r_wound_loops = mpWoundForce->rGetWoundLoops();
+    const unsigned num_wounds = r_wound_loops.size();
+
+    mPreviousWoundAreas.swap(mWoundAreas);
+    mWoundAreas.resize(num_wounds);
+    mWoundPerimeters.resize(num_wounds);
+    mWoundClosureRates.resize(num_wounds);
+
+    for (unsigned wound_index=0; wound_index<num_wounds; wound_index++)
+    {
+        mWoundAreas[wound_index] = WoundMeshUtilities::GetAreaOfWound(r_mesh, r_wound_loops[wound_index]);
+        mWoundPerimeters[wound_index] = WoundMeshUtilities::GetPerimeterOfLoop(r_mesh, r_wound_loops[wound_index]);
+    }
+
+    double time = SimulationTime::Instance()->GetTime();
+    double dt = time - mLastTime;
+    bool have_rates = (dt > 0.0) && (mPreviousWoundAreas.size() == num_wounds);
+    for (unsigned wound_index=0; wound_index<num_wounds; wound_index++)
+    {
+        mWoundClosureRates[wound_index] = have_rates ? (mPreviousWoundAreas[wound_index] - mWoundAreas[wound_index])/dt : 0.0;
+    }
+    mLastTime = time;
+
+    if (mpMetricsFile && (mNumStepsMeasured % mOutputTimestepMultiple == 0))
+    {
+        for (unsigned wound_index=0; wound_index<num_wounds; wound_index++)
+        {
+            uint32_t num_nodes = r_wound_loops[wound_index].size();
+            double circularity = GetWoundCircularity(wound_index);
+            if (mUseBinaryOutput)
+            {
+                uint32_t index = wound_index;
+                mpMetricsFile->write(reinterpret_cast<const char*>(&time), sizeof(double));
+                mpMetricsFile->write(reinterpret_cast<const char*>(&index), sizeof(uint32_t));
+                mpMetricsFile->write(reinterpret_cast<const char*>(&num_nodes), sizeof(uint32_t));
+                mpMetricsFile->write(reinterpret_cast<const char*>(&mWoundAreas[wound_index]), sizeof(double));
+                mpMetricsFile->write(reinterpret_cast<const char*>(&mWoundPerimeters[wound_index]), sizeof(double));
+                mpMetricsFile->write(reinterpret_cast<const char*>(&circularity), sizeof(double));
+                mpMetricsFile->write(reinterpret_cast<const char*>(&mWoundClosureRates[wound_index]), sizeof(double));
+            }
+            else
+            {
+                *mpMetricsFile << time << "," << wound_index << "," << num_nodes << ","
+                               << mWoundAreas[wound_index] << "," << mWoundPerimeters[wound_index] << ","
+                               << circularity << "," << mWoundClosureRates[wound_index] << "\n";
+            }
+        }
+    }
+    mNumStepsMeasured++;
+}
+
+template<unsigned DIM>
+boost::shared_ptr<WoundHealingForce<DIM> > WoundMetricsModifier<DIM>::GetWoundForce() const
+{
+    return mpWoundForce;
+}
+
+template<unsigned DIM>
+unsigned WoundMetricsModifier<DIM>::GetOutputTimestepMultiple() const
+{
+    return mOutputTimestepMultiple;
+}
+
+template<unsigned DIM>
+void WoundMetricsModifier<DIM>::SetOutputTimestepMultiple(unsigned outputTimestepMultiple)
+{
+    assert(outputTimestepMultiple > 0);
+    mOutputTimestepMultiple = outputTimestepMultiple;
+}
+
+template<unsigned DIM>
+bool WoundMetricsModifier<DIM>::GetUseBinaryOutput() const
+{
+    return mUseBinaryOutput;
+}
+
+template<unsigned DIM>
+void WoundMetricsModifier<DIM>::SetUseBinaryOutput(bool useBinaryOutput)
+{
+    mUseBinaryOutput = useBinaryOutput;
+}
+
+template<unsigned DIM>
+unsigned WoundMetricsModifier<DIM>::GetNumWounds() const
+{
+    return mWoundAreas.size();
+}
+
+template<unsigned DIM>
+double WoundMetricsModifier<DIM>::GetWoundArea(unsigned woundIndex) const
+{
+    assert(woundIndex < mWoundAreas.size());
+    return mWoundAreas[woundIndex];
+}
+
+template<unsigned DIM>
+double WoundMetricsModifier<DIM>::GetWoundPerimeter(unsigned woundIndex) const
+{
+    assert(woundIndex < mWoundPerimeters.size());
+    return mWoundPerimeters[woundIndex];
+}
+
+template<unsigned DIM>
+double WoundMetricsModifier<DIM>::GetWoundCircularity(unsigned woundIndex) const
+{
+    assert(woundIndex < mWoundPerimeters.size());
+    double perimeter = mWoundPerimeters[woundIndex];
+    return (perimeter > 0.0) ? 4.0*M_PI*mWoundAreas[woundIndex]/(perimeter*perimeter) : 0.0;
+}
+
+template<unsigned DIM>
+double WoundMetricsModifier<DIM>::GetWoundClosureRate(unsigned woundIndex) const
+{
+    assert(woundIndex < mWoundClosureRates.size());
+    return mWoundClosureRates[woundIndex];
+}
+
+template<unsigned DIM>
+double WoundMetricsModifier<DIM>::GetTotalWoundArea() const
+{
+    double total_area = 0.0;
+    for (unsigned wound_index=0; wound_index<mWoundAreas.size(); wound_index++)
+    {
+        total_area += mWoundAreas[wound_index];
+    }
+    return total_area;
+}
+
+template<unsigned DIM>
+void WoundMetricsModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<OutputTimestepMultiple>" << mOutputTimestepMultiple << "</OutputTimestepMultiple>\n";
+    *rParamsFile << "\t\t\t<UseBinaryOutput>" << mUseBinaryOutput << "</UseBinaryOutput>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM, DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class WoundMetricsModifier<2>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS1(WoundMetricsModifier, 2)
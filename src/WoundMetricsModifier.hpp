@@ -0,0 +1,243 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef WOUNDMETRICSMODIFIER_HPP_
+#define WOUNDMETRICSMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "OutputFileHandler.hpp"
+#include "WoundHealingForce.hpp"
+
+#include <vector>
+
+/**
+ * A modifier that measures the wounds at the end of each time step, using the rings of
+ * nodes around the wounds found by a WoundHealingForce (or FarhadifarWoundHealingForce)
+ * at that step. For each wound it records the area, perimeter, circularity 4*pi*A/P^2
+ * and closure rate -dA/dt, at a cost proportional to the number of wound nodes.
+ *
+ * The measurements are written to wound_metrics.csv in the output directory of the
+ * simulation, with a row per wound and sampled step, or to wound_metrics.bin as fixed
+ * size records (see SetUseBinaryOutput()). Together with a large sampling timestep
+ * multiple for the simulation, this makes it possible to follow wound closure without
+ * writing the whole mesh.
+ *
+ * The closure rate is only defined while the number of wounds stays the same, and is
+ * zero at a step where a wound has closed or split. It is measured between consecutive
+ * time steps, whatever the output sampling.
+ */
+template<unsigned DIM>
+class WoundMetricsModifier : public AbstractCellBasedSimulationModifier<DIM, DIM>
+{
+static_assert(DIM == 2, "WoundMetricsModifier is only defined for two-dimensional vertex populations");
+
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM, DIM> >(*this);
+        archive & mpWoundForce;
+        archive & mOutputTimestepMultiple;
+        archive & mUseBinaryOutput;
+    }
+
+    /** The force whose wound rings are measured. */
+    boost::shared_ptr<WoundHealingForce<DIM> > mpWoundForce;
+
+    /** The metrics are written every this many time steps. */
+    unsigned mOutputTimestepMultiple;
+
+    /** Whether to write binary records rather than CSV rows. */
+    bool mUseBinaryOutput;
+
+    /** The number of time steps measured so far in this solve. */
+    unsigned mNumStepsMeasured;
+
+    /** The file the metrics are written to. */
+    out_stream mpMetricsFile;
+
+    /** The area of each wound at the last step. */
+    std::vector<double> mWoundAreas;
+
+    /** The perimeter of each wound at the last step. */
+    std::vector<double> mWoundPerimeters;
+
+    /** The closure rate of each wound at the last step. */
+    std::vector<double> mWoundClosureRates;
+
+    /** The area of each wound at the step before, for the closure rates. */
+    std::vector<double> mPreviousWoundAreas;
+
+    /** The time of the last step. */
+    double mLastTime;
+
+    /**
+     * Measure the wounds and write the measurements if this step is sampled.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void MeasureWounds(AbstractCellPopulation<DIM, DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor, for archiving only.
+     */
+    WoundMetricsModifier();
+
+    /**
+     * Constructor.
+     *
+     * @param pWoundForce the force whose wound rings are measured. It must be one of the forces of the simulation.
+     */
+    WoundMetricsModifier(boost::shared_ptr<WoundHealingForce<DIM> > pWoundForce);
+
+    /**
+     * Destructor.
+     */
+    virtual ~WoundMetricsModifier();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method. Measures the wounds.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method. Opens the output file.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method. Closes the output file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation);
+
+    /**
+     * @return the force whose wound rings are measured
+     */
+    boost::shared_ptr<WoundHealingForce<DIM> > GetWoundForce() const;
+
+    /**
+     * @return the number of time steps between outputs
+     */
+    unsigned GetOutputTimestepMultiple() const;
+
+    /**
+     * Set the number of time steps between outputs. The wounds are still measured at every step.
+     *
+     * @param outputTimestepMultiple the number of time steps between outputs
+     */
+    void SetOutputTimestepMultiple(unsigned outputTimestepMultiple);
+
+    /**
+     * @return whether binary records are written rather than CSV rows
+     */
+    bool GetUseBinaryOutput() const;
+
+    /**
+     * Set whether to write binary records rather than CSV rows. Each record holds the time
+     * as a double, the wound index and number of wound nodes as uint32_t, and the area,
+     * perimeter, circularity and closure rate as doubles, 48 bytes in all.
+     *
+     * @param useBinaryOutput whether to write binary records
+     */
+    void SetUseBinaryOutput(bool useBinaryOutput);
+
+    /**
+     * @return the number of wounds at the last step
+     */
+    unsigned GetNumWounds() const;
+
+    /**
+     * @param woundIndex the index of a wound
+     * @return the area of the wound at the last step
+     */
+    double GetWoundArea(unsigned woundIndex) const;
+
+    /**
+     * @param woundIndex the index of a wound
+     * @return the perimeter of the wound at the last step
+     */
+    double GetWoundPerimeter(unsigned woundIndex) const;
+
+    /**
+     * @param woundIndex the index of a wound
+     * @return the circularity 4*pi*A/P^2 of the wound at the last step, or zero if it has closed
+     */
+    double GetWoundCircularity(unsigned woundIndex) const;
+
+    /**
+     * @param woundIndex the index of a wound
+     * @return the rate at which the area of the wound decreased over the last step
+     */
+    double GetWoundClosureRate(unsigned woundIndex) const;
+
+    /**
+     * @return the total area of the wounds at the last step
+     */
+    double GetTotalWoundArea() const;
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS1(WoundMetricsModifier, 2)
+
+#endif /*WOUNDMETRICSMODIFIER_HPP_*/
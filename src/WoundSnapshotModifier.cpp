@@ -0,0 +1,292 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "WoundSnapshotModifier.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SimulationTime.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+#include "WoundMeshUtilities.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <sstream>
+
+template<unsigned DIM>
+WoundSnapshotModifier<DIM>::WoundSnapshotModifier()
+    : AbstractCellBasedSimulationModifier<DIM, DIM>(),
+      mSnapshotOnWoundEdgeChanges(false),
+      mCompressionLevel(1),
+      mInitialWoundArea(-1.0),
+      mNextAreaFractionIndex(0),
+      mNumT1SwapsSeen(0),
+      mLastT1SwapLocationSeen(zero_vector<double>(DIM)),
+      mLastT2SwapLocationSeen(zero_vector<double>(DIM))
+{
+}
+
+template<unsigned DIM>
+WoundSnapshotModifier<DIM>::WoundSnapshotModifier(boost::shared_ptr<WoundHealingForce<DIM> > pWoundForce)
+    : AbstractCellBasedSimulationModifier<DIM, DIM>(),
+      mpWoundForce(pWoundForce),
+      mSnapshotOnWoundEdgeChanges(false),
+      mCompressionLevel(1),
+      mInitialWoundArea(-1.0),
+      mNextAreaFractionIndex(0),
+      mNumT1SwapsSeen(0),
+      mLastT1SwapLocationSeen(zero_vector<double>(DIM)),
+      mLastT2SwapLocationSeen(zero_vector<double>(DIM))
+{
+}
+
+template<unsigned DIM>
+WoundSnapshotModifier<DIM>::~WoundSnapshotModifier()
+{
+}
+
+template<unsigned DIM>
+void WoundSnapshotModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation, std::string outputDirectory)
+{
+    if (dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("WoundSnapshotModifier is to be used with a VertexBasedCellPopulation only");
+    }
+    if (!mpWoundForce)
+    {
+        EXCEPTION("WoundSnapshotModifier needs a WoundHealingForce to follow the wounds");
+    }
+
+    mInitialWoundArea = -1.0;
+    mNextAreaFractionIndex = 0;
+    mPreviousWoundLoopSizes.clear();
+
+    // Swaps that happened before the solve are not wound edge changes
+    MutableVertexMesh<DIM, DIM>& r_mesh = static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation).rGetMesh();
+    HasSwapHappenedNextToWound(r_mesh, std::vector<std::vector<unsigned> >());
+
+    OutputFileHandler output_file_handler(outputDirectory + "/snapshots", false);
+    mpWriter.reset(new CompressedSnapshotWriter(output_file_handler.GetOutputDirectoryFullPath(), mCompressionLevel));
+    TakeSnapshot(rCellPopulation, "initial");
+}
+
+template<unsigned DIM>
+void WoundSnapshotModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DIM>& rCellPopulation)
+{
+    // The rings were found by the force during this step, and their node indices are still valid here
+    MutableVertexMesh<DIM, DIM>& r_mesh = static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation).rGetMesh();
+    const std::vector<std::vector<unsigned> >& r_wound_loops = mpWoundForce->rGetWoundLoops();
+
+    double total_wound_area = WoundMeshUtilities::GetTotalAreaOfWounds(r_mesh, r_wound_loops);
+
+    // Node indices change whenever the mesh is renumbered, so the rings are compared by their sizes and swaps instead
+    bool wound_edge_changed = false;
+    if (mSnapshotOnWoundEdgeChanges)
+    {
+        wound_edge_changed = HasSwapHappenedNextToWound(r_mesh, r_wound_loops)
+                             || r_wound_loops.size() != mPreviousWoundLoopSizes.size();
+        mPreviousWoundLoopSizes.resize(r_wound_loops.size());
+        for (unsigned wound_index=0; wound_index<r_wound_loops.size(); wound_index++)
+        {
+            wound_edge_changed = wound_edge_changed || r_wound_loops[wound_index].size() != mPreviousWoundLoopSizes[wound_index];
+            mPreviousWoundLoopSizes[wound_index] = r_wound_loops[wound_index].size();
+        }
+    }
+
+    std::string event;
+    if (mInitialWoundArea < 0.0)
+    {
+        mInitialWoundArea = total_wound_area;
+    }
+    else
+    {
+        // Only the smallest fraction reached at this step names the snapshot
+        while (mNextAreaFractionIndex < mAreaFractions.size()
+               && total_wound_area <= mAreaFractions[mNextAreaFractionIndex]*mInitialWoundArea)
+        {
+            std::stringstream event_stream;
+            event_stream << "area_fraction_" << mAreaFractions[mNextAreaFractionIndex];
+            event = event_stream.str();
+            mNextAreaFractionIndex++;
+        }
+        if (event.empty() && wound_edge_changed)
+        {
+            event = "wound_edge";
+        }
+    }
+
+    if (!event.empty())
+    {
+        TakeSnapshot(rCellPopulation, event);
+    }
+}
+
+template<unsigned DIM>
+void WoundSnapshotModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation)
+{
+    if (mpWriter)
+    {
+        TakeSnapshot(rCellPopulation, "final");
+        mpWriter->Finish();
+    }
+}
+
+template<unsigned DIM>
+bool WoundSnapshotModifier<DIM>::HasSwapHappenedNextToWound(MutableVertexMesh<DIM, DIM>& rMesh,
+                                                            const std::vector<std::vector<unsigned> >& rWoundLoops)
+{
+    std::vector<c_vector<double, DIM> > new_swap_locations;
+
+    // The T1 swap locations build up until something clears them, such as the writer of the usual output
+    const std::vector<c_vector<double, DIM> >& r_t1_swap_locations = rMesh.GetLocationsOfT1Swaps();
+    unsigned first_new_t1_swap = mNumT1SwapsSeen;
+    if (first_new_t1_swap > r_t1_swap_locations.size()
+        || (first_new_t1_swap > 0 && norm_2(r_t1_swap_locations[first_new_t1_swap-1] - mLastT1SwapLocationSeen) > 0.0))
+    {
+        first_new_t1_swap = 0;
+    }
+    new_swap_locations.insert(new_swap_locations.end(), r_t1_swap_locations.begin() + first_new_t1_swap, r_t1_swap_locations.end());
+    mNumT1SwapsSeen = r_t1_swap_locations.size();
+    if (mNumT1SwapsSeen > 0)
+    {
+        mLastT1SwapLocationSeen = r_t1_swap_locations.back();
+    }
+
+    // Only the last T2 swap is kept, so a T2 swap is new if its location has moved
+    c_vector<double, DIM> last_t2_swap_location = rMesh.GetLastT2SwapLocation();
+    if (norm_2(last_t2_swap_location - mLastT2SwapLocationSeen) > 0.0)
+    {
+        new_swap_locations.push_back(last_t2_swap_location);
+        mLastT2SwapLocationSeen = last_t2_swap_location;
+    }
+
+    // The nodes of a T1 swap end up at most this far from where it is recorded, and a T2 swap leaves its node there
+    double distance = rMesh.GetCellRearrangementRatio()*rMesh.GetCellRearrangementThreshold();
+    for (unsigned swap=0; swap<new_swap_locations.size(); swap++)
+    {
+        for (unsigned wound_index=0; wound_index<rWoundLoops.size(); wound_index++)
+        {
+            for (unsigned i=0; i<rWoundLoops[wound_index].size(); i++)
+            {
+                c_vector<double, DIM> node_location = rMesh.GetNode(rWoundLoops[wound_index][i])->rGetLocation();
+                if (norm_2(rMesh.GetVectorFromAtoB(new_swap_locations[swap], node_location)) <= distance)
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+template<unsigned DIM>
+void WoundSnapshotModifier<DIM>::TakeSnapshot(AbstractCellPopulation<DIM, DIM>& rCellPopulation, const std::string& rEvent)
+{
+    MutableVertexMesh<DIM, DIM>& r_mesh = static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation).rGetMesh();
+    mpWriter->WriteSnapshot(r_mesh, SimulationTime::Instance()->GetTime(), rEvent);
+}
+
+template<unsigned DIM>
+void WoundSnapshotModifier<DIM>::AddAreaFraction(double areaFraction)
+{
+    if (areaFraction < 0.0 || areaFraction > 1.0)
+    {
+        EXCEPTION("A wound area fraction must be between 0 and 1");
+    }
+    mAreaFractions.push_back(areaFraction);
+    std::sort(mAreaFractions.begin(), mAreaFractions.end(), std::greater<double>());
+}
+
+template<unsigned DIM>
+const std::vector<double>& WoundSnapshotModifier<DIM>::rGetAreaFractions() const
+{
+    return mAreaFractions;
+}
+
+template<unsigned DIM>
+bool WoundSnapshotModifier<DIM>::GetSnapshotOnWoundEdgeChanges() const
+{
+    return mSnapshotOnWoundEdgeChanges;
+}
+
+template<unsigned DIM>
+void WoundSnapshotModifier<DIM>::SetSnapshotOnWoundEdgeChanges(bool snapshotOnWoundEdgeChanges)
+{
+    mSnapshotOnWoundEdgeChanges = snapshotOnWoundEdgeChanges;
+}
+
+template<unsigned DIM>
+int WoundSnapshotModifier<DIM>::GetCompressionLevel() const
+{
+    return mCompressionLevel;
+}
+
+template<unsigned DIM>
+void WoundSnapshotModifier<DIM>::SetCompressionLevel(int compressionLevel)
+{
+    if (compressionLevel < 0 || compressionLevel > 9)
+    {
+        EXCEPTION("The compression level must be between 0 and 9");
+    }
+    mCompressionLevel = compressionLevel;
+}
+
+template<unsigned DIM>
+unsigned WoundSnapshotModifier<DIM>::GetNumSnapshots() const
+{
+    return mpWriter ? mpWriter->GetNumSnapshots() : 0u;
+}
+
+template<unsigned DIM>
+void WoundSnapshotModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<AreaFractions>";
+    for (unsigned i=0; i<mAreaFractions.size(); i++)
+    {
+        *rParamsFile << (i == 0 ? "" : ",") << mAreaFractions[i];
+    }
+    *rParamsFile << "</AreaFractions>\n";
+    *rParamsFile << "\t\t\t<SnapshotOnWoundEdgeChanges>" << mSnapshotOnWoundEdgeChanges << "</SnapshotOnWoundEdgeChanges>\n";
+    *rParamsFile << "\t\t\t<CompressionLevel>" << mCompressionLevel << "</CompressionLevel>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM, DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class WoundSnapshotModifier<2>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS1(WoundSnapshotModifier, 2)
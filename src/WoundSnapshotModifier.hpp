@@ -0,0 +1,240 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef WOUNDSNAPSHOTMODIFIER_HPP_
+#define WOUNDSNAPSHOTMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/vector.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "CompressedSnapshotWriter.hpp"
+#include "WoundHealingForce.hpp"
+
+#include <vector>
+
+/**
+ * A modifier that writes snapshots of the mesh when something happens to the wounds, rather
+ * than at a fixed interval. Snapshots are taken
+ *
+ *  - at the start and end of the simulation;
+ *  - when the total wound area first falls to or below each of a list of fractions of its
+ *    area at the first step (see AddAreaFraction());
+ *  - optionally, whenever the ring of nodes around a wound changes, which happens when a T1
+ *    or T2 swap involves the wound edge or a wound closes (see SetSnapshotOnWoundEdgeChanges()).
+ *    These changes are found from the number and sizes of the rings and the swap locations
+ *    recorded by the mesh, so renumbering the nodes of the mesh does not count as a change.
+ *
+ * The wounds are followed through the rings found by a WoundHealingForce, at a cost proportional
+ * to the number of wound nodes when there is no snapshot. The snapshots are compressed and written
+ * by a CompressedSnapshotWriter on a background thread, in the snapshots folder of the simulation
+ * output directory, so the simulation only waits for the mesh to be copied. Usually the sampling
+ * timestep multiple of the simulation is made large, so that the usual output is not written too.
+ */
+template<unsigned DIM>
+class WoundSnapshotModifier : public AbstractCellBasedSimulationModifier<DIM, DIM>
+{
+static_assert(DIM == 2, "WoundSnapshotModifier is only defined for two-dimensional vertex populations");
+
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM, DIM> >(*this);
+        archive & mpWoundForce;
+        archive & mAreaFractions;
+        archive & mSnapshotOnWoundEdgeChanges;
+        archive & mCompressionLevel;
+    }
+
+    /** The force whose wound rings are followed. */
+    boost::shared_ptr<WoundHealingForce<DIM> > mpWoundForce;
+
+    /** The fractions of the initial wound area at which to take snapshots, largest first. */
+    std::vector<double> mAreaFractions;
+
+    /** Whether to take a snapshot whenever a wound ring changes. */
+    bool mSnapshotOnWoundEdgeChanges;
+
+    /** The zlib compression level of the snapshots. */
+    int mCompressionLevel;
+
+    /** The writer of the snapshots, during a solve. */
+    boost::shared_ptr<CompressedSnapshotWriter> mpWriter;
+
+    /** The total wound area at the first step of the solve, or a negative number before then. */
+    double mInitialWoundArea;
+
+    /** The index into mAreaFractions of the next fraction to be reached. */
+    unsigned mNextAreaFractionIndex;
+
+    /** The number of nodes in each wound ring at the step before, to detect changes to them. */
+    std::vector<unsigned> mPreviousWoundLoopSizes;
+
+    /** The number of T1 swap locations of the mesh that have already been looked at. */
+    unsigned mNumT1SwapsSeen;
+
+    /** The last of the T1 swap locations that have already been looked at, to notice when they are cleared. */
+    c_vector<double, DIM> mLastT1SwapLocationSeen;
+
+    /** The location of the last T2 swap of the mesh at the step before. */
+    c_vector<double, DIM> mLastT2SwapLocationSeen;
+
+    /**
+     * Find whether a T1 or T2 swap has happened next to a wound ring since the step before,
+     * and remember the swaps that have been looked at.
+     *
+     * @param rMesh the mesh of the cell population
+     * @param rWoundLoops the wound rings found by the force
+     * @return whether any new swap is next to a node of a ring
+     */
+    bool HasSwapHappenedNextToWound(MutableVertexMesh<DIM, DIM>& rMesh,
+                                    const std::vector<std::vector<unsigned> >& rWoundLoops);
+
+    /**
+     * Take a snapshot of the mesh.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param rEvent the event that caused the snapshot
+     */
+    void TakeSnapshot(AbstractCellPopulation<DIM, DIM>& rCellPopulation, const std::string& rEvent);
+
+public:
+
+    /**
+     * Default constructor, for archiving only.
+     */
+    WoundSnapshotModifier();
+
+    /**
+     * Constructor.
+     *
+     * @param pWoundForce the force whose wound rings are followed. It must be one of the forces of the simulation.
+     */
+    WoundSnapshotModifier(boost::shared_ptr<WoundHealingForce<DIM> > pWoundForce);
+
+    /**
+     * Destructor.
+     */
+    virtual ~WoundSnapshotModifier();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method. Takes a snapshot if an event has happened.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method. Starts the snapshot writer and takes the first snapshot.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method. Takes the last snapshot and waits for all the
+     * snapshots to be written.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation);
+
+    /**
+     * Take a snapshot when the total wound area first falls to or below a fraction of its
+     * area at the first step.
+     *
+     * @param areaFraction the fraction, between 0 and 1
+     */
+    void AddAreaFraction(double areaFraction);
+
+    /**
+     * @return the fractions of the initial wound area at which snapshots are taken, largest first
+     */
+    const std::vector<double>& rGetAreaFractions() const;
+
+    /**
+     * @return whether a snapshot is taken whenever a wound ring changes
+     */
+    bool GetSnapshotOnWoundEdgeChanges() const;
+
+    /**
+     * Set whether to take a snapshot whenever a wound ring changes.
+     *
+     * @param snapshotOnWoundEdgeChanges whether to take these snapshots
+     */
+    void SetSnapshotOnWoundEdgeChanges(bool snapshotOnWoundEdgeChanges);
+
+    /**
+     * @return the zlib compression level of the snapshots
+     */
+    int GetCompressionLevel() const;
+
+    /**
+     * Set the zlib compression level of the snapshots. Defaults to 1, the fastest.
+     *
+     * @param compressionLevel the compression level, from 0 to 9
+     */
+    void SetCompressionLevel(int compressionLevel);
+
+    /**
+     * @return the number of snapshots taken in the current or last solve
+     */
+    unsigned GetNumSnapshots() const;
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS1(WoundSnapshotModifier, 2)
+
+#endif /*WOUNDSNAPSHOTMODIFIER_HPP_*/
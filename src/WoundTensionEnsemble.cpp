@@ -0,0 +1,480 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#include "WoundTensionEnsemble.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+WoundTensionEnsemble::WoundTensionEnsemble(VertexBasedCellPopulation<2>& rCellPopulation,
+                                           boost::shared_ptr<FarhadifarWoundHealingForce<2> > pForce,
+                                           const std::vector<double>& rWoundTensions,
+                                           double dt)
+    : mWoundTensions(rWoundTensions),
+      mNumLanes(rWoundTensions.size()),
+      mDt(dt),
+      mNumSteps(0)
+{
+    if (mNumLanes == 0)
+    {
+        EXCEPTION("An ensemble needs at least one wound tension");
+    }
+    if (!(dt > 0.0))
+    {
+        EXCEPTION("The time step must be positive");
+    }
+    if (rCellPopulation.GetRestrictVertexMovementBoolean())
+    {
+        EXCEPTION("The lanes of an ensemble move without restriction, so vertex movement must not be restricted in the population");
+    }
+
+    // The wound rings come from the force, as they would in the first step of a simulation
+    MutableVertexMesh<2,2>& r_mesh = rCellPopulation.rGetMesh();
+    pForce->UpdateWoundBoundaries(rCellPopulation);
+    if (pForce->GetMeshIsPeriodic())
+    {
+        EXCEPTION("Ensembles of wound tensions are not implemented for periodic meshes");
+    }
+    mAreaElasticityParameter = pForce->GetAreaElasticityParameter();
+    mPerimeterContractilityParameter = pForce->GetPerimeterContractilityParameter();
+    mCellRearrangementThreshold = r_mesh.GetCellRearrangementThreshold();
+    mT2Threshold = r_mesh.GetT2Threshold();
+
+    // The target area of each element, from its cell
+    std::vector<double> target_areas(r_mesh.GetNumAllElements(), 0.0);
+    for (AbstractCellPopulation<2>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        try
+        {
+            target_areas[rCellPopulation.GetLocationIndexUsingCell(*cell_iter)] = cell_iter->GetCellData()->GetItem("target area");
+        }
+        catch (Exception&)
+        {
+            EXCEPTION("The cells need target areas, from an AbstractTargetAreaModifier, to build an ensemble");
+        }
+    }
+
+    // The topology, with the line tension parameter of each edge as FarhadifarWoundHealingForce uses it
+    mElementOffsets.push_back(0);
+    for (unsigned elem_index=0; elem_index<r_mesh.GetNumAllElements(); elem_index++)
+    {
+        VertexElement<2,2>* p_element = r_mesh.GetElement(elem_index);
+        if (p_element->IsDeleted())
+        {
+            continue;
+        }
+        unsigned num_nodes_elem = p_element->GetNumNodes();
+        for (unsigned local_index=0; local_index<num_nodes_elem; local_index++)
+        {
+            Node<2>* p_this_node = p_element->GetNode(local_index);
+            Node<2>* p_next_node = p_element->GetNode((local_index+1)%num_nodes_elem);
+            const std::set<unsigned>& r_this_elem_indices = p_this_node->rGetContainingElementIndices();
+            const std::set<unsigned>& r_next_elem_indices = p_next_node->rGetContainingElementIndices();
+            unsigned num_shared_elements = 0;
+            for (std::set<unsigned>::const_iterator iter = r_next_elem_indices.begin();
+                 iter != r_next_elem_indices.end();
+                 ++iter)
+            {
+                num_shared_elements += r_this_elem_indices.count(*iter);
+            }
+            mElementNodes.push_back(p_this_node->GetIndex());
+            mEdgeLineTensions.push_back(num_shared_elements == 1 ? pForce->GetBoundaryLineTensionParameter()
+                                                                 : pForce->GetLineTensionParameter()/2.0);
+        }
+        mElementOffsets.push_back(mElementNodes.size());
+        mTargetAreas.push_back(target_areas[elem_index]);
+    }
+
+    pForce->GetWoundNodeTriples(mWoundNodeTriples);
+
+    // Every lane starts from the locations of the nodes of the population
+    mNumNodes = r_mesh.GetNumAllNodes();
+    mNodeDampings.assign(mNumNodes, 1.0);
+    mX.resize(mNumNodes*mNumLanes);
+    mY.resize(mNumNodes*mNumLanes);
+    for (unsigned node_index=0; node_index<mNumNodes; node_index++)
+    {
+        Node<2>* p_node = r_mesh.GetNode(node_index);
+        if (!p_node->IsDeleted())
+        {
+            mNodeDampings[node_index] = rCellPopulation.GetDampingConstant(node_index);
+        }
+        for (unsigned lane=0; lane<mNumLanes; lane++)
+        {
+            mX[node_index*mNumLanes + lane] = p_node->rGetLocation()[0];
+            mY[node_index*mNumLanes + lane] = p_node->rGetLocation()[1];
+        }
+    }
+    mForceX.assign(mNumNodes*mNumLanes, 0.0);
+    mForceY.assign(mNumNodes*mNumLanes, 0.0);
+    mLaneAreas.resize(mNumLanes);
+    mLanePerimeters.resize(mNumLanes);
+    mLaneSteps.resize(mNumLanes);
+    mLaneMaxSquaredDisplacements.resize(mNumLanes);
+    mLaneMaxDisplacements.assign(mNumLanes, 0.0);
+    mIsLaneActive.assign(mNumLanes, true);
+    mLaneNumSteps.assign(mNumLanes, 0);
+
+    // If the population would be remeshed before its first step, no lane can start in lockstep
+    if (DoesLaneNeedReMesh(0))
+    {
+        mIsLaneActive.assign(mNumLanes, false);
+    }
+}
+
+unsigned WoundTensionEnsemble::GetNumLanes() const
+{
+    return mNumLanes;
+}
+
+unsigned WoundTensionEnsemble::GetNumActiveLanes() const
+{
+    return std::count(mIsLaneActive.begin(), mIsLaneActive.end(), true);
+}
+
+bool WoundTensionEnsemble::IsLaneActive(unsigned lane) const
+{
+    assert(lane < mNumLanes);
+    return mIsLaneActive[lane];
+}
+
+double WoundTensionEnsemble::GetWoundTension(unsigned lane) const
+{
+    assert(lane < mNumLanes);
+    return mWoundTensions[lane];
+}
+
+unsigned WoundTensionEnsemble::GetNumSteps() const
+{
+    return mNumSteps;
+}
+
+unsigned WoundTensionEnsemble::GetLaneNumSteps(unsigned lane) const
+{
+    assert(lane < mNumLanes);
+    return mLaneNumSteps[lane];
+}
+
+c_vector<double, 2> WoundTensionEnsemble::GetNodeLocation(unsigned nodeIndex, unsigned lane) const
+{
+    assert(nodeIndex < mNumNodes && lane < mNumLanes);
+    c_vector<double, 2> location;
+    location[0] = mX[nodeIndex*mNumLanes + lane];
+    location[1] = mY[nodeIndex*mNumLanes + lane];
+    return location;
+}
+
+c_vector<double, 2> WoundTensionEnsemble::GetNodeForce(unsigned nodeIndex, unsigned lane) const
+{
+    assert(nodeIndex < mNumNodes && lane < mNumLanes);
+    c_vector<double, 2> force;
+    force[0] = mForceX[nodeIndex*mNumLanes + lane];
+    force[1] = mForceY[nodeIndex*mNumLanes + lane];
+    return force;
+}
+
+void WoundTensionEnsemble::ComputeForces()
+{
+    const unsigned num_lanes = mNumLanes;
+    std::fill(mForceX.begin(), mForceX.end(), 0.0);
+    std::fill(mForceY.begin(), mForceY.end(), 0.0);
+    double* p_areas = &mLaneAreas[0];
+    double* p_perimeters = &mLanePerimeters[0];
+
+    /*
+     * Visit each element once, as FarhadifarWoundHealingForce does. The area and perimeter
+     * of the element are found in every lane first, and then the area elasticity acts on
+     * each of its nodes, and the perimeter contractility and line tension along each of
+     * its edges.
+     */
+    unsigned num_elements = mElementOffsets.size() - 1;
+    for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+    {
+        const unsigned* p_nodes = &mElementNodes[mElementOffsets[elem_index]];
+        unsigned num_nodes_elem = mElementOffsets[elem_index+1] - mElementOffsets[elem_index];
+
+        std::fill(p_areas, p_areas + num_lanes, 0.0);
+        std::fill(p_perimeters, p_perimeters + num_lanes, 0.0);
+        for (unsigned local_index=0; local_index<num_nodes_elem; local_index++)
+        {
+            const double* p_x = &mX[p_nodes[local_index]*num_lanes];
+            const double* p_y = &mY[p_nodes[local_index]*num_lanes];
+            const double* p_next_x = &mX[p_nodes[(local_index+1)%num_nodes_elem]*num_lanes];
+            const double* p_next_y = &mY[p_nodes[(local_index+1)%num_nodes_elem]*num_lanes];
+#ifdef _OPENMP
+            #pragma omp simd
+#endif
+            for (unsigned lane=0; lane<num_lanes; lane++)
+            {
+                double dx = p_next_x[lane] - p_x[lane];
+                double dy = p_next_y[lane] - p_y[lane];
+                p_areas[lane] += p_x[lane]*p_next_y[lane] - p_next_x[lane]*p_y[lane];
+                p_perimeters[lane] += sqrt(dx*dx + dy*dy);
+            }
+        }
+
+        // From here on, the scratch arrays hold the area elasticity and perimeter contractility coefficients
+        double target_area = mTargetAreas[elem_index];
+        for (unsigned lane=0; lane<num_lanes; lane++)
+        {
+            p_areas[lane] = mAreaElasticityParameter*(0.5*p_areas[lane] - target_area);
+            p_perimeters[lane] *= mPerimeterContractilityParameter;
+        }
+
+        for (unsigned local_index=0; local_index<num_nodes_elem; local_index++)
+        {
+            unsigned previous_node = p_nodes[(local_index+num_nodes_elem-1)%num_nodes_elem];
+            unsigned this_node = p_nodes[local_index];
+            unsigned next_node = p_nodes[(local_index+1)%num_nodes_elem];
+            const double* p_previous_x = &mX[previous_node*num_lanes];
+            const double* p_previous_y = &mY[previous_node*num_lanes];
+            const double* p_x = &mX[this_node*num_lanes];
+            const double* p_y = &mY[this_node*num_lanes];
+            const double* p_next_x = &mX[next_node*num_lanes];
+            const double* p_next_y = &mY[next_node*num_lanes];
+            double* p_force_x = &mForceX[this_node*num_lanes];
+            double* p_force_y = &mForceY[this_node*num_lanes];
+            double* p_next_force_x = &mForceX[next_node*num_lanes];
+            double* p_next_force_y = &mForceY[next_node*num_lanes];
+            double line_tension = mEdgeLineTensions[mElementOffsets[elem_index] + local_index];
+#ifdef _OPENMP
+            #pragma omp simd
+#endif
+            for (unsigned lane=0; lane<num_lanes; lane++)
+            {
+                // The area gradient at this node
+                p_force_x[lane] -= p_areas[lane]*0.5*(p_next_y[lane] - p_previous_y[lane]);
+                p_force_y[lane] -= p_areas[lane]*0.5*(p_previous_x[lane] - p_next_x[lane]);
+
+                // The gradient of the edge to the next node is the unit vector from the next node to this one
+                double dx = p_x[lane] - p_next_x[lane];
+                double dy = p_y[lane] - p_next_y[lane];
+                double edge_coefficient = (p_perimeters[lane] + line_tension)/sqrt(dx*dx + dy*dy);
+                p_force_x[lane] -= edge_coefficient*dx;
+                p_force_y[lane] -= edge_coefficient*dy;
+                p_next_force_x[lane] += edge_coefficient*dx;
+                p_next_force_y[lane] += edge_coefficient*dy;
+            }
+        }
+    }
+
+    // The tension along the wounds, which is the only force that differs between the lanes for the same locations
+    const double* p_tensions = &mWoundTensions[0];
+    for (unsigned triple=0; triple<mWoundNodeTriples.size(); triple+=3)
+    {
+        const double* p_previous_x = &mX[mWoundNodeTriples[triple]*num_lanes];
+        const double* p_previous_y = &mY[mWoundNodeTriples[triple]*num_lanes];
+        const double* p_x = &mX[mWoundNodeTriples[triple+1]*num_lanes];
+        const double* p_y = &mY[mWoundNodeTriples[triple+1]*num_lanes];
+        const double* p_next_x = &mX[mWoundNodeTriples[triple+2]*num_lanes];
+        const double* p_next_y = &mY[mWoundNodeTriples[triple+2]*num_lanes];
+        double* p_force_x = &mForceX[mWoundNodeTriples[triple+1]*num_lanes];
+        double* p_force_y = &mForceY[mWoundNodeTriples[triple+1]*num_lanes];
+#ifdef _OPENMP
+        #pragma omp simd
+#endif
+        for (unsigned lane=0; lane<num_lanes; lane++)
+        {
+            double previous_dx = p_x[lane] - p_previous_x[lane];
+            double previous_dy = p_y[lane] - p_previous_y[lane];
+            double next_dx = p_x[lane] - p_next_x[lane];
+            double next_dy = p_y[lane] - p_next_y[lane];
+            double previous_coefficient = p_tensions[lane]/sqrt(previous_dx*previous_dx + previous_dy*previous_dy);
+            double next_coefficient = p_tensions[lane]/sqrt(next_dx*next_dx + next_dy*next_dy);
+            p_force_x[lane] -= previous_coefficient*previous_dx + next_coefficient*next_dx;
+            p_force_y[lane] -= previous_coefficient*previous_dy + next_coefficient*next_dy;
+        }
+    }
+}
+
+bool WoundTensionEnsemble::DoesLaneNeedReMesh(unsigned lane) const
+{
+    const unsigned num_lanes = mNumLanes;
+
+    // T1 swaps are carried out on edges shorter than the rearrangement threshold, and T2 swaps on small triangles
+    unsigned num_elements = mElementOffsets.size() - 1;
+    for (unsigned elem_index=0; elem_index<num_elements; elem_index++)
+    {
+        const unsigned* p_nodes = &mElementNodes[mElementOffsets[elem_index]];
+        unsigned num_nodes_elem = mElementOffsets[elem_index+1] - mElementOffsets[elem_index];
+        double twice_area = 0.0;
+        for (unsigned local_index=0; local_index<num_nodes_elem; local_index++)
+        {
+            unsigned this_index = p_nodes[local_index]*num_lanes + lane;
+            unsigned next_index = p_nodes[(local_index+1)%num_nodes_elem]*num_lanes + lane;
+            double dx = mX[next_index] - mX[this_index];
+            double dy = mY[next_index] - mY[this_index];
+            if (dx*dx + dy*dy < mCellRearrangementThreshold*mCellRearrangementThreshold)
+            {
+                return true;
+            }
+            twice_area += mX[this_index]*mY[next_index] - mX[next_index]*mY[this_index];
+        }
+        if (num_nodes_elem == 3 && 0.5*twice_area < mT2Threshold)
+        {
+            return true;
+        }
+    }
+
+    /*
+     * T3 swaps are carried out when a boundary node has moved into an element. Across a
+     * wound this can only happen to a wound node that has come close to another wound edge,
+     * so we split off a lane once a wound node is within the rearrangement threshold, plus
+     * twice the distance nodes moved in the last step, of a wound edge it is not on.
+     */
+    double contact_distance = mCellRearrangementThreshold + 2.0*mLaneMaxDisplacements[lane];
+    for (unsigned triple=0; triple<mWoundNodeTriples.size(); triple+=3)
+    {
+        unsigned node = mWoundNodeTriples[triple+1];
+        double x = mX[node*num_lanes + lane];
+        double y = mY[node*num_lanes + lane];
+        for (unsigned edge_triple=0; edge_triple<mWoundNodeTriples.size(); edge_triple+=3)
+        {
+            unsigned start = mWoundNodeTriples[edge_triple+1];
+            unsigned end = mWoundNodeTriples[edge_triple+2];
+            if (start == node || end == node)
+            {
+                continue;
+            }
+            double start_x = mX[start*num_lanes + lane];
+            double start_y = mY[start*num_lanes + lane];
+            double edge_x = mX[end*num_lanes + lane] - start_x;
+            double edge_y = mY[end*num_lanes + lane] - start_y;
+            double fraction = ((x - start_x)*edge_x + (y - start_y)*edge_y)/(edge_x*edge_x + edge_y*edge_y);
+            fraction = std::min(std::max(fraction, 0.0), 1.0);
+            double dx = x - start_x - fraction*edge_x;
+            double dy = y - start_y - fraction*edge_y;
+            if (dx*dx + dy*dy < contact_distance*contact_distance)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::vector<unsigned> WoundTensionEnsemble::Step()
+{
+    const unsigned num_lanes = mNumLanes;
+    ComputeForces();
+
+    // Lanes that have split off are moved by a step of zero, so that the loop over the lanes stays uniform
+    for (unsigned lane=0; lane<num_lanes; lane++)
+    {
+        mLaneSteps[lane] = mIsLaneActive[lane] ? mDt : 0.0;
+    }
+    const double* p_lane_steps = &mLaneSteps[0];
+    std::fill(mLaneMaxSquaredDisplacements.begin(), mLaneMaxSquaredDisplacements.end(), 0.0);
+    double* p_max_squared_displacements = &mLaneMaxSquaredDisplacements[0];
+    for (unsigned node_index=0; node_index<mNumNodes; node_index++)
+    {
+        double* p_x = &mX[node_index*num_lanes];
+        double* p_y = &mY[node_index*num_lanes];
+        const double* p_force_x = &mForceX[node_index*num_lanes];
+        const double* p_force_y = &mForceY[node_index*num_lanes];
+        double inverse_damping = 1.0/mNodeDampings[node_index];
+#ifdef _OPENMP
+        #pragma omp simd
+#endif
+        for (unsigned lane=0; lane<num_lanes; lane++)
+        {
+            double dx = p_lane_steps[lane]*inverse_damping*p_force_x[lane];
+            double dy = p_lane_steps[lane]*inverse_damping*p_force_y[lane];
+            p_x[lane] += dx;
+            p_y[lane] += dy;
+            p_max_squared_displacements[lane] = std::max(p_max_squared_displacements[lane], dx*dx + dy*dy);
+        }
+    }
+    mNumSteps++;
+
+    std::vector<unsigned> split_lanes;
+    for (unsigned lane=0; lane<num_lanes; lane++)
+    {
+        if (mIsLaneActive[lane])
+        {
+            mLaneNumSteps[lane] = mNumSteps;
+            mLaneMaxDisplacements[lane] = sqrt(mLaneMaxSquaredDisplacements[lane]);
+            if (DoesLaneNeedReMesh(lane))
+            {
+                mIsLaneActive[lane] = false;
+                split_lanes.push_back(lane);
+            }
+        }
+    }
+    return split_lanes;
+}
+
+void WoundTensionEnsemble::Run(unsigned maxNumSteps)
+{
+    while (mNumSteps < maxNumSteps && GetNumActiveLanes() > 0)
+    {
+        Step();
+    }
+}
+
+void WoundTensionEnsemble::HandOffLane(unsigned lane, VertexBasedCellPopulation<2>& rCellPopulation) const
+{
+    assert(lane < mNumLanes);
+    MutableVertexMesh<2,2>& r_mesh = rCellPopulation.rGetMesh();
+    if (r_mesh.GetNumAllNodes() != mNumNodes)
+    {
+        EXCEPTION("A lane can only be handed off to a copy of the population the ensemble was built from");
+    }
+    for (unsigned node_index=0; node_index<mNumNodes; node_index++)
+    {
+        Node<2>* p_node = r_mesh.GetNode(node_index);
+        if (!p_node->IsDeleted())
+        {
+            p_node->rGetModifiableLocation() = GetNodeLocation(node_index, lane);
+        }
+    }
+
+    // Move the simulation time on by the steps the lane has taken
+    unsigned num_steps = mLaneNumSteps[lane];
+    if (num_steps > 0)
+    {
+        SimulationTime* p_simulation_time = SimulationTime::Instance();
+        p_simulation_time->ResetEndTimeAndNumberOfTimeSteps(p_simulation_time->GetTime() + num_steps*mDt, num_steps);
+        for (unsigned step=0; step<num_steps; step++)
+        {
+            p_simulation_time->IncrementTimeOneStep();
+        }
+    }
+}
@@ -0,0 +1,256 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef WOUNDTENSIONENSEMBLE_HPP_
+#define WOUNDTENSIONENSEMBLE_HPP_
+
+#include "FarhadifarWoundHealingForce.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+/**
+ * Runs the same wounded tissue with several wound tensions at once, in lockstep.
+ *
+ * Runs of a sweep over the wound tension start from the same mesh, and keep the same
+ * topology until their first T1, T2 or T3 swap. Until then, this class carries a lane
+ * of node locations for each wound tension, alongside a single copy of the topology
+ * of the population it is built from. The locations are stored in structure-of-arrays
+ * layout, with the lanes of each node next to each other, so the forces of all lanes
+ * are found in one pass over the elements and wound nodes. Their inner loops run over
+ * the lanes and are vectorised by the compiler.
+ *
+ * The lanes move by forward Euler steps, as OffLatticeSimulation does by default, with
+ * the forces of the FarhadifarWoundHealingForce the ensemble is built with and each
+ * lane's own wound tension. The target areas of the elements are taken from the cells
+ * when the ensemble is built, and stay fixed, as with a SimpleTargetAreaModifier after
+ * its growth duration.
+ *
+ * After each step, a lane whose mesh would be changed by ReMesh() at the start of the
+ * next step splits off and stops moving. That is the case when an edge has become
+ * shorter than the cell rearrangement threshold, a triangular element has become
+ * smaller than the T2 threshold, or a wound node has come so close to another wound
+ * edge that it could cross it in the next step. These tests are conservative, so a lane
+ * may split a little early, but never carries on with the wrong topology. A lane that
+ * has split is carried on by an independent simulation with HandOffLane().
+ *
+ * Periodic meshes are not supported.
+ */
+class WoundTensionEnsemble
+{
+private:
+
+    /** The wound tension of each lane. */
+    std::vector<double> mWoundTensions;
+
+    /** The number of lanes. */
+    unsigned mNumLanes;
+
+    /** The number of nodes of the mesh, including deleted ones. */
+    unsigned mNumNodes;
+
+    /** The time step. */
+    double mDt;
+
+    /** The area elasticity parameter of the force. */
+    double mAreaElasticityParameter;
+
+    /** The perimeter contractility parameter of the force. */
+    double mPerimeterContractilityParameter;
+
+    /** The cell rearrangement (T1) threshold of the mesh. */
+    double mCellRearrangementThreshold;
+
+    /** The T2 threshold of the mesh. */
+    double mT2Threshold;
+
+    /** The nodes of element e are mElementNodes[mElementOffsets[e]] up to, but not including, mElementNodes[mElementOffsets[e+1]]. */
+    std::vector<unsigned> mElementOffsets;
+
+    /** The global indices of the nodes of each live element, in order. */
+    std::vector<unsigned> mElementNodes;
+
+    /** The line tension parameter of the edge from each entry of mElementNodes to the next node of its element. */
+    std::vector<double> mEdgeLineTensions;
+
+    /** The target area of each live element, in the order of mElementOffsets. */
+    std::vector<double> mTargetAreas;
+
+    /** The previous node, the node and the next node of each wound node, as triples. */
+    std::vector<unsigned> mWoundNodeTriples;
+
+    /** The damping constant of each node. */
+    std::vector<double> mNodeDampings;
+
+    /** The x coordinate of each node in each lane, at index node*mNumLanes + lane. */
+    std::vector<double> mX;
+
+    /** The y coordinate of each node in each lane, at index node*mNumLanes + lane. */
+    std::vector<double> mY;
+
+    /** The x component of the force on each node in each lane, laid out as mX. */
+    std::vector<double> mForceX;
+
+    /** The y component of the force on each node in each lane, laid out as mX. */
+    std::vector<double> mForceY;
+
+    /** Scratch space for the area of an element in each lane. */
+    std::vector<double> mLaneAreas;
+
+    /** Scratch space for the perimeter of an element in each lane. */
+    std::vector<double> mLanePerimeters;
+
+    /** Scratch space for the step size of each lane, which is zero once the lane has split off. */
+    std::vector<double> mLaneSteps;
+
+    /** Scratch space for the largest squared distance moved by a node of each lane in a step. */
+    std::vector<double> mLaneMaxSquaredDisplacements;
+
+    /** The largest distance moved by a node of each lane in the last step. */
+    std::vector<double> mLaneMaxDisplacements;
+
+    /** Whether each lane is still moving in lockstep. */
+    std::vector<bool> mIsLaneActive;
+
+    /** The number of steps taken by each lane. */
+    std::vector<unsigned> mLaneNumSteps;
+
+    /** The number of steps taken by the ensemble. */
+    unsigned mNumSteps;
+
+    /**
+     * @param lane a lane
+     * @return whether the mesh of the lane would be changed by ReMesh() before the next step
+     */
+    bool DoesLaneNeedReMesh(unsigned lane) const;
+
+public:
+
+    /**
+     * Constructor. The lanes start from the node locations of the population.
+     *
+     * @param rCellPopulation the cell population to start from. It is not changed.
+     * @param pForce the force whose parameters (other than the wound tension) the lanes use
+     * @param rWoundTensions the wound tension of each lane
+     * @param dt the time step
+     */
+    WoundTensionEnsemble(VertexBasedCellPopulation<2>& rCellPopulation,
+                         boost::shared_ptr<FarhadifarWoundHealingForce<2> > pForce,
+                         const std::vector<double>& rWoundTensions,
+                         double dt);
+
+    /**
+     * @return the number of lanes
+     */
+    unsigned GetNumLanes() const;
+
+    /**
+     * @return the number of lanes that are still moving in lockstep
+     */
+    unsigned GetNumActiveLanes() const;
+
+    /**
+     * @param lane a lane
+     * @return whether the lane is still moving in lockstep
+     */
+    bool IsLaneActive(unsigned lane) const;
+
+    /**
+     * @param lane a lane
+     * @return the wound tension of the lane
+     */
+    double GetWoundTension(unsigned lane) const;
+
+    /**
+     * @return the number of steps taken by the ensemble
+     */
+    unsigned GetNumSteps() const;
+
+    /**
+     * @param lane a lane
+     * @return the number of steps taken by the lane before it split off, or by the ensemble if it has not
+     */
+    unsigned GetLaneNumSteps(unsigned lane) const;
+
+    /**
+     * @param nodeIndex the global index of a node
+     * @param lane a lane
+     * @return the location of the node in the lane
+     */
+    c_vector<double, 2> GetNodeLocation(unsigned nodeIndex, unsigned lane) const;
+
+    /**
+     * @param nodeIndex the global index of a node
+     * @param lane a lane
+     * @return the force on the node in the lane, as found by the last call to ComputeForces()
+     */
+    c_vector<double, 2> GetNodeForce(unsigned nodeIndex, unsigned lane) const;
+
+    /**
+     * Find the forces on the nodes of all lanes, in one pass over the elements and wound nodes.
+     */
+    void ComputeForces();
+
+    /**
+     * Move the active lanes by one time step, and split off the lanes whose topology
+     * would change before the next step.
+     *
+     * @return the lanes that split off at this step
+     */
+    std::vector<unsigned> Step();
+
+    /**
+     * Step until all lanes have split off or a number of steps has been taken.
+     *
+     * @param maxNumSteps the largest number of steps to take
+     */
+    void Run(unsigned maxNumSteps);
+
+    /**
+     * Carry a lane on in a separate simulation. The node locations of the lane are copied
+     * into a population that must be in the state the ensemble was built from, for example
+     * a copy loaded from the same checkpoint, and the simulation time is moved on by the
+     * steps the lane has taken. Solving a simulation of the population with the same time
+     * step then carries on exactly where the lane stopped.
+     *
+     * @param lane a lane
+     * @param rCellPopulation the population to carry the lane on in
+     */
+    void HandOffLane(unsigned lane, VertexBasedCellPopulation<2>& rCellPopulation) const;
+};
+
+#endif /*WOUNDTENSIONENSEMBLE_HPP_*/
@@ -0,0 +1,205 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef WOUNDTRAJECTORYFORMAT_HPP_
+#define WOUNDTRAJECTORYFORMAT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The header of a wound trajectory file. These files hold the results of one run as a
+ * sequence of blocks, appended as the run goes, in the byte order of the machine that
+ * wrote them. Each block is a WoundTrajectoryBlockHeader followed by its payload, whose
+ * columns each start at a multiple of 8 bytes from the start of the file, so the file
+ * can be memory mapped and its columns used in place. A run that stops early leaves a
+ * file whose complete blocks can still be read.
+ *
+ * There are three kinds of block:
+ *
+ *  - A topology block holds the connectivity of the mesh: its version as a uint32_t, the
+ *    numbers of nodes, elements and element node entries as uint32_t, the boundary flag of
+ *    each node as a byte, then the element offsets and element nodes as uint32_t, as in
+ *    the binary vertex mesh format (see VertexMeshBinaryFormat.hpp). A new version is
+ *    written whenever the connectivity changes, before any frame that uses it.
+ *  - A frames block holds the node positions of a batch of frames: the time of each
+ *    frame as a double, the topology version of each frame as uint32_t, the offset of each
+ *    frame into the coordinate columns as uint64_t (one more than the number of frames),
+ *    then the x coordinates and the y coordinates of all frames, as doubles.
+ *  - A metrics block holds a batch of wound measurements, one row per wound and frame: the
+ *    time as a double, the wound index and number of wound nodes as uint32_t, and the area
+ *    and perimeter of the wound as doubles.
+ *
+ * python/wound_trajectory.py reads these files into numpy arrays without copying them.
+ */
+struct WoundTrajectoryFileHeader
+{
+    /** Identifies the file as a wound trajectory. */
+    char mMagic[8];
+
+    /** The version of the format. */
+    uint32_t mVersion;
+
+    /** The value 0x01020304, to detect files written on machines of a different byte order. */
+    uint32_t mByteOrderMark;
+};
+
+static_assert(sizeof(WoundTrajectoryFileHeader) == 16, "The wound trajectory header must not be padded");
+
+/**
+ * The header of a block of a wound trajectory file.
+ */
+struct WoundTrajectoryBlockHeader
+{
+    /** The kind of block, one of the WoundTrajectoryBlockType values. */
+    uint32_t mBlockType;
+
+    /** The number of topologies, frames or metrics rows in the block. */
+    uint32_t mNumRecords;
+
+    /** The size of the payload that follows, in bytes, a multiple of 8. */
+    uint64_t mPayloadBytes;
+
+    /** The total number of nodes of the frames in a frames block, and zero otherwise. */
+    uint64_t mNumFrameNodes;
+};
+
+static_assert(sizeof(WoundTrajectoryBlockHeader) == 24, "The wound trajectory block header must not be padded");
+
+/** The kinds of block of a wound trajectory file. */
+enum WoundTrajectoryBlockType
+{
+    WOUND_TRAJECTORY_TOPOLOGY_BLOCK = 1,
+    WOUND_TRAJECTORY_FRAMES_BLOCK = 2,
+    WOUND_TRAJECTORY_METRICS_BLOCK = 3
+};
+
+/** The magic string at the start of a wound trajectory file. */
+const char WOUND_TRAJECTORY_MAGIC[8] = {'W', 'N', 'D', 'T', 'R', 'A', 'J', '1'};
+
+/** The current version of the wound trajectory format. */
+const uint32_t WOUND_TRAJECTORY_VERSION = 1;
+
+/** The byte order mark of a wound trajectory file. */
+const uint32_t WOUND_TRAJECTORY_BYTE_ORDER_MARK = 0x01020304;
+
+/**
+ * The positions of the columns in the payload of a block, in bytes from the start of the payload.
+ */
+struct WoundTrajectoryBlockLayout
+{
+    /** The start of each column of the block, in the order they are described above. */
+    std::size_t mColumnOffsets[8];
+
+    /** The number of columns of the block. */
+    unsigned mNumColumns;
+
+    /** The size of the payload. */
+    std::size_t mPayloadBytes;
+
+    /**
+     * Lay out a topology block. The four counts come first, as uint32_t.
+     *
+     * @param numNodes the number of nodes
+     * @param numElements the number of elements
+     * @param numElementNodeEntries the total number of entries in the element node list
+     * @return the layout
+     */
+    static WoundTrajectoryBlockLayout ForTopology(std::size_t numNodes, std::size_t numElements, std::size_t numElementNodeEntries)
+    {
+        WoundTrajectoryBlockLayout layout;
+        layout.mNumColumns = 0;
+        layout.mPayloadBytes = 0;
+        layout.AddColumn(4*sizeof(uint32_t));
+        layout.AddColumn(numNodes);
+        layout.AddColumn((numElements + 1)*sizeof(uint32_t));
+        layout.AddColumn(numElementNodeEntries*sizeof(uint32_t));
+        return layout;
+    }
+
+    /**
+     * Lay out a frames block.
+     *
+     * @param numFrames the number of frames
+     * @param numFrameNodes the total number of nodes of the frames
+     * @return the layout
+     */
+    static WoundTrajectoryBlockLayout ForFrames(std::size_t numFrames, std::size_t numFrameNodes)
+    {
+        WoundTrajectoryBlockLayout layout;
+        layout.mNumColumns = 0;
+        layout.mPayloadBytes = 0;
+        layout.AddColumn(numFrames*sizeof(double));
+        layout.AddColumn(numFrames*sizeof(uint32_t));
+        layout.AddColumn((numFrames + 1)*sizeof(uint64_t));
+        layout.AddColumn(numFrameNodes*sizeof(double));
+        layout.AddColumn(numFrameNodes*sizeof(double));
+        return layout;
+    }
+
+    /**
+     * Lay out a metrics block.
+     *
+     * @param numRows the number of rows
+     * @return the layout
+     */
+    static WoundTrajectoryBlockLayout ForMetrics(std::size_t numRows)
+    {
+        WoundTrajectoryBlockLayout layout;
+        layout.mNumColumns = 0;
+        layout.mPayloadBytes = 0;
+        layout.AddColumn(numRows*sizeof(double));
+        layout.AddColumn(numRows*sizeof(uint32_t));
+        layout.AddColumn(numRows*sizeof(uint32_t));
+        layout.AddColumn(numRows*sizeof(double));
+        layout.AddColumn(numRows*sizeof(double));
+        return layout;
+    }
+
+private:
+
+    /**
+     * Add a column at the end of the payload, padded to a multiple of 8 bytes.
+     *
+     * @param numBytes the size of the column
+     */
+    void AddColumn(std::size_t numBytes)
+    {
+        mColumnOffsets[mNumColumns++] = mPayloadBytes;
+        mPayloadBytes = (mPayloadBytes + numBytes + 7) & ~static_cast<std::size_t>(7);
+    }
+};
+
+#endif /*WOUNDTRAJECTORYFORMAT_HPP_*/
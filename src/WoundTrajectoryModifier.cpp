@@ -0,0 +1,175 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "WoundTrajectoryModifier.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SimulationTime.hpp"
+#include "OutputFileHandler.hpp"
+#include "Exception.hpp"
+#include "WoundMeshUtilities.hpp"
+
+template<unsigned DIM>
+WoundTrajectoryModifier<DIM>::WoundTrajectoryModifier()
+    : AbstractCellBasedSimulationModifier<DIM, DIM>(),
+      mOutputTimestepMultiple(1u),
+      mBlockBytes(16u*1024u*1024u),
+      mNumSteps(0u)
+{
+}
+
+template<unsigned DIM>
+WoundTrajectoryModifier<DIM>::WoundTrajectoryModifier(boost::shared_ptr<WoundHealingForce<DIM> > pWoundForce)
+    : AbstractCellBasedSimulationModifier<DIM, DIM>(),
+      mpWoundForce(pWoundForce),
+      mOutputTimestepMultiple(1u),
+      mBlockBytes(16u*1024u*1024u),
+      mNumSteps(0u)
+{
+}
+
+template<unsigned DIM>
+WoundTrajectoryModifier<DIM>::~WoundTrajectoryModifier()
+{
+}
+
+template<unsigned DIM>
+void WoundTrajectoryModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation, std::string outputDirectory)
+{
+    if (dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation) == nullptr)
+    {
+        EXCEPTION("WoundTrajectoryModifier is to be used with a VertexBasedCellPopulation only");
+    }
+    if (!mpWoundForce)
+    {
+        EXCEPTION("WoundTrajectoryModifier needs a WoundHealingForce to measure");
+    }
+
+    mNumSteps = 0;
+
+    OutputFileHandler output_file_handler(outputDirectory, false);
+    mpWriter.reset(new WoundTrajectoryWriter(output_file_handler.GetOutputDirectoryFullPath() + "trajectory.wtraj", mBlockBytes));
+
+    MutableVertexMesh<DIM, DIM>& r_mesh = static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation).rGetMesh();
+    mpWriter->AddFrame(r_mesh, SimulationTime::Instance()->GetTime());
+}
+
+template<unsigned DIM>
+void WoundTrajectoryModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DIM>& rCellPopulation)
+{
+    mNumSteps++;
+    if (mNumSteps % mOutputTimestepMultiple != 0)
+    {
+        return;
+    }
+
+    // The rings were found by the force during this step, and their node indices are still valid here
+    MutableVertexMesh<DIM, DIM>& r_mesh = static_cast<VertexBasedCellPopulation<DIM>&>(rCellPopulation).rGetMesh();
+    const std::vector<std::vector<unsigned> >& r_wound_loops = mpWoundForce->rGetWoundLoops();
+    double time = SimulationTime::Instance()->GetTime();
+
+    for (unsigned wound_index=0; wound_index<r_wound_loops.size(); wound_index++)
+    {
+        const std::vector<unsigned>& r_loop = r_wound_loops[wound_index];
+        mpWriter->AddWoundMetrics(time, wound_index, r_loop.size(),
+                                  WoundMeshUtilities::GetAreaOfWound(r_mesh, r_loop),
+                                  WoundMeshUtilities::GetPerimeterOfLoop(r_mesh, r_loop));
+    }
+
+    // The frame is taken after the metrics, as taking it may write the block that holds them
+    mpWriter->AddFrame(r_mesh, time);
+}
+
+template<unsigned DIM>
+void WoundTrajectoryModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation)
+{
+    if (mpWriter)
+    {
+        mpWriter->Close();
+    }
+}
+
+template<unsigned DIM>
+unsigned WoundTrajectoryModifier<DIM>::GetOutputTimestepMultiple() const
+{
+    return mOutputTimestepMultiple;
+}
+
+template<unsigned DIM>
+void WoundTrajectoryModifier<DIM>::SetOutputTimestepMultiple(unsigned outputTimestepMultiple)
+{
+    assert(outputTimestepMultiple > 0);
+    mOutputTimestepMultiple = outputTimestepMultiple;
+}
+
+template<unsigned DIM>
+unsigned WoundTrajectoryModifier<DIM>::GetBlockBytes() const
+{
+    return mBlockBytes;
+}
+
+template<unsigned DIM>
+void WoundTrajectoryModifier<DIM>::SetBlockBytes(unsigned blockBytes)
+{
+    mBlockBytes = blockBytes;
+}
+
+template<unsigned DIM>
+unsigned WoundTrajectoryModifier<DIM>::GetNumFrames() const
+{
+    return mpWriter ? mpWriter->GetNumFrames() : 0u;
+}
+
+template<unsigned DIM>
+unsigned WoundTrajectoryModifier<DIM>::GetNumTopologyVersions() const
+{
+    return mpWriter ? mpWriter->GetNumTopologyVersions() : 0u;
+}
+
+template<unsigned DIM>
+void WoundTrajectoryModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<OutputTimestepMultiple>" << mOutputTimestepMultiple << "</OutputTimestepMultiple>\n";
+    *rParamsFile << "\t\t\t<BlockBytes>" << mBlockBytes << "</BlockBytes>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM, DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class WoundTrajectoryModifier<2>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS1(WoundTrajectoryModifier, 2)
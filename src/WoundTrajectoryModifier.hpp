@@ -0,0 +1,186 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef WOUNDTRAJECTORYMODIFIER_HPP_
+#define WOUNDTRAJECTORYMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "WoundHealingForce.hpp"
+#include "WoundTrajectoryWriter.hpp"
+
+/**
+ * A modifier that stores the trajectory of a run in one file, trajectory.wtraj in the
+ * simulation output directory, in the columnar format described in WoundTrajectoryFormat.hpp.
+ * Every few steps it stores the positions of the nodes and the area and perimeter of each wound
+ * found by a WoundHealingForce; the connectivity of the mesh is stored again only when it
+ * changes. The file is written by a WoundTrajectoryWriter in large blocks, and can be read
+ * without copying by python/wound_trajectory.py.
+ *
+ * This is an alternative to the usual VTK output for long or large runs, which is best
+ * turned off by making the sampling timestep multiple of the simulation large.
+ */
+template<unsigned DIM>
+class WoundTrajectoryModifier : public AbstractCellBasedSimulationModifier<DIM, DIM>
+{
+static_assert(DIM == 2, "WoundTrajectoryModifier is only defined for two-dimensional vertex populations");
+
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM, DIM> >(*this);
+        archive & mpWoundForce;
+        archive & mOutputTimestepMultiple;
+        archive & mBlockBytes;
+    }
+
+    /** The force whose wound rings are measured. */
+    boost::shared_ptr<WoundHealingForce<DIM> > mpWoundForce;
+
+    /** The number of steps between frames. */
+    unsigned mOutputTimestepMultiple;
+
+    /** The number of bytes of frames and metrics to gather before they are written. */
+    unsigned mBlockBytes;
+
+    /** The writer of the trajectory, during and after a solve. */
+    boost::shared_ptr<WoundTrajectoryWriter> mpWriter;
+
+    /** The number of steps taken in the current solve. */
+    unsigned mNumSteps;
+
+public:
+
+    /**
+     * Default constructor, for archiving only.
+     */
+    WoundTrajectoryModifier();
+
+    /**
+     * Constructor.
+     *
+     * @param pWoundForce the force whose wound rings are measured. It must be one of the forces of the simulation.
+     */
+    WoundTrajectoryModifier(boost::shared_ptr<WoundHealingForce<DIM> > pWoundForce);
+
+    /**
+     * Destructor.
+     */
+    virtual ~WoundTrajectoryModifier();
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method. Adds a frame and the wound metrics every
+     * mOutputTimestepMultiple steps.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM, DIM>& rCellPopulation);
+
+    /**
+     * Overridden SetupSolve() method. Creates the trajectory file and adds the first frame.
+     * There are no wound metrics for the first frame, as the force has not yet found the wounds.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method. Writes the frames that are waiting and closes the file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM, DIM>& rCellPopulation);
+
+    /**
+     * @return the number of steps between frames
+     */
+    unsigned GetOutputTimestepMultiple() const;
+
+    /**
+     * Set the number of steps between frames. Defaults to 1.
+     *
+     * @param outputTimestepMultiple the number of steps, at least 1
+     */
+    void SetOutputTimestepMultiple(unsigned outputTimestepMultiple);
+
+    /**
+     * @return the number of bytes of frames and metrics gathered before they are written
+     */
+    unsigned GetBlockBytes() const;
+
+    /**
+     * Set the number of bytes of frames and metrics gathered before they are written.
+     * Defaults to 16 MiB.
+     *
+     * @param blockBytes the number of bytes
+     */
+    void SetBlockBytes(unsigned blockBytes);
+
+    /**
+     * @return the number of frames stored in the current or last solve
+     */
+    unsigned GetNumFrames() const;
+
+    /**
+     * @return the number of topology versions stored in the current or last solve
+     */
+    unsigned GetNumTopologyVersions() const;
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS1(WoundTrajectoryModifier, 2)
+
+#endif /*WOUNDTRAJECTORYMODIFIER_HPP_*/
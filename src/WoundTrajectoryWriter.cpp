@@ -0,0 +1,288 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "WoundTrajectoryWriter.hpp"
+#include "Exception.hpp"
+#include "WoundHealingTracer.hpp"
+
+#include <cassert>
+#include <cstring>
+
+WoundTrajectoryWriter::WoundTrajectoryWriter(const std::string& rPathToFile, std::size_t blockBytes)
+    : mPath(rPathToFile),
+      mBlockBytes(blockBytes),
+      mFrameNodeOffsets(1, 0),
+      mNumTopologyVersions(0),
+      mNumFrames(0),
+      mNumMetricsRows(0),
+      mNumBlocks(0),
+      mNumBytesWritten(0)
+{
+    mFile.open(mPath.c_str(), std::ios::binary | std::ios::trunc);
+    if (!mFile.is_open())
+    {
+        EXCEPTION("Could not open the wound trajectory file " + mPath + " for writing");
+    }
+
+    WoundTrajectoryFileHeader header;
+    memcpy(header.mMagic, WOUND_TRAJECTORY_MAGIC, sizeof(WOUND_TRAJECTORY_MAGIC));
+    header.mVersion = WOUND_TRAJECTORY_VERSION;
+    header.mByteOrderMark = WOUND_TRAJECTORY_BYTE_ORDER_MARK;
+    WriteColumn(&header, sizeof(header));
+}
+
+WoundTrajectoryWriter::~WoundTrajectoryWriter()
+{
+    try
+    {
+        Close();
+    }
+    catch (const Exception&)
+    {
+        // Destructors must not throw; call Close() first to see errors
+    }
+}
+
+void WoundTrajectoryWriter::AddFrame(VertexMesh<2, 2>& rMesh, double time)
+{
+    VertexMeshBinaryWriter::CopyArraysOfMesh(rMesh, mMeshArrays);
+    AddFrame(mMeshArrays, time);
+}
+
+void WoundTrajectoryWriter::AddFrame(const VertexMeshBinaryArrays& rArrays, double time)
+{
+    if (!mFile.is_open())
+    {
+        EXCEPTION("Frames cannot be added to the wound trajectory file " + mPath + " once it is closed");
+    }
+
+    // Frames refer to topologies written before them, so a new topology is written straight away
+    if (mNumTopologyVersions == 0 || HasTopologyChanged(rArrays))
+    {
+        WriteTopology(rArrays);
+    }
+
+    mFrameTimes.push_back(time);
+    mFrameTopologyVersions.push_back(mNumTopologyVersions - 1);
+    mFrameX.insert(mFrameX.end(), rArrays.mX.begin(), rArrays.mX.end());
+    mFrameY.insert(mFrameY.end(), rArrays.mY.begin(), rArrays.mY.end());
+    mFrameNodeOffsets.push_back(mFrameX.size());
+    mNumFrames++;
+
+    if (GetNumPendingBytes() >= mBlockBytes)
+    {
+        Flush();
+    }
+}
+
+void WoundTrajectoryWriter::AddWoundMetrics(double time, unsigned woundIndex, unsigned numNodes, double area, double perimeter)
+{
+    if (!mFile.is_open())
+    {
+        EXCEPTION("Metrics cannot be added to the wound trajectory file " + mPath + " once it is closed");
+    }
+
+    mMetricsTimes.push_back(time);
+    mMetricsWoundIndices.push_back(woundIndex);
+    mMetricsNumNodes.push_back(numNodes);
+    mMetricsAreas.push_back(area);
+    mMetricsPerimeters.push_back(perimeter);
+    mNumMetricsRows++;
+
+    if (GetNumPendingBytes() >= mBlockBytes)
+    {
+        Flush();
+    }
+}
+
+void WoundTrajectoryWriter::Flush()
+{
+    if (!mFile.is_open())
+    {
+        return;
+    }
+    WOUND_HEALING_TRACE_SCOPE("WriteTrajectoryBlocks");
+
+    if (!mFrameTimes.empty())
+    {
+        const std::size_t num_frames = mFrameTimes.size();
+        WoundTrajectoryBlockLayout layout = WoundTrajectoryBlockLayout::ForFrames(num_frames, mFrameX.size());
+        WriteBlockHeader(WOUND_TRAJECTORY_FRAMES_BLOCK, num_frames, layout, mFrameX.size());
+        WriteColumn(mFrameTimes.data(), num_frames*sizeof(double));
+        WriteColumn(mFrameTopologyVersions.data(), num_frames*sizeof(uint32_t));
+        WriteColumn(mFrameNodeOffsets.data(), (num_frames + 1)*sizeof(uint64_t));
+        WriteColumn(mFrameX.data(), mFrameX.size()*sizeof(double));
+        WriteColumn(mFrameY.data(), mFrameY.size()*sizeof(double));
+
+        // Clearing keeps the capacity, so later blocks of a similar size do not allocate
+        mFrameTimes.clear();
+        mFrameTopologyVersions.clear();
+        mFrameNodeOffsets.assign(1, 0);
+        mFrameX.clear();
+        mFrameY.clear();
+    }
+
+    if (!mMetricsTimes.empty())
+    {
+        const std::size_t num_rows = mMetricsTimes.size();
+        WoundTrajectoryBlockLayout layout = WoundTrajectoryBlockLayout::ForMetrics(num_rows);
+        WriteBlockHeader(WOUND_TRAJECTORY_METRICS_BLOCK, num_rows, layout);
+        WriteColumn(mMetricsTimes.data(), num_rows*sizeof(double));
+        WriteColumn(mMetricsWoundIndices.data(), num_rows*sizeof(uint32_t));
+        WriteColumn(mMetricsNumNodes.data(), num_rows*sizeof(uint32_t));
+        WriteColumn(mMetricsAreas.data(), num_rows*sizeof(double));
+        WriteColumn(mMetricsPerimeters.data(), num_rows*sizeof(double));
+
+        mMetricsTimes.clear();
+        mMetricsWoundIndices.clear();
+        mMetricsNumNodes.clear();
+        mMetricsAreas.clear();
+        mMetricsPerimeters.clear();
+    }
+
+    mFile.flush();
+    if (mFile.fail())
+    {
+        EXCEPTION("Could not write the wound trajectory file " + mPath);
+    }
+}
+
+void WoundTrajectoryWriter::Close()
+{
+    if (mFile.is_open())
+    {
+        Flush();
+        mFile.close();
+        if (mFile.fail())
+        {
+            EXCEPTION("Could not write the wound trajectory file " + mPath);
+        }
+    }
+}
+
+bool WoundTrajectoryWriter::HasTopologyChanged(const VertexMeshBinaryArrays& rArrays) const
+{
+    return rArrays.mElementOffsets != mTopology.mElementOffsets
+        || rArrays.mElementNodes != mTopology.mElementNodes
+        || rArrays.mIsBoundaryNode != mTopology.mIsBoundaryNode;
+}
+
+void WoundTrajectoryWriter::WriteTopology(const VertexMeshBinaryArrays& rArrays)
+{
+    WOUND_HEALING_TRACE_SCOPE("WriteTrajectoryTopology");
+
+    // Assigning reuses the capacity of the vectors, so this does not allocate once the mesh settles
+    mTopology.mIsBoundaryNode.assign(rArrays.mIsBoundaryNode.begin(), rArrays.mIsBoundaryNode.end());
+    mTopology.mElementOffsets.assign(rArrays.mElementOffsets.begin(), rArrays.mElementOffsets.end());
+    mTopology.mElementNodes.assign(rArrays.mElementNodes.begin(), rArrays.mElementNodes.end());
+
+    const std::size_t num_nodes = rArrays.mX.size();
+    const std::size_t num_elements = rArrays.mElementOffsets.size() - 1;
+    const std::size_t num_entries = rArrays.mElementNodes.size();
+    uint32_t counts[4] = {mNumTopologyVersions,
+                          static_cast<uint32_t>(num_nodes),
+                          static_cast<uint32_t>(num_elements),
+                          static_cast<uint32_t>(num_entries)};
+
+    WoundTrajectoryBlockLayout layout = WoundTrajectoryBlockLayout::ForTopology(num_nodes, num_elements, num_entries);
+    WriteBlockHeader(WOUND_TRAJECTORY_TOPOLOGY_BLOCK, 1, layout);
+    WriteColumn(counts, sizeof(counts));
+    WriteColumn(rArrays.mIsBoundaryNode.data(), num_nodes);
+    WriteColumn(rArrays.mElementOffsets.data(), (num_elements + 1)*sizeof(uint32_t));
+    WriteColumn(rArrays.mElementNodes.data(), num_entries*sizeof(uint32_t));
+    mNumTopologyVersions++;
+}
+
+void WoundTrajectoryWriter::WriteBlockHeader(WoundTrajectoryBlockType blockType, std::size_t numRecords,
+                                             const WoundTrajectoryBlockLayout& rLayout, std::size_t numFrameNodes)
+{
+    WoundTrajectoryBlockHeader header;
+    header.mBlockType = blockType;
+    header.mNumRecords = numRecords;
+    header.mPayloadBytes = rLayout.mPayloadBytes;
+    header.mNumFrameNodes = numFrameNodes;
+    WriteColumn(&header, sizeof(header));
+    mNumBlocks++;
+}
+
+void WoundTrajectoryWriter::WriteColumn(const void* pData, std::size_t numBytes)
+{
+    static const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    std::size_t num_padding_bytes = (8 - numBytes%8)%8;
+    if (numBytes > 0)
+    {
+        mFile.write(static_cast<const char*>(pData), numBytes);
+    }
+    mFile.write(padding, num_padding_bytes);
+    mNumBytesWritten += numBytes + num_padding_bytes;
+    assert(mNumBytesWritten%8 == 0);
+}
+
+std::size_t WoundTrajectoryWriter::GetNumPendingBytes() const
+{
+    return mFrameTimes.size()*(sizeof(double) + sizeof(uint32_t) + sizeof(uint64_t))
+         + mFrameX.size()*2*sizeof(double)
+         + mMetricsTimes.size()*(3*sizeof(double) + 2*sizeof(uint32_t));
+}
+
+std::size_t WoundTrajectoryWriter::GetBlockBytes() const
+{
+    return mBlockBytes;
+}
+
+unsigned WoundTrajectoryWriter::GetNumFrames() const
+{
+    return mNumFrames;
+}
+
+unsigned WoundTrajectoryWriter::GetNumMetricsRows() const
+{
+    return mNumMetricsRows;
+}
+
+unsigned WoundTrajectoryWriter::GetNumTopologyVersions() const
+{
+    return mNumTopologyVersions;
+}
+
+unsigned WoundTrajectoryWriter::GetNumBlocks() const
+{
+    return mNumBlocks;
+}
+
+std::size_t WoundTrajectoryWriter::GetNumBytesWritten() const
+{
+    return mNumBytesWritten;
+}
@@ -0,0 +1,246 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef WOUNDTRAJECTORYWRITER_HPP_
+#define WOUNDTRAJECTORYWRITER_HPP_
+
+#include "VertexMesh.hpp"
+#include "VertexMeshBinaryWriter.hpp"
+#include "WoundTrajectoryFormat.hpp"
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Writes the trajectory of a run to one file, in the append-only columnar format described
+ * in WoundTrajectoryFormat.hpp.
+ *
+ * Frames and wound metrics are gathered in memory, column by column, and written as one
+ * frames block and one metrics block once they take up the block size, so the file is
+ * written in a few large writes rather than one per step. The connectivity of the mesh is
+ * compared with that of the previous frame, and a topology block is written only when it
+ * has changed, so a run with few T1 and T2 swaps stores its elements a few times rather
+ * than at every frame.
+ */
+class WoundTrajectoryWriter
+{
+private:
+
+    /** The path to the file. */
+    std::string mPath;
+
+    /** The file. */
+    std::ofstream mFile;
+
+    /** The number of bytes of frames and metrics to gather before they are written. */
+    std::size_t mBlockBytes;
+
+    /** The times of the frames waiting to be written. */
+    std::vector<double> mFrameTimes;
+
+    /** The topology versions of the frames waiting to be written. */
+    std::vector<uint32_t> mFrameTopologyVersions;
+
+    /** The offsets of the frames waiting to be written into mFrameX and mFrameY, starting with 0. */
+    std::vector<uint64_t> mFrameNodeOffsets;
+
+    /** The x coordinates of the frames waiting to be written. */
+    std::vector<double> mFrameX;
+
+    /** The y coordinates of the frames waiting to be written. */
+    std::vector<double> mFrameY;
+
+    /** The times of the metrics rows waiting to be written. */
+    std::vector<double> mMetricsTimes;
+
+    /** The wound indices of the metrics rows waiting to be written. */
+    std::vector<uint32_t> mMetricsWoundIndices;
+
+    /** The numbers of wound nodes of the metrics rows waiting to be written. */
+    std::vector<uint32_t> mMetricsNumNodes;
+
+    /** The wound areas of the metrics rows waiting to be written. */
+    std::vector<double> mMetricsAreas;
+
+    /** The wound perimeters of the metrics rows waiting to be written. */
+    std::vector<double> mMetricsPerimeters;
+
+    /** The connectivity of the last topology written, to detect changes to it. */
+    VertexMeshBinaryArrays mTopology;
+
+    /** Scratch space for the arrays of a mesh, reused between frames. */
+    VertexMeshBinaryArrays mMeshArrays;
+
+    /** The number of topology versions written. */
+    unsigned mNumTopologyVersions;
+
+    /** The number of frames added. */
+    unsigned mNumFrames;
+
+    /** The number of metrics rows added. */
+    unsigned mNumMetricsRows;
+
+    /** The number of blocks written. */
+    unsigned mNumBlocks;
+
+    /** The number of bytes written to the file. */
+    std::size_t mNumBytesWritten;
+
+    /**
+     * @param rArrays the arrays of a mesh
+     * @return whether their connectivity differs from that of the last topology written
+     */
+    bool HasTopologyChanged(const VertexMeshBinaryArrays& rArrays) const;
+
+    /**
+     * Write a topology block for the connectivity of some arrays.
+     *
+     * @param rArrays the arrays of a mesh
+     */
+    void WriteTopology(const VertexMeshBinaryArrays& rArrays);
+
+    /**
+     * Write a block header.
+     *
+     * @param blockType the kind of block
+     * @param numRecords the number of records in the block
+     * @param rLayout the layout of the payload
+     * @param numFrameNodes the total number of nodes of the frames in a frames block
+     */
+    void WriteBlockHeader(WoundTrajectoryBlockType blockType, std::size_t numRecords,
+                          const WoundTrajectoryBlockLayout& rLayout, std::size_t numFrameNodes=0);
+
+    /**
+     * Write a column of a block, padded with zeros to a multiple of 8 bytes.
+     *
+     * @param pData the start of the column
+     * @param numBytes the size of the column
+     */
+    void WriteColumn(const void* pData, std::size_t numBytes);
+
+    /**
+     * @return the number of bytes of frames and metrics waiting to be written
+     */
+    std::size_t GetNumPendingBytes() const;
+
+public:
+
+    /**
+     * Constructor. Creates the file, replacing any file of the same name, and writes its header.
+     *
+     * @param rPathToFile the path to the file
+     * @param blockBytes the number of bytes of frames and metrics to gather before they are written
+     */
+    WoundTrajectoryWriter(const std::string& rPathToFile, std::size_t blockBytes=16u*1024u*1024u);
+
+    /**
+     * Destructor. Writes any frames and metrics that are waiting, without reporting errors.
+     */
+    ~WoundTrajectoryWriter();
+
+    /**
+     * Add a frame of a mesh. Deleted nodes and elements are left out, as by
+     * VertexMeshBinaryWriter::WriteFileUsingMesh().
+     *
+     * @param rMesh the mesh
+     * @param time the simulation time
+     */
+    void AddFrame(VertexMesh<2, 2>& rMesh, double time);
+
+    /**
+     * Add a frame of a mesh held as arrays. Element attributes are not stored.
+     *
+     * @param rArrays the arrays of the mesh
+     * @param time the simulation time
+     */
+    void AddFrame(const VertexMeshBinaryArrays& rArrays, double time);
+
+    /**
+     * Add a row of wound metrics.
+     *
+     * @param time the simulation time
+     * @param woundIndex the index of the wound
+     * @param numNodes the number of nodes around the wound
+     * @param area the area of the wound
+     * @param perimeter the perimeter of the wound
+     */
+    void AddWoundMetrics(double time, unsigned woundIndex, unsigned numNodes, double area, double perimeter);
+
+    /**
+     * Write the frames and metrics that are waiting, however few there are.
+     */
+    void Flush();
+
+    /**
+     * Write the frames and metrics that are waiting and close the file. Does nothing if the
+     * file is already closed.
+     */
+    void Close();
+
+    /**
+     * @return the number of bytes of frames and metrics gathered before they are written
+     */
+    std::size_t GetBlockBytes() const;
+
+    /**
+     * @return the number of frames added
+     */
+    unsigned GetNumFrames() const;
+
+    /**
+     * @return the number of metrics rows added
+     */
+    unsigned GetNumMetricsRows() const;
+
+    /**
+     * @return the number of topology versions written, which is one more than the number of
+     * times the connectivity changed between frames
+     */
+    unsigned GetNumTopologyVersions() const;
+
+    /**
+     * @return the number of blocks written so far
+     */
+    unsigned GetNumBlocks() const;
+
+    /**
+     * @return the number of bytes written to the file so far
+     */
+    std::size_t GetNumBytesWritten() const;
+};
+
+#endif /*WOUNDTRAJECTORYWRITER_HPP_*/
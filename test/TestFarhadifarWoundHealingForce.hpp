@@ -0,0 +1,193 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTFARHADIFARWOUNDHEALINGFORCE_HPP_
+#define TESTFARHADIFARWOUNDHEALINGFORCE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "FarhadifarForce.hpp"
+#include "SmartPointers.hpp"
+#include "WoundHealingForce.hpp"
+#include "FarhadifarWoundHealingForce.hpp"
+
+class TestFarhadifarWoundHealingForce : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestFusedForceMatchesSeparateForces()
+    {
+        // Create a honeycomb mesh with a wound
+        HoneycombVertexMeshGenerator generator(6, 6);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        p_mesh->DeleteElementPriorToReMesh(14);
+        p_mesh->ReMesh();
+
+        // Perturb the nodes, so that no forces cancel by symmetry
+        for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+        {
+            c_vector<double, 2>& r_location = p_mesh->GetNode(node_index)->rGetModifiableLocation();
+            r_location[0] += 0.02*sin((double)node_index);
+            r_location[1] += 0.02*cos(3.0*node_index);
+        }
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_fused_force);
+        p_fused_force->SetAreaElasticityParameter(1.5);
+        p_fused_force->SetPerimeterContractilityParameter(0.07);
+        p_fused_force->SetLineTensionParameter(0.2);
+        p_fused_force->SetBoundaryLineTensionParameter(0.3);
+        p_fused_force->SetWoundTensionParameter(1.0);
+
+        // The force needs target areas
+        TS_ASSERT_THROWS_THIS(p_fused_force->AddForceContribution(cell_population),
+                "You need to add an AbstractTargetAreaModifier to the simulation in order to use a FarhadifarWoundHealingForce");
+
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            cell_iter->GetCellData()->SetItem("target area", 0.8);
+        }
+
+        // Apply a FarhadifarForce and a WoundHealingForce with the same parameters
+        MAKE_PTR(FarhadifarForce<2>, p_farhadifar_force);
+        p_farhadifar_force->SetAreaElasticityParameter(1.5);
+        p_farhadifar_force->SetPerimeterContractilityParameter(0.07);
+        p_farhadifar_force->SetLineTensionParameter(0.2);
+        p_farhadifar_force->SetBoundaryLineTensionParameter(0.3);
+        MAKE_PTR(WoundHealingForce<2>, p_wound_force);
+        p_wound_force->SetWoundTensionParameter(1.0);
+
+        for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+        {
+            cell_population.GetNode(node_index)->ClearAppliedForce();
+        }
+        p_farhadifar_force->AddForceContribution(cell_population);
+        p_wound_force->AddForceContribution(cell_population);
+
+        std::vector<c_vector<double, 2> > separate_forces;
+        for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+        {
+            separate_forces.push_back(cell_population.GetNode(node_index)->rGetAppliedForce());
+            cell_population.GetNode(node_index)->ClearAppliedForce();
+        }
+
+        // The fused force gives the same result, up to round-off
+        p_fused_force->AddForceContribution(cell_population);
+        for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+        {
+            c_vector<double, 2> fused_force = cell_population.GetNode(node_index)->rGetAppliedForce();
+            TS_ASSERT_DELTA(fused_force[0], separate_forces[node_index][0], 1e-10);
+            TS_ASSERT_DELTA(fused_force[1], separate_forces[node_index][1], 1e-10);
+        }
+        TS_ASSERT_EQUALS(p_fused_force->rGetWoundLoops().size(), 1u);
+    }
+
+    void TestResultsDoNotDependOnNumberOfThreads()
+    {
+        // Create a honeycomb mesh with two wounds
+        HoneycombVertexMeshGenerator generator(10, 10);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        p_mesh->DeleteElementPriorToReMesh(22);
+        p_mesh->DeleteElementPriorToReMesh(66);
+        p_mesh->ReMesh();
+
+        for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+        {
+            c_vector<double, 2>& r_location = p_mesh->GetNode(node_index)->rGetModifiableLocation();
+            r_location[0] += 0.02*sin((double)node_index);
+            r_location[1] += 0.02*cos(3.0*node_index);
+        }
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            cell_iter->GetCellData()->SetItem("target area", 0.8);
+        }
+
+        // Calculate the forces with one thread
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+        TS_ASSERT_EQUALS(p_force->GetNumThreads(), 1u);
+        TS_ASSERT_THROWS_THIS(p_force->SetNumThreads(0), "The number of threads must be positive");
+
+        for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+        {
+            cell_population.GetNode(node_index)->ClearAppliedForce();
+        }
+        p_force->AddForceContribution(cell_population);
+
+        std::vector<c_vector<double, 2> > serial_forces;
+        for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+        {
+            serial_forces.push_back(cell_population.GetNode(node_index)->rGetAppliedForce());
+        }
+
+        // Several threads give exactly the same result
+        for (unsigned num_threads=2; num_threads<=5; num_threads++)
+        {
+            MAKE_PTR(FarhadifarWoundHealingForce<2>, p_threaded_force);
+            p_threaded_force->SetNumThreads(num_threads);
+            for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+            {
+                cell_population.GetNode(node_index)->ClearAppliedForce();
+            }
+            p_threaded_force->AddForceContribution(cell_population);
+
+            TS_ASSERT_EQUALS(p_threaded_force->rGetWoundLoops().size(), 2u);
+            for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+            {
+                TS_ASSERT_EQUALS(cell_population.GetNode(node_index)->rGetAppliedForce()[0], serial_forces[node_index][0]);
+                TS_ASSERT_EQUALS(cell_population.GetNode(node_index)->rGetAppliedForce()[1], serial_forces[node_index][1]);
+            }
+        }
+    }
+};
+
+#endif /*TESTFARHADIFARWOUNDHEALINGFORCE_HPP_*/
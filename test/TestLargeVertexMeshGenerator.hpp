@@ -0,0 +1,199 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTLARGEVERTEXMESHGENERATOR_HPP_
+#define TESTLARGEVERTEXMESHGENERATOR_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+#include "OutputFileHandler.hpp"
+#include "VertexMeshBinaryReader.hpp"
+#include "LargeVertexMeshGenerator.hpp"
+#include "WoundHealingForce.hpp"
+
+#include <vector>
+
+class TestLargeVertexMeshGenerator : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Check that a mesh is a proper vertex tissue: every node is used by at most three
+     * elements, and by three unless it is on the boundary.
+     */
+    void CheckNodeUses(MutableVertexMesh<2,2>& rMesh)
+    {
+        for (unsigned node_index=0; node_index<rMesh.GetNumNodes(); node_index++)
+        {
+            Node<2>* p_node = rMesh.GetNode(node_index);
+            unsigned num_elements = p_node->rGetContainingElementIndices().size();
+            TS_ASSERT_LESS_THAN_EQUALS(1u, num_elements);
+            TS_ASSERT_LESS_THAN_EQUALS(num_elements, 3u);
+            if (!p_node->IsBoundaryNode())
+            {
+                TS_ASSERT_EQUALS(num_elements, 3u);
+            }
+        }
+    }
+
+public:
+
+    void TestVoronoiTissueTilesTheRectangle()
+    {
+        LargeVertexMeshGenerator generator(10, 8, 2.0);
+        generator.GenerateVoronoiTissue(3);
+        TS_ASSERT_DELTA(generator.GetWidth(), 10.0*sqrt(2.0), 1e-12);
+        TS_ASSERT_DELTA(generator.GetHeight(), 8.0*sqrt(2.0), 1e-12);
+        TS_ASSERT_EQUALS(generator.GetNumElements(), 80u);
+        TS_ASSERT_LESS_THAN(0u, generator.GetPeakMemoryBytes());
+        TS_ASSERT_LESS_THAN(0u, LargeVertexMeshGenerator::GetPeakResidentMemoryBytes());
+
+        // The cells are counterclockwise and cover the rectangle without gaps or overlaps
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        TS_ASSERT_EQUALS(p_mesh->GetNumElements(), 80u);
+        TS_ASSERT_EQUALS(p_mesh->GetNumNodes(), generator.GetNumNodes());
+        double total_area = 0.0;
+        for (unsigned elem_index=0; elem_index<p_mesh->GetNumElements(); elem_index++)
+        {
+            double area = p_mesh->GetVolumeOfElement(elem_index);
+            TS_ASSERT_LESS_THAN(0.0, area);
+            total_area += area;
+        }
+        TS_ASSERT_DELTA(total_area, 160.0, 1e-9);
+        CheckNodeUses(*p_mesh);
+
+        // The nodes on the sides of the rectangle are on the boundary
+        for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+        {
+            const c_vector<double, 2>& r_location = p_mesh->GetNode(node_index)->rGetLocation();
+            bool is_on_side = r_location[0] < 1e-12 || r_location[1] < 1e-12
+                              || r_location[0] > generator.GetWidth() - 1e-12 || r_location[1] > generator.GetHeight() - 1e-12;
+            TS_ASSERT_EQUALS(p_mesh->GetNode(node_index)->IsBoundaryNode(), is_on_side);
+        }
+
+        // Random numbers are drawn in serial, so the tissue does not depend on the number of threads
+        RandomNumberGenerator::Instance()->Reseed(0);
+        LargeVertexMeshGenerator serial_generator(10, 8, 2.0);
+        serial_generator.GenerateVoronoiTissue(3);
+        RandomNumberGenerator::Instance()->Reseed(0);
+        LargeVertexMeshGenerator threaded_generator(10, 8, 2.0);
+        threaded_generator.SetNumThreads(3);
+        TS_ASSERT_EQUALS(threaded_generator.GetNumThreads(), 3u);
+        threaded_generator.GenerateVoronoiTissue(3);
+        TS_ASSERT(serial_generator.rGetArrays().mX == threaded_generator.rGetArrays().mX);
+        TS_ASSERT(serial_generator.rGetArrays().mY == threaded_generator.rGetArrays().mY);
+        TS_ASSERT(serial_generator.rGetArrays().mElementNodes == threaded_generator.rGetArrays().mElementNodes);
+    }
+
+    void TestJitteredHoneycomb()
+    {
+        // Without jitter, this is the honeycomb of HoneycombVertexMeshGenerator
+        LargeVertexMeshGenerator generator(6, 4);
+        generator.GenerateJitteredHoneycomb(0.0);
+        HoneycombVertexMeshGenerator honeycomb_generator(6, 4);
+        TS_ASSERT_EQUALS(generator.GetNumNodes(), honeycomb_generator.GetMesh()->GetNumNodes());
+        TS_ASSERT_EQUALS(generator.GetNumElements(), 24u);
+
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        for (unsigned elem_index=0; elem_index<p_mesh->GetNumElements(); elem_index++)
+        {
+            TS_ASSERT_EQUALS(p_mesh->GetElement(elem_index)->GetNumNodes(), 6u);
+            TS_ASSERT_DELTA(p_mesh->GetVolumeOfElement(elem_index), 1.0, 1e-12);
+        }
+        CheckNodeUses(*p_mesh);
+
+        // Jitter moves the nodes but keeps the topology
+        LargeVertexMeshGenerator jittered_generator(6, 4);
+        jittered_generator.GenerateJitteredHoneycomb(0.2);
+        TS_ASSERT_EQUALS(jittered_generator.GetNumNodes(), generator.GetNumNodes());
+        TS_ASSERT(jittered_generator.rGetArrays().mElementNodes == generator.rGetArrays().mElementNodes);
+        TS_ASSERT(jittered_generator.rGetArrays().mX != generator.rGetArrays().mX);
+        double edge_length = sqrt(2.0/(3.0*sqrt(3.0)));
+        for (unsigned node_index=0; node_index<generator.GetNumNodes(); node_index++)
+        {
+            TS_ASSERT_DELTA(jittered_generator.rGetArrays().mX[node_index], generator.rGetArrays().mX[node_index], 0.2*edge_length);
+            TS_ASSERT_DELTA(jittered_generator.rGetArrays().mY[node_index], generator.rGetArrays().mY[node_index], 0.2*edge_length);
+        }
+
+        TS_ASSERT_THROWS_THIS(jittered_generator.GenerateJitteredHoneycomb(0.5), "The jitter must be at least 0 and below 0.5");
+        TS_ASSERT_THROWS_THIS(LargeVertexMeshGenerator(0, 4), "The tissue must have at least one cell across and up");
+        TS_ASSERT_THROWS_THIS(LargeVertexMeshGenerator(4, 4, 0.0), "The target area of the cells must be positive");
+    }
+
+    void TestWoundInTheMiddle()
+    {
+        LargeVertexMeshGenerator generator(12, 12);
+        generator.GenerateJitteredHoneycomb(0.0);
+        unsigned num_nodes = generator.GetNumNodes();
+        TS_ASSERT_EQUALS(generator.CutCircularWound(1.5), 8u);
+        TS_ASSERT_EQUALS(generator.GetNumElements(), 136u);
+        TS_ASSERT_EQUALS(generator.GetNumNodes(), num_nodes - 6);
+
+        // The wound force finds a single wound in the tissue
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        CheckNodeUses(*p_mesh);
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        p_force->AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops().size(), 1u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops()[0].size(), 22u);
+
+        // The tissue can be written straight to the binary format
+        OutputFileHandler handler("TestLargeVertexMeshGenerator");
+        std::string path = handler.GetOutputDirectoryFullPath() + "wounded.vmesh";
+        generator.WriteBinaryFile(path);
+        VertexMeshBinaryReader reader(path);
+        TS_ASSERT_EQUALS(reader.GetNumNodes(), generator.GetNumNodes());
+        TS_ASSERT_EQUALS(reader.GetNumElements(), generator.GetNumElements());
+        MutableVertexMesh<2,2> read_mesh;
+        read_mesh.ConstructFromMeshReader(reader);
+        for (unsigned node_index=0; node_index<read_mesh.GetNumNodes(); node_index++)
+        {
+            TS_ASSERT_EQUALS(read_mesh.GetNode(node_index)->IsBoundaryNode(), p_mesh->GetNode(node_index)->IsBoundaryNode());
+        }
+    }
+};
+
+#endif /*TESTLARGEVERTEXMESHGENERATOR_HPP_*/
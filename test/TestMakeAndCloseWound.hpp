@@ -5,55 +5,53 @@
  * and closing it at the end.  (If you never run code in parallel then it is safe to replace PetscSetupAndFinalize.hpp with FakePetscSetup.hpp)
  */
 #include "PetscSetupAndFinalize.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "ToroidalHoneycombVertexMeshGenerator.hpp"
 #include "VoronoiVertexMeshGenerator.hpp"
 #include "Cell.hpp"
 #include "CellsGenerator.hpp"
 #include "NoCellCycleModel.hpp"
 #include "VertexBasedCellPopulation.hpp"
-#include "OffLatticeSimulation.hpp"
-#include "FarhadifarForce.hpp"
 #include "SmartPointers.hpp"
 #include "SimpleTargetAreaModifier.hpp"
 #include "VertexMeshReader.hpp"
+#include "WoundMeshBuilder.hpp"
 #include "WoundHealingForce.hpp"
+#include "FarhadifarWoundHealingForce.hpp"
+#include "WoundSnapshotModifier.hpp"
+#include "WoundHealingSimulation.hpp"
+#include "DisplacementControlledNumericalMethod.hpp"
+#include "OutputFileHandler.hpp"
+#include "SimulationTime.hpp"
+
+#include <climits>
+#include <cmath>
+#include <sstream>
+#include <string>
 
 class TestWoundHealing : public AbstractCellBasedWithTimingsTestSuite
 {
-public:
-    void xTestMakeAndCloseWound()
+private:
+
+    /**
+     * Cut a circular wound of radius 1.5 into a tissue, which removes a cell and its six
+     * neighbours from a honeycomb, and run until the wound closes.
+     *
+     * @param rMesh the mesh of the tissue
+     * @param rWoundCentre the centre of the wound
+     * @param rOutputDirectory the output directory of the simulation
+     * @return the time at which the wound closed
+     */
+    double RunWoundClosure(MutableVertexMesh<2,2>& rMesh, const c_vector<double, 2>& rWoundCentre, const std::string& rOutputDirectory)
     {
-        // Create a simple 2D MutableVertexMesh
-        // MutableVertexMesh<2,2>* p_mesh;
-        VoronoiVertexMeshGenerator mesh_generator(10,10,5,1.0); // number of cells, number of cells, number of LLoyds steps, elementArea
-
-        // Get the centroid of the mesh
-//        MutableVertexMesh<2,2>* p_mesh = mesh_generator.GetMesh();
-        Toroidal2dVertexMesh* p_mesh = mesh_generator.GetToroidalMesh();
-        c_vector<double, 2> mesh_centroid = zero_vector<double>(2);
-        for (unsigned element_index = 0; element_index < p_mesh->GetNumAllElements(); element_index++)
-        {
-            mesh_centroid += p_mesh->GetCentroidOfElement(element_index);
-        }
-        mesh_centroid /= p_mesh->GetNumAllElements();
-
-        // delete all elements in the mesh that fall within a circle of radius 5
-        c_vector<double, 2> this_centroid = zero_vector<double>(2);
-
-        for (unsigned element_index = 0; element_index < p_mesh->GetNumAllElements(); element_index++)
-        {
-            this_centroid = p_mesh->GetCentroidOfElement(element_index);
-            if (norm_2(this_centroid - mesh_centroid) < 1.5)
-            {
-                p_mesh->DeleteElementPriorToReMesh(element_index);
-            }
-        }
-
-        p_mesh->ReMesh();
+        WoundMeshBuilder builder(rMesh);
+        builder.CutCircularWound(rWoundCentre, 1.5);
+        builder.Build();
 
         // Create cells
         std::vector<CellPtr> cells;
         CellsGenerator<NoCellCycleModel, 2> cells_generator;
-        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        cells_generator.GenerateBasic(cells, rMesh.GetNumElements());
 
         for (unsigned i=0; i<cells.size(); i++)
         {
@@ -61,16 +59,20 @@ public:
         }
 
         // Create cell population
-        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        VertexBasedCellPopulation<2> cell_population(rMesh, cells);
 
         // Set up cell-based simulation
-        OffLatticeSimulation<2> simulator(cell_population);
-        simulator.SetOutputDirectory("TestWoundHealing");
+        WoundHealingSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory(rOutputDirectory);
         simulator.SetEndTime(20.0);
-        simulator.SetSamplingTimestepMultiple(10);
+        simulator.SetDt(0.01);
+
+        // Only the closure time is needed, so only write the usual output at the start
+        simulator.SetSamplingTimestepMultiple(UINT_MAX);
+
         // Create a force law and pass it to the simulation
-        MAKE_PTR(FarhadifarForce<2>, p_force);
-        p_force->SetBoundaryLineTensionParameter(1.0);
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+        p_force->SetWoundTensionParameter(1.0);
         simulator.AddForce(p_force);
 
         // A FarhadifarForce has to be used together with an AbstractTargetAreaModifier#2488
@@ -78,40 +80,107 @@ public:
         p_growth_modifier->SetGrowthDuration(0.0);
         simulator.AddSimulationModifier(p_growth_modifier);
 
-        simulator.SetDt(0.01);
+        simulator.SetWoundClosureStoppingEvent(p_force);
 
         // Run simulation
         simulator.Solve();
+        TS_ASSERT(simulator.GetWoundsHaveClosed());
+        double closure_time = simulator.GetWoundClosureTime();
+
+        // Start the next run with fresh simulation time
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        return closure_time;
     }
 
-    void TestReadAndRunVirtualLeaf()
+public:
+    void TestMakeAndCloseWound()
     {
-        VertexMeshReader<2,2> mesh_reader("projects/wound_healing_comparison/test/data/virtual_leaf");
-        MutableVertexMesh<2,2> mesh;
-        mesh.ConstructFromMeshReader(mesh_reader);
+        /*
+         * Close the same wound in periodic tissues of increasing size, and in tissues with
+         * free edges of the same sizes. The closure time in the largest periodic tissue is
+         * taken as the reference for the bulk tissue. A periodic tissue has no free edges
+         * whose relaxation disturbs the wound, so it needs fewer cells to reach the same
+         * accuracy. The sizes are multiples of four, so that the wound sits at the same
+         * place in the honeycomb for every size.
+         */
+        std::vector<unsigned> num_cells_across;
+        num_cells_across.push_back(8);
+        num_cells_across.push_back(12);
+        num_cells_across.push_back(16);
+        num_cells_across.push_back(24);
+
+        std::vector<double> periodic_closure_times;
+        std::vector<double> free_edge_closure_times;
+        for (unsigned size_index=0; size_index<num_cells_across.size(); size_index++)
+        {
+            unsigned n = num_cells_across[size_index];
+            unsigned centre_element_index = (n/2)*n + n/2;
+            std::stringstream size_name;
+            size_name << n;
+
+            ToroidalHoneycombVertexMeshGenerator periodic_generator(n, n);
+            MutableVertexMesh<2,2>* p_periodic_mesh = periodic_generator.GetToroidalMesh();
+            periodic_closure_times.push_back(RunWoundClosure(*p_periodic_mesh, p_periodic_mesh->GetCentroidOfElement(centre_element_index),
+                                                             "TestMakeAndCloseWound/periodic_" + size_name.str()));
+
+            HoneycombVertexMeshGenerator free_edge_generator(n, n);
+            MutableVertexMesh<2,2>* p_free_edge_mesh = free_edge_generator.GetMesh();
+            free_edge_closure_times.push_back(RunWoundClosure(*p_free_edge_mesh, p_free_edge_mesh->GetCentroidOfElement(centre_element_index),
+                                                              "TestMakeAndCloseWound/free_edges_" + size_name.str()));
+        }
 
-        double mean_cell_area = 0.0;
-        for (unsigned element_index = 0; element_index < mesh.GetNumAllElements(); element_index++)
+        // Write the closure times and their errors against the reference
+        double reference_time = periodic_closure_times.back();
+        OutputFileHandler output_file_handler("TestMakeAndCloseWound", false);
+        out_stream p_comparison_file = output_file_handler.OpenOutputFile("closure_time_by_tissue_size.csv");
+        *p_comparison_file << "tissue,num_cells,closure_time,relative_error\n";
+        for (unsigned size_index=0; size_index<num_cells_across.size(); size_index++)
         {
-            if (mesh.GetElement(element_index)->GetNumNodes() > 12)
-            {
-                mesh.DeleteElementPriorToReMesh(element_index);
-            }
-            else
-            {
-                mean_cell_area += mesh.GetVolumeOfElement(element_index);
-            }
+            unsigned num_cells = num_cells_across[size_index]*num_cells_across[size_index];
+            double periodic_error = fabs(periodic_closure_times[size_index] - reference_time)/reference_time;
+            double free_edge_error = fabs(free_edge_closure_times[size_index] - reference_time)/reference_time;
+            *p_comparison_file << "periodic," << num_cells << "," << periodic_closure_times[size_index] << "," << periodic_error << "\n";
+            *p_comparison_file << "free_edges," << num_cells << "," << free_edge_closure_times[size_index] << "," << free_edge_error << "\n";
+            std::cout << num_cells << " cells: periodic closure at " << periodic_closure_times[size_index]
+                      << " (error " << periodic_error << "), free edges closure at " << free_edge_closure_times[size_index]
+                      << " (error " << free_edge_error << ")" << std::endl;
         }
+        p_comparison_file->close();
 
-        // Need to rescale the mesh before remeshing
-        mean_cell_area /= mesh.GetNumAllElements() - 1; //Before Remesh the element is still being counted by chaste
-        for ( unsigned node_index = 0; node_index < mesh.GetNumAllNodes(); node_index++ )
+        // The periodic tissues converge to the bulk closure time as they grow, and faster than those with free edges
+        TS_ASSERT_DELTA(periodic_closure_times[2], reference_time, 0.1*reference_time);
+        for (unsigned size_index=0; size_index<num_cells_across.size(); size_index++)
         {
-            auto p_this_node = mesh.GetNode(node_index);
-            p_this_node->rGetModifiableLocation() /= sqrt(2.0*mean_cell_area);
+            TS_ASSERT_LESS_THAN(fabs(periodic_closure_times[size_index] - reference_time),
+                                fabs(free_edge_closure_times[size_index] - reference_time));
         }
+    }
+
+    void TestCloseWoundInVoronoiToroidalTissue()
+    {
+        // A periodic tissue of irregular cells, made by Lloyd's relaxation of random seeds
+        VoronoiVertexMeshGenerator mesh_generator(10, 10, 5, 1.0);
+        Toroidal2dVertexMesh* p_mesh = mesh_generator.GetToroidalMesh();
+        WoundMeshBuilder centre_finder(*p_mesh);
+        c_vector<double, 2> wound_centre = centre_finder.GetCentroidOfKeptElements();
+
+        double closure_time = RunWoundClosure(*p_mesh, wound_centre, "TestMakeAndCloseWound/voronoi_periodic");
+        TS_ASSERT_LESS_THAN(0.0, closure_time);
+        TS_ASSERT_LESS_THAN(closure_time, 20.0);
+    }
 
-        mesh.ReMesh();
+    void TestReadAndRunVirtualLeaf()
+    {
+        VertexMeshReader<2,2> mesh_reader("projects/wound_healing_comparison/test/data/virtual_leaf");
+        MutableVertexMesh<2,2> mesh;
+        mesh.ConstructFromMeshReader(mesh_reader);
+
+        // Delete the large elements and rescale the mesh to a mean cell area of 0.5, with a single ReMesh()
+        WoundMeshBuilder builder(mesh);
+        builder.RemoveElementsWithMoreNodesThan(12);
+        builder.RescaleToMeanElementArea(0.5);
+        builder.Build();
 
         // Create cells
         std::vector<CellPtr> cells;
@@ -128,26 +197,57 @@ public:
         cell_population.SetRestrictVertexMovementBoolean(false);
 
         // Set up cell-based simulation
-        OffLatticeSimulation<2> simulator(cell_population);
+        // The time step is chosen at each step from how far the nodes move, starting from 0.01
+        WoundHealingSimulation<2> simulator(cell_population);
         simulator.SetOutputDirectory("TestReadAndRunVirtalLeaf");
         simulator.SetEndTime(1000.0);
-        simulator.SetSamplingTimestepMultiple(100);
+
+        // Only write the usual output at the start; snapshots are taken as the wound closes instead
+        simulator.SetSamplingTimestepMultiple(UINT_MAX);
         // Create a force law and pass it to the simulation
-        MAKE_PTR(FarhadifarForce<2>, p_farhadifar_force);
-        simulator.AddForce(p_farhadifar_force);
-        MAKE_PTR(WoundHealingForce<2>, p_wound_force);
-        p_wound_force->SetWoundTensionParameter(1.0);
-        simulator.AddForce(p_wound_force);
+        // This is a FarhadifarForce and a WoundHealingForce combined in a single pass over the mesh
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+        p_force->SetWoundTensionParameter(1.0);
+        simulator.AddForce(p_force);
 
         // A FarhadifarForce has to be used together with an AbstractTargetAreaModifier#2488
         MAKE_PTR(SimpleTargetAreaModifier<2>, p_growth_modifier);
         p_growth_modifier->SetGrowthDuration(0.0);
         simulator.AddSimulationModifier(p_growth_modifier);
 
+        // Snapshots are compressed and written on a background thread, so the time steps do not wait for them
+        MAKE_PTR_ARGS(WoundSnapshotModifier<2>, p_snapshot_modifier, (p_force));
+        p_snapshot_modifier->AddAreaFraction(0.75);
+        p_snapshot_modifier->AddAreaFraction(0.5);
+        p_snapshot_modifier->AddAreaFraction(0.25);
+        p_snapshot_modifier->AddAreaFraction(0.1);
+        p_snapshot_modifier->SetSnapshotOnWoundEdgeChanges(true);
+        simulator.AddSimulationModifier(p_snapshot_modifier);
+
+        MAKE_PTR(DisplacementControlledNumericalMethod<2>, p_numerical_method);
+        simulator.SetNumericalMethod(p_numerical_method);
         simulator.SetDt(0.01);
 
+        // Stop as soon as the wounds have closed, rather than relaxing a healed tissue until the end time
+        simulator.SetWoundClosureStoppingEvent(p_force);
+
         // Run simulation
         simulator.Solve();
+        TS_ASSERT(simulator.GetWoundsHaveClosed());
+
+        /*
+         * Steps shrink around swaps but grow while the tissue relaxes, so they need far fewer than fixed
+         * steps of 0.01. Rejected steps and the sub-steps that redo them each evaluate the forces too.
+         */
+        unsigned num_fixed_steps = (unsigned)(SimulationTime::Instance()->GetTime()/0.01);
+        unsigned num_adaptive_steps = p_numerical_method->GetNumAcceptedSteps() + p_numerical_method->GetNumRejectedSteps();
+        TS_ASSERT_LESS_THAN_EQUALS(num_adaptive_steps, num_fixed_steps/5);
+
+        // The parameters file is written before the run, so write the force again now that its timings are known
+        OutputFileHandler output_file_handler("TestReadAndRunVirtalLeaf", false);
+        out_stream p_force_file = output_file_handler.OpenOutputFile("force_timings.parameters");
+        p_force->OutputForceParameters(p_force_file);
+        p_force_file->close();
     }
 };
 
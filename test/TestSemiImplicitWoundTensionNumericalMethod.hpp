@@ -0,0 +1,305 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTSEMIIMPLICITWOUNDTENSIONNUMERICALMETHOD_HPP_
+#define TESTSEMIIMPLICITWOUNDTENSIONNUMERICALMETHOD_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SimpleTargetAreaModifier.hpp"
+#include "SmartPointers.hpp"
+#include "ForwardEulerNumericalMethod.hpp"
+#include "FarhadifarWoundHealingForce.hpp"
+#include "WoundHealingForce.hpp"
+#include "SemiImplicitWoundTensionNumericalMethod.hpp"
+#include "OutputFileHandler.hpp"
+#include "FileFinder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+class TestSemiImplicitWoundTensionNumericalMethod : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Take one step from a hexagonal wound with an extra node in the middle of one of its
+     * edges, pulled only by the wound tension, and return how much a small displacement of
+     * that node across the edge is amplified by the step. Forward Euler amplifies it by
+     * 1 - 4*dt/L for edges of length L, so it is unstable for steps longer than L/2.
+     *
+     * @param semiImplicit whether to take a semi-implicit step rather than a forward Euler step
+     * @param dt the step size
+     * @return the ratio of the displacement of the node after the step to that before
+     */
+    double GetAmplificationOfStiffMode(bool semiImplicit, double dt)
+    {
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        c_vector<double, 2> wound_centre = p_mesh->GetCentroidOfElement(12);
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.SetRestrictVertexMovementBoolean(false);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        p_force->SetWoundTensionParameter(1.0);
+        std::vector<boost::shared_ptr<AbstractForce<2,2> > > forces;
+        forces.push_back(p_force);
+
+        // Put a node in the middle of a wound edge, where the wound tension cancels out
+        p_force->AddForceContribution(cell_population);
+        const std::vector<unsigned>& r_loop = p_force->rGetWoundLoops()[0];
+        p_mesh->DivideEdge(p_mesh->GetNode(r_loop[0]), p_mesh->GetNode(r_loop[1]));
+        unsigned middle_node = p_mesh->GetNumNodes() - 1;
+        c_vector<double, 2> normal = p_mesh->GetNode(middle_node)->rGetLocation() - wound_centre;
+        normal /= norm_2(normal);
+
+        boost::shared_ptr<AbstractNumericalMethod<2,2> > p_method;
+        if (semiImplicit)
+        {
+            p_method.reset(new SemiImplicitWoundTensionNumericalMethod<2>());
+        }
+        else
+        {
+            p_method.reset(new ForwardEulerNumericalMethod<2,2>());
+        }
+        p_method->SetCellPopulation(&cell_population);
+        p_method->SetForceCollection(&forces);
+
+        // Step from the unperturbed and the perturbed state
+        std::vector<c_vector<double, 2> > old_locations;
+        for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+        {
+            old_locations.push_back(p_mesh->GetNode(node_index)->rGetLocation());
+        }
+        p_method->UpdateAllNodePositions(dt);
+        c_vector<double, 2> unperturbed_location = p_mesh->GetNode(middle_node)->rGetLocation();
+
+        const double perturbation = 1e-6;
+        for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+        {
+            p_mesh->GetNode(node_index)->rGetModifiableLocation() = old_locations[node_index];
+        }
+        p_mesh->GetNode(middle_node)->rGetModifiableLocation() += perturbation*normal;
+        p_method->UpdateAllNodePositions(dt);
+
+        return inner_prod(p_mesh->GetNode(middle_node)->rGetLocation() - unperturbed_location, normal)/perturbation;
+    }
+
+public:
+
+    void TestShrinkingHexagonalWound()
+    {
+        // Pulled only by the wound tension, the corners of a hexagonal wound move towards its centre at unit speed
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        c_vector<double, 2> wound_centre = p_mesh->GetCentroidOfElement(12);
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.SetRestrictVertexMovementBoolean(false);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        p_force->SetWoundTensionParameter(1.0);
+        std::vector<boost::shared_ptr<AbstractForce<2,2> > > forces;
+        forces.push_back(p_force);
+
+        MAKE_PTR(SemiImplicitWoundTensionNumericalMethod<2>, p_method);
+        p_method->SetCellPopulation(&cell_population);
+        p_method->SetForceCollection(&forces);
+        TS_ASSERT(!p_method->HasAdaptiveTimestep());
+
+        std::vector<c_vector<double, 2> > old_locations;
+        for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+        {
+            old_locations.push_back(p_mesh->GetNode(node_index)->rGetLocation());
+        }
+        p_method->UpdateAllNodePositions(0.05);
+        TS_ASSERT_EQUALS(p_method->GetNumImplicitEdgesOfLastStep(), 6u);
+        TS_ASSERT_LESS_THAN(0u, p_method->GetNumIterationsOfLastSolve());
+
+        // Shrinking the wound evenly only moves its nodes along its edges, so the step is the same as forward Euler
+        std::vector<unsigned> wound_loop = p_force->rGetWoundLoops()[0];
+        TS_ASSERT_EQUALS(wound_loop.size(), 6u);
+        for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+        {
+            c_vector<double, 2> displacement = p_mesh->GetNode(node_index)->rGetLocation() - old_locations[node_index];
+            if (std::find(wound_loop.begin(), wound_loop.end(), node_index) != wound_loop.end())
+            {
+                c_vector<double, 2> inward = wound_centre - old_locations[node_index];
+                TS_ASSERT_DELTA(displacement[0], 0.05*inward[0]/norm_2(inward), 1e-9);
+                TS_ASSERT_DELTA(displacement[1], 0.05*inward[1]/norm_2(inward), 1e-9);
+            }
+            else
+            {
+                TS_ASSERT_DELTA(norm_2(displacement), 0.0, 1e-9);
+            }
+        }
+    }
+
+    void TestStiffModeIsDamped()
+    {
+        // The edges next to the extra node have length 1/(2*sqrt(3)), so forward Euler is unstable for steps longer than 0.14
+        double explicit_amplification = GetAmplificationOfStiffMode(false, 0.4);
+        TS_ASSERT_DELTA(explicit_amplification, 1.0 - 0.4*4.0*sqrt(3.0), 1e-4);
+        TS_ASSERT_LESS_THAN(1.0, fabs(explicit_amplification));
+
+        double semi_implicit_amplification = GetAmplificationOfStiffMode(true, 0.4);
+        TS_ASSERT_LESS_THAN(fabs(semi_implicit_amplification), 0.5);
+    }
+
+    void TestSmallStepsMatchForwardEuler()
+    {
+        std::vector<c_vector<double, 2> > new_locations[2];
+        for (unsigned semi_implicit=0; semi_implicit<2; semi_implicit++)
+        {
+            HoneycombVertexMeshGenerator generator(6, 6);
+            MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+            p_mesh->DeleteElementPriorToReMesh(14);
+            p_mesh->DeleteElementPriorToReMesh(15);
+            p_mesh->ReMesh();
+            for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+            {
+                c_vector<double, 2>& r_location = p_mesh->GetNode(node_index)->rGetModifiableLocation();
+                r_location[0] += 0.02*sin((double)node_index);
+                r_location[1] += 0.02*cos(3.0*node_index);
+            }
+
+            std::vector<CellPtr> cells;
+            CellsGenerator<NoCellCycleModel, 2> cells_generator;
+            cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+            VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+            cell_population.SetRestrictVertexMovementBoolean(false);
+            SimpleTargetAreaModifier<2> target_area_modifier;
+            target_area_modifier.SetGrowthDuration(0.0);
+            target_area_modifier.UpdateTargetAreas(cell_population);
+
+            MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+            p_force->SetWoundTensionParameter(1.0);
+            std::vector<boost::shared_ptr<AbstractForce<2,2> > > forces;
+            forces.push_back(p_force);
+
+            boost::shared_ptr<AbstractNumericalMethod<2,2> > p_method(new ForwardEulerNumericalMethod<2,2>());
+            if (semi_implicit)
+            {
+                boost::shared_ptr<SemiImplicitWoundTensionNumericalMethod<2> > p_semi_implicit_method(new SemiImplicitWoundTensionNumericalMethod<2>());
+                p_semi_implicit_method->SetTreatCellEdgesImplicitly(true);
+                p_method = p_semi_implicit_method;
+            }
+            p_method->SetCellPopulation(&cell_population);
+            p_method->SetForceCollection(&forces);
+            p_method->UpdateAllNodePositions(1e-4);
+
+            for (unsigned node_index=0; node_index<p_mesh->GetNumNodes(); node_index++)
+            {
+                new_locations[semi_implicit].push_back(p_mesh->GetNode(node_index)->rGetLocation());
+            }
+            if (semi_implicit)
+            {
+                // Each cell edge is counted once from each of its cells, and the 10 wound edges once more
+                unsigned num_cell_edges = 0;
+                for (unsigned elem_index=0; elem_index<p_mesh->GetNumElements(); elem_index++)
+                {
+                    num_cell_edges += p_mesh->GetElement(elem_index)->GetNumNodes();
+                }
+                boost::shared_ptr<SemiImplicitWoundTensionNumericalMethod<2> > p_semi_implicit_method =
+                        boost::static_pointer_cast<SemiImplicitWoundTensionNumericalMethod<2> >(p_method);
+                TS_ASSERT_EQUALS(p_semi_implicit_method->GetNumImplicitEdgesOfLastStep(), num_cell_edges + 10);
+            }
+        }
+
+        // The steps differ by dt^2 times the stiffness times the forces
+        for (unsigned node_index=0; node_index<new_locations[0].size(); node_index++)
+        {
+            TS_ASSERT_DELTA(new_locations[1][node_index][0], new_locations[0][node_index][0], 2e-7);
+            TS_ASSERT_DELTA(new_locations[1][node_index][1], new_locations[0][node_index][1], 2e-7);
+        }
+    }
+
+    void TestExceptionsAndOutputParameters()
+    {
+        HoneycombVertexMeshGenerator generator(3, 3);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MAKE_PTR(SemiImplicitWoundTensionNumericalMethod<2>, p_method);
+        std::vector<boost::shared_ptr<AbstractForce<2,2> > > forces;
+        p_method->SetCellPopulation(&cell_population);
+        p_method->SetForceCollection(&forces);
+        TS_ASSERT_THROWS_THIS(p_method->UpdateAllNodePositions(0.01),
+                              "SemiImplicitWoundTensionNumericalMethod needs a WoundHealingForce in the simulation");
+
+        TS_ASSERT(!p_method->GetTreatCellEdgesImplicitly());
+        TS_ASSERT_DELTA(p_method->GetRelativeTolerance(), 1e-10, 1e-20);
+        p_method->SetTreatCellEdgesImplicitly(true);
+        p_method->SetRelativeTolerance(1e-8);
+        TS_ASSERT(p_method->GetTreatCellEdgesImplicitly());
+        TS_ASSERT_DELTA(p_method->GetRelativeTolerance(), 1e-8, 1e-20);
+
+        OutputFileHandler output_file_handler("TestSemiImplicitWoundTensionNumericalMethod", false);
+        out_stream parameter_file = output_file_handler.OpenOutputFile("numerical_method.parameters");
+        p_method->OutputNumericalMethodParameters(parameter_file);
+        parameter_file->close();
+
+        FileFinder parameter_finder = output_file_handler.FindFile("numerical_method.parameters");
+        std::ifstream parameter_stream(parameter_finder.GetAbsolutePath().c_str());
+        std::string parameters((std::istreambuf_iterator<char>(parameter_stream)), std::istreambuf_iterator<char>());
+        TS_ASSERT_DIFFERS(parameters.find("<TreatCellEdgesImplicitly>1</TreatCellEdgesImplicitly>"), std::string::npos);
+        TS_ASSERT_DIFFERS(parameters.find("<RelativeTolerance>1e-08</RelativeTolerance>"), std::string::npos);
+    }
+};
+
+#endif /*TESTSEMIIMPLICITWOUNDTENSIONNUMERICALMETHOD_HPP_*/
@@ -0,0 +1,126 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTVERTEXMESHBINARYFORMAT_HPP_
+#define TESTVERTEXMESHBINARYFORMAT_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "FakePetscSetup.hpp"
+#include "MutableVertexMesh.hpp"
+#include "OutputFileHandler.hpp"
+#include "VertexMeshReader.hpp"
+#include "VertexMeshBinaryReader.hpp"
+#include "VertexMeshBinaryWriter.hpp"
+
+#include <fstream>
+
+class TestVertexMeshBinaryFormat : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * Check that two meshes have exactly the same nodes and elements.
+     */
+    void CompareMeshes(MutableVertexMesh<2,2>& rMesh, MutableVertexMesh<2,2>& rOtherMesh)
+    {
+        TS_ASSERT_EQUALS(rMesh.GetNumNodes(), rOtherMesh.GetNumNodes());
+        TS_ASSERT_EQUALS(rMesh.GetNumElements(), rOtherMesh.GetNumElements());
+        for (unsigned node_index=0; node_index<rMesh.GetNumNodes(); node_index++)
+        {
+            Node<2>* p_node = rMesh.GetNode(node_index);
+            Node<2>* p_other_node = rOtherMesh.GetNode(node_index);
+            TS_ASSERT_EQUALS(p_node->rGetLocation()[0], p_other_node->rGetLocation()[0]);
+            TS_ASSERT_EQUALS(p_node->rGetLocation()[1], p_other_node->rGetLocation()[1]);
+            TS_ASSERT_EQUALS(p_node->IsBoundaryNode(), p_other_node->IsBoundaryNode());
+        }
+        for (unsigned elem_index=0; elem_index<rMesh.GetNumElements(); elem_index++)
+        {
+            VertexElement<2,2>* p_element = rMesh.GetElement(elem_index);
+            VertexElement<2,2>* p_other_element = rOtherMesh.GetElement(elem_index);
+            TS_ASSERT_EQUALS(p_element->GetNumNodes(), p_other_element->GetNumNodes());
+            for (unsigned local_index=0; local_index<p_element->GetNumNodes(); local_index++)
+            {
+                TS_ASSERT_EQUALS(p_element->GetNodeGlobalIndex(local_index), p_other_element->GetNodeGlobalIndex(local_index));
+            }
+        }
+    }
+
+public:
+
+    void TestTextAndBinaryMeshesAreIdentical()
+    {
+        VertexMeshReader<2,2> text_reader("projects/wound_healing_comparison/test/data/virtual_leaf");
+        MutableVertexMesh<2,2> text_mesh;
+        text_mesh.ConstructFromMeshReader(text_reader);
+
+        // Convert the text files
+        OutputFileHandler handler("TestVertexMeshBinaryFormat");
+        std::string binary_path = handler.GetOutputDirectoryFullPath() + "virtual_leaf.vmesh";
+        VertexMeshBinaryWriter::WriteFileUsingMeshReader(text_reader, binary_path);
+
+        VertexMeshBinaryReader binary_reader(binary_path);
+        TS_ASSERT_EQUALS(binary_reader.GetNumNodes(), 647u);
+        TS_ASSERT_EQUALS(binary_reader.GetNumElements(), 400u);
+        TS_ASSERT_EQUALS(binary_reader.GetNumElementAttributes(), text_reader.GetNumElementAttributes());
+
+        MutableVertexMesh<2,2> binary_mesh;
+        binary_mesh.ConstructFromMeshReader(binary_reader);
+        CompareMeshes(text_mesh, binary_mesh);
+
+        // A mesh in memory can also be written, and gives the same mesh again
+        std::string mesh_path = handler.GetOutputDirectoryFullPath() + "virtual_leaf_from_mesh.vmesh";
+        VertexMeshBinaryWriter::WriteFileUsingMesh(text_mesh, mesh_path);
+        VertexMeshBinaryReader mesh_reader(mesh_path);
+        MutableVertexMesh<2,2> mesh_from_mesh;
+        mesh_from_mesh.ConstructFromMeshReader(mesh_reader);
+        CompareMeshes(text_mesh, mesh_from_mesh);
+    }
+
+    void TestExceptions()
+    {
+        TS_ASSERT_THROWS_THIS(VertexMeshBinaryReader reader("no_such_file.vmesh"),
+                              "Could not open the binary mesh file no_such_file.vmesh");
+
+        OutputFileHandler handler("TestVertexMeshBinaryFormat", false);
+        std::string path = handler.GetOutputDirectoryFullPath() + "not_a_mesh.vmesh";
+        std::ofstream file(path.c_str());
+        file << "This is a text file that is long enough to hold a header.\n";
+        file.close();
+        TS_ASSERT_THROWS_THIS(VertexMeshBinaryReader reader(path),
+                              "The file " + path + " is not a binary mesh file");
+    }
+};
+
+#endif /*TESTVERTEXMESHBINARYFORMAT_HPP_*/
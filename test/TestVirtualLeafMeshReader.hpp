@@ -0,0 +1,107 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTVIRTUALLEAFMESHREADER_HPP_
+#define TESTVIRTUALLEAFMESHREADER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "FakePetscSetup.hpp"
+#include "MutableVertexMesh.hpp"
+#include "VirtualLeafMeshReader.hpp"
+
+class TestVirtualLeafMeshReader : public CxxTest::TestSuite
+{
+public:
+
+    void TestReadSmallLeaf()
+    {
+        VirtualLeafMeshReader mesh_reader("projects/wound_healing_comparison/test/data/virtual_leaf_small.xml");
+
+        // The node in the middle of the shared wall is dropped, the nodes on the leaf boundary are kept
+        TS_ASSERT_EQUALS(mesh_reader.GetNumNodes(), 7u);
+        TS_ASSERT_EQUALS(mesh_reader.GetNumElements(), 2u);
+        TS_ASSERT_EQUALS(mesh_reader.GetNumFaces(), 0u);
+        TS_ASSERT_EQUALS(mesh_reader.GetNumElementAttributes(), 1u);
+
+        std::vector<double> node_data = mesh_reader.GetNextNode();
+        TS_ASSERT_EQUALS(node_data.size(), 3u);
+        TS_ASSERT_DELTA(node_data[0], 0.0, 1e-12);
+        TS_ASSERT_DELTA(node_data[1], 0.0, 1e-12);
+        TS_ASSERT_DELTA(node_data[2], 1.0, 1e-12);
+        for (unsigned i=1; i<6; i++)
+        {
+            mesh_reader.GetNextNode();
+        }
+        node_data = mesh_reader.GetNextNode();
+        TS_ASSERT_DELTA(node_data[0], 0.5, 1e-12);
+        TS_ASSERT_DELTA(node_data[1], 0.0, 1e-12);
+        TS_ASSERT_THROWS_THIS(mesh_reader.GetNextNode(), "All nodes have already been read");
+
+        // The nodes of the boundary polygon do not make a cell
+        ElementData element_data = mesh_reader.GetNextElementData();
+        unsigned first_cell_nodes[5] = {0, 6, 1, 4, 5};
+        TS_ASSERT_EQUALS(element_data.NodeIndices.size(), 5u);
+        for (unsigned i=0; i<5; i++)
+        {
+            TS_ASSERT_EQUALS(element_data.NodeIndices[i], first_cell_nodes[i]);
+        }
+        element_data = mesh_reader.GetNextElementData();
+        unsigned second_cell_nodes[4] = {1, 2, 3, 4};
+        TS_ASSERT_EQUALS(element_data.NodeIndices.size(), 4u);
+        for (unsigned i=0; i<4; i++)
+        {
+            TS_ASSERT_EQUALS(element_data.NodeIndices[i], second_cell_nodes[i]);
+        }
+        TS_ASSERT_THROWS_THIS(mesh_reader.GetNextElementData(), "All elements have already been read");
+        TS_ASSERT_THROWS_THIS(mesh_reader.GetNextFaceData(), "A VirtualLeaf mesh has no faces");
+
+        // The reader can be passed straight to a vertex mesh
+        MutableVertexMesh<2,2> mesh;
+        mesh.ConstructFromMeshReader(mesh_reader);
+        TS_ASSERT_EQUALS(mesh.GetNumNodes(), 7u);
+        TS_ASSERT_EQUALS(mesh.GetNumElements(), 2u);
+        TS_ASSERT_DELTA(mesh.GetVolumeOfElement(0), 1.0, 1e-12);
+        TS_ASSERT_DELTA(mesh.GetVolumeOfElement(1), 1.0, 1e-12);
+        TS_ASSERT_EQUALS(mesh.GetNode(6)->IsBoundaryNode(), true);
+    }
+
+    void TestExceptions()
+    {
+        TS_ASSERT_THROWS_THIS(VirtualLeafMeshReader mesh_reader("projects/wound_healing_comparison/test/data/no_such_leaf.xml"),
+                              "Could not open the VirtualLeaf file projects/wound_healing_comparison/test/data/no_such_leaf.xml");
+    }
+};
+
+#endif /*TESTVIRTUALLEAFMESHREADER_HPP_*/
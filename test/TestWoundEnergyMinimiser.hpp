@@ -0,0 +1,201 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTWOUNDENERGYMINIMISER_HPP_
+#define TESTWOUNDENERGYMINIMISER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SimpleTargetAreaModifier.hpp"
+#include "SmartPointers.hpp"
+#include "FarhadifarWoundHealingForce.hpp"
+#include "WoundHealingForce.hpp"
+#include "WoundHealingSimulation.hpp"
+#include "WoundEnergyMinimiser.hpp"
+#include "WoundTestFixtures.hpp"
+
+#include <cmath>
+
+class TestWoundEnergyMinimiser : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestForceIsMinusEnergyGradient()
+    {
+        // The energy of the wound tension alone is the tension times the perimeter of the wound
+        {
+            HoneycombVertexMeshGenerator generator(5, 5);
+            MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+            double wound_perimeter = p_mesh->GetSurfaceAreaOfElement(12);
+            p_mesh->DeleteElementPriorToReMesh(12);
+            p_mesh->ReMesh();
+
+            std::vector<CellPtr> cells;
+            CellsGenerator<NoCellCycleModel, 2> cells_generator;
+            cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+            VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+            MAKE_PTR(WoundHealingForce<2>, p_force);
+            p_force->SetWoundTensionParameter(1.5);
+            TS_ASSERT_DELTA(p_force->CalculateEnergy(cell_population), 1.5*wound_perimeter, 1e-12);
+        }
+
+        HoneycombVertexMeshGenerator generator(6, 6);
+        VertexBasedCellPopulation<2>* p_cell_population = WoundTestFixtures::MakeWoundedPopulation(generator);
+        MutableVertexMesh<2,2>& r_mesh = p_cell_population->rGetMesh();
+        for (unsigned node_index=0; node_index<r_mesh.GetNumNodes(); node_index++)
+        {
+            c_vector<double, 2>& r_location = r_mesh.GetNode(node_index)->rGetModifiableLocation();
+            r_location[0] += 0.02*sin((double)node_index);
+            r_location[1] += 0.02*cos(3.0*node_index);
+        }
+
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+        p_force->SetAreaElasticityParameter(1.5);
+        p_force->SetPerimeterContractilityParameter(0.07);
+        p_force->SetLineTensionParameter(0.2);
+        p_force->SetBoundaryLineTensionParameter(0.3);
+        p_force->SetWoundTensionParameter(0.8);
+        p_force->AddForceContribution(*p_cell_population);
+
+        // Compare the force on each node with central differences of the energy
+        const double step = 1e-6;
+        for (unsigned node_index=0; node_index<r_mesh.GetNumNodes(); node_index++)
+        {
+            c_vector<double, 2>& r_location = r_mesh.GetNode(node_index)->rGetModifiableLocation();
+            for (unsigned i=0; i<2; i++)
+            {
+                r_location[i] += step;
+                double energy_plus = p_force->CalculateEnergy(*p_cell_population);
+                r_location[i] -= 2.0*step;
+                double energy_minus = p_force->CalculateEnergy(*p_cell_population);
+                r_location[i] += step;
+                TS_ASSERT_DELTA(r_mesh.GetNode(node_index)->rGetAppliedForce()[i], -(energy_plus - energy_minus)/(2.0*step), 1e-6);
+            }
+        }
+        delete p_cell_population;
+    }
+
+    void TestMinimumMatchesRelaxedSimulation()
+    {
+        // Relax a wounded tissue by following the dynamics for a long time
+        HoneycombVertexMeshGenerator relaxed_generator(6, 6);
+        VertexBasedCellPopulation<2>* p_relaxed_population = WoundTestFixtures::MakeWoundedPopulation(relaxed_generator);
+        WoundHealingSimulation<2> simulator(*p_relaxed_population);
+        simulator.SetOutputDirectory("TestWoundEnergyMinimiser");
+        simulator.SetDt(0.01);
+        simulator.SetEndTime(200.0);
+        simulator.SetSamplingTimestepMultiple(20000);
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_relaxed_force);
+        p_relaxed_force->SetWoundTensionParameter(0.1);
+        simulator.AddForce(p_relaxed_force);
+        MAKE_PTR(SimpleTargetAreaModifier<2>, p_growth_modifier);
+        p_growth_modifier->SetGrowthDuration(0.0);
+        simulator.AddSimulationModifier(p_growth_modifier);
+        simulator.Solve();
+
+        // Minimise the energy of the same tissue instead
+        HoneycombVertexMeshGenerator generator(6, 6);
+        VertexBasedCellPopulation<2>* p_cell_population = WoundTestFixtures::MakeWoundedPopulation(generator);
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+        p_force->SetWoundTensionParameter(0.1);
+        WoundEnergyMinimiser<2> minimiser(*p_cell_population, p_force);
+        double initial_energy = minimiser.GetEnergy();
+        TS_ASSERT(minimiser.Minimise());
+        TS_ASSERT_LESS_THAN(minimiser.GetMaxForce(), 1e-6);
+        TS_ASSERT_LESS_THAN(minimiser.GetEnergy(), initial_energy);
+        TS_ASSERT_EQUALS(minimiser.GetNumTopologyChanges(), 0u);
+
+        // This takes far fewer force evaluations than the 20000 time steps of the simulation
+        TS_ASSERT_LESS_THAN(minimiser.GetNumForceEvaluations(), 2000u);
+
+        // Both end up at the same equilibrium
+        MutableVertexMesh<2,2>& r_mesh = p_cell_population->rGetMesh();
+        MutableVertexMesh<2,2>& r_relaxed_mesh = p_relaxed_population->rGetMesh();
+        TS_ASSERT_EQUALS(r_mesh.GetNumNodes(), r_relaxed_mesh.GetNumNodes());
+        TS_ASSERT_DELTA(minimiser.GetEnergy(), p_relaxed_force->CalculateEnergy(*p_relaxed_population), 1e-6);
+        for (unsigned node_index=0; node_index<r_mesh.GetNumNodes(); node_index++)
+        {
+            TS_ASSERT_DELTA(r_mesh.GetNode(node_index)->rGetLocation()[0], r_relaxed_mesh.GetNode(node_index)->rGetLocation()[0], 1e-3);
+            TS_ASSERT_DELTA(r_mesh.GetNode(node_index)->rGetLocation()[1], r_relaxed_mesh.GetNode(node_index)->rGetLocation()[1], 1e-3);
+        }
+
+        // A minimisation from a minimum stops at once
+        TS_ASSERT(minimiser.Minimise());
+        TS_ASSERT_EQUALS(minimiser.GetNumForceEvaluations(), 1u);
+
+        delete p_relaxed_population;
+        delete p_cell_population;
+    }
+
+    void TestSettings()
+    {
+        HoneycombVertexMeshGenerator generator(4, 4);
+        VertexBasedCellPopulation<2>* p_cell_population = WoundTestFixtures::MakeWoundedPopulation(generator);
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+        WoundEnergyMinimiser<2> minimiser(*p_cell_population, p_force);
+
+        TS_ASSERT_DELTA(minimiser.GetForceTolerance(), 1e-6, 1e-15);
+        TS_ASSERT_DELTA(minimiser.GetMaxDisplacementFraction(), 0.5, 1e-12);
+        TS_ASSERT_DELTA(minimiser.GetInitialTimestep(), 0.01, 1e-12);
+        TS_ASSERT_DELTA(minimiser.GetMaximumTimestep(), 0.1, 1e-12);
+        TS_ASSERT_EQUALS(minimiser.GetMaxNumIterations(), 100000u);
+
+        minimiser.SetForceTolerance(1e-8);
+        minimiser.SetMaxDisplacementFraction(0.25);
+        minimiser.SetTimesteps(0.02, 0.2);
+        minimiser.SetMaxNumIterations(3);
+        TS_ASSERT_DELTA(minimiser.GetForceTolerance(), 1e-8, 1e-15);
+        TS_ASSERT_DELTA(minimiser.GetMaxDisplacementFraction(), 0.25, 1e-12);
+        TS_ASSERT_DELTA(minimiser.GetInitialTimestep(), 0.02, 1e-12);
+        TS_ASSERT_DELTA(minimiser.GetMaximumTimestep(), 0.2, 1e-12);
+        TS_ASSERT_THROWS_THIS(minimiser.SetTimesteps(0.2, 0.1),
+                              "The initial step size must be positive, and no larger than the maximum step size");
+
+        // Three iterations are not enough to reach the minimum
+        TS_ASSERT(!minimiser.Minimise());
+        TS_ASSERT_EQUALS(minimiser.GetNumForceEvaluations(), 4u);
+        TS_ASSERT_LESS_THAN(1e-8, minimiser.GetMaxForce());
+        delete p_cell_population;
+    }
+};
+
+#endif /*TESTWOUNDENERGYMINIMISER_HPP_*/
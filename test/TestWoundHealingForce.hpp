@@ -0,0 +1,397 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTWOUNDHEALINGFORCE_HPP_
+#define TESTWOUNDHEALINGFORCE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "ToroidalHoneycombVertexMeshGenerator.hpp"
+#include "CylindricalHoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SmartPointers.hpp"
+#include "WoundHealingForce.hpp"
+#include "OutputFileHandler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+class TestWoundHealingForce : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestWoundBoundaryIsCachedAndPatched()
+    {
+        // Create a honeycomb mesh and cut a hexagonal wound into its centre
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        c_vector<double, 2> wound_centre = p_mesh->GetCentroidOfElement(12);
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+        {
+            cell_population.GetNode(node_index)->ClearAppliedForce();
+        }
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        p_force->SetWoundTensionParameter(2.0);
+        p_force->AddForceContribution(cell_population);
+
+        // The wound is the hexagon left by the deleted element
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops().size(), 1u);
+        std::vector<unsigned> wound_nodes = p_force->rGetWoundLoops()[0];
+        TS_ASSERT_EQUALS(wound_nodes.size(), 6u);
+        TS_ASSERT_EQUALS(p_force->GetNumWoundBoundaryRebuilds(), 1u);
+
+        // On a regular hexagon the tension pulls each wound node towards the centre of the wound
+        for (unsigned i=0; i<wound_nodes.size(); i++)
+        {
+            Node<2>* p_node = cell_population.GetNode(wound_nodes[i]);
+            c_vector<double, 2> to_centre = wound_centre - p_node->rGetLocation();
+            to_centre /= norm_2(to_centre);
+            TS_ASSERT_DELTA(p_node->rGetAppliedForce()[0], 2.0*to_centre[0], 1e-6);
+            TS_ASSERT_DELTA(p_node->rGetAppliedForce()[1], 2.0*to_centre[1], 1e-6);
+        }
+
+        // A second call reuses the cached ring
+        p_force->AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(p_force->GetNumWoundBoundaryRebuilds(), 1u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops()[0].size(), 6u);
+
+        /*
+         * Widen the wound by deleting a neighbouring element. The force only looks
+         * at the mesh, so we can change it underneath the population here. The
+         * cached ring is patched by walking the new wound from a surviving node.
+         */
+        p_mesh->DeleteElementPriorToReMesh(13);
+        p_mesh->ReMesh();
+        p_force->AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(p_force->GetNumWoundBoundaryRebuilds(), 1u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops().size(), 1u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops()[0].size(), 10u);
+    }
+
+    void TestRenumberingIsDetectedWhenTheNumberOfNodesIsUnchanged()
+    {
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        c_vector<double, 2> wound_centre = p_mesh->GetCentroidOfElement(12);
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        MAKE_PTR(WoundHealingForce<2>, p_centred_force);
+        std::vector<c_vector<double, 2> > wound_centres(1, wound_centre);
+        p_centred_force->SetWoundCentres(wound_centres);
+        p_force->AddForceContribution(cell_population);
+        p_centred_force->AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops()[0].size(), 6u);
+
+        /*
+         * Remove the corner cell, which removes its outer nodes and shifts the indices of all
+         * the later nodes down, then divide edges of the opposite corner cell until there are
+         * as many nodes as before. The old indices of the ring now belong to other nodes.
+         */
+        unsigned num_nodes = p_mesh->GetNumAllNodes();
+        p_mesh->DeleteElementPriorToReMesh(0);
+        p_mesh->ReMesh();
+        TS_ASSERT_LESS_THAN(p_mesh->GetNumAllNodes(), num_nodes);
+        while (p_mesh->GetNumAllNodes() < num_nodes)
+        {
+            VertexElement<2,2>* p_element = p_mesh->GetElement(p_mesh->GetNumElements() - 1);
+            p_mesh->DivideEdge(p_element->GetNode(0), p_element->GetNode(1));
+        }
+        TS_ASSERT_EQUALS(p_mesh->GetNumAllNodes(), num_nodes);
+
+        // Both forces find the ring again from its locations, without rebuilding it
+        p_force->AddForceContribution(cell_population);
+        p_centred_force->AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(p_force->GetNumWoundBoundaryRebuilds(), 1u);
+        TS_ASSERT_EQUALS(p_centred_force->GetNumWoundBoundaryRebuilds(), 1u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops().size(), 1u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops()[0].size(), 6u);
+        TS_ASSERT_EQUALS(p_centred_force->rGetWoundLoops()[0], p_force->rGetWoundLoops()[0]);
+        for (unsigned i=0; i<6; i++)
+        {
+            unsigned node_index = p_force->rGetWoundLoops()[0][i];
+            TS_ASSERT_LESS_THAN(norm_2(p_mesh->GetNode(node_index)->rGetLocation() - wound_centre), 1.0);
+        }
+    }
+
+    void TestSeveralWounds()
+    {
+        // Cut two separate wounds into a honeycomb mesh
+        HoneycombVertexMeshGenerator generator(8, 8);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        c_vector<double, 2> second_wound_centre = p_mesh->GetCentroidOfElement(45);
+        p_mesh->DeleteElementPriorToReMesh(18);
+        p_mesh->DeleteElementPriorToReMesh(45);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+        {
+            cell_population.GetNode(node_index)->ClearAppliedForce();
+        }
+
+        // All boundary loops are labelled, and exactly one of them is the outer boundary
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        std::vector<std::vector<unsigned> > boundary_loops;
+        p_force->LabelBoundaryLoops(cell_population, boundary_loops);
+        TS_ASSERT_EQUALS(boundary_loops.size(), 3u);
+        unsigned num_boundary_nodes = 0;
+        for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+        {
+            if (cell_population.GetNode(node_index)->IsBoundaryNode())
+            {
+                num_boundary_nodes++;
+            }
+        }
+        TS_ASSERT_EQUALS(boundary_loops[0].size() + boundary_loops[1].size() + boundary_loops[2].size(), num_boundary_nodes);
+
+        // By default both wounds are under tension
+        p_force->AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops().size(), 2u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops()[0].size(), 6u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops()[1].size(), 6u);
+
+        // Wounds can also be chosen explicitly, by a point inside each of them
+        std::vector<c_vector<double, 2> > wound_centres;
+        wound_centres.push_back(second_wound_centre);
+        MAKE_PTR(WoundHealingForce<2>, p_selective_force);
+        p_selective_force->SetWoundCentres(wound_centres);
+        p_selective_force->AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(p_selective_force->rGetWoundLoops().size(), 1u);
+        TS_ASSERT_EQUALS(p_selective_force->rGetWoundLoops()[0].size(), 6u);
+        for (unsigned i=0; i<6; i++)
+        {
+            unsigned node_index = p_selective_force->rGetWoundLoops()[0][i];
+            TS_ASSERT_LESS_THAN(norm_2(cell_population.GetNode(node_index)->rGetLocation() - second_wound_centre), 1.0);
+        }
+    }
+
+    void TestBoundaryChainsThatDoNotCloseAreNotLoops()
+    {
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        // Flag an interior node as a boundary node; a walk from it cannot go anywhere
+        unsigned interior_node_index = 0;
+        while (p_mesh->GetNode(interior_node_index)->IsBoundaryNode())
+        {
+            interior_node_index++;
+        }
+        p_mesh->GetNode(interior_node_index)->SetAsBoundaryNode(true);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        std::vector<std::vector<unsigned> > boundary_loops;
+        p_force->LabelBoundaryLoops(cell_population, boundary_loops);
+        TS_ASSERT_EQUALS(boundary_loops.size(), 2u);
+        for (unsigned loop_index=0; loop_index<boundary_loops.size(); loop_index++)
+        {
+            TS_ASSERT(std::find(boundary_loops[loop_index].begin(), boundary_loops[loop_index].end(),
+                                interior_node_index) == boundary_loops[loop_index].end());
+        }
+
+        p_force->AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops().size(), 1u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops()[0].size(), 6u);
+    }
+
+    void TestToroidalMesh()
+    {
+        /*
+         * Cut a wound that straddles the periodic edges of a toroidal honeycomb mesh. The
+         * mesh has no outer boundary, so the wound is its only boundary loop.
+         */
+        ToroidalHoneycombVertexMeshGenerator generator(6, 6);
+        Toroidal2dVertexMesh* p_mesh = generator.GetToroidalMesh();
+        c_vector<double, 2> wound_centre = p_mesh->GetCentroidOfElement(0);
+        p_mesh->DeleteElementPriorToReMesh(0);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+        {
+            cell_population.GetNode(node_index)->ClearAppliedForce();
+        }
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        std::vector<std::vector<unsigned> > boundary_loops;
+        p_force->LabelBoundaryLoops(cell_population, boundary_loops);
+        TS_ASSERT_EQUALS(boundary_loops.size(), 1u);
+
+        p_force->SetWoundTensionParameter(2.0);
+        p_force->AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops().size(), 1u);
+        std::vector<unsigned> wound_nodes = p_force->rGetWoundLoops()[0];
+        TS_ASSERT_EQUALS(wound_nodes.size(), 6u);
+
+        // The edges of the wound are measured across the periodic boundaries, so the tension still pulls towards its centre
+        for (unsigned i=0; i<wound_nodes.size(); i++)
+        {
+            Node<2>* p_node = cell_population.GetNode(wound_nodes[i]);
+            c_vector<double, 2> to_centre = p_mesh->GetVectorFromAtoB(p_node->rGetLocation(), wound_centre);
+            to_centre /= norm_2(to_centre);
+            TS_ASSERT_DELTA(p_node->rGetAppliedForce()[0], 2.0*to_centre[0], 1e-6);
+            TS_ASSERT_DELTA(p_node->rGetAppliedForce()[1], 2.0*to_centre[1], 1e-6);
+        }
+
+        // The wound can also be found from a point inside it, on either side of the periodic edges
+        std::vector<c_vector<double, 2> > wound_centres;
+        wound_centres.push_back(wound_centre);
+        MAKE_PTR(WoundHealingForce<2>, p_selective_force);
+        p_selective_force->SetWoundCentres(wound_centres);
+        p_selective_force->AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(p_selective_force->rGetWoundLoops().size(), 1u);
+        TS_ASSERT_EQUALS(p_selective_force->rGetWoundLoops()[0].size(), 6u);
+    }
+
+    void TestCylindricalMesh()
+    {
+        // The top and bottom boundaries of a cylindrical mesh wrap around it, and are not wounds
+        CylindricalHoneycombVertexMeshGenerator generator(6, 6);
+        Cylindrical2dVertexMesh* p_mesh = generator.GetCylindricalMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        p_force->AddForceContribution(cell_population);
+        std::vector<std::vector<unsigned> > boundary_loops;
+        p_force->LabelBoundaryLoops(cell_population, boundary_loops);
+        TS_ASSERT_EQUALS(boundary_loops.size(), 2u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops().size(), 0u);
+
+        // A wound cut into the middle of the cylinder is found alongside them
+        p_mesh->DeleteElementPriorToReMesh(15);
+        p_mesh->ReMesh();
+        p_force->AddForceContribution(cell_population);
+        p_force->LabelBoundaryLoops(cell_population, boundary_loops);
+        TS_ASSERT_EQUALS(boundary_loops.size(), 3u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops().size(), 1u);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops()[0].size(), 6u);
+    }
+
+    void TestTimingsAreWrittenWithParameters()
+    {
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        for (unsigned step=0; step<3; step++)
+        {
+            p_force->AddForceContribution(cell_population);
+        }
+
+        // The counters are only updated if timings are compiled in
+        const WoundHealingForceTimings& r_timings = p_force->rGetTimings();
+        if (WoundHealingForceTimings::IsEnabled())
+        {
+            TS_ASSERT_EQUALS(r_timings.GetNumCalls(), 3u);
+            TS_ASSERT_EQUALS(r_timings.GetNumPhaseCalls(WoundHealingForceTimings::BOUNDARY_UPDATE), 3u);
+            TS_ASSERT_EQUALS(r_timings.GetNumPhaseCalls(WoundHealingForceTimings::BOUNDARY_REBUILD), 1u);
+            TS_ASSERT_EQUALS(r_timings.GetNumPhaseCalls(WoundHealingForceTimings::WOUND_TENSION), 3u);
+            TS_ASSERT_EQUALS(r_timings.GetNumPhaseCalls(WoundHealingForceTimings::FARHADIFAR), 0u);
+            TS_ASSERT_LESS_THAN_EQUALS(6u, r_timings.GetMaxLoopLength());
+            TS_ASSERT_LESS_THAN(0u, r_timings.GetNumNodesScanned());
+        }
+        else
+        {
+            TS_ASSERT_EQUALS(r_timings.GetNumCalls(), 0u);
+            TS_ASSERT_EQUALS(r_timings.GetNumLoopWalks(), 0u);
+            TS_ASSERT_EQUALS(r_timings.GetPhaseNanoseconds(WoundHealingForceTimings::BOUNDARY_UPDATE), 0u);
+        }
+
+        // The summary is written after the wound tension parameter
+        OutputFileHandler handler("TestWoundHealingForceTimings");
+        out_stream p_parameter_file = handler.OpenOutputFile("wound_healing_force.parameters");
+        p_force->OutputForceParameters(p_parameter_file);
+        p_parameter_file->close();
+
+        std::ifstream parameter_file((handler.GetOutputDirectoryFullPath() + "wound_healing_force.parameters").c_str());
+        std::stringstream parameters;
+        parameters << parameter_file.rdbuf();
+        TS_ASSERT_DIFFERS(parameters.str().find("<WoundTensionParameter>0.12</WoundTensionParameter>"), std::string::npos);
+        TS_ASSERT_EQUALS(parameters.str().find("<WoundForceTimings>") != std::string::npos,
+                         WoundHealingForceTimings::IsEnabled());
+
+        p_force->ResetTimings();
+        TS_ASSERT_EQUALS(p_force->rGetTimings().GetNumCalls(), 0u);
+        TS_ASSERT_EQUALS(p_force->rGetTimings().GetMaxLoopLength(), 0u);
+    }
+};
+
+#endif /*TESTWOUNDHEALINGFORCE_HPP_*/
@@ -0,0 +1,164 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTWOUNDHEALINGFORCEALLOCATIONS_HPP_
+#define TESTWOUNDHEALINGFORCEALLOCATIONS_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SmartPointers.hpp"
+#include "WoundHealingForce.hpp"
+#include "FarhadifarWoundHealingForce.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+/*
+ * Each test suite is built into its own executable, so we can replace the global
+ * operator new here to count the heap allocations made while the forces are evaluated.
+ */
+namespace
+{
+    /** Whether allocations are currently being counted. */
+    bool gCountAllocations = false;
+
+    /** The number of allocations counted. */
+    unsigned gNumAllocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+    if (gCountAllocations)
+    {
+        gNumAllocations++;
+    }
+    void* p_memory = std::malloc(size == 0 ? 1 : size);
+    if (p_memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p_memory;
+}
+
+void operator delete(void* pMemory) noexcept
+{
+    std::free(pMemory);
+}
+
+class TestWoundHealingForceAllocations : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Move the nodes of a population slightly, without changing its topology, and
+     * evaluate a force on it.
+     */
+    void MoveNodesAndAddForce(AbstractForce<2>& rForce, VertexBasedCellPopulation<2>& rCellPopulation, unsigned step)
+    {
+        for (unsigned node_index=0; node_index<rCellPopulation.GetNumNodes(); node_index++)
+        {
+            Node<2>* p_node = rCellPopulation.GetNode(node_index);
+            p_node->rGetModifiableLocation()[0] += 1e-4*sin((double)(node_index + step));
+            p_node->ClearAppliedForce();
+        }
+        rForce.AddForceContribution(rCellPopulation);
+    }
+
+public:
+
+    void TestNoAllocationsInSteadyState()
+    {
+        // Create a honeycomb mesh with two wounds
+        HoneycombVertexMeshGenerator generator(8, 8);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        p_mesh->DeleteElementPriorToReMesh(18);
+        p_mesh->DeleteElementPriorToReMesh(45);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            cell_iter->GetCellData()->SetItem("target area", 0.8);
+        }
+
+        MAKE_PTR(WoundHealingForce<2>, p_wound_force);
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_fused_force);
+
+        // Warm up, so that all scratch buffers have reached their size
+        for (unsigned step=0; step<3; step++)
+        {
+            MoveNodesAndAddForce(*p_wound_force, cell_population, step);
+            MoveNodesAndAddForce(*p_fused_force, cell_population, step);
+        }
+        TS_ASSERT_EQUALS(p_wound_force->rGetWoundLoops().size(), 2u);
+        TS_ASSERT_EQUALS(p_fused_force->rGetWoundLoops().size(), 2u);
+
+        // Count the allocations over further time steps
+        gNumAllocations = 0;
+        gCountAllocations = true;
+        for (unsigned step=3; step<13; step++)
+        {
+            MoveNodesAndAddForce(*p_wound_force, cell_population, step);
+        }
+        gCountAllocations = false;
+        TS_ASSERT_EQUALS(gNumAllocations, 0u);
+
+        gNumAllocations = 0;
+        gCountAllocations = true;
+        for (unsigned step=3; step<13; step++)
+        {
+            MoveNodesAndAddForce(*p_fused_force, cell_population, step);
+        }
+        gCountAllocations = false;
+        TS_ASSERT_EQUALS(gNumAllocations, 0u);
+
+        // The wounds were patched rather than rebuilt
+        TS_ASSERT_EQUALS(p_wound_force->GetNumWoundBoundaryRebuilds(), 1u);
+        TS_ASSERT_EQUALS(p_fused_force->GetNumWoundBoundaryRebuilds(), 1u);
+    }
+};
+
+#endif /*TESTWOUNDHEALINGFORCEALLOCATIONS_HPP_*/
@@ -0,0 +1,187 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTWOUNDHEALINGFORCEPERFORMANCE_HPP_
+#define TESTWOUNDHEALINGFORCEPERFORMANCE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SmartPointers.hpp"
+#include "Timer.hpp"
+#include "WoundHealingForce.hpp"
+#include "PlainVector2d.hpp"
+
+#include <vector>
+
+/**
+ * A microbenchmark of the tension calculation on the wound nodes. The same loop over the
+ * same ring is timed twice: once with c_vector and GetVectorFromAtoB(), as the generic
+ * template did, and once with PlainVector2d, as WoundHealingForce<2> does. It only prints
+ * its times, so it is in the profile test pack rather than the continuous one.
+ */
+class TestWoundHealingForcePerformance : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * The tension on each wound node, calculated with c_vector and the vectors of the mesh.
+     *
+     * @param rTriples the previous node, the node and the next node of each wound node in turn
+     * @param woundTension the wound tension parameter
+     * @param rMesh the mesh
+     * @param rForces vector to be filled with the tension on each wound node
+     */
+    void CalculateTensionsWithCVector(const std::vector<unsigned>& rTriples, double woundTension,
+                                      MutableVertexMesh<2,2>& rMesh, std::vector<c_vector<double, 2> >& rForces)
+    {
+        for (unsigned i=0; i<rForces.size(); i++)
+        {
+            const c_vector<double, 2>& r_previous_location = rMesh.GetNode(rTriples[3*i])->rGetLocation();
+            const c_vector<double, 2>& r_this_location = rMesh.GetNode(rTriples[3*i+1])->rGetLocation();
+            const c_vector<double, 2>& r_next_location = rMesh.GetNode(rTriples[3*i+2])->rGetLocation();
+            c_vector<double, 2> previous_edge = rMesh.GetVectorFromAtoB(r_previous_location, r_this_location);
+            c_vector<double, 2> next_edge = rMesh.GetVectorFromAtoB(r_next_location, r_this_location);
+            rForces[i] = -woundTension/norm_2(previous_edge)*previous_edge - woundTension/norm_2(next_edge)*next_edge;
+        }
+    }
+
+    /**
+     * The tension on each wound node, calculated with PlainVector2d.
+     *
+     * @param rTriples the previous node, the node and the next node of each wound node in turn
+     * @param woundTension the wound tension parameter
+     * @param rMesh the mesh
+     * @param rForces vector to be filled with the tension on each wound node
+     */
+    void CalculateTensionsWithPlainVector(const std::vector<unsigned>& rTriples, double woundTension,
+                                          MutableVertexMesh<2,2>& rMesh, std::vector<PlainVector2d>& rForces)
+    {
+        for (unsigned i=0; i<rForces.size(); i++)
+        {
+            PlainVector2d previous_location = MakePlainVector2d(rMesh.GetNode(rTriples[3*i])->rGetLocation());
+            PlainVector2d this_location = MakePlainVector2d(rMesh.GetNode(rTriples[3*i+1])->rGetLocation());
+            PlainVector2d next_location = MakePlainVector2d(rMesh.GetNode(rTriples[3*i+2])->rGetLocation());
+            PlainVector2d previous_edge = this_location - previous_location;
+            PlainVector2d next_edge = this_location - next_location;
+            rForces[i] = (-woundTension/Norm(previous_edge))*previous_edge - (woundTension/Norm(next_edge))*next_edge;
+        }
+    }
+
+public:
+
+    void TestWoundTensionPerNode()
+    {
+        // Cut a large circular wound into a honeycomb mesh
+        HoneycombVertexMeshGenerator generator(30, 30);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        c_vector<double, 2> mesh_centre = p_mesh->GetCentroidOfElement(15*30+15);
+        for (unsigned elem_index=0; elem_index<p_mesh->GetNumElements(); elem_index++)
+        {
+            if (norm_2(p_mesh->GetCentroidOfElement(elem_index) - mesh_centre) < 5.0)
+            {
+                p_mesh->DeleteElementPriorToReMesh(elem_index);
+            }
+        }
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        for (unsigned node_index=0; node_index<cell_population.GetNumNodes(); node_index++)
+        {
+            cell_population.GetNode(node_index)->ClearAppliedForce();
+        }
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        p_force->SetWoundTensionParameter(1.0);
+        p_force->AddForceContribution(cell_population);
+        TS_ASSERT_EQUALS(p_force->rGetWoundLoops().size(), 1u);
+
+        std::vector<unsigned> triples;
+        p_force->GetWoundNodeTriples(triples);
+        unsigned num_wound_nodes = triples.size()/3;
+        TS_ASSERT_EQUALS(num_wound_nodes, p_force->rGetWoundLoops()[0].size());
+        std::vector<c_vector<double, 2> > c_vector_forces(num_wound_nodes);
+        std::vector<PlainVector2d> plain_forces(num_wound_nodes);
+
+        // Both loops agree with each other and with the force, which only acts on the wound nodes
+        CalculateTensionsWithCVector(triples, 1.0, *p_mesh, c_vector_forces);
+        CalculateTensionsWithPlainVector(triples, 1.0, *p_mesh, plain_forces);
+        for (unsigned i=0; i<num_wound_nodes; i++)
+        {
+            const c_vector<double, 2>& r_applied_force = cell_population.GetNode(triples[3*i+1])->rGetAppliedForce();
+            TS_ASSERT_DELTA(c_vector_forces[i][0], r_applied_force[0], 1e-12);
+            TS_ASSERT_DELTA(c_vector_forces[i][1], r_applied_force[1], 1e-12);
+            TS_ASSERT_DELTA(plain_forces[i].x, r_applied_force[0], 1e-12);
+            TS_ASSERT_DELTA(plain_forces[i].y, r_applied_force[1], 1e-12);
+        }
+
+        // Time the same loop over the same ring both ways, reading the results so that neither loop is optimised away
+        unsigned num_repetitions = 20000;
+        double c_vector_checksum = 0.0;
+        Timer::Reset();
+        for (unsigned repetition=0; repetition<num_repetitions; repetition++)
+        {
+            CalculateTensionsWithCVector(triples, 1.0, *p_mesh, c_vector_forces);
+            c_vector_checksum += c_vector_forces[repetition%num_wound_nodes][0];
+        }
+        double c_vector_time = Timer::GetElapsedTime();
+
+        double plain_checksum = 0.0;
+        Timer::Reset();
+        for (unsigned repetition=0; repetition<num_repetitions; repetition++)
+        {
+            CalculateTensionsWithPlainVector(triples, 1.0, *p_mesh, plain_forces);
+            plain_checksum += plain_forces[repetition%num_wound_nodes].x;
+        }
+        double plain_time = Timer::GetElapsedTime();
+        TS_ASSERT_DELTA(c_vector_checksum, plain_checksum, 1e-6);
+
+        double num_evaluations = (double)num_repetitions*num_wound_nodes;
+        std::cout << "Wound nodes: " << num_wound_nodes << "\n"
+                  << "c_vector and GetVectorFromAtoB(): " << 1e9*c_vector_time/num_evaluations << " ns per node\n"
+                  << "PlainVector2d:                    " << 1e9*plain_time/num_evaluations << " ns per node\n"
+                  << "Speed-up: " << c_vector_time/plain_time << std::endl;
+    }
+};
+
+#endif /*TESTWOUNDHEALINGFORCEPERFORMANCE_HPP_*/
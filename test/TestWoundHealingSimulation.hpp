@@ -0,0 +1,268 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTWOUNDHEALINGSIMULATION_HPP_
+#define TESTWOUNDHEALINGSIMULATION_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SimpleTargetAreaModifier.hpp"
+#include "SimulationTime.hpp"
+#include "SmartPointers.hpp"
+#include "StepSizeException.hpp"
+#include "DisplacementControlledNumericalMethod.hpp"
+#include "FarhadifarWoundHealingForce.hpp"
+#include "WoundHealingForce.hpp"
+#include "WoundHealingSimulation.hpp"
+#include "WoundMeshUtilities.hpp"
+#include "OutputFileHandler.hpp"
+#include "FileFinder.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+class TestWoundHealingSimulation : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Run a wound closing in a honeycomb mesh, and return its area at the end. The number of
+     * steps counts every step the numerical method tried, including those it rejected.
+     */
+    double RunWoundClosure(bool useAdaptiveTimestep, unsigned& rNumTimeSteps)
+    {
+        HoneycombVertexMeshGenerator generator(6, 6);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        p_mesh->DeleteElementPriorToReMesh(14);
+        p_mesh->DeleteElementPriorToReMesh(15);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.SetRestrictVertexMovementBoolean(false);
+
+        WoundHealingSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory(useAdaptiveTimestep ? "TestWoundHealingSimulationAdaptive" : "TestWoundHealingSimulationFixed");
+        simulator.SetEndTime(100.0);
+        simulator.SetDt(0.01);
+        simulator.SetSamplingTimestepMultiple(5000);
+
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+        p_force->SetWoundTensionParameter(1.0);
+        simulator.AddForce(p_force);
+        MAKE_PTR(SimpleTargetAreaModifier<2>, p_growth_modifier);
+        p_growth_modifier->SetGrowthDuration(0.0);
+        simulator.AddSimulationModifier(p_growth_modifier);
+
+        MAKE_PTR(DisplacementControlledNumericalMethod<2>, p_method);
+        if (useAdaptiveTimestep)
+        {
+            simulator.SetNumericalMethod(p_method);
+        }
+        simulator.Solve();
+
+        TS_ASSERT_DELTA(SimulationTime::Instance()->GetTime(), 100.0, 1e-9);
+        if (useAdaptiveTimestep)
+        {
+            // Rejected steps and the sub-steps that redo them each evaluate the forces too
+            rNumTimeSteps = p_method->GetNumAcceptedSteps() + p_method->GetNumRejectedSteps();
+            TS_ASSERT_LESS_THAN_EQUALS(simulator.GetNumTimeSteps(), p_method->GetNumAcceptedSteps());
+        }
+        else
+        {
+            rNumTimeSteps = simulator.GetNumTimeSteps();
+            TS_ASSERT_EQUALS(simulator.GetNumTimestepChanges(), 0u);
+        }
+
+        return WoundMeshUtilities::GetTotalAreaOfWounds(*p_mesh, p_force->rGetWoundLoops());
+    }
+
+public:
+
+    void TestLargeStepsAreRejected()
+    {
+        // The tension on a hexagonal wound moves each of its nodes towards the centre at speed 2
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        p_force->SetWoundTensionParameter(2.0);
+        std::vector<boost::shared_ptr<AbstractForce<2,2> > > forces;
+        forces.push_back(p_force);
+
+        MAKE_PTR(DisplacementControlledNumericalMethod<2>, p_method);
+        p_method->SetCellPopulation(&cell_population);
+        p_method->SetForceCollection(&forces);
+        TS_ASSERT(p_method->HasAdaptiveTimestep());
+        TS_ASSERT_DELTA(p_method->GetSuggestedTimestep(), 0.0, 1e-12);
+
+        // Nodes may move by half the rearrangement threshold of 0.01 in a step, so a step of 0.01 is too large
+        c_vector<double, 2> old_location = p_mesh->GetNode(0)->rGetLocation();
+        try
+        {
+            p_method->UpdateAllNodePositions(0.01);
+            TS_FAIL("The step should have been rejected");
+        }
+        catch (StepSizeException& e)
+        {
+            TS_ASSERT(!e.IsTerminal());
+            TS_ASSERT_DELTA(e.GetNewStepSize(), 0.9*0.005/2.0, 1e-9);
+        }
+        TS_ASSERT_EQUALS(p_method->GetNumRejectedSteps(), 1u);
+        TS_ASSERT_DELTA(p_mesh->GetNode(0)->rGetLocation()[0], old_location[0], 1e-12);
+        TS_ASSERT_DELTA(p_mesh->GetNode(0)->rGetLocation()[1], old_location[1], 1e-12);
+
+        // A smaller step is taken, and the next step may only grow to the displacement limit
+        unsigned wound_node = p_force->rGetWoundLoops()[0][0];
+        c_vector<double, 2> old_wound_location = p_mesh->GetNode(wound_node)->rGetLocation();
+        p_method->UpdateAllNodePositions(0.002);
+        TS_ASSERT_EQUALS(p_method->GetNumAcceptedSteps(), 1u);
+        TS_ASSERT_DELTA(norm_2(p_mesh->GetNode(wound_node)->rGetLocation() - old_wound_location), 0.004, 1e-9);
+        TS_ASSERT_DELTA(p_method->GetSuggestedTimestep(), 0.9*0.005/2.0, 1e-9);
+
+        // Steps at the minimum size are always taken
+        p_method->SetMinimumTimestep(0.02);
+        p_method->UpdateAllNodePositions(0.02);
+        TS_ASSERT_EQUALS(p_method->GetNumAcceptedSteps(), 2u);
+        TS_ASSERT_DELTA(p_method->GetSuggestedTimestep(), 0.02, 1e-12);
+    }
+
+    void TestAdaptiveRunTakesFewerSteps()
+    {
+        unsigned num_fixed_steps = 0;
+        double fixed_step_wound_area = RunWoundClosure(false, num_fixed_steps);
+        TS_ASSERT_EQUALS(num_fixed_steps, 10000u);
+
+        // Start again with fresh simulation time
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+
+        unsigned num_adaptive_steps = 0;
+        double adaptive_wound_area = RunWoundClosure(true, num_adaptive_steps);
+        // Steps are small while the wound closes, but grow once the tissue is relaxing, which takes most of the run
+        TS_ASSERT_LESS_THAN_EQUALS(num_adaptive_steps, num_fixed_steps/5);
+        TS_ASSERT_DELTA(adaptive_wound_area, fixed_step_wound_area, 0.1);
+    }
+
+    void TestSimulationStopsWhenWoundCloses()
+    {
+        // Pulled only by the wound tension, the corners of a hexagonal wound move towards its centre at unit speed
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        double wound_radius = p_mesh->GetSurfaceAreaOfElement(12)/6.0;
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.SetRestrictVertexMovementBoolean(false);
+
+        WoundHealingSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("TestWoundHealingSimulationStops");
+        simulator.SetEndTime(1.0);
+        simulator.SetDt(0.01);
+        simulator.SetSamplingTimestepMultiple(100);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        p_force->SetWoundTensionParameter(1.0);
+        simulator.AddForce(p_force);
+        simulator.SetWoundClosureStoppingEvent(p_force, 0.05);
+        TS_ASSERT_EQUALS(simulator.GetWoundClosureForce(), p_force);
+        TS_ASSERT_DELTA(simulator.GetClosedWoundArea(), 0.05, 1e-12);
+        TS_ASSERT_EQUALS(simulator.GetMaxClosedWoundNumNodes(), 3u);
+
+        simulator.Solve();
+
+        // The area of the wound is 3*sqrt(3)/2*r^2, so it falls below 0.05 once the radius is below 0.139
+        double closure_time = wound_radius - sqrt(0.1/(3.0*sqrt(3.0)));
+        TS_ASSERT(simulator.GetWoundsHaveClosed());
+        TS_ASSERT_DELTA(simulator.GetWoundClosureTime(), closure_time, 0.011);
+        TS_ASSERT_DELTA(SimulationTime::Instance()->GetTime(), simulator.GetWoundClosureTime(), 1e-12);
+        TS_ASSERT_LESS_THAN(SimulationTime::Instance()->GetTime(), 1.0);
+
+        // The stopping event is written with the simulation parameters
+        OutputFileHandler output_file_handler("TestWoundHealingSimulationStops/results_from_time_0", false);
+        FileFinder parameter_finder = output_file_handler.FindFile("results.parameters");
+        std::ifstream parameter_stream(parameter_finder.GetAbsolutePath().c_str());
+        std::string parameters((std::istreambuf_iterator<char>(parameter_stream)), std::istreambuf_iterator<char>());
+        TS_ASSERT_DIFFERS(parameters.find("<ClosedWoundArea>0.05</ClosedWoundArea>"), std::string::npos);
+    }
+
+    void TestOutputParameters()
+    {
+        MAKE_PTR(DisplacementControlledNumericalMethod<2>, p_method);
+        p_method->SetMaxDisplacementFraction(0.3);
+        p_method->SetErrorTolerance(2e-3);
+        p_method->SetSafetyFactor(0.8);
+        p_method->SetMaxGrowthFactor(1.5);
+        p_method->SetMaximumTimestep(0.5);
+        TS_ASSERT_DELTA(p_method->GetMaxDisplacementFraction(), 0.3, 1e-12);
+        TS_ASSERT_DELTA(p_method->GetErrorTolerance(), 2e-3, 1e-12);
+        TS_ASSERT_DELTA(p_method->GetSafetyFactor(), 0.8, 1e-12);
+        TS_ASSERT_DELTA(p_method->GetMaxGrowthFactor(), 1.5, 1e-12);
+        TS_ASSERT_DELTA(p_method->GetMinimumTimestep(), 1e-4, 1e-12);
+        TS_ASSERT_DELTA(p_method->GetMaximumTimestep(), 0.5, 1e-12);
+
+        OutputFileHandler output_file_handler("TestWoundHealingSimulation", false);
+        out_stream parameter_file = output_file_handler.OpenOutputFile("numerical_method.parameters");
+        p_method->OutputNumericalMethodParameters(parameter_file);
+        parameter_file->close();
+
+        FileFinder parameter_finder = output_file_handler.FindFile("numerical_method.parameters");
+        std::ifstream parameter_stream(parameter_finder.GetAbsolutePath().c_str());
+        std::string parameters((std::istreambuf_iterator<char>(parameter_stream)), std::istreambuf_iterator<char>());
+        TS_ASSERT_DIFFERS(parameters.find("<MaxDisplacementFraction>0.3</MaxDisplacementFraction>"), std::string::npos);
+        TS_ASSERT_DIFFERS(parameters.find("<MaximumTimestep>0.5</MaximumTimestep>"), std::string::npos);
+    }
+};
+
+#endif /*TESTWOUNDHEALINGSIMULATION_HPP_*/
@@ -0,0 +1,224 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTWOUNDHEALINGTRACER_HPP_
+#define TESTWOUNDHEALINGTRACER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SimpleTargetAreaModifier.hpp"
+#include "SmartPointers.hpp"
+#include "OutputFileHandler.hpp"
+#include "FarhadifarWoundHealingForce.hpp"
+#include "WoundHealingSimulation.hpp"
+#include "WoundHealingTracer.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestWoundHealingTracer : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * @return the contents of a file
+     */
+    std::string ReadFile(const std::string& rPath)
+    {
+        std::ifstream file(rPath.c_str());
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    /**
+     * @return the number of times a string occurs in another
+     */
+    unsigned CountOccurrences(const std::string& rText, const std::string& rPattern)
+    {
+        unsigned count = 0;
+        for (std::size_t pos = rText.find(rPattern); pos != std::string::npos; pos = rText.find(rPattern, pos + 1))
+        {
+            count++;
+        }
+        return count;
+    }
+
+public:
+
+    void TestEventsFromSeveralThreads()
+    {
+        WoundHealingTracer* p_tracer = WoundHealingTracer::Instance();
+
+        // Nothing is recorded unless the tracer is started
+        p_tracer->RecordInstant("Ignored");
+        {
+            WoundHealingTracer::Scope scope("IgnoredScope");
+        }
+
+        p_tracer->Start(16);
+        TS_ASSERT(p_tracer->IsRecording());
+        {
+            WoundHealingTracer::Scope scope("Outer");
+            p_tracer->RecordInstant("Swap", "num_swaps", 2.0);
+        }
+        p_tracer->RecordCounter("NumCells", 36.0);
+
+        std::vector<std::thread> threads;
+        for (unsigned thread_index=0; thread_index<3; thread_index++)
+        {
+            threads.push_back(std::thread([p_tracer]
+            {
+                p_tracer->SetThreadName("worker");
+                for (unsigned i=0; i<5; i++)
+                {
+                    WoundHealingTracer::Scope scope("Work");
+                }
+            }));
+        }
+        for (unsigned thread_index=0; thread_index<threads.size(); thread_index++)
+        {
+            threads[thread_index].join();
+        }
+
+        OutputFileHandler handler("TestWoundHealingTracer");
+        std::string path = handler.GetOutputDirectoryFullPath() + "trace.json";
+        TS_ASSERT_THROWS_THIS(p_tracer->WriteChromeTrace(path),
+                              "The tracer must be stopped before its trace is written");
+        p_tracer->Stop();
+        TS_ASSERT(!p_tracer->IsRecording());
+        TS_ASSERT_EQUALS(p_tracer->GetNumEvents(), 18u);
+        TS_ASSERT_EQUALS(p_tracer->GetNumOverwrittenEvents(), 0u);
+        p_tracer->WriteChromeTrace(path);
+
+        std::string trace = ReadFile(path);
+        TS_ASSERT_EQUALS(trace.substr(0, 19), "{\"displayTimeUnit\":");
+        TS_ASSERT_EQUALS(CountOccurrences(trace, "\"name\":\"Work\",\"ph\":\"X\""), 15u);
+        TS_ASSERT_EQUALS(CountOccurrences(trace, "\"name\":\"Outer\",\"ph\":\"X\""), 1u);
+        TS_ASSERT_EQUALS(CountOccurrences(trace, "\"name\":\"Swap\",\"ph\":\"i\""), 1u);
+        TS_ASSERT_EQUALS(CountOccurrences(trace, "\"args\":{\"num_swaps\":2}"), 1u);
+        TS_ASSERT_EQUALS(CountOccurrences(trace, "\"args\":{\"value\":36}"), 1u);
+        TS_ASSERT_EQUALS(CountOccurrences(trace, "\"args\":{\"name\":\"worker\"}"), 3u);
+        TS_ASSERT_EQUALS(CountOccurrences(trace, "Ignored"), 0u);
+    }
+
+    void TestFullBufferKeepsTheLatestEvents()
+    {
+        // The buffers of an earlier recording are cleared when the tracer is started again
+        WoundHealingTracer* p_tracer = WoundHealingTracer::Instance();
+        p_tracer->Start(5);
+        for (unsigned i=0; i<20; i++)
+        {
+            p_tracer->RecordCounter("Step", i);
+        }
+        p_tracer->Stop();
+
+        // The size is rounded up to 8
+        TS_ASSERT_EQUALS(p_tracer->GetNumEvents(), 8u);
+        TS_ASSERT_EQUALS(p_tracer->GetNumOverwrittenEvents(), 12u);
+
+        OutputFileHandler handler("TestWoundHealingTracer", false);
+        std::string path = handler.GetOutputDirectoryFullPath() + "wrapped_trace.json";
+        p_tracer->WriteChromeTrace(path);
+        std::string trace = ReadFile(path);
+        TS_ASSERT_EQUALS(CountOccurrences(trace, "\"name\":\"Step\""), 8u);
+        TS_ASSERT_EQUALS(CountOccurrences(trace, "\"args\":{\"value\":11}"), 0u);
+        TS_ASSERT_EQUALS(CountOccurrences(trace, "\"args\":{\"value\":12}"), 1u);
+        TS_ASSERT_EQUALS(CountOccurrences(trace, "\"args\":{\"value\":19}"), 1u);
+
+        // The oldest kept event comes first
+        TS_ASSERT_LESS_THAN(trace.find("\"value\":12}"), trace.find("\"value\":19}"));
+    }
+
+    void TestSimulationPhasesAreTraced()
+    {
+        HoneycombVertexMeshGenerator generator(6, 6);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        p_mesh->DeleteElementPriorToReMesh(14);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        WoundHealingSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("TestWoundHealingTracerSimulation");
+        simulator.SetEndTime(0.1);
+        simulator.SetDt(0.01);
+        simulator.SetSamplingTimestepMultiple(5);
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+        simulator.AddForce(p_force);
+        MAKE_PTR(SimpleTargetAreaModifier<2>, p_growth_modifier);
+        p_growth_modifier->SetGrowthDuration(0.0);
+        simulator.AddSimulationModifier(p_growth_modifier);
+
+        WoundHealingTracer* p_tracer = WoundHealingTracer::Instance();
+        p_tracer->Start();
+        simulator.Solve();
+        p_tracer->Stop();
+
+        OutputFileHandler handler("TestWoundHealingTracer", false);
+        std::string path = handler.GetOutputDirectoryFullPath() + "simulation_trace.json";
+        p_tracer->WriteChromeTrace(path);
+        std::string trace = ReadFile(path);
+
+        if (WoundHealingTracer::IsEnabled())
+        {
+            // Each of the 10 steps is traced, except for the output after the last one
+            TS_ASSERT_EQUALS(CountOccurrences(trace, "\"name\":\"UpdateCellPopulation\""), 10u);
+            TS_ASSERT_EQUALS(CountOccurrences(trace, "\"name\":\"UpdateCellLocationsAndTopology\""), 10u);
+            TS_ASSERT_EQUALS(CountOccurrences(trace, "\"name\":\"ModifiersAndOutput\""), 9u);
+            TS_ASSERT_EQUALS(CountOccurrences(trace, "\"name\":\"TimeStep\""), 9u);
+            TS_ASSERT_EQUALS(CountOccurrences(trace, "\"name\":\"FarhadifarWoundHealingForce::AddForceContribution\""), 10u);
+            TS_ASSERT_EQUALS(CountOccurrences(trace, "\"name\":\"WoundTension\""), 10u);
+            TS_ASSERT_EQUALS(CountOccurrences(trace, "\"t1_swaps\":"), 10u);
+        }
+        else
+        {
+            // Without the trace points, the trace is empty
+            TS_ASSERT_EQUALS(p_tracer->GetNumEvents(), 0u);
+            TS_ASSERT_EQUALS(CountOccurrences(trace, "\"ph\":\"X\""), 0u);
+        }
+    }
+};
+
+#endif /*TESTWOUNDHEALINGTRACER_HPP_*/
@@ -0,0 +1,206 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTWOUNDMESHBUILDER_HPP_
+#define TESTWOUNDMESHBUILDER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "WoundMeshBuilder.hpp"
+
+#include <cmath>
+#include <vector>
+
+class TestWoundMeshBuilder : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestCentroidsAndAreas()
+    {
+        HoneycombVertexMeshGenerator generator(6, 6);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+        WoundMeshBuilder builder(*p_mesh);
+        TS_ASSERT_EQUALS(builder.GetNumKeptElements(), 36u);
+        TS_ASSERT_DELTA(builder.GetScaleFactor(), 1.0, 1e-12);
+
+        c_vector<double, 2> mesh_centroid = zero_vector<double>(2);
+        for (unsigned elem_index=0; elem_index<p_mesh->GetNumAllElements(); elem_index++)
+        {
+            TS_ASSERT(builder.IsElementKept(elem_index));
+            c_vector<double, 2> centroid = p_mesh->GetCentroidOfElement(elem_index);
+            TS_ASSERT_DELTA(builder.GetCentroidOfElement(elem_index)[0], centroid[0], 1e-12);
+            TS_ASSERT_DELTA(builder.GetCentroidOfElement(elem_index)[1], centroid[1], 1e-12);
+            TS_ASSERT_DELTA(builder.GetAreaOfElement(elem_index), p_mesh->GetVolumeOfElement(elem_index), 1e-12);
+            mesh_centroid += centroid;
+        }
+        mesh_centroid /= p_mesh->GetNumAllElements();
+        TS_ASSERT_DELTA(builder.GetCentroidOfKeptElements()[0], mesh_centroid[0], 1e-12);
+        TS_ASSERT_DELTA(builder.GetCentroidOfKeptElements()[1], mesh_centroid[1], 1e-12);
+        TS_ASSERT_DELTA(builder.GetMeanAreaOfKeptElements(), 0.5*sqrt(3.0), 1e-12);
+    }
+
+    void TestRegionQueriesMatchAPassOverAllElements()
+    {
+        HoneycombVertexMeshGenerator generator(20, 20);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        WoundMeshBuilder builder(*p_mesh);
+
+        // Circles inside, overlapping and outside the mesh
+        std::vector<c_vector<double, 2> > centres(3);
+        centres[0][0] = 10.0;
+        centres[0][1] = 9.0;
+        centres[1][0] = 0.5;
+        centres[1][1] = 17.0;
+        centres[2][0] = -20.0;
+        centres[2][1] = 5.0;
+        for (unsigned centre_index=0; centre_index<centres.size(); centre_index++)
+        {
+            std::vector<unsigned> expected;
+            for (unsigned elem_index=0; elem_index<p_mesh->GetNumAllElements(); elem_index++)
+            {
+                if (norm_2(p_mesh->GetCentroidOfElement(elem_index) - centres[centre_index]) < 3.2)
+                {
+                    expected.push_back(elem_index);
+                }
+            }
+            std::vector<unsigned> in_circle = builder.GetElementsInCircle(centres[centre_index], 3.2);
+            TS_ASSERT_EQUALS(in_circle, expected);
+        }
+        TS_ASSERT(builder.GetElementsInCircle(centres[2], 3.2).empty());
+
+        // A triangle, given clockwise
+        std::vector<c_vector<double, 2> > triangle(3);
+        triangle[0][0] = 2.0;
+        triangle[0][1] = 2.0;
+        triangle[1][0] = 8.0;
+        triangle[1][1] = 14.0;
+        triangle[2][0] = 14.0;
+        triangle[2][1] = 2.0;
+        std::vector<unsigned> expected;
+        for (unsigned elem_index=0; elem_index<p_mesh->GetNumAllElements(); elem_index++)
+        {
+            c_vector<double, 2> centroid = p_mesh->GetCentroidOfElement(elem_index);
+            if (centroid[1] > 2.0 && centroid[1] < 14.0 - 2.0*fabs(centroid[0] - 8.0))
+            {
+                expected.push_back(elem_index);
+            }
+        }
+        TS_ASSERT(!expected.empty());
+        TS_ASSERT_EQUALS(builder.GetElementsInPolygon(triangle), expected);
+
+        triangle.resize(2);
+        TS_ASSERT_THROWS_THIS(builder.GetElementsInPolygon(triangle), "A polygon needs at least three vertices");
+    }
+
+    void TestRescaleAndCutSeveralWounds()
+    {
+        HoneycombVertexMeshGenerator generator(20, 20);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        WoundMeshBuilder builder(*p_mesh);
+
+        builder.RescaleToMeanElementArea(1.0);
+        double scale_factor = sqrt(2.0/sqrt(3.0));
+        TS_ASSERT_DELTA(builder.GetScaleFactor(), scale_factor, 1e-12);
+        TS_ASSERT_DELTA(builder.GetMeanAreaOfKeptElements(), 1.0, 1e-12);
+
+        // A circular wound in the lower left and a square one in the upper right, in rescaled coordinates
+        c_vector<double, 2> circle_centre;
+        circle_centre[0] = 6.0;
+        circle_centre[1] = 6.0;
+        unsigned num_in_circle = builder.CutCircularWound(circle_centre, 2.0);
+        TS_ASSERT_LESS_THAN(0u, num_in_circle);
+
+        std::vector<c_vector<double, 2> > square(4);
+        square[0][0] = 12.0;
+        square[0][1] = 12.0;
+        square[1][0] = 16.0;
+        square[1][1] = 12.0;
+        square[2][0] = 16.0;
+        square[2][1] = 16.0;
+        square[3][0] = 12.0;
+        square[3][1] = 16.0;
+        unsigned num_in_square = builder.CutPolygonalWound(square);
+        TS_ASSERT_LESS_THAN(0u, num_in_square);
+        TS_ASSERT_EQUALS(builder.GetNumKeptElements(), 400u - num_in_circle - num_in_square);
+
+        // Cutting the same wound again chooses nothing more
+        TS_ASSERT_EQUALS(builder.GetElementsInCircle(circle_centre, 2.0).size(), 0u);
+
+        TS_ASSERT_EQUALS(builder.rGetWoundCentres().size(), 2u);
+        TS_ASSERT_DELTA(builder.rGetWoundCentres()[0][0], 6.0, 1e-12);
+        TS_ASSERT_DELTA(builder.rGetWoundCentres()[1][0], 14.0, 1e-12);
+        TS_ASSERT_DELTA(builder.rGetWoundCentres()[1][1], 14.0, 1e-12);
+
+        TS_ASSERT_THROWS_THIS(builder.SetScaleFactor(2.0), "The mesh must be rescaled before any wounds are cut");
+
+        // The kept elements are the ones left in the mesh, with their areas rescaled
+        std::vector<double> kept_areas;
+        for (unsigned elem_index=0; elem_index<p_mesh->GetNumAllElements(); elem_index++)
+        {
+            if (builder.IsElementKept(elem_index))
+            {
+                kept_areas.push_back(builder.GetAreaOfElement(elem_index));
+            }
+        }
+        builder.Build();
+        TS_ASSERT_EQUALS(p_mesh->GetNumElements(), 400u - num_in_circle - num_in_square);
+        TS_ASSERT_EQUALS(p_mesh->GetNumAllElements(), kept_areas.size());
+        for (unsigned elem_index=0; elem_index<p_mesh->GetNumAllElements(); elem_index++)
+        {
+            TS_ASSERT_DELTA(p_mesh->GetVolumeOfElement(elem_index), kept_areas[elem_index], 1e-9);
+        }
+
+        TS_ASSERT_THROWS_THIS(builder.Build(), "The mesh has already been built");
+    }
+
+    void TestRemoveLargeElements()
+    {
+        HoneycombVertexMeshGenerator generator(4, 4);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        WoundMeshBuilder builder(*p_mesh);
+
+        // The hexagons of a honeycomb all have six nodes
+        TS_ASSERT_EQUALS(builder.RemoveElementsWithMoreNodesThan(6), 0u);
+        TS_ASSERT_EQUALS(builder.RemoveElementsWithMoreNodesThan(5), 16u);
+        TS_ASSERT_EQUALS(builder.GetNumKeptElements(), 0u);
+        TS_ASSERT_THROWS_THIS(builder.RescaleToMeanElementArea(1.0), "There are no elements left to rescale");
+    }
+};
+
+#endif /*TESTWOUNDMESHBUILDER_HPP_*/
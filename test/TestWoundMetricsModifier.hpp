@@ -0,0 +1,222 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTWOUNDMETRICSMODIFIER_HPP_
+#define TESTWOUNDMETRICSMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "CheckpointArchiveTypes.hpp"
+#include "ArchiveOpener.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SmartPointers.hpp"
+#include "SimulationTime.hpp"
+#include "WoundHealingForce.hpp"
+#include "WoundMetricsModifier.hpp"
+#include "OutputFileHandler.hpp"
+#include "FileFinder.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+class TestWoundMetricsModifier : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestMetricsOfHexagonalWound()
+    {
+        // Create a honeycomb mesh and cut a hexagonal wound into its centre
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        c_vector<double, 2> wound_centre = p_mesh->GetCentroidOfElement(12);
+        double hexagon_area = p_mesh->GetVolumeOfElement(12);
+        double hexagon_perimeter = p_mesh->GetSurfaceAreaOfElement(12);
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        MAKE_PTR_ARGS(WoundMetricsModifier<2>, p_modifier, (p_force));
+        TS_ASSERT_EQUALS(p_modifier->GetWoundForce(), p_force);
+        TS_ASSERT_EQUALS(p_modifier->GetOutputTimestepMultiple(), 1u);
+        TS_ASSERT_EQUALS(p_modifier->GetUseBinaryOutput(), false);
+
+        // Mimic the first time step of a simulation: the force finds the ring, then the modifier measures it
+        p_modifier->SetupSolve(cell_population, "TestWoundMetricsModifier");
+        p_force->AddForceContribution(cell_population);
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        p_modifier->UpdateAtEndOfTimeStep(cell_population);
+
+        TS_ASSERT_EQUALS(p_modifier->GetNumWounds(), 1u);
+        TS_ASSERT_DELTA(p_modifier->GetWoundArea(0), hexagon_area, 1e-9);
+        TS_ASSERT_DELTA(p_modifier->GetWoundPerimeter(0), hexagon_perimeter, 1e-9);
+        TS_ASSERT_DELTA(p_modifier->GetWoundCircularity(0), M_PI/(2.0*sqrt(3.0)), 1e-9);
+        TS_ASSERT_DELTA(p_modifier->GetWoundClosureRate(0), 0.0, 1e-12);
+        TS_ASSERT_DELTA(p_modifier->GetTotalWoundArea(), hexagon_area, 1e-9);
+
+        // Shrink the wound by a factor of two about its centre
+        const std::vector<unsigned>& r_loop = p_force->rGetWoundLoops()[0];
+        for (unsigned i=0; i<r_loop.size(); i++)
+        {
+            c_vector<double, 2>& r_location = cell_population.GetNode(r_loop[i])->rGetModifiableLocation();
+            r_location = wound_centre + 0.5*(r_location - wound_centre);
+        }
+        p_force->AddForceContribution(cell_population);
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        p_modifier->UpdateAtEndOfTimeStep(cell_population);
+
+        // The shape is unchanged and three quarters of the area closed over the step of 0.1
+        TS_ASSERT_DELTA(p_modifier->GetWoundArea(0), 0.25*hexagon_area, 1e-9);
+        TS_ASSERT_DELTA(p_modifier->GetWoundPerimeter(0), 0.5*hexagon_perimeter, 1e-9);
+        TS_ASSERT_DELTA(p_modifier->GetWoundCircularity(0), M_PI/(2.0*sqrt(3.0)), 1e-9);
+        TS_ASSERT_DELTA(p_modifier->GetWoundClosureRate(0), 0.75*hexagon_area/0.1, 1e-9);
+        p_modifier->UpdateAtEndOfSolve(cell_population);
+
+        // There is a header and one row per step
+        FileFinder metrics_file("TestWoundMetricsModifier/wound_metrics.csv", RelativeTo::ChasteTestOutput);
+        TS_ASSERT(metrics_file.Exists());
+        std::ifstream metrics_stream(metrics_file.GetAbsolutePath().c_str());
+        std::string line;
+        unsigned num_lines = 0;
+        while (std::getline(metrics_stream, line))
+        {
+            num_lines++;
+        }
+        TS_ASSERT_EQUALS(num_lines, 3u);
+
+        // Check the modifier parameters are written
+        OutputFileHandler output_file_handler("TestWoundMetricsModifier", false);
+        out_stream parameter_file = output_file_handler.OpenOutputFile("wound_metrics_modifier.parameters");
+        p_modifier->OutputSimulationModifierParameters(parameter_file);
+        parameter_file->close();
+
+        FileFinder parameter_finder = output_file_handler.FindFile("wound_metrics_modifier.parameters");
+        std::ifstream parameter_stream(parameter_finder.GetAbsolutePath().c_str());
+        std::string parameters((std::istreambuf_iterator<char>(parameter_stream)), std::istreambuf_iterator<char>());
+        TS_ASSERT_DIFFERS(parameters.find("<OutputTimestepMultiple>1</OutputTimestepMultiple>"), std::string::npos);
+        TS_ASSERT_DIFFERS(parameters.find("<UseBinaryOutput>0</UseBinaryOutput>"), std::string::npos);
+    }
+
+    void TestBinaryOutputIsSampled()
+    {
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        MAKE_PTR_ARGS(WoundMetricsModifier<2>, p_modifier, (p_force));
+        p_modifier->SetUseBinaryOutput(true);
+        p_modifier->SetOutputTimestepMultiple(4);
+
+        p_modifier->SetupSolve(cell_population, "TestWoundMetricsModifierBinary");
+        for (unsigned step=0; step<10; step++)
+        {
+            p_force->AddForceContribution(cell_population);
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        }
+        p_modifier->UpdateAtEndOfSolve(cell_population);
+
+        // Steps 0, 4 and 8 are written, as 48 byte records
+        FileFinder metrics_file("TestWoundMetricsModifierBinary/wound_metrics.bin", RelativeTo::ChasteTestOutput);
+        std::ifstream metrics_stream(metrics_file.GetAbsolutePath().c_str(), std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(metrics_stream)), std::istreambuf_iterator<char>());
+        TS_ASSERT_EQUALS(contents.size(), 3u*48u);
+
+        double time;
+        memcpy(&time, contents.data() + 48, sizeof(double));
+        TS_ASSERT_DELTA(time, 0.5, 1e-12);
+        double area;
+        memcpy(&area, contents.data() + 48 + 16, sizeof(double));
+        TS_ASSERT_DELTA(area, p_modifier->GetWoundArea(0), 1e-12);
+    }
+
+    void TestArchiving()
+    {
+        FileFinder archive_dir("archive", RelativeTo::ChasteTestOutput);
+        std::string archive_file = "WoundMetricsModifier.arch";
+
+        {
+            MAKE_PTR(WoundHealingForce<2>, p_force);
+            p_force->SetWoundTensionParameter(3.0);
+            WoundMetricsModifier<2> modifier(p_force);
+            modifier.SetOutputTimestepMultiple(7);
+            modifier.SetUseBinaryOutput(true);
+
+            ArchiveOpener<boost::archive::text_oarchive, std::ofstream> arch_opener(archive_dir, archive_file);
+            boost::archive::text_oarchive* p_arch = arch_opener.GetCommonArchive();
+            AbstractCellBasedSimulationModifier<2,2>* const p_modifier = &modifier;
+            (*p_arch) << p_modifier;
+        }
+
+        {
+            AbstractCellBasedSimulationModifier<2,2>* p_modifier;
+
+            ArchiveOpener<boost::archive::text_iarchive, std::ifstream> arch_opener(archive_dir, archive_file);
+            boost::archive::text_iarchive* p_arch = arch_opener.GetCommonArchive();
+            (*p_arch) >> p_modifier;
+
+            WoundMetricsModifier<2>* p_metrics = static_cast<WoundMetricsModifier<2>*>(p_modifier);
+            TS_ASSERT_EQUALS(p_metrics->GetOutputTimestepMultiple(), 7u);
+            TS_ASSERT_EQUALS(p_metrics->GetUseBinaryOutput(), true);
+            TS_ASSERT_DELTA(p_metrics->GetWoundForce()->GetWoundTensionParameter(), 3.0, 1e-12);
+
+            delete p_modifier;
+        }
+    }
+};
+
+#endif /*TESTWOUNDMETRICSMODIFIER_HPP_*/
@@ -0,0 +1,254 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTWOUNDSNAPSHOTMODIFIER_HPP_
+#define TESTWOUNDSNAPSHOTMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SmartPointers.hpp"
+#include "SimulationTime.hpp"
+#include "OutputFileHandler.hpp"
+#include "FileFinder.hpp"
+#include "CompressedSnapshotWriter.hpp"
+#include "VertexMeshBinaryReader.hpp"
+#include "WoundHealingForce.hpp"
+#include "WoundSnapshotModifier.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+class TestWoundSnapshotModifier : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Decompress a snapshot into a binary mesh file.
+     */
+    void Decompress(const std::string& rCompressedPath, const std::string& rPath)
+    {
+        gzFile compressed_file = gzopen(rCompressedPath.c_str(), "rb");
+        TS_ASSERT(compressed_file != nullptr);
+        std::ofstream file(rPath.c_str(), std::ios::binary | std::ios::trunc);
+        char buffer[4096];
+        int num_bytes;
+        while ((num_bytes = gzread(compressed_file, buffer, sizeof(buffer))) > 0)
+        {
+            file.write(buffer, num_bytes);
+        }
+        TS_ASSERT_EQUALS(num_bytes, 0);
+        gzclose(compressed_file);
+    }
+
+    /**
+     * @return the events in the index of the snapshots in a folder
+     */
+    std::vector<std::string> ReadSnapshotEvents(const std::string& rFolder)
+    {
+        FileFinder index_file(rFolder + "/snapshots.csv", RelativeTo::ChasteTestOutput);
+        std::ifstream index_stream(index_file.GetAbsolutePath().c_str());
+        std::string line;
+        std::getline(index_stream, line);
+        TS_ASSERT_EQUALS(line, "index,time,event,file,num_nodes,num_elements,bytes,compressed_bytes");
+
+        std::vector<std::string> events;
+        while (std::getline(index_stream, line))
+        {
+            std::size_t start = line.find(',', line.find(',') + 1) + 1;
+            events.push_back(line.substr(start, line.find(',', start) - start));
+        }
+        return events;
+    }
+
+public:
+
+    void TestSnapshotsCanBeReadBack()
+    {
+        HoneycombVertexMeshGenerator generator(4, 4);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+        OutputFileHandler handler("TestCompressedSnapshotWriter");
+        CompressedSnapshotWriter writer(handler.GetOutputDirectoryFullPath(), 6);
+        TS_ASSERT_EQUALS(writer.WriteSnapshot(*p_mesh, 0.0, "first"), 0u);
+
+        // The mesh is copied when the snapshot is queued, so later changes do not affect it
+        c_vector<double, 2> old_location = p_mesh->GetNode(0)->rGetLocation();
+        p_mesh->GetNode(0)->rGetModifiableLocation()[0] += 1.0;
+        TS_ASSERT_EQUALS(writer.WriteSnapshot(*p_mesh, 0.5, "second"), 1u);
+        writer.Finish();
+        TS_ASSERT_EQUALS(writer.GetNumSnapshots(), 2u);
+        TS_ASSERT_THROWS_THIS(writer.WriteSnapshot(*p_mesh, 1.0, "third"),
+                              "No more snapshots can be written once the snapshot writer has finished");
+
+        std::vector<std::string> events = ReadSnapshotEvents("TestCompressedSnapshotWriter");
+        TS_ASSERT_EQUALS(events.size(), 2u);
+        TS_ASSERT_EQUALS(events[0], "first");
+        TS_ASSERT_EQUALS(events[1], "second");
+
+        std::string first_path = handler.GetOutputDirectoryFullPath() + "first.vmesh";
+        Decompress(handler.GetOutputDirectoryFullPath() + "snapshot_00000.vmesh.gz", first_path);
+        VertexMeshBinaryReader reader(first_path);
+        MutableVertexMesh<2,2> mesh;
+        mesh.ConstructFromMeshReader(reader);
+        TS_ASSERT_EQUALS(mesh.GetNumNodes(), p_mesh->GetNumNodes());
+        TS_ASSERT_EQUALS(mesh.GetNumElements(), p_mesh->GetNumElements());
+        TS_ASSERT_DELTA(mesh.GetNode(0)->rGetLocation()[0], old_location[0], 1e-12);
+        for (unsigned node_index=1; node_index<mesh.GetNumNodes(); node_index++)
+        {
+            TS_ASSERT_DELTA(mesh.GetNode(node_index)->rGetLocation()[0], p_mesh->GetNode(node_index)->rGetLocation()[0], 1e-12);
+            TS_ASSERT_DELTA(mesh.GetNode(node_index)->rGetLocation()[1], p_mesh->GetNode(node_index)->rGetLocation()[1], 1e-12);
+        }
+
+        std::string second_path = handler.GetOutputDirectoryFullPath() + "second.vmesh";
+        Decompress(handler.GetOutputDirectoryFullPath() + "snapshot_00001.vmesh.gz", second_path);
+        VertexMeshBinaryReader second_reader(second_path);
+        MutableVertexMesh<2,2> second_mesh;
+        second_mesh.ConstructFromMeshReader(second_reader);
+        TS_ASSERT_DELTA(second_mesh.GetNode(0)->rGetLocation()[0], old_location[0] + 1.0, 1e-12);
+
+        TS_ASSERT_THROWS_THIS(CompressedSnapshotWriter bad_writer(handler.GetOutputDirectoryFullPath(), 10),
+                              "The compression level must be between 0 and 9, or -1 for the default");
+    }
+
+    void TestSnapshotsAreTakenOnWoundEvents()
+    {
+        // Create a honeycomb mesh and cut a hexagonal wound into its centre
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        c_vector<double, 2> wound_centre = p_mesh->GetCentroidOfElement(12);
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        MAKE_PTR_ARGS(WoundSnapshotModifier<2>, p_modifier, (p_force));
+        p_modifier->AddAreaFraction(0.5);
+        p_modifier->AddAreaFraction(0.75);
+        p_modifier->AddAreaFraction(0.1);
+        p_modifier->SetSnapshotOnWoundEdgeChanges(true);
+        TS_ASSERT_EQUALS(p_modifier->rGetAreaFractions().size(), 3u);
+        TS_ASSERT_DELTA(p_modifier->rGetAreaFractions()[0], 0.75, 1e-12);
+        TS_ASSERT_DELTA(p_modifier->rGetAreaFractions()[2], 0.1, 1e-12);
+        TS_ASSERT_THROWS_THIS(p_modifier->AddAreaFraction(1.5), "A wound area fraction must be between 0 and 1");
+        TS_ASSERT_THROWS_THIS(p_modifier->SetCompressionLevel(12), "The compression level must be between 0 and 9");
+
+        // Mimic the time steps of a simulation: the force finds the rings, then the modifier follows them
+        p_modifier->SetupSolve(cell_population, "TestWoundSnapshotModifier");
+        TS_ASSERT_EQUALS(p_modifier->GetNumSnapshots(), 1u);
+
+        // The first step only measures the wound, and the second has nothing new
+        for (unsigned step=0; step<2; step++)
+        {
+            p_force->AddForceContribution(cell_population);
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        }
+        TS_ASSERT_EQUALS(p_modifier->GetNumSnapshots(), 1u);
+
+        // Shrink the wound to 64% and then 25% of its area
+        double scale_factors[2] = {0.8, 0.625};
+        for (unsigned step=0; step<2; step++)
+        {
+            const std::vector<unsigned>& r_loop = p_force->rGetWoundLoops()[0];
+            for (unsigned i=0; i<r_loop.size(); i++)
+            {
+                c_vector<double, 2>& r_location = cell_population.GetNode(r_loop[i])->rGetModifiableLocation();
+                r_location = wound_centre + scale_factors[step]*(r_location - wound_centre);
+            }
+            p_force->AddForceContribution(cell_population);
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        }
+        TS_ASSERT_EQUALS(p_modifier->GetNumSnapshots(), 3u);
+
+        // Widen the wound by deleting a neighbouring element, which changes its ring
+        p_mesh->DeleteElementPriorToReMesh(13);
+        p_mesh->ReMesh();
+        p_force->AddForceContribution(cell_population);
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        TS_ASSERT_EQUALS(p_modifier->GetNumSnapshots(), 4u);
+
+        // Removing a corner cell renumbers the nodes of the ring without changing it, so is not a wound edge change
+        unsigned first_ring_node = p_force->rGetWoundLoops()[0][0];
+        p_mesh->DeleteElementPriorToReMesh(0);
+        p_mesh->ReMesh();
+        p_force->AddForceContribution(cell_population);
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        p_modifier->UpdateAtEndOfTimeStep(cell_population);
+        TS_ASSERT_DIFFERS(p_force->rGetWoundLoops()[0][0], first_ring_node);
+        TS_ASSERT_EQUALS(p_modifier->GetNumSnapshots(), 4u);
+
+        p_modifier->UpdateAtEndOfSolve(cell_population);
+        TS_ASSERT_EQUALS(p_modifier->GetNumSnapshots(), 5u);
+
+        std::vector<std::string> events = ReadSnapshotEvents("TestWoundSnapshotModifier/snapshots");
+        TS_ASSERT_EQUALS(events.size(), 5u);
+        TS_ASSERT_EQUALS(events[0], "initial");
+        TS_ASSERT_EQUALS(events[1], "area_fraction_0.75");
+        TS_ASSERT_EQUALS(events[2], "area_fraction_0.5");
+        TS_ASSERT_EQUALS(events[3], "wound_edge");
+        TS_ASSERT_EQUALS(events[4], "final");
+
+        // Check the modifier parameters are written
+        OutputFileHandler output_file_handler("TestWoundSnapshotModifier", false);
+        out_stream parameter_file = output_file_handler.OpenOutputFile("wound_snapshot_modifier.parameters");
+        p_modifier->OutputSimulationModifierParameters(parameter_file);
+        parameter_file->close();
+
+        FileFinder parameter_finder = output_file_handler.FindFile("wound_snapshot_modifier.parameters");
+        std::ifstream parameter_stream(parameter_finder.GetAbsolutePath().c_str());
+        std::string parameters((std::istreambuf_iterator<char>(parameter_stream)), std::istreambuf_iterator<char>());
+        TS_ASSERT_DIFFERS(parameters.find("<AreaFractions>0.75,0.5,0.1</AreaFractions>"), std::string::npos);
+        TS_ASSERT_DIFFERS(parameters.find("<SnapshotOnWoundEdgeChanges>1</SnapshotOnWoundEdgeChanges>"), std::string::npos);
+        TS_ASSERT_DIFFERS(parameters.find("<CompressionLevel>1</CompressionLevel>"), std::string::npos);
+    }
+};
+
+#endif /*TESTWOUNDSNAPSHOTMODIFIER_HPP_*/
@@ -0,0 +1,207 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef TESTWOUNDTENSIONENSEMBLE_HPP_
+#define TESTWOUNDTENSIONENSEMBLE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SmartPointers.hpp"
+#include "SimpleTargetAreaModifier.hpp"
+#include "SimulationTime.hpp"
+#include "FarhadifarWoundHealingForce.hpp"
+#include "WoundHealingSimulation.hpp"
+#include "WoundTensionEnsemble.hpp"
+#include "WoundTestFixtures.hpp"
+
+#include <cmath>
+#include <vector>
+
+class TestWoundTensionEnsemble : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestLaneForcesMatchFusedForce()
+    {
+        HoneycombVertexMeshGenerator generator(6, 6);
+        VertexBasedCellPopulation<2>* p_cell_population = WoundTestFixtures::MakeWoundedPopulation(generator);
+
+        // Perturb the nodes, so that no forces cancel by symmetry
+        MutableVertexMesh<2,2>& r_mesh = p_cell_population->rGetMesh();
+        for (unsigned node_index=0; node_index<r_mesh.GetNumNodes(); node_index++)
+        {
+            c_vector<double, 2>& r_location = r_mesh.GetNode(node_index)->rGetModifiableLocation();
+            r_location[0] += 0.02*sin((double)node_index);
+            r_location[1] += 0.02*cos(3.0*node_index);
+        }
+
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+        p_force->SetAreaElasticityParameter(1.5);
+        p_force->SetPerimeterContractilityParameter(0.07);
+        p_force->SetLineTensionParameter(0.2);
+        p_force->SetBoundaryLineTensionParameter(0.3);
+
+        std::vector<double> wound_tensions;
+        wound_tensions.push_back(0.25);
+        wound_tensions.push_back(1.0);
+        wound_tensions.push_back(2.0);
+        WoundTensionEnsemble ensemble(*p_cell_population, p_force, wound_tensions, 0.01);
+        TS_ASSERT_EQUALS(ensemble.GetNumLanes(), 3u);
+        TS_ASSERT_EQUALS(ensemble.GetNumActiveLanes(), 3u);
+        ensemble.ComputeForces();
+
+        // Each lane has the forces of the fused force with its own wound tension
+        for (unsigned lane=0; lane<wound_tensions.size(); lane++)
+        {
+            TS_ASSERT_DELTA(ensemble.GetWoundTension(lane), wound_tensions[lane], 1e-12);
+            p_force->SetWoundTensionParameter(wound_tensions[lane]);
+            for (unsigned node_index=0; node_index<r_mesh.GetNumNodes(); node_index++)
+            {
+                r_mesh.GetNode(node_index)->ClearAppliedForce();
+            }
+            p_force->AddForceContribution(*p_cell_population);
+            for (unsigned node_index=0; node_index<r_mesh.GetNumNodes(); node_index++)
+            {
+                c_vector<double, 2> applied_force = r_mesh.GetNode(node_index)->rGetAppliedForce();
+                TS_ASSERT_DELTA(ensemble.GetNodeForce(node_index, lane)[0], applied_force[0], 1e-10);
+                TS_ASSERT_DELTA(ensemble.GetNodeForce(node_index, lane)[1], applied_force[1], 1e-10);
+            }
+        }
+
+        TS_ASSERT_THROWS_THIS(WoundTensionEnsemble(*p_cell_population, p_force, std::vector<double>(), 0.01),
+                              "An ensemble needs at least one wound tension");
+        p_cell_population->SetRestrictVertexMovementBoolean(true);
+        TS_ASSERT_THROWS_THIS(WoundTensionEnsemble(*p_cell_population, p_force, wound_tensions, 0.01),
+                              "The lanes of an ensemble move without restriction, so vertex movement must not be restricted in the population");
+        delete p_cell_population;
+    }
+
+    void TestLaneIsCarriedOnBySimulation()
+    {
+        // Run two wound tensions in lockstep for a few steps, before any swaps
+        HoneycombVertexMeshGenerator ensemble_generator(6, 6);
+        VertexBasedCellPopulation<2>* p_ensemble_population = WoundTestFixtures::MakeWoundedPopulation(ensemble_generator);
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_ensemble_force);
+        std::vector<double> wound_tensions;
+        wound_tensions.push_back(0.5);
+        wound_tensions.push_back(1.0);
+        WoundTensionEnsemble ensemble(*p_ensemble_population, p_ensemble_force, wound_tensions, 0.01);
+        ensemble.Run(10);
+        TS_ASSERT_EQUALS(ensemble.GetNumSteps(), 10u);
+        TS_ASSERT_EQUALS(ensemble.GetNumActiveLanes(), 2u);
+        TS_ASSERT_EQUALS(ensemble.GetLaneNumSteps(1), 10u);
+
+        // Hand the second lane off to a copy of the population, and carry on for ten more steps
+        HoneycombVertexMeshGenerator generator(6, 6);
+        VertexBasedCellPopulation<2>* p_cell_population = WoundTestFixtures::MakeWoundedPopulation(generator);
+        ensemble.HandOffLane(1, *p_cell_population);
+        TS_ASSERT_DELTA(SimulationTime::Instance()->GetTime(), 0.1, 1e-12);
+
+        WoundHealingSimulation<2> handed_off_simulator(*p_cell_population);
+        handed_off_simulator.SetOutputDirectory("TestWoundTensionEnsembleHandedOff");
+        handed_off_simulator.SetDt(0.01);
+        handed_off_simulator.SetEndTime(0.2);
+        handed_off_simulator.SetSamplingTimestepMultiple(100);
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+        p_force->SetWoundTensionParameter(1.0);
+        handed_off_simulator.AddForce(p_force);
+        MAKE_PTR(SimpleTargetAreaModifier<2>, p_growth_modifier);
+        p_growth_modifier->SetGrowthDuration(0.0);
+        handed_off_simulator.AddSimulationModifier(p_growth_modifier);
+        handed_off_simulator.Solve();
+
+        // The same twenty steps in a single simulation
+        SimulationTime::Destroy();
+        SimulationTime::Instance()->SetStartTime(0.0);
+        HoneycombVertexMeshGenerator reference_generator(6, 6);
+        VertexBasedCellPopulation<2>* p_reference_population = WoundTestFixtures::MakeWoundedPopulation(reference_generator);
+        WoundHealingSimulation<2> reference_simulator(*p_reference_population);
+        reference_simulator.SetOutputDirectory("TestWoundTensionEnsembleReference");
+        reference_simulator.SetDt(0.01);
+        reference_simulator.SetEndTime(0.2);
+        reference_simulator.SetSamplingTimestepMultiple(100);
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_reference_force);
+        p_reference_force->SetWoundTensionParameter(1.0);
+        reference_simulator.AddForce(p_reference_force);
+        reference_simulator.AddSimulationModifier(p_growth_modifier);
+        reference_simulator.Solve();
+
+        // The results only differ by rounding
+        MutableVertexMesh<2,2>& r_mesh = p_cell_population->rGetMesh();
+        MutableVertexMesh<2,2>& r_reference_mesh = p_reference_population->rGetMesh();
+        TS_ASSERT_EQUALS(r_mesh.GetNumNodes(), r_reference_mesh.GetNumNodes());
+        for (unsigned node_index=0; node_index<r_mesh.GetNumNodes(); node_index++)
+        {
+            TS_ASSERT_DELTA(r_mesh.GetNode(node_index)->rGetLocation()[0], r_reference_mesh.GetNode(node_index)->rGetLocation()[0], 1e-10);
+            TS_ASSERT_DELTA(r_mesh.GetNode(node_index)->rGetLocation()[1], r_reference_mesh.GetNode(node_index)->rGetLocation()[1], 1e-10);
+        }
+
+        delete p_ensemble_population;
+        delete p_cell_population;
+        delete p_reference_population;
+    }
+
+    void TestLanesSplitOffBeforeSwaps()
+    {
+        HoneycombVertexMeshGenerator generator(6, 6);
+        VertexBasedCellPopulation<2>* p_cell_population = WoundTestFixtures::MakeWoundedPopulation(generator);
+        MAKE_PTR(FarhadifarWoundHealingForce<2>, p_force);
+        std::vector<double> wound_tensions;
+        wound_tensions.push_back(1.0);
+        wound_tensions.push_back(4.0);
+        WoundTensionEnsemble ensemble(*p_cell_population, p_force, wound_tensions, 0.01);
+
+        // The wound closes, which takes swaps, so both lanes split off; the stronger tension gets there first
+        ensemble.Run(100000);
+        TS_ASSERT_EQUALS(ensemble.GetNumActiveLanes(), 0u);
+        TS_ASSERT_LESS_THAN(ensemble.GetNumSteps(), 100000u);
+        TS_ASSERT_LESS_THAN(ensemble.GetLaneNumSteps(1), ensemble.GetLaneNumSteps(0));
+        TS_ASSERT_EQUALS(ensemble.GetNumSteps(), ensemble.GetLaneNumSteps(0));
+
+        // Stepping again leaves the lanes where they split off
+        c_vector<double, 2> location = ensemble.GetNodeLocation(0, 1);
+        TS_ASSERT(ensemble.Step().empty());
+        TS_ASSERT(!ensemble.IsLaneActive(1));
+        TS_ASSERT_DELTA(ensemble.GetNodeLocation(0, 1)[0], location[0], 1e-12);
+        TS_ASSERT_DELTA(ensemble.GetNodeLocation(0, 1)[1], location[1], 1e-12);
+        delete p_cell_population;
+    }
+};
+
+#endif /*TESTWOUNDTENSIONENSEMBLE_HPP_*/
@@ -0,0 +1,288 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTWOUNDTRAJECTORYMODIFIER_HPP_
+#define TESTWOUNDTRAJECTORYMODIFIER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "AbstractCellBasedTestSuite.hpp"
+#include "FakePetscSetup.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SmartPointers.hpp"
+#include "SimulationTime.hpp"
+#include "OutputFileHandler.hpp"
+#include "FileFinder.hpp"
+#include "WoundHealingForce.hpp"
+#include "WoundMeshUtilities.hpp"
+#include "WoundTrajectoryFormat.hpp"
+#include "WoundTrajectoryModifier.hpp"
+#include "WoundTrajectoryWriter.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+class TestWoundTrajectoryModifier : public AbstractCellBasedTestSuite
+{
+private:
+
+    /** A block of a trajectory file that has been read back. */
+    struct Block
+    {
+        /** The header of the block. */
+        WoundTrajectoryBlockHeader mHeader;
+
+        /** The offset of the payload from the start of the file. */
+        std::size_t mPayloadOffset;
+    };
+
+    /**
+     * Read a trajectory file and find its blocks.
+     */
+    std::vector<Block> ReadBlocks(const std::string& rPath, std::vector<char>& rContents)
+    {
+        std::ifstream file(rPath.c_str(), std::ios::binary);
+        rContents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        TS_ASSERT(rContents.size() >= sizeof(WoundTrajectoryFileHeader));
+        TS_ASSERT_EQUALS(rContents.size()%8, 0u);
+
+        WoundTrajectoryFileHeader header;
+        memcpy(&header, rContents.data(), sizeof(header));
+        TS_ASSERT_EQUALS(std::string(header.mMagic, 8), std::string(WOUND_TRAJECTORY_MAGIC, 8));
+        TS_ASSERT_EQUALS(header.mVersion, WOUND_TRAJECTORY_VERSION);
+        TS_ASSERT_EQUALS(header.mByteOrderMark, WOUND_TRAJECTORY_BYTE_ORDER_MARK);
+
+        std::vector<Block> blocks;
+        std::size_t offset = sizeof(WoundTrajectoryFileHeader);
+        while (offset < rContents.size())
+        {
+            Block block;
+            memcpy(&block.mHeader, &rContents[offset], sizeof(WoundTrajectoryBlockHeader));
+            block.mPayloadOffset = offset + sizeof(WoundTrajectoryBlockHeader);
+            offset = block.mPayloadOffset + block.mHeader.mPayloadBytes;
+            blocks.push_back(block);
+        }
+        TS_ASSERT_EQUALS(offset, rContents.size());
+        return blocks;
+    }
+
+    /**
+     * @return a value from a column of a block
+     */
+    template<typename T>
+    T GetValue(const std::vector<char>& rContents, const Block& rBlock, const WoundTrajectoryBlockLayout& rLayout,
+               unsigned column, std::size_t index)
+    {
+        T value;
+        memcpy(&value, &rContents[rBlock.mPayloadOffset + rLayout.mColumnOffsets[column] + index*sizeof(T)], sizeof(T));
+        return value;
+    }
+
+public:
+
+    void TestWriterBatchesFramesAndStoresTopologyChanges()
+    {
+        HoneycombVertexMeshGenerator generator(4, 4);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        const unsigned num_nodes = p_mesh->GetNumNodes();
+        const double old_x = p_mesh->GetNode(0)->rGetLocation()[0];
+
+        // Make the blocks hold three frames each
+        OutputFileHandler handler("TestWoundTrajectoryWriter");
+        std::string path = handler.GetOutputDirectoryFullPath() + "trajectory.wtraj";
+        WoundTrajectoryWriter writer(path, 3*num_nodes*2*sizeof(double));
+        TS_ASSERT_EQUALS(writer.GetNumTopologyVersions(), 0u);
+
+        // Nodes move between the first four frames, then an element is removed
+        for (unsigned frame=0; frame<4; frame++)
+        {
+            p_mesh->GetNode(0)->rGetModifiableLocation()[0] = old_x + 0.01*frame;
+            writer.AddFrame(*p_mesh, 0.1*frame);
+        }
+        TS_ASSERT_EQUALS(writer.GetNumTopologyVersions(), 1u);
+        p_mesh->DeleteElementPriorToReMesh(5);
+        p_mesh->ReMesh();
+        writer.AddFrame(*p_mesh, 0.4);
+        writer.AddWoundMetrics(0.4, 0, 6, 1.5, 4.5);
+        TS_ASSERT_EQUALS(writer.GetNumTopologyVersions(), 2u);
+        writer.Close();
+        TS_ASSERT_THROWS_THIS(writer.AddFrame(*p_mesh, 0.5),
+                              "Frames cannot be added to the wound trajectory file " + path + " once it is closed");
+
+        TS_ASSERT_EQUALS(writer.GetNumFrames(), 5u);
+        TS_ASSERT_EQUALS(writer.GetNumMetricsRows(), 1u);
+
+        // The first topology, a block of three frames, the second topology, then the rest
+        std::vector<char> contents;
+        std::vector<Block> blocks = ReadBlocks(path, contents);
+        TS_ASSERT_EQUALS(blocks.size(), 5u);
+        TS_ASSERT_EQUALS(writer.GetNumBlocks(), 5u);
+        TS_ASSERT_EQUALS(writer.GetNumBytesWritten(), contents.size());
+        TS_ASSERT_EQUALS(blocks[0].mHeader.mBlockType, (uint32_t)WOUND_TRAJECTORY_TOPOLOGY_BLOCK);
+        TS_ASSERT_EQUALS(blocks[1].mHeader.mBlockType, (uint32_t)WOUND_TRAJECTORY_FRAMES_BLOCK);
+        TS_ASSERT_EQUALS(blocks[2].mHeader.mBlockType, (uint32_t)WOUND_TRAJECTORY_TOPOLOGY_BLOCK);
+        TS_ASSERT_EQUALS(blocks[3].mHeader.mBlockType, (uint32_t)WOUND_TRAJECTORY_FRAMES_BLOCK);
+        TS_ASSERT_EQUALS(blocks[4].mHeader.mBlockType, (uint32_t)WOUND_TRAJECTORY_METRICS_BLOCK);
+
+        // The first topology holds the whole honeycomb
+        WoundTrajectoryBlockLayout topology_layout = WoundTrajectoryBlockLayout::ForTopology(num_nodes, 16, 0);
+        TS_ASSERT_EQUALS(GetValue<uint32_t>(contents, blocks[0], topology_layout, 0, 0), 0u);
+        TS_ASSERT_EQUALS(GetValue<uint32_t>(contents, blocks[0], topology_layout, 0, 1), num_nodes);
+        TS_ASSERT_EQUALS(GetValue<uint32_t>(contents, blocks[0], topology_layout, 0, 2), 16u);
+        TS_ASSERT_EQUALS(GetValue<uint32_t>(contents, blocks[2], topology_layout, 0, 0), 1u);
+        TS_ASSERT_EQUALS(GetValue<uint32_t>(contents, blocks[2], topology_layout, 0, 2), 15u);
+
+        // The frames of the first block share the first topology, and node 0 moves between them
+        TS_ASSERT_EQUALS(blocks[1].mHeader.mNumRecords, 3u);
+        TS_ASSERT_EQUALS(blocks[1].mHeader.mNumFrameNodes, 3u*num_nodes);
+        WoundTrajectoryBlockLayout frames_layout = WoundTrajectoryBlockLayout::ForFrames(3, 3*num_nodes);
+        TS_ASSERT_EQUALS(blocks[1].mHeader.mPayloadBytes, frames_layout.mPayloadBytes);
+        for (unsigned frame=0; frame<3; frame++)
+        {
+            TS_ASSERT_DELTA(GetValue<double>(contents, blocks[1], frames_layout, 0, frame), 0.1*frame, 1e-12);
+            TS_ASSERT_EQUALS(GetValue<uint32_t>(contents, blocks[1], frames_layout, 1, frame), 0u);
+            TS_ASSERT_EQUALS(GetValue<uint64_t>(contents, blocks[1], frames_layout, 2, frame), frame*num_nodes);
+            TS_ASSERT_DELTA(GetValue<double>(contents, blocks[1], frames_layout, 3, frame*num_nodes), old_x + 0.01*frame, 1e-12);
+        }
+        TS_ASSERT_DELTA(GetValue<double>(contents, blocks[1], frames_layout, 4, num_nodes + 1),
+                        p_mesh->GetNode(1)->rGetLocation()[1], 1e-12);
+
+        // The last frame comes after the removal, and so uses the second topology
+        TS_ASSERT_EQUALS(blocks[3].mHeader.mNumRecords, 2u);
+        frames_layout = WoundTrajectoryBlockLayout::ForFrames(2, blocks[3].mHeader.mNumFrameNodes);
+        TS_ASSERT_EQUALS(GetValue<uint32_t>(contents, blocks[3], frames_layout, 1, 0), 0u);
+        TS_ASSERT_EQUALS(GetValue<uint32_t>(contents, blocks[3], frames_layout, 1, 1), 1u);
+        TS_ASSERT_EQUALS(GetValue<uint64_t>(contents, blocks[3], frames_layout, 2, 2), num_nodes + p_mesh->GetNumNodes());
+
+        WoundTrajectoryBlockLayout metrics_layout = WoundTrajectoryBlockLayout::ForMetrics(1);
+        TS_ASSERT_EQUALS(blocks[4].mHeader.mNumRecords, 1u);
+        TS_ASSERT_EQUALS(GetValue<uint32_t>(contents, blocks[4], metrics_layout, 2, 0), 6u);
+        TS_ASSERT_DELTA(GetValue<double>(contents, blocks[4], metrics_layout, 3, 0), 1.5, 1e-12);
+        TS_ASSERT_DELTA(GetValue<double>(contents, blocks[4], metrics_layout, 4, 0), 4.5, 1e-12);
+    }
+
+    void TestModifierStoresFramesAndWoundMetrics()
+    {
+        // Create a honeycomb mesh and cut a hexagonal wound into its centre
+        HoneycombVertexMeshGenerator generator(5, 5);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        c_vector<double, 2> wound_centre = p_mesh->GetCentroidOfElement(12);
+        p_mesh->DeleteElementPriorToReMesh(12);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 10);
+
+        MAKE_PTR(WoundHealingForce<2>, p_force);
+        MAKE_PTR_ARGS(WoundTrajectoryModifier<2>, p_modifier, (p_force));
+        p_modifier->SetOutputTimestepMultiple(2);
+        TS_ASSERT_EQUALS(p_modifier->GetOutputTimestepMultiple(), 2u);
+        TS_ASSERT_EQUALS(p_modifier->GetBlockBytes(), 16u*1024u*1024u);
+        TS_ASSERT_EQUALS(p_modifier->GetNumFrames(), 0u);
+
+        // Mimic the time steps of a simulation, shrinking the wound at each one
+        p_modifier->SetupSolve(cell_population, "TestWoundTrajectoryModifier");
+        TS_ASSERT_EQUALS(p_modifier->GetNumFrames(), 1u);
+
+        std::vector<double> expected_areas;
+        for (unsigned step=0; step<4; step++)
+        {
+            p_force->AddForceContribution(cell_population);
+            const std::vector<unsigned>& r_loop = p_force->rGetWoundLoops()[0];
+            for (unsigned i=0; i<r_loop.size(); i++)
+            {
+                c_vector<double, 2>& r_location = cell_population.GetNode(r_loop[i])->rGetModifiableLocation();
+                r_location = wound_centre + 0.9*(r_location - wound_centre);
+            }
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            p_modifier->UpdateAtEndOfTimeStep(cell_population);
+            if (step%2 == 1)
+            {
+                expected_areas.push_back(-WoundMeshUtilities::GetSignedAreaOfLoop(*p_mesh, r_loop));
+            }
+        }
+        TS_ASSERT_EQUALS(p_modifier->GetNumFrames(), 3u);
+        p_modifier->UpdateAtEndOfSolve(cell_population);
+        TS_ASSERT_EQUALS(p_modifier->GetNumTopologyVersions(), 1u);
+
+        // The frames and metrics are small enough to be written as one block each
+        OutputFileHandler output_file_handler("TestWoundTrajectoryModifier", false);
+        std::vector<char> contents;
+        std::vector<Block> blocks = ReadBlocks(output_file_handler.GetOutputDirectoryFullPath() + "trajectory.wtraj", contents);
+        TS_ASSERT_EQUALS(blocks.size(), 3u);
+        TS_ASSERT_EQUALS(blocks[1].mHeader.mBlockType, (uint32_t)WOUND_TRAJECTORY_FRAMES_BLOCK);
+        TS_ASSERT_EQUALS(blocks[1].mHeader.mNumRecords, 3u);
+        TS_ASSERT_EQUALS(blocks[2].mHeader.mBlockType, (uint32_t)WOUND_TRAJECTORY_METRICS_BLOCK);
+        TS_ASSERT_EQUALS(blocks[2].mHeader.mNumRecords, 2u);
+
+        WoundTrajectoryBlockLayout frames_layout = WoundTrajectoryBlockLayout::ForFrames(3, blocks[1].mHeader.mNumFrameNodes);
+        TS_ASSERT_DELTA(GetValue<double>(contents, blocks[1], frames_layout, 0, 0), 0.0, 1e-12);
+        TS_ASSERT_DELTA(GetValue<double>(contents, blocks[1], frames_layout, 0, 1), 0.2, 1e-12);
+        TS_ASSERT_DELTA(GetValue<double>(contents, blocks[1], frames_layout, 0, 2), 0.4, 1e-12);
+
+        // The hexagonal wound keeps its six nodes and shrinks by 19% every two steps
+        WoundTrajectoryBlockLayout metrics_layout = WoundTrajectoryBlockLayout::ForMetrics(2);
+        for (unsigned row=0; row<2; row++)
+        {
+            TS_ASSERT_DELTA(GetValue<double>(contents, blocks[2], metrics_layout, 0, row), 0.2*(row + 1), 1e-12);
+            TS_ASSERT_EQUALS(GetValue<uint32_t>(contents, blocks[2], metrics_layout, 1, row), 0u);
+            TS_ASSERT_EQUALS(GetValue<uint32_t>(contents, blocks[2], metrics_layout, 2, row), 6u);
+            TS_ASSERT_DELTA(GetValue<double>(contents, blocks[2], metrics_layout, 3, row), expected_areas[row], 1e-12);
+        }
+        TS_ASSERT_DELTA(expected_areas[1]/expected_areas[0], 0.81, 1e-9);
+
+        // Check the modifier parameters are written
+        out_stream parameter_file = output_file_handler.OpenOutputFile("wound_trajectory_modifier.parameters");
+        p_modifier->OutputSimulationModifierParameters(parameter_file);
+        parameter_file->close();
+
+        FileFinder parameter_finder = output_file_handler.FindFile("wound_trajectory_modifier.parameters");
+        std::ifstream parameter_stream(parameter_finder.GetAbsolutePath().c_str());
+        std::string parameters((std::istreambuf_iterator<char>(parameter_stream)), std::istreambuf_iterator<char>());
+        TS_ASSERT_DIFFERS(parameters.find("<OutputTimestepMultiple>2</OutputTimestepMultiple>"), std::string::npos);
+        TS_ASSERT_DIFFERS(parameters.find("<BlockBytes>16777216</BlockBytes>"), std::string::npos);
+    }
+};
+
+#endif /*TESTWOUNDTRAJECTORYMODIFIER_HPP_*/
@@ -0,0 +1,83 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+#ifndef WOUNDTESTFIXTURES_HPP_
+#define WOUNDTESTFIXTURES_HPP_
+
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "CellsGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "SimpleTargetAreaModifier.hpp"
+
+#include <vector>
+
+/**
+ * Populations shared by the tests of the solvers that take a wounded tissue as a whole,
+ * such as WoundEnergyMinimiser and WoundTensionEnsemble.
+ */
+class WoundTestFixtures
+{
+public:
+
+    /**
+     * Make a honeycomb population with a wound of two cells, whose cells have their target areas.
+     * The nodes move without restriction, as both solvers require.
+     *
+     * @param rGenerator the generator of the mesh, at least six cells across
+     * @return the population, to be deleted by the caller
+     */
+    static VertexBasedCellPopulation<2>* MakeWoundedPopulation(HoneycombVertexMeshGenerator& rGenerator)
+    {
+        MutableVertexMesh<2,2>* p_mesh = rGenerator.GetMesh();
+        p_mesh->DeleteElementPriorToReMesh(14);
+        p_mesh->DeleteElementPriorToReMesh(15);
+        p_mesh->ReMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2>* p_cell_population = new VertexBasedCellPopulation<2>(*p_mesh, cells);
+        p_cell_population->SetRestrictVertexMovementBoolean(false);
+
+        SimpleTargetAreaModifier<2> target_area_modifier;
+        target_area_modifier.SetGrowthDuration(0.0);
+        target_area_modifier.UpdateTargetAreas(*p_cell_population);
+        return p_cell_population;
+    }
+};
+
+#endif /*WOUNDTESTFIXTURES_HPP_*/